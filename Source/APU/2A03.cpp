@@ -110,8 +110,13 @@ void C2A03::Process(uint32_t Time, Blip_Buffer& Output)
 		// the result of `Tick(clocks); Render()` should be sent to Blip_Synth
 		// at the instant in time *before* Tick() is called.
 		// See https://docs.google.com/document/d/1BnXwR3Avol7S5YNa3d4duGdbI6GNMwuYWLHuYiMZh5Y/edit#heading=h.lnh9d8j1x3uc
+		//
+		// ClocksUntilLevelChange() skips over steps which don't change a channel's level,
+		// so each iteration covers a whole run of identical levels rather than a single
+		// wavetable/LFSR step. Pulse lookahead is disabled while a frame sequencer step
+		// is pending, since a sweep may change the period.
 		auto dclocks = vmin(
-			m_Apu1.ClocksUntilLevelChange(),
+			m_Apu1.ClocksUntilLevelChange(!m_Apu2.FrameSequencePending()),
 			m_Apu2.ClocksUntilLevelChange(),
 			Time - now);
 		get_output(dclocks, now, Output);
@@ -175,6 +180,14 @@ int C2A03::GetChannelLevel(int Channel)
 	return 0;
 }
 
+int C2A03::GetChannelOutput(int Channel) const
+{
+	if (0 <= Channel && Channel < 5) {
+		return m_ChannelLevels[Channel].getCurrent();
+	}
+	return 0;
+}
+
 int C2A03::GetChannelLevelRange(int Channel) const
 {
 	ASSERT(0 <= Channel && Channel < 5);
@@ -92,6 +92,7 @@ public:
 
 	double GetFreq(int Channel) const override;		// // //
 	int GetChannelLevel(int Channel) override;
+	int GetChannelOutput(int Channel) const override;
 	int GetChannelLevelRange(int Channel) const override;
 
 public:
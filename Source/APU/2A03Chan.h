@@ -25,20 +25,12 @@
 
 class C2A03Chan : public CChannel {		// // //
 public:
-	C2A03Chan(CMixer *pMixer, uint8_t Chip, uint8_t ID) : CChannel(pMixer, Chip, ID) { }
+	C2A03Chan(Blip_Synth<blip_good_quality> &Synth, uint8_t Chip, uint8_t ID) : CChannel(Synth, Chip, ID) { }
 
 	inline uint16_t GetPeriod() const {
 		return m_iPeriod;
 	}
 
-protected:
-	inline void Mix(int32_t Value) {
-		if (m_iLastValue != Value) {
-			m_pMixer->AddValue(m_iChanId, m_iChip, Value, Value, m_iTime);
-			m_iLastValue = Value;
-		}
-	};
-
 protected:
 	// Variables used by channels
 	uint8_t		m_iControlReg;
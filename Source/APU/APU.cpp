@@ -32,7 +32,6 @@
 #include "N163.h"
 #include "VRC7.h"
 #include "S5B.h"
-#include "SoundChip.h"
 #include "SoundChip2.h"
 #include "../RegisterState.h"		// // //
 #include "../SpeedDlg.h"
@@ -159,17 +158,16 @@ CAPU::CAPU(IAudioCallback *pCallback) :		// // //
 	m_pSoundBuffer(NULL),
 	m_pMixer(new CMixer(this)),
 	m_p2A03(std::make_unique<C2A03>()),
+	m_pVRC6(std::make_unique<CVRC6>()),
+	m_pMMC5(std::make_unique<CMMC5>()),
 	m_pFDS(std::make_unique<CFDS>()),
 	m_pN163(std::make_unique<CN163>()),
 	m_pVRC7(std::make_unique<CVRC7>()),
+	m_pS5B(std::make_unique<CS5B>()),
 	m_iExternalSoundChips(0),
 	m_iCyclesToRun(0),
 	m_iSampleRate(44100)		// // //
 {
-	m_pMMC5 = new CMMC5(m_pMixer);
-	m_pVRC6 = new CVRC6(m_pMixer);
-	m_pS5B  = new CS5B(m_pMixer);
-
 	m_fLevelVRC7 = 1.0f;
 
 #ifdef LOGGING
@@ -180,10 +178,6 @@ CAPU::CAPU(IAudioCallback *pCallback) :		// // //
 
 CAPU::~CAPU()
 {
-	SAFE_RELEASE(m_pMMC5);
-	SAFE_RELEASE(m_pVRC6);
-	SAFE_RELEASE(m_pS5B);
-
 	SAFE_RELEASE(m_pMixer);
 
 	SAFE_RELEASE(m_pSoundBuffer);
@@ -200,22 +194,29 @@ CAPU::~CAPU()
 //
 void CAPU::Process()
 {	
+	const bool ScopeTapEnabled = m_ChannelScopeTap.IsEnabled();
+
 	while (m_iCyclesToRun > 0) {
 
 		uint32_t Time = m_iCyclesToRun;
 		Time = std::min(Time, m_iSequencerNext - m_iSequencerClock);		// // //
 		Time = std::min(Time, m_iFrameClock);
+		if (ScopeTapEnabled)
+			Time = std::min(Time, m_ChannelScopeTap.CyclesUntilSample());
 
-		for (auto Chip : m_SoundChips)		// // //
-			Chip->Process(Time);
-		for (auto Chip : m_SoundChips2)
-			Chip->Process(Time, m_pMixer->GetBuffer());
+		for (std::size_t i = 0; i < m_SoundChips2.size(); ++i) {		// // //
+			AUDIO_PROFILE_SCOPE(PROFILE_CHIP_PROCESS + m_SoundChipProfileIds[i]);
+			m_SoundChips2[i]->Process(Time, m_pMixer->GetBuffer());
+		}
 
 		m_iFrameCycles	  += Time;
 		m_iSequencerClock += Time;
 		m_iFrameClock	  -= Time;
 		m_iCyclesToRun	  -= Time;
 
+		if (ScopeTapEnabled && m_ChannelScopeTap.Advance(Time))
+			SampleChannelScopes();
+
 		if (m_iSequencerClock == m_iSequencerNext)
 			StepSequence();		// // //
 
@@ -233,15 +234,22 @@ void CAPU::StepSequence()		// // //
 	m_pMMC5->ClockSequence();		// // //
 }
 
+void CAPU::SampleChannelScopes()
+{
+	std::array<int16_t, CHANNELS> Levels;
+	m_pMixer->GetChannelOutputs(Levels);
+	m_ChannelScopeTap.Push(Levels);
+}
+
 // End of audio frame, flush the buffer if enough samples has been produced, and start a new frame
 void CAPU::EndFrame()
 {
 	// The APU will always output audio in 32 bit signed format
 	
-	for (auto Chip : m_SoundChips)		// // //
-		Chip->EndFrame();
-	for (auto Chip : m_SoundChips2)
-		Chip->EndFrame(m_pMixer->GetBuffer(), gsl::span(m_pSoundBuffer, m_iSoundBufferSize << 1));
+	for (std::size_t i = 0; i < m_SoundChips2.size(); ++i) {		// // //
+		AUDIO_PROFILE_SCOPE(PROFILE_CHIP_END_FRAME + m_SoundChipProfileIds[i]);
+		m_SoundChips2[i]->EndFrame(m_pMixer->GetBuffer(), gsl::span(m_pSoundBuffer, m_iSoundBufferSize << 1));
+	}
 
 	m_pMixer->FinishBuffer(m_iFrameCycles);
 	int ReadSamples	= m_pMixer->ReadBuffer(m_pSoundBuffer);
@@ -250,9 +258,7 @@ void CAPU::EndFrame()
 	m_iFrameClock /*+*/= m_iFrameCycleCount;
 	m_iFrameCycles = 0;
 
-	for (auto& r : m_SoundChips)		// // //
-		r->GetRegisterLogger()->Step();
-	for (auto& r : m_SoundChips2)
+	for (auto& r : m_SoundChips2)		// // //
 		r->GetRegisterLogger()->Step();
 
 #ifdef LOGGING
@@ -275,11 +281,7 @@ void CAPU::Reset()
 	
 	m_pMixer->ClearBuffer();
 	
-	for (auto Chip : m_SoundChips) {		// // //
-		Chip->GetRegisterLogger()->Reset();
-		Chip->Reset();
-	}
-	for (auto Chip : m_SoundChips2) {
+	for (auto Chip : m_SoundChips2) {		// // //
 		Chip->GetRegisterLogger()->Reset();
 		Chip->Reset();
 	}
@@ -293,22 +295,28 @@ void CAPU::SetExternalSound(uint8_t Chip)
 {
 	// Initialize list of active sound chips.
 	// Do this first because m_SoundChips2 is used by CMixer::ExternalSound() -> CMixer::UpdateMixing().
-	m_SoundChips.clear();
 	m_SoundChips2.clear();
+	m_SoundChipProfileIds.clear();		// // //
+
+	auto AddChip = [&] (CSoundChip2 *pChip, profile_chip_t ProfileId) {		// // //
+		pChip->SetOutput(m_pMixer->GetBuffer());
+		m_SoundChips2.push_back(pChip);
+		m_SoundChipProfileIds.push_back(ProfileId);
+	};
 
-	m_SoundChips2.push_back(m_p2A03.get());		// // //
+	AddChip(m_p2A03.get(), PROFILE_CHIP_2A03);		// // //
 	if (Chip & SNDCHIP_VRC6)
-		m_SoundChips.push_back(m_pVRC6);
+		AddChip(m_pVRC6.get(), PROFILE_CHIP_VRC6);
 	if (Chip & SNDCHIP_VRC7)
-		m_SoundChips2.push_back(m_pVRC7.get());
+		AddChip(m_pVRC7.get(), PROFILE_CHIP_VRC7);
 	if (Chip & SNDCHIP_FDS)
-		m_SoundChips2.push_back(m_pFDS.get());
+		AddChip(m_pFDS.get(), PROFILE_CHIP_FDS);
 	if (Chip & SNDCHIP_MMC5)
-		m_SoundChips.push_back(m_pMMC5);
+		AddChip(m_pMMC5.get(), PROFILE_CHIP_MMC5);
 	if (Chip & SNDCHIP_N163)
-		m_SoundChips2.push_back(m_pN163.get());
+		AddChip(m_pN163.get(), PROFILE_CHIP_N163);
 	if (Chip & SNDCHIP_S5B)
-		m_SoundChips.push_back(m_pS5B);
+		AddChip(m_pS5B.get(), PROFILE_CHIP_S5B);
 
 	// Set (unused) bitfield of external sound chips enabled.
 	m_iExternalSoundChips = Chip;
@@ -391,9 +399,7 @@ void CAPU::Write(uint16_t Address, uint8_t Value)
 
 	Process();
 	
-	for (auto Chip : m_SoundChips)		// // //
-		Chip->Write(Address, Value);
-	for (auto Chip : m_SoundChips2)
+	for (auto Chip : m_SoundChips2)		// // //
 		Chip->Write(Address, Value);
 
 	LogWrite(Address, Value);
@@ -409,10 +415,7 @@ uint8_t CAPU::Read(uint16_t Address)
 
 	Process();
 	
-	for (auto Chip : m_SoundChips)		// // //
-		if (!Mapped)
-			Value = Chip->Read(Address, Mapped);
-	for (auto Chip : m_SoundChips2)
+	for (auto Chip : m_SoundChips2)		// // //
 		if (!Mapped)
 			Value = Chip->Read(Address, Mapped);
 
@@ -424,6 +427,11 @@ uint8_t CAPU::Read(uint16_t Address)
 
 // Expansion for famitracker
 
+CChannelScopeTap *CAPU::GetChannelScopeTap()
+{
+	return &m_ChannelScopeTap;
+}
+
 int32_t CAPU::GetVol(uint8_t Chan) const	
 {
 	return m_pMixer->GetChanOutput(Chan);
@@ -509,9 +517,7 @@ int CAPU::GetMeterDecayRate() const		// // // 050B
 
 void CAPU::LogWrite(uint16_t Address, uint8_t Value)
 {
-	for (auto &r : m_SoundChips)		// // //
-		r->Log(Address, Value);
-	for (auto& r : m_SoundChips2)
+	for (auto& r : m_SoundChips2)		// // //
 		r->Log(Address, Value);
 }
 
@@ -26,6 +26,8 @@
 #include "../Common.h"
 // TODO switch to MixerCommon.h, with forward-declaration of CMixer, plus MixerConfig
 #include "Mixer.h"
+#include "ChannelScopeTap.h"
+#include "../AudioProfiler.h"		// // //
 
 #include <vector>
 #include <memory>
@@ -43,7 +45,6 @@ class CMMC5;
 class CN163;
 class CS5B;
 
-class CSoundChip;		// // //
 class CSoundChip2;
 class CRegisterState;		// // //
 
@@ -95,6 +96,8 @@ private:
 	// End configuration methods.
 
 public:
+	CChannelScopeTap *GetChannelScopeTap();
+
 	void	SetMeterDecayRate(int Type) const;		// // // 050B
 	int		GetMeterDecayRate() const;		// // // 050B
 
@@ -121,6 +124,7 @@ private:
 	static const int SEQUENCER_FREQUENCY;		// // //
 
 	void StepSequence();		// // //
+	void SampleChannelScopes();
 	void EndFrame();
 
 	void LogWrite(uint16_t Address, uint8_t Value);
@@ -131,19 +135,19 @@ private:
 
 	// Expansion chips
 	std::unique_ptr<C2A03> m_p2A03;
-	CVRC6		*m_pVRC6;
-	CMMC5		*m_pMMC5;
+	std::unique_ptr<CVRC6> m_pVRC6;
+	std::unique_ptr<CMMC5> m_pMMC5;
 	std::unique_ptr<CFDS> m_pFDS;
 	std::unique_ptr<CN163> m_pN163;
 	std::unique_ptr<CVRC7> m_pVRC7;
-	CS5B		*m_pS5B;
+	std::unique_ptr<CS5B> m_pS5B;
 
 	/// Bitfield of external sound chips enabled.
 	/// Never read, except for code hidden behind #ifdef LOGGING.
 	uint8_t		m_iExternalSoundChips;
 
-	std::vector<CSoundChip*> m_SoundChips;
 	std::vector<CSoundChip2*> m_SoundChips2;
+	std::vector<profile_chip_t> m_SoundChipProfileIds;		// // // Parallel to m_SoundChips2
 
 	uint32_t	m_iSampleRate;						// // //
 	uint32_t	m_iFrameCycleCount;
@@ -164,6 +168,8 @@ private:
 	uint8_t		m_iSequencerCount;					// // // Step count for sequencer
 
 	float		m_fLevelVRC7;
+
+	CChannelScopeTap m_ChannelScopeTap;				// Per-channel oscilloscope samples
 	// // // 050B removed
 
 #ifdef LOGGING
@@ -21,16 +21,20 @@
 
 #pragma once
 
-class CMixer;
+#include "Blip_Buffer/Blip_Buffer.h"
+#include "ChannelLevelState.h"
 
 //
 // This class is used to derive the audio channels
 //
+// Each channel writes its deltas directly to the Blip_Synth owned by its sound chip,
+// into the buffer passed to SetOutput() by CSoundChip2::SetOutput() when the chip is attached.
+//
 
 class CChannel {
 public:
-	CChannel(CMixer *pMixer, uint8_t Chip, uint8_t ID) :
-		m_pMixer(pMixer), m_iChip(Chip), m_iChanId(ID), m_iTime(0), m_iLastValue(0) 
+	CChannel(Blip_Synth<blip_good_quality> &Synth, uint8_t Chip, uint8_t ID) :
+		m_Synth(Synth), m_pOutput(nullptr), m_iChip(Chip), m_iChanId(ID), m_iTime(0), m_iLastValue(0)
 	{
 	}
 
@@ -38,19 +42,37 @@ public:
 
 	virtual double GetFrequency() const = 0;		// // //
 
+	void SetOutput(Blip_Buffer *pOutput) { m_pOutput = pOutput; }
+
+	/// See CSoundChip2::GetChannelLevel() and CSoundChip2::GetChannelOutput().
+	int GetLevel() { return m_Level.getLevel(); }
+	int GetOutput() const { return m_Level.getCurrent(); }
+
 protected:
-	virtual void Mix(int32_t Value) {
+	void Mix(int32_t Value) {
 		int32_t Delta = Value - m_iLastValue;
-		if (Delta)
-			m_pMixer->AddValue(m_iChanId, m_iChip, Delta, Value, m_iTime);
-		m_iLastValue = Value;
+		if (Delta) {
+			if (m_pOutput)
+				m_Synth.offset_inline(m_iTime, Delta, m_pOutput);
+			m_iLastValue = Value;
+			m_Level.update(-Value);		// outputs are inverted, meters and scopes show the magnitude
+		}
+	}
+
+	/// Forgets the last output without writing a delta, used when the output buffer is cleared as well.
+	void ClearOutput() {
+		m_iLastValue = 0;
+		m_Level = { };
 	}
 
 protected:
-	CMixer		*m_pMixer;			// The mixer
+	Blip_Synth<blip_good_quality> &m_Synth;		// Synth of the sound chip
+	Blip_Buffer	*m_pOutput;			// Output buffer, owned by the mixer
 
 	uint32_t	m_iTime;			// Cycle counter, resets every new frame
 	uint8_t		m_iChanId;			// This channels unique ID
 	uint8_t		m_iChip;			// Chip
-	int32_t		m_iLastValue;		// Last value sent to mixer
+	int32_t		m_iLastValue;		// Last value sent to the synth
+
+	ChannelLevelState<int32_t> m_Level;
 };
@@ -18,6 +18,12 @@ public:
 		m_MaxLevel = max(m_MaxLevel, m_CurrLevel);
 	}
 
+	/// Returns the most recent level without resetting the range.
+	T getCurrent() const
+	{
+		return m_CurrLevel;
+	}
+
 	T getLevel()
 	{
 		T out = m_MaxLevel - m_MinLevel;
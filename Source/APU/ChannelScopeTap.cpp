@@ -0,0 +1,116 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#include "../stdafx.h"
+#include "ChannelScopeTap.h"
+#include "utils/variadic_minmax.h"
+
+CChannelScopeTap::CChannelScopeTap() :
+	m_bEnabled(false),
+	m_iDecimation(DEFAULT_DECIMATION),
+	m_iClock(DEFAULT_DECIMATION)
+{
+	for (auto &pQueue : m_pQueues)
+		pQueue = std::make_unique<rigtorp::SPSCQueue<int16_t>>(QUEUE_SIZE);
+}
+
+int CChannelScopeTap::GetChipStream(int Channel)
+{
+	if (Channel < CHANID_VRC6_PULSE1)
+		return STREAM_2A03;
+	if (Channel < CHANID_MMC5_SQUARE1)
+		return STREAM_VRC6;
+	if (Channel < CHANID_N163_CH1)
+		return STREAM_MMC5;
+	if (Channel < CHANID_FDS)
+		return STREAM_N163;
+	if (Channel < CHANID_VRC7_CH1)
+		return STREAM_FDS;
+	if (Channel < CHANID_S5B_CH1)
+		return STREAM_VRC7;
+	return STREAM_S5B;
+}
+
+void CChannelScopeTap::SetEnabled(bool Enable)
+{
+	m_bEnabled.store(Enable, std::memory_order_relaxed);
+}
+
+bool CChannelScopeTap::IsEnabled() const
+{
+	return m_bEnabled.load(std::memory_order_relaxed);
+}
+
+void CChannelScopeTap::SetDecimation(uint32_t Cycles)
+{
+	m_iDecimation.store(max(Cycles, 1u), std::memory_order_relaxed);
+}
+
+uint32_t CChannelScopeTap::GetDecimation() const
+{
+	return m_iDecimation.load(std::memory_order_relaxed);
+}
+
+bool CChannelScopeTap::Advance(uint32_t Cycles)
+{
+	ASSERT(Cycles <= m_iClock);
+	m_iClock -= Cycles;
+	if (m_iClock > 0)
+		return false;
+	m_iClock = m_iDecimation.load(std::memory_order_relaxed);
+	return true;
+}
+
+void CChannelScopeTap::Push(const std::array<int16_t, CHANNELS> &Levels)
+{
+	std::array<int32_t, STREAM_COUNT - CHANNELS> ChipLevels = { };
+
+	for (int i = 0; i < CHANNELS; ++i) {
+		(void)m_pQueues[i]->try_push(Levels[i]);
+		ChipLevels[GetChipStream(i) - CHANNELS] += Levels[i];
+	}
+	for (int i = CHANNELS; i < STREAM_COUNT; ++i) {
+		int32_t Level = ChipLevels[i - CHANNELS];
+		(void)m_pQueues[i]->try_push(static_cast<int16_t>(min(max(Level, -32768), 32767)));
+	}
+}
+
+std::size_t CChannelScopeTap::Read(int Stream, gsl::span<int16_t> Out)
+{
+	ASSERT(0 <= Stream && Stream < STREAM_COUNT);
+	auto &Queue = *m_pQueues[Stream];
+
+	std::size_t Count = 0;
+	while (Count < Out.size()) {
+		const int16_t *pSample = Queue.front();
+		if (!pSample)
+			break;
+		Out[Count++] = *pSample;
+		Queue.pop();
+	}
+	return Count;
+}
+
+void CChannelScopeTap::Flush()
+{
+	for (auto &pQueue : m_pQueues)
+		while (pQueue->front())
+			pQueue->pop();
+}
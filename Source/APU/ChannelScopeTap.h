@@ -0,0 +1,93 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include "Types.h"
+#include "rigtorp/SPSCQueue.h"
+#include "gsl/span"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/// Per-channel and per-chip oscilloscope data, sampled from the emulator at
+/// display resolution.
+///
+/// The audio thread samples every channel's output level once every
+/// GetDecimation() clock cycles and pushes it into one lock-free queue per
+/// stream. A GUI thread drains the queues with Read(). If the reader falls
+/// behind, new samples are dropped instead of blocking the audio thread.
+/// Nothing is sampled unless the tap is enabled.
+class CChannelScopeTap {
+public:
+	/// Chip streams follow the channel streams, in this order.
+	enum chip_stream_t {
+		STREAM_2A03 = CHANNELS,
+		STREAM_VRC6,
+		STREAM_VRC7,
+		STREAM_FDS,
+		STREAM_MMC5,
+		STREAM_N163,
+		STREAM_S5B,
+		STREAM_COUNT
+	};
+
+	/// Samples per stream which can be buffered before new samples are dropped.
+	static constexpr std::size_t QUEUE_SIZE = 4096;
+	/// ~7 kHz at NTSC, about 116 points per channel per 60 Hz frame.
+	static constexpr uint32_t DEFAULT_DECIMATION = 256;
+
+	CChannelScopeTap();
+
+	/// Returns the chip stream index which channel Channel (chan_id_t) is summed into.
+	static int GetChipStream(int Channel);
+
+	// Called by any thread.
+	void SetEnabled(bool Enable);
+	bool IsEnabled() const;
+	void SetDecimation(uint32_t Cycles);
+	uint32_t GetDecimation() const;
+
+	// Called by the audio thread.
+	/// Number of clock cycles until the next sample is due. Only meaningful if IsEnabled().
+	uint32_t CyclesUntilSample() const {
+		return m_iClock;
+	}
+	/// Advances the sample clock, returns true if a sample is due.
+	bool Advance(uint32_t Cycles);
+	/// Pushes one sample of every channel, normalized to the int16_t range.
+	void Push(const std::array<int16_t, CHANNELS> &Levels);
+
+	// Called by the GUI thread.
+	/// Pops up to Out.size() samples of stream Stream (chan_id_t or chip_stream_t)
+	/// into Out. Returns the number of samples read.
+	std::size_t Read(int Stream, gsl::span<int16_t> Out);
+	/// Discards all buffered samples of every stream.
+	void Flush();
+
+private:
+	std::array<std::unique_ptr<rigtorp::SPSCQueue<int16_t>>, STREAM_COUNT> m_pQueues;
+	std::atomic<bool> m_bEnabled;
+	std::atomic<uint32_t> m_iDecimation;
+	uint32_t m_iClock;		// Cycles until next sample, audio thread only
+};
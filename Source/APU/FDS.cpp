@@ -203,6 +203,14 @@ int CFDS::GetChannelLevel(int Channel)
 	return 0;
 }
 
+int CFDS::GetChannelOutput(int Channel) const
+{
+	if (Channel == 0) {
+		return m_ChannelLevel.getCurrent();
+	}
+	return 0;
+}
+
 int CFDS::GetChannelLevelRange(int Channel) const
 {
 	ASSERT(Channel == 0);
@@ -43,6 +43,7 @@ public:
 	void	EndFrame(Blip_Buffer& Output, gsl::span<int16_t> TempBuffer) override;
 	double	GetFreq(int Channel) const override;		// // //
 	int GetChannelLevel(int Channel) override;
+	int GetChannelOutput(int Channel) const override;
 	int GetChannelLevelRange(int Channel) const override;
 
 	int CFDS::GetModCounter() const;
@@ -18,21 +18,20 @@
 ** along with this program. If not, see https://www.gnu.org/licenses/.
 */
 
+#include "../stdafx.h"
 //#include "APU.h"
 #include "../Common.h"
 #include "Types.h"
-#include "Mixer.h"
 #include "MMC5.h"
 #include "Square.h"
 #include "../RegisterState.h"		// // //
 
 // MMC5 external sound
 
-CMMC5::CMMC5(CMixer *pMixer) :
-	CSoundChip(pMixer),		// // //
+CMMC5::CMMC5() :
 	m_pEXRAM(new uint8_t[0x400]),
-	m_pSquare1(new CSquare(pMixer, CHANID_MMC5_SQUARE1, SNDCHIP_MMC5)),
-	m_pSquare2(new CSquare(pMixer, CHANID_MMC5_SQUARE2, SNDCHIP_MMC5)),
+	m_pSquare1(new CSquare(m_SynthMMC5, CHANID_MMC5_SQUARE1, SNDCHIP_MMC5)),
+	m_pSquare2(new CSquare(m_SynthMMC5, CHANID_MMC5_SQUARE2, SNDCHIP_MMC5)),
 	m_iMulLow(0),
 	m_iMulHigh(0)
 {
@@ -59,6 +58,13 @@ void CMMC5::Reset()
 
 	m_pSquare1->Write(0x01, 0x08);
 	m_pSquare2->Write(0x01, 0x08);
+
+	m_SynthMMC5.clear();
+}
+
+void CMMC5::UpdateFilter(blip_eq_t eq)
+{
+	m_SynthMMC5.treble_eq(eq);
 }
 
 void CMMC5::Write(uint16_t Address, uint8_t Value)
@@ -124,14 +130,22 @@ uint8_t CMMC5::Read(uint16_t Address, bool &Mapped)
 	return 0;
 }
 
-void CMMC5::EndFrame()
+void CMMC5::EndFrame(Blip_Buffer&, gsl::span<int16_t>)
 {
 	m_pSquare1->EndFrame();
 	m_pSquare2->EndFrame();
 }
 
-void CMMC5::Process(uint32_t Time)
+void CMMC5::SetOutput(Blip_Buffer& Output)		// // //
 {
+	m_pSquare1->SetOutput(&Output);
+	m_pSquare2->SetOutput(&Output);
+}
+
+void CMMC5::Process(uint32_t Time, Blip_Buffer& Output)
+{
+	SetOutput(Output);
+
 	m_pSquare1->Process(Time);
 	m_pSquare2->Process(Time);
 }
@@ -145,6 +159,52 @@ double CMMC5::GetFreq(int Channel) const		// // //
 	return 0.;
 }
 
+CSquare *CMMC5::GetChannel(int Channel) const
+{
+	switch (Channel) {
+	case 0: return m_pSquare1;
+	case 1: return m_pSquare2;
+	}
+	return nullptr;
+}
+
+int CMMC5::GetChannelLevel(int Channel)
+{
+	// the PCM channel is not emulated
+	if (CSquare *pChan = GetChannel(Channel))
+		return pChan->GetLevel();
+	return 0;
+}
+
+int CMMC5::GetChannelOutput(int Channel) const
+{
+	if (const CSquare *pChan = GetChannel(Channel))
+		return pChan->GetOutput();
+	return 0;
+}
+
+int CMMC5::GetChannelLevelRange(int Channel) const
+{
+	switch (Channel) {
+	case 0: case 1:
+		return 15;
+	case 2:
+		// PCM
+		return 255;
+	default:
+		// unknown channel, return 1 to avoid division by 0
+		return 1;
+	}
+}
+
+void CMMC5::UpdateMixLevel(double v, bool UseSurveyMix)
+{
+	if (UseSurveyMix)
+		m_SynthMMC5.volume(v, 15 + 15 + 255);	// P1 + P2 + DAC, linear
+	else
+		m_SynthMMC5.volume(v * 1.18421f, 130);
+}
+
 void CMMC5::LengthCounterUpdate()
 {
 	m_pSquare1->LengthCounterUpdate();
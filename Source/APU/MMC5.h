@@ -21,28 +21,41 @@
 
 #pragma once
 
-#include "SoundChip.h"
+#include "SoundChip2.h"
 #include "Channel.h"
 
 class CSquare;		// // //
 
-class CMMC5 : public CSoundChip {
+class CMMC5 : public CSoundChip2 {
 public:
-	CMMC5(CMixer *pMixer);
+	CMMC5();
 	virtual ~CMMC5();
 
-	void Reset();
-	void Write(uint16_t Address, uint8_t Value);
-	uint8_t Read(uint16_t Address, bool &Mapped);
-	void EndFrame();
-	void Process(uint32_t Time);
+	void Reset() override;
+	void UpdateFilter(blip_eq_t eq) override;
+	void Write(uint16_t Address, uint8_t Value) override;
+	uint8_t Read(uint16_t Address, bool &Mapped) override;
+	void EndFrame(Blip_Buffer& Output, gsl::span<int16_t> TempBuffer) override;
+	void Process(uint32_t Time, Blip_Buffer& Output) override;
+	void SetOutput(Blip_Buffer& Output) override;		// // //
 	double GetFreq(int Channel) const override;		// // //
+	int GetChannelLevel(int Channel) override;
+	int GetChannelOutput(int Channel) const override;
+	int GetChannelLevelRange(int Channel) const override;
+
+	void UpdateMixLevel(double v, bool UseSurveyMix = false);
 
 	void LengthCounterUpdate();
 	void EnvelopeUpdate();
 	void ClockSequence();		// // //
 
-private:	
+private:
+	CSquare *GetChannel(int Channel) const;
+
+private:
+	// Shared by all channels, must be declared before them
+	Blip_Synth<blip_good_quality> m_SynthMMC5;
+
 	CSquare	*m_pSquare1;
 	CSquare	*m_pSquare2;
 	uint8_t	*m_pEXRAM;
@@ -70,8 +70,11 @@
 #include "Mixer.h"
 #include "APU.h"
 #include "2A03.h"
+#include "VRC6.h"
+#include "MMC5.h"
 #include "FDS.h"
 #include "N163.h"
+#include "S5B.h"
 #include "utils/variadic_minmax.h"
 
 //#define LINEAR_MIXING
@@ -82,7 +85,6 @@ static const int   LEVEL_FALL_OFF_DELAY = 3;
 CMixer::CMixer(CAPU* Parent)
 	: m_APU(Parent)
 {
-	memset(m_iChannels, 0, sizeof(int32_t) * CHANNELS);
 	memset(m_fChannelLevels, 0, sizeof(float) * CHANNELS);
 	memset(m_iChanLevelFallOff, 0, sizeof(uint32_t) * CHANNELS);
 
@@ -202,15 +204,14 @@ void CMixer::RecomputeEmuMixState()
 		chip->UpdateFilter(eq);
 	}
 
-	SynthVRC6.treble_eq(eq);
-	SynthMMC5.treble_eq(eq);
-	SynthS5B.treble_eq(eq);
-
 	// Volume levels
 	auto &chip2A03 = *m_APU->m_p2A03;
+	auto &chipVRC6 = *m_APU->m_pVRC6;
 	auto &chipVRC7 = *m_APU->m_pVRC7;
 	auto &chipFDS = *m_APU->m_pFDS;
+	auto &chipMMC5 = *m_APU->m_pMMC5;
 	auto &chipN163 = *m_APU->m_pN163;
+	auto &chipS5B = *m_APU->m_pS5B;
 
 	bool UseSurveyMixing = m_MixerConfig.UseSurveyMix;
 
@@ -224,21 +225,18 @@ void CMixer::RecomputeEmuMixState()
 	chip2A03.UpdateMixingAPU2(Volume * m_fLevelAPU2, UseSurveyMixing);
 	chipFDS.UpdateMixLevel(Volume * m_fLevelFDS, UseSurveyMixing);
 	chipN163.UpdateMixLevel(Volume * m_fLevelN163, UseSurveyMixing);
+	chipVRC6.UpdateMixLevel(Volume * m_fLevelVRC6, UseSurveyMixing);
+	chipMMC5.UpdateMixLevel(Volume * m_fLevelMMC5, UseSurveyMixing);
+	chipS5B.UpdateMixLevel(Volume * m_fLevelS5B, UseSurveyMixing);
 
 	if (UseSurveyMixing) {
 		chipVRC7.UpdateMixLevel(Volume * m_fLevelVRC7, UseSurveyMixing);
-		SynthVRC6.volume(Volume * m_fLevelVRC6, 15 + 15 + 31);	// P1 + P2 + Saw, linear
-		SynthMMC5.volume(Volume * m_fLevelMMC5, 15 + 15 + 255);	// P1 + P2 + DAC, linear
-		SynthS5B.volume(Volume * m_fLevelS5B, 255 + 255 + 255);	// 5B1 + 5B2 + 5B3, linear
 	}
 	else {
 		// match legacy expansion audio mixing
 
 		// VRC7 level does not decrease as you enable expansion chips
 		chipVRC7.UpdateMixLevel(m_MixerConfig.OverallVol * m_fLevelVRC7);
-		SynthVRC6.volume(Volume * 3.98333f * m_fLevelVRC6, 500);
-		SynthMMC5.volume(Volume * 1.18421f * m_fLevelMMC5, 130);
-		SynthS5B.volume(Volume * m_fLevelS5B, 1200);  // Not checked
 	}
 
 	// Update per-chip filtering and emulation
@@ -298,10 +296,6 @@ void CMixer::ClearBuffer()
 	//
 	// This works because CMixer::ClearBuffer() is only called by CAPU::Reset(),
 	// which also calls CSoundChip2::Reset() on each sound chip.
-
-	#define X(SYNTH)  SYNTH.clear();
-	FOREACH_SYNTH(X, );
-	#undef X
 }
 
 int CMixer::SamplesAvail() const
@@ -353,6 +347,19 @@ void CMixer::FinishBuffer(int t)
 	for (int i = 0; i < 5; i++)
 		StoreChannelLevel(CHANID_SQUARE1 + i, get_channel_level(chip2A03, i));
 
+	// VRC6, MMC5 and 5B meters use the raw levels, scaled by StoreChannelLevel()
+	auto& chipVRC6 = *m_APU->m_pVRC6;
+	for (int i = 0; i < 3; ++i)
+		StoreChannelLevel(CHANID_VRC6_PULSE1 + i, chipVRC6.GetChannelLevel(i));
+
+	auto& chipMMC5 = *m_APU->m_pMMC5;
+	for (int i = 0; i < 2; ++i)
+		StoreChannelLevel(CHANID_MMC5_SQUARE1 + i, chipMMC5.GetChannelLevel(i));
+
+	auto& chipS5B = *m_APU->m_pS5B;
+	for (int i = 0; i < 3; ++i)
+		StoreChannelLevel(CHANID_S5B_CH1 + i, chipS5B.GetChannelLevel(i));
+
 	auto& chipFDS = *m_APU->m_pFDS;
 	StoreChannelLevel(CHANID_FDS, get_channel_level(chipFDS, 0));
 
@@ -365,61 +372,55 @@ void CMixer::FinishBuffer(int t)
 		StoreChannelLevel(CHANID_N163_CH1 + i, get_channel_level(chipN163, i));
 }
 
-//
-// Mixing
-//
-
-void CMixer::MixVRC6(int Value, int Time)
+int CMixer::ReadBuffer(void *Buffer)
 {
-	SynthVRC6.offset(Time, Value, &BlipBuffer);
+	return BlipBuffer.read_samples((blip_amplitude_t*)Buffer, BlipBuffer.samples_avail());
 }
 
-void CMixer::MixMMC5(int Value, int Time)
+int32_t CMixer::GetChanOutput(uint8_t Chan) const
 {
-	SynthMMC5.offset(Time, Value, &BlipBuffer);
+	return (int32_t)m_fChannelLevels[Chan];
 }
 
-void CMixer::MixS5B(int Value, int Time)
-{
-	SynthS5B.offset(Time, Value, &BlipBuffer);
+static int16_t normalize_channel_output(int Level, int Range) {
+	int out = Level * 32767 / max(Range, 1);
+	return static_cast<int16_t>(min(max(out, -32768), 32767));
+}
+
+static int16_t get_channel_output(const CSoundChip2& chip, int channel) {
+	return normalize_channel_output(chip.GetChannelOutput(channel), chip.GetChannelLevelRange(channel));
 }
 
-void CMixer::AddValue(int ChanID, int Chip, int Value, int AbsValue, int FrameCycles)
+void CMixer::GetChannelOutputs(std::array<int16_t, CHANNELS> &Levels) const
 {
-	// Add sound to mixer
-	//
+	Levels.fill(0);
 
-	int Delta = Value - m_iChannels[ChanID];
-	StoreChannelLevel(ChanID, AbsValue);
-	m_iChannels[ChanID] = Value;
+	auto& chip2A03 = *m_APU->m_p2A03;
+	for (int i = 0; i < 5; i++)
+		Levels[CHANID_SQUARE1 + i] = get_channel_output(chip2A03, i);
 
-	// Unless otherwise notes, Value is already a delta.
-	switch (Chip) {
-		case SNDCHIP_NONE:
-			// 2A03 nonlinear mixing bypasses CMixer now, and talks directly to BlipBuffer
-			// (obtained by CMixer::GetBuffer()).
-			break;
-		case SNDCHIP_MMC5:
-			// Value == AbsValue.
-			MixMMC5(Delta, FrameCycles);
-			break;
-		case SNDCHIP_VRC6:
-			MixVRC6(Value, FrameCycles);
-			break;
-		case SNDCHIP_S5B:		// // // 050B
-			MixS5B(Value, FrameCycles);
-			break;
-	}
-}
+	auto& chipVRC6 = *m_APU->m_pVRC6;
+	for (int i = 0; i < 3; ++i)
+		Levels[CHANID_VRC6_PULSE1 + i] = get_channel_output(chipVRC6, i);
 
-int CMixer::ReadBuffer(void *Buffer)
-{
-	return BlipBuffer.read_samples((blip_amplitude_t*)Buffer, BlipBuffer.samples_avail());
-}
+	auto& chipMMC5 = *m_APU->m_pMMC5;
+	for (int i = 0; i < 2; ++i)
+		Levels[CHANID_MMC5_SQUARE1 + i] = get_channel_output(chipMMC5, i);
 
-int32_t CMixer::GetChanOutput(uint8_t Chan) const
-{
-	return (int32_t)m_fChannelLevels[Chan];
+	auto& chipS5B = *m_APU->m_pS5B;
+	for (int i = 0; i < 3; ++i)
+		Levels[CHANID_S5B_CH1 + i] = get_channel_output(chipS5B, i);
+
+	auto& chipFDS = *m_APU->m_pFDS;
+	Levels[CHANID_FDS] = get_channel_output(chipFDS, 0);
+
+	auto& chipVRC7 = *m_APU->m_pVRC7;
+	for (int i = 0; i < 6; ++i)
+		Levels[CHANID_VRC7_CH1 + i] = get_channel_output(chipVRC7, i);
+
+	auto& chipN163 = *m_APU->m_pN163;
+	for (int i = 0; i < 8; i++)
+		Levels[CHANID_N163_CH1 + i] = get_channel_output(chipN163, i);
 }
 
 void CMixer::StoreChannelLevel(int Channel, int Value)
@@ -431,7 +432,7 @@ void CMixer::StoreChannelLevel(int Channel, int Value)
 		AbsVol = (AbsVol * 3) / 4;
 
 	if (Channel >= CHANID_S5B_CH1 && Channel <= CHANID_S5B_CH3) {
-		AbsVol = (int)(logf((float)AbsVol) * 2.8f);
+		AbsVol = AbsVol > 0 ? (int)(logf((float)AbsVol) * 2.8f) : 0;		// // //
 	}
 
 	if (float(AbsVol) >= m_fChannelLevels[Channel]) {
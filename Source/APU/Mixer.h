@@ -25,6 +25,7 @@
 #include "../Common.h"
 #include "../Blip_Buffer/blip_buffer.h"
 
+#include <array>
 #include <vector>		// !! !!
 #include <string>		// !! !!
 
@@ -138,7 +139,6 @@ public:
 
 	void	ExternalSound(int Chip);
 
-	void	AddValue(int ChanID, int Chip, int Value, int AbsValue, int FrameCycles);
 	void	SetMixing(MixerConfig cfg) {
 		m_MixerConfig = cfg;
 	}
@@ -162,6 +162,7 @@ public:
 	int		ReadBuffer(void *Buffer);
 
 	int32_t	GetChanOutput(uint8_t Chan) const;
+	void	GetChannelOutputs(std::array<int16_t, CHANNELS> &Levels) const;
 	void	SetChipLevel(chip_level_t Chip, float Level);
 	uint32_t	ResampleDuration(uint32_t Time) const;
 
@@ -169,10 +170,6 @@ public:
 	void	SetMeterDecayRate(int Rate);		// // // 050B
 
 private:
-	void MixVRC6(int Value, int Time);
-	void MixMMC5(int Value, int Time);
-	void MixS5B(int Value, int Time);
-
 	void StoreChannelLevel(int Channel, int Value);
 	void ClearChannelLevels();
 
@@ -182,32 +179,10 @@ private:
 	// Pointer to parent/owning CAPU object.
 	CAPU * m_APU;
 
-	// Blip buffer synths
-
-	// Should never be null during playback. CAPU creates all expansion chips,
-	// even if chips are not active in current module.
-	Blip_Synth<blip_good_quality> SynthVRC6;
-	Blip_Synth<blip_good_quality> SynthMMC5;
-	Blip_Synth<blip_good_quality> SynthS5B;		// // // 050B
-
-	/// Only used by CMixer::ClearBuffer(), which clears the global Blip_Buffer
-	/// and all Blip_Synth owned by CMixer.
-	///
-	/// What about CSoundChip2 which owns its own Blip_Synth?
-	/// I've decided that CMixer should not be responsible for clearing those Blip_Synth,
-	/// but rather CSoundChip2::Reset() should do so.
-	///
-	/// This works because CMixer::ClearBuffer() is only called by CAPU::Reset(),
-	/// which also calls CSoundChip2::Reset() on each sound chip.
-	#define FOREACH_SYNTH(X, SEP) \
-		X(SynthVRC6) SEP \
-		X(SynthMMC5) SEP \
-		X(SynthS5B)
-
 	// Blip buffer object
+	// Every sound chip owns its Blip_Synth and writes to this buffer directly.
 	Blip_Buffer	BlipBuffer;
 
-	int32_t		m_iChannels[CHANNELS];
 	uint8_t		m_iExternalChip;
 	uint32_t	m_iSampleRate;
 
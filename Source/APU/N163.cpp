@@ -85,48 +85,23 @@ void CN163::Process(uint32_t Time, Blip_Buffer& Output)
 {
 	// Mix level will dynamically change based on number of channels
 	auto channels = m_N163.GetNumberOfChannels();
-	auto scale = m_bUseLinearMixing ? (channels + 1) : 1;
-
-	if (m_UseSurveyMix) {
-		m_SynthN163.volume(m_Attenuation, 225 * scale);
-	}
-	else {
-		double N163_volume = (channels == 0) ? 1.3f : (1.5f + float(channels) / 1.5f);
-		N163_volume *= m_Attenuation;
-		m_SynthN163.volume(N163_volume * 1.1, 1600 * scale);
-	}
-
-	uint32_t now = 0;
-
-	while (true) {
-		assert(now <= Time);
-		if (now >= Time)
-			break;
+	if (channels != m_iSynthChannels)
+		UpdateSynthVolume(channels);
 
+	bool refreshAll = true;
+	m_N163.RunClockAudio(Time, [&] (uint32_t now, int16_t out, int channel) {
+		// output master audio
+		m_SynthN163.update(m_iTime + now, out * -1, &m_BlipN163);
 
-		auto tmp = m_N163.ClockAudioMaxSkip();
-		auto clock_skip = std::min(tmp, Time - now);
-		if (clock_skip > 0) {
-			m_N163.SkipClockAudio(clock_skip);
-			now += clock_skip;
+		// update the channel levels; only the clocked channel can change after the first update
+		if (refreshAll) {
+			for (int i = 0; i < 8; i++)
+				m_ChannelLevels[i].update((int32_t) m_N163._channelOutput[7 - i]);
+			refreshAll = false;
 		}
-
-		if (tmp < (1 << 24))
-			assert(tmp - m_N163.ClockAudioMaxSkip() == clock_skip);
-		assert(now <= Time);
-		if (now >= Time)
-			break;
-
-		// output master audio
-		auto master_out = m_N163.ClockAudio() * -1;
-		m_SynthN163.update(m_iTime + now, master_out, &m_BlipN163);
-			
-		// update the channel levels
-		for (int i = 0; i < 8; i++)
-			m_ChannelLevels[i].update((int32_t) m_N163._channelOutput[7 - i]);
-
-		now++;
-	}
+		else if (channel >= 0)
+			m_ChannelLevels[7 - channel].update((int32_t) m_N163._channelOutput[channel]);
+	});
 
 	m_iTime += Time;
 
@@ -181,6 +156,14 @@ int CN163::GetChannelLevel(int Channel)
 	return 0;
 }
 
+int CN163::GetChannelOutput(int Channel) const
+{
+	if (0 <= Channel && Channel < 8) {
+		return m_ChannelLevels[Channel].getCurrent();
+	}
+	return 0;
+}
+
 int CN163::GetChannelLevelRange(int Channel) const
 {
 	ASSERT(0 <= Channel && Channel < 8);
@@ -204,6 +187,7 @@ void CN163::UpdateMixLevel(double v, bool UseSurveyMix)
 {
 	m_Attenuation = v;
 	m_UseSurveyMix = UseSurveyMix;
+	m_iSynthChannels = -1;
 	// Recalculate chip levels at runtime; this is dependent on the amount of
 	// N163 channels at execution.
 }
@@ -225,6 +209,23 @@ void CN163::SetMixingMethod(bool bLinear)		// // //
 {
 	m_bUseLinearMixing = bLinear;
 	m_N163.SetMixing(m_bUseLinearMixing);
+	m_iSynthChannels = -1;
+}
+
+void CN163::UpdateSynthVolume(int Channels)
+{
+	auto scale = m_bUseLinearMixing ? (Channels + 1) : 1;
+
+	if (m_UseSurveyMix) {
+		m_SynthN163.volume(m_Attenuation, 225 * scale);
+	}
+	else {
+		double N163_volume = (Channels == 0) ? 1.3f : (1.5f + float(Channels) / 1.5f);
+		N163_volume *= m_Attenuation;
+		m_SynthN163.volume(N163_volume * 1.1, 1600 * scale);
+	}
+
+	m_iSynthChannels = Channels;
 }
 
 void CN163::RecomputeN163Filter()
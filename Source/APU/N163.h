@@ -41,6 +41,7 @@ public:
 	void	EndFrame(Blip_Buffer& Output, gsl::span<int16_t> TempBuffer) override;
 	double	GetFreq(int Channel) const override;
 	int GetChannelLevel(int Channel) override;
+	int GetChannelOutput(int Channel) const override;
 	int GetChannelLevelRange(int Channel) const override;
 
 	void UpdateN163Filter(int CutoffHz, bool DisableMultiplex);
@@ -52,6 +53,7 @@ public:
 
 private:
 	void RecomputeN163Filter();
+	void UpdateSynthVolume(int Channels);
 
 	int m_CutoffHz;
 
@@ -75,4 +77,5 @@ private:
 
 	int32_t m_iChannelSample[8];
 	bool m_bUseLinearMixing = false;		// // //
+	int m_iSynthChannels = -1;		// Channel count m_SynthN163's volume was computed for, -1 if stale
 };
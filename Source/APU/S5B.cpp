@@ -18,6 +18,7 @@
 ** along with this program. If not, see https://www.gnu.org/licenses/.
 */
 
+#include "../stdafx.h"
 #include <algorithm>
 #include "APU.h"
 #include "S5B.h"
@@ -37,44 +38,69 @@ const int32_t EXP_VOLUME[32] = {
 	180, 212, 255, 255
 };
 
-CS5BChannel::CS5BChannel(CMixer *pMixer, uint8_t ID) : CChannel(pMixer, SNDCHIP_S5B, ID),
+namespace {
+
+const uint32_t NO_EVENT = 0xFFFFFFFFU;		// // //
+
+// Returns the cycle at which a divider reloaded at Start expires, or Now if it is already overdue
+uint32_t NextEvent(uint32_t Start, uint32_t Period, uint32_t Now) {
+	return Now - Start < Period ? Start + Period : Now;
+}
+
+} // namespace
+
+CS5BChannel::CS5BChannel(Blip_Synth<blip_good_quality> &Synth, uint8_t ID) : CChannel(Synth, SNDCHIP_S5B, ID),
 	m_iVolume(0),
 	m_iPeriod(0),
-	m_iPeriodClock(0),
+	m_iPeriodStart(0),
 	m_bSquareHigh(false),
 	m_bSquareDisable(false),
 	m_bNoiseDisable(false)
 {
 }
 
-void CS5BChannel::Process(uint32_t Time)
-{
-	m_iPeriodClock += Time;
-	if (m_iPeriodClock >= m_iPeriod) {
-		m_iPeriodClock = 0;
-		m_bSquareHigh = !m_bSquareHigh;
-	}
-	m_iTime += Time;
-}
-
 void CS5BChannel::Reset()
 {
 	m_iVolume = 0;
 	m_iPeriod = 0;
-	m_iPeriodClock = 0;
+	m_iPeriodStart = 0;
 	m_bSquareHigh = false;
 	m_bSquareDisable = true;
 	m_bNoiseDisable = true;
+	ClearOutput();		// // //
 }
 
-uint32_t CS5BChannel::GetTime()
+uint32_t CS5BChannel::GetNextEvent(uint32_t Now) const		// // //
 {
-	if (m_iPeriod < 2U || !m_iVolume)
-		return 0xFFFFFU;
-	return m_iPeriod - m_iPeriodClock;
+	// Not scheduled while it cannot be heard, see CatchUpSquare()
+	if (!UsesSquare())
+		return NO_EVENT;
+	return NextEvent(m_iPeriodStart, m_iPeriod, Now);
 }
 
-void CS5BChannel::Output(uint32_t Noise, uint32_t Envelope)
+void CS5BChannel::ClockSquare(uint32_t Time)		// // //
+{
+	m_iPeriodStart = Time;
+	m_bSquareHigh = !m_bSquareHigh;
+}
+
+void CS5BChannel::CatchUpSquare(uint32_t Time)		// // //
+{
+	// A period below 2 is never scheduled but toggles on every step, the end of a call included
+	if (m_iPeriod < 2U) {
+		if (Time != m_iPeriodStart)
+			ClockSquare(Time);
+	}
+	// Keeps the phase running while no events are scheduled
+	else if (Time - m_iPeriodStart >= m_iPeriod) {
+		const uint32_t Count = (Time - m_iPeriodStart) / m_iPeriod;
+		m_iPeriodStart += Count * m_iPeriod;
+		if (Count & 1U)
+			m_bSquareHigh = !m_bSquareHigh;
+	}
+}
+
+void CS5BChannel::Output(uint32_t Time, uint32_t Noise, uint32_t Envelope)
 {
 	int Level = ((m_iVolume & 0x20) ? Envelope : m_iVolume) & 0x1F;
 	int32_t Output = EXP_VOLUME[Level];
@@ -82,9 +108,25 @@ void CS5BChannel::Output(uint32_t Noise, uint32_t Envelope)
 		Output = 0;
 	if (!m_bNoiseDisable && !Noise)
 		Output = 0;
+	m_iTime = Time;		// // //
 	Mix(static_cast<int32_t>(Output) * -1);
 }
 
+bool CS5BChannel::UsesNoise() const		// // //
+{
+	return m_iVolume && !m_bNoiseDisable;
+}
+
+bool CS5BChannel::UsesEnvelope() const
+{
+	return (m_iVolume & 0x20) != 0;
+}
+
+bool CS5BChannel::UsesSquare() const
+{
+	return m_iVolume && !m_bSquareDisable && m_iPeriod >= 2U;
+}
+
 double CS5BChannel::GetFrequency() const		// // //
 {
 	if (m_bSquareDisable || !m_iPeriod)
@@ -96,15 +138,15 @@ double CS5BChannel::GetFrequency() const		// // //
 
 // Sunsoft 5B chip class
 
-CS5B::CS5B(CMixer *pMixer) : CSoundChip(pMixer),
+CS5B::CS5B() :
 	m_cPort(0),
 	m_iCounter(0)
 {
 	m_pRegisterLogger->AddRegisterRange(0x00, 0x0F);		// // //
 
-	m_pChannel[0] = new CS5BChannel(pMixer, CHANID_S5B_CH1);
-	m_pChannel[1] = new CS5BChannel(pMixer, CHANID_S5B_CH2);
-	m_pChannel[2] = new CS5BChannel(pMixer, CHANID_S5B_CH3);
+	m_pChannel[0] = new CS5BChannel(m_SynthS5B, CHANID_S5B_CH1);
+	m_pChannel[1] = new CS5BChannel(m_SynthS5B, CHANID_S5B_CH2);
+	m_pChannel[2] = new CS5BChannel(m_SynthS5B, CHANID_S5B_CH3);
 	Reset();
 }
 
@@ -120,45 +162,102 @@ void CS5B::Reset()
 	m_iNoiseState = 0xFFFF;
 	m_iCounter = 0;
 	m_iNoisePeriod = 0x1F << 5;
-	m_iNoiseClock = 0;
+	m_iNoiseStart = 0;
 	m_iEnvelopePeriod = 0;
-	m_iEnvelopeClock = 0;
+	m_iEnvelopeStart = 0;
 	m_iEnvelopeLevel = 0;
 	m_iEnvelopeShape = 0;
 	m_bEnvelopeHold = true;
 	
 	for (auto x : m_pChannel)
 		x->Reset();
+
+	m_SynthS5B.clear();
 }
 
-void CS5B::Process(uint32_t Time)
+void CS5B::UpdateFilter(blip_eq_t eq)
 {
-	while (Time > 0U) {
-		uint32_t TimeToRun = Time;
-		if (m_iEnvelopeClock < m_iEnvelopePeriod)
-			TimeToRun = std::min<uint32_t>(m_iEnvelopePeriod - m_iEnvelopeClock, TimeToRun);
-		if (m_iNoiseClock < m_iNoisePeriod)
-			TimeToRun = std::min<uint32_t>(m_iNoisePeriod - m_iNoiseClock, TimeToRun);
-		for (const auto x : m_pChannel)
-			TimeToRun = std::min<uint32_t>(x->GetTime(), TimeToRun);
-
-		m_iCounter += TimeToRun;
-		Time -= TimeToRun;
-
-		RunEnvelope(TimeToRun);
-		RunNoise(TimeToRun);
-		for (auto x : m_pChannel)
-			x->Process(TimeToRun);
-
-		for (auto x : m_pChannel)
-			x->Output(m_iNoiseState & 0x01, m_iEnvelopeLevel);
-	}
+	m_SynthS5B.treble_eq(eq);
 }
 
-void CS5B::EndFrame()
+void CS5B::SetOutput(Blip_Buffer& Output)		// // //
 {
 	for (auto x : m_pChannel)
+		x->SetOutput(&Output);
+}
+
+void CS5B::Process(uint32_t Time, Blip_Buffer& Output)
+{
+	SetOutput(Output);
+
+	// // // Registers may have been written since the last call
+	for (auto x : m_pChannel)
+		x->Output(m_iCounter, m_iNoiseState & 0x01, m_iEnvelopeLevel);
+
+	// Registers cannot change during the call, so neither can the listeners
+	unsigned EnvelopeMask = 0, NoiseMask = 0;
+	for (int i = 0; i < 3; ++i) {
+		if (m_pChannel[i]->UsesEnvelope())
+			EnvelopeMask |= 1 << i;
+		if (m_pChannel[i]->UsesNoise())
+			NoiseMask |= 1 << i;
+	}
+
+	// Only the component whose deadline is reached is clocked and rescheduled,
+	// and only the channels that can hear the change are mixed again
+	uint32_t Envelope = GetNextEnvelopeEvent();
+	uint32_t Noise = NoiseMask ? GetNextNoiseEvent() : NO_EVENT;
+	uint32_t Square[3];
+	for (int i = 0; i < 3; ++i)
+		Square[i] = m_pChannel[i]->GetNextEvent(m_iCounter);
+
+	const uint32_t End = m_iCounter + Time;
+	while (true) {
+		const uint32_t Now = std::min({Envelope, Noise, Square[0], Square[1], Square[2]});
+		if (Now > End)
+			break;
+		m_iCounter = Now;
+
+		unsigned Changed = 0;
+		if (Envelope == Now) {
+			if (ClockEnvelope(Now))
+				Changed |= EnvelopeMask;
+			Envelope = GetNextEnvelopeEvent();
+		}
+		if (Noise == Now) {
+			if (ClockNoise(Now))
+				Changed |= NoiseMask;
+			Noise = GetNextNoiseEvent();
+		}
+		for (int i = 0; i < 3; ++i)
+			if (Square[i] == Now) {
+				m_pChannel[i]->ClockSquare(Now);
+				Square[i] = m_pChannel[i]->GetNextEvent(Now);
+				Changed |= 1 << i;
+			}
+			else if (m_pChannel[i]->m_iPeriod < 2U)
+				m_pChannel[i]->ClockSquare(Now);		// // // inaudible, see CatchUpSquare()
+
+		for (int i = 0; i < 3; ++i)
+			if (Changed & (1 << i))
+				m_pChannel[i]->Output(Now, m_iNoiseState & 0x01, m_iEnvelopeLevel);
+	}
+
+	m_iCounter = End;
+	CatchUpNoise(End);		// not scheduled without listeners
+	for (auto x : m_pChannel)
+		x->CatchUpSquare(End);
+}
+
+void CS5B::EndFrame(Blip_Buffer&, gsl::span<int16_t>)
+{
+	// // // Rebase the dividers onto the next frame
+	m_iNoiseStart -= m_iCounter;
+	m_iEnvelopeStart -= m_iCounter;
+	for (auto x : m_pChannel) {
+		x->m_iPeriodStart -= m_iCounter;
 		x->EndFrame();
+	}
 	m_iCounter = 0;
 }
 
@@ -196,6 +295,35 @@ double CS5B::GetFreq(int Channel) const		// // //
 	return 0.;
 }
 
+int CS5B::GetChannelLevel(int Channel)
+{
+	ASSERT(0 <= Channel && Channel < 3);
+	if (0 <= Channel && Channel < 3)
+		return m_pChannel[Channel]->GetLevel();
+	return 0;
+}
+
+int CS5B::GetChannelOutput(int Channel) const
+{
+	if (0 <= Channel && Channel < 3)
+		return m_pChannel[Channel]->GetOutput();
+	return 0;
+}
+
+int CS5B::GetChannelLevelRange(int Channel) const
+{
+	// EXP_VOLUME ranges from 0 to 255
+	return (0 <= Channel && Channel < 3) ? 255 : 1;
+}
+
+void CS5B::UpdateMixLevel(double v, bool UseSurveyMix)
+{
+	if (UseSurveyMix)
+		m_SynthS5B.volume(v, 255 + 255 + 255);	// 5B1 + 5B2 + 5B3, linear
+	else
+		m_SynthS5B.volume(v, 1200);  // Not checked
+}
+
 void CS5B::WriteReg(uint8_t Port, uint8_t Value)
 {
 	switch (Port) {
@@ -212,7 +340,7 @@ void CS5B::WriteReg(uint8_t Port, uint8_t Value)
 	}
 		break;
 	case 0x06:
-		m_iNoisePeriod = Value ? ((Value & 0x1F) << 5) : 0x10;
+		m_iNoisePeriod = (Value & 0x1F) ? ((Value & 0x1F) << 5) : 0x10;		// // // never 0
 		break;
 	case 0x07:
 		for (int i = 0; i < 3; ++i) {
@@ -231,7 +359,7 @@ void CS5B::WriteReg(uint8_t Port, uint8_t Value)
 		m_iEnvelopePeriod = (m_iEnvelopePeriod & 0x00FF0) | (Value << 12);
 		break;
 	case 0x0D:
-		m_iEnvelopeClock = 0;
+		m_iEnvelopeStart = m_iCounter;		// // //
 		m_iEnvelopeShape = Value;
 		m_bEnvelopeHold = false;
 		m_iEnvelopeLevel = (Value & 0x04) ? 0 : 0x1F;
@@ -247,38 +375,55 @@ void CS5B::Log(uint16_t Address, uint8_t Value)		// // //
 	}
 }
 
-void CS5B::RunEnvelope(uint32_t Time)
+uint32_t CS5B::GetNextEnvelopeEvent() const		// // //
 {
-	m_iEnvelopeClock += Time;
-	if (m_iEnvelopeClock >= m_iEnvelopePeriod && m_iEnvelopePeriod) {
-		m_iEnvelopeClock = 0;
-		if (!m_bEnvelopeHold) {
-			m_iEnvelopeLevel += (m_iEnvelopeShape & 0x04) ? 1 : -1;
-			m_iEnvelopeLevel &= 0x3F;
-		}
-		if (m_iEnvelopeLevel & 0x20) {
-			if (m_iEnvelopeShape & 0x08) {
-				if ((m_iEnvelopeShape & 0x03) == 0x01 || (m_iEnvelopeShape & 0x03) == 0x02)
-					m_iEnvelopeShape ^= 0x04;
-				if (m_iEnvelopeShape & 0x01)
-					m_bEnvelopeHold = true;
-				m_iEnvelopeLevel = (m_iEnvelopeShape & 0x04) ? 0 : 0x1F;
-			}
-			else {
+	// A held envelope never changes until register $0D is written
+	if (!m_iEnvelopePeriod || m_bEnvelopeHold)
+		return NO_EVENT;
+	return NextEvent(m_iEnvelopeStart, m_iEnvelopePeriod, m_iCounter);
+}
+
+uint32_t CS5B::GetNextNoiseEvent() const		// // //
+{
+	return NextEvent(m_iNoiseStart, m_iNoisePeriod, m_iCounter);
+}
+
+bool CS5B::ClockEnvelope(uint32_t Time)
+{
+	const char Last = m_iEnvelopeLevel;
+	m_iEnvelopeStart = Time;
+	if (!m_bEnvelopeHold) {
+		m_iEnvelopeLevel += (m_iEnvelopeShape & 0x04) ? 1 : -1;
+		m_iEnvelopeLevel &= 0x3F;
+	}
+	if (m_iEnvelopeLevel & 0x20) {
+		if (m_iEnvelopeShape & 0x08) {
+			if ((m_iEnvelopeShape & 0x03) == 0x01 || (m_iEnvelopeShape & 0x03) == 0x02)
+				m_iEnvelopeShape ^= 0x04;
+			if (m_iEnvelopeShape & 0x01)
 				m_bEnvelopeHold = true;
-				m_iEnvelopeLevel = 0;
-			}
+			m_iEnvelopeLevel = (m_iEnvelopeShape & 0x04) ? 0 : 0x1F;
+		}
+		else {
+			m_bEnvelopeHold = true;
+			m_iEnvelopeLevel = 0;
 		}
 	}
+	return m_iEnvelopeLevel != Last;
 }
 
-void CS5B::RunNoise(uint32_t Time)
+bool CS5B::ClockNoise(uint32_t Time)
 {
-	m_iNoiseClock += Time;
-	if (m_iNoiseClock >= m_iNoisePeriod) {
-		m_iNoiseClock = 0;
-		if (m_iNoiseState & 0x01)
-			m_iNoiseState ^= 0x24000;
-		m_iNoiseState >>= 1;
-	}
+	const uint32_t Last = m_iNoiseState & 0x01;
+	m_iNoiseStart = Time;
+	if (m_iNoiseState & 0x01)
+		m_iNoiseState ^= 0x24000;
+	m_iNoiseState >>= 1;
+	return (m_iNoiseState & 0x01) != Last;
+}
+
+void CS5B::CatchUpNoise(uint32_t Time)		// // //
+{
+	while (Time - m_iNoiseStart >= m_iNoisePeriod)
+		ClockNoise(m_iNoiseStart + m_iNoisePeriod);
 }
@@ -21,7 +21,7 @@
 
 #pragma once
 
-#include "SoundChip.h"
+#include "SoundChip2.h"
 #include "Channel.h"
 
 // // // 050B
@@ -31,60 +31,80 @@ class CS5BChannel : public CChannel
 public:
 	friend class CS5B;
 
-	CS5BChannel(CMixer *pMixer, uint8_t ID);
+	CS5BChannel(Blip_Synth<blip_good_quality> &Synth, uint8_t ID);
 	
-	void Process(uint32_t Time);
 	void Reset();
 
-	uint32_t GetTime();
-	void Output(uint32_t Noise, uint32_t Envelope);
+	uint32_t GetNextEvent(uint32_t Now) const;
+	void ClockSquare(uint32_t Time);
+	void CatchUpSquare(uint32_t Time);
+	void Output(uint32_t Time, uint32_t Noise, uint32_t Envelope);
+
+	bool UsesNoise() const;
+	bool UsesEnvelope() const;
+	bool UsesSquare() const;
 
 	double GetFrequency() const override;
 
 private:
 	uint8_t m_iVolume;
 	uint32_t m_iPeriod;
-	uint32_t m_iPeriodClock;
+	uint32_t m_iPeriodStart;		// // // Cycle at which the current half-period began
 
 	bool m_bSquareHigh;
 	bool m_bSquareDisable;
 	bool m_bNoiseDisable;
 };
 
-class CS5B : public CSoundChip
+class CS5B : public CSoundChip2
 {
 public:
-	CS5B(CMixer *pMixer);
+	CS5B();
 	virtual ~CS5B();
 	
-	void	Reset();
-	void	Process(uint32_t Time);
-	void	EndFrame();
+	void	Reset() override;
+	void	UpdateFilter(blip_eq_t eq) override;
+	void	Process(uint32_t Time, Blip_Buffer& Output) override;
+	void	SetOutput(Blip_Buffer& Output) override;		// // //
+	void	EndFrame(Blip_Buffer& Output, gsl::span<int16_t> TempBuffer) override;
 
-	void	Write(uint16_t Address, uint8_t Value);
-	uint8_t	Read(uint16_t Address, bool &Mapped);
-	void	Log(uint16_t Address, uint8_t Value);		// // //
+	void	Write(uint16_t Address, uint8_t Value) override;
+	uint8_t	Read(uint16_t Address, bool &Mapped) override;
+	void	Log(uint16_t Address, uint8_t Value) override;		// // //
 
 	double	GetFreq(int Channel) const override;		// // //
+	int		GetChannelLevel(int Channel) override;
+	int		GetChannelOutput(int Channel) const override;
+	int		GetChannelLevelRange(int Channel) const override;
+
+	void	UpdateMixLevel(double v, bool UseSurveyMix = false);
 
 private:
 	void	WriteReg(uint8_t Port, uint8_t Value);
-	void	RunEnvelope(uint32_t Time);
-	void	RunNoise(uint32_t Time);
+
+	// // // Event scheduling, all times are cycles since the start of the frame
+	uint32_t GetNextEnvelopeEvent() const;
+	uint32_t GetNextNoiseEvent() const;
+	bool	ClockEnvelope(uint32_t Time);
+	bool	ClockNoise(uint32_t Time);
+	void	CatchUpNoise(uint32_t Time);
 
 private:
+	// Shared by all channels, must be declared before them
+	Blip_Synth<blip_good_quality> m_SynthS5B;
+
 	CS5BChannel *m_pChannel[3];
 
 	uint8_t m_cPort;
 
-	int m_iCounter;
+	uint32_t m_iCounter;
 
 	uint32_t m_iNoisePeriod;
-	uint32_t m_iNoiseClock;
+	uint32_t m_iNoiseStart;
 	uint32_t m_iNoiseState;
 
 	uint32_t m_iEnvelopePeriod;
-	uint32_t m_iEnvelopeClock;
+	uint32_t m_iEnvelopeStart;
 	char m_iEnvelopeLevel;
 	char m_iEnvelopeShape;
 	bool m_bEnvelopeHold;
@@ -46,6 +46,11 @@ public:
 	/// and tear down all sound chips when it changes.
 	virtual void SetClockRate(uint32_t Rate) {}
 
+	/// Called when the chip is attached to the mixer, before any register is written.
+	/// Chips whose channels write deltas during register writes must attach them to Output here,
+	/// otherwise writes before the first Process() call are lost.
+	virtual void SetOutput(Blip_Buffer& Output) {}		// // //
+
 	/// Advance the sound chip emulator.
 	///
 	/// - Time is the number of clock cycles to advance.
@@ -80,6 +85,14 @@ public:
 		return 0;
 	}
 
+	/// The specified channel's current output level, in the same units as
+	/// GetChannelLevel(). Unlike GetChannelLevel(), this does not reset any state,
+	/// so it may be sampled at any rate (used by CChannelScopeTap).
+	virtual int GetChannelOutput(int Channel) const
+	{
+		return 0;
+	}
+
 	/// The largest possible value returned by GetChannelLevel(Channel).
 	/// Return 1 instead of 0 for invalid channels, to avoid division-by-0 crashes.
 	virtual int GetChannelLevelRange(int Channel) const
@@ -31,7 +31,7 @@ const uint8_t CSquare::DUTY_TABLE[4][16] = {
 	{1, 1, 0, 0,  0, 0, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1}
 };
 
-CSquare::CSquare(CMixer *pMixer, int ID, int Chip) : C2A03Chan(pMixer, Chip, ID)		// // //
+CSquare::CSquare(Blip_Synth<blip_good_quality> &Synth, int ID, int Chip) : C2A03Chan(Synth, Chip, ID)		// // //
 {
 	m_iDutyLength = 0;
 	m_iDutyCycle = 0;
@@ -75,7 +75,7 @@ void CSquare::Reset()
 
 	SweepUpdate(false);
 
-	Mix(0);		// // //
+	ClearOutput();		// // //
 	EndFrame();
 }
 
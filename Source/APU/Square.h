@@ -30,7 +30,7 @@
 
 class CSquare : public C2A03Chan {
 public:
-	CSquare(CMixer *pMixer, int ID, int Chip);
+	CSquare(Blip_Synth<blip_good_quality> &Synth, int ID, int Chip);
 	~CSquare();
 
 	void	Reset();
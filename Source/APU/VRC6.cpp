@@ -18,13 +18,14 @@
 ** along with this program. If not, see https://www.gnu.org/licenses/.
 */
 
+#include "../stdafx.h"
 #include "APU.h"
 #include "VRC6.h"
 #include "../RegisterState.h"		// // //
 
 // Konami VRC6 external sound chip emulation
 
-CVRC6_Pulse::CVRC6_Pulse(CMixer *pMixer, int ID) : CChannel(pMixer, SNDCHIP_VRC6, ID) 
+CVRC6_Pulse::CVRC6_Pulse(Blip_Synth<blip_good_quality> &Synth, int ID) : CChannel(Synth, SNDCHIP_VRC6, ID)
 {
 	Reset();
 }
@@ -36,7 +37,7 @@ void CVRC6_Pulse::Reset()
 	m_iCounter = 0;
 	m_iDutyCycleCounter = 0;
 	
-	Mix(0);		// // //
+	ClearOutput();		// // //
 	EndFrame();
 }
 
@@ -94,7 +95,7 @@ double CVRC6_Pulse::GetFrequency() const		// // //
 	return CAPU::BASE_FREQ_NTSC / 16. / (m_iPeriod + 1.);
 }
 
-CVRC6_Sawtooth::CVRC6_Sawtooth(CMixer *pMixer, int ID) : CChannel(pMixer, SNDCHIP_VRC6, ID) 
+CVRC6_Sawtooth::CVRC6_Sawtooth(Blip_Synth<blip_good_quality> &Synth, int ID) : CChannel(Synth, SNDCHIP_VRC6, ID)
 {
 	Reset();
 }
@@ -106,7 +107,7 @@ void CVRC6_Sawtooth::Reset()
 	m_iPeriodLow = m_iPeriodHigh = 0;
 	m_iCounter = 0;
 	
-	Mix(0);		// // //
+	ClearOutput();		// // //
 	EndFrame();
 }
 
@@ -175,11 +176,10 @@ double CVRC6_Sawtooth::GetFrequency() const		// // //
 	return CAPU::BASE_FREQ_NTSC / 14. / (m_iPeriod + 1.);
 }
 
-CVRC6::CVRC6(CMixer *pMixer) :
-	CSoundChip(pMixer),		// // //
-	m_pPulse1(new CVRC6_Pulse(pMixer, CHANID_VRC6_PULSE1)),
-	m_pPulse2(new CVRC6_Pulse(pMixer, CHANID_VRC6_PULSE2)),
-	m_pSawtooth(new CVRC6_Sawtooth(pMixer, CHANID_VRC6_SAWTOOTH))
+CVRC6::CVRC6() :
+	m_pPulse1(new CVRC6_Pulse(m_SynthVRC6, CHANID_VRC6_PULSE1)),
+	m_pPulse2(new CVRC6_Pulse(m_SynthVRC6, CHANID_VRC6_PULSE2)),
+	m_pSawtooth(new CVRC6_Sawtooth(m_SynthVRC6, CHANID_VRC6_SAWTOOTH))
 {
 	m_pRegisterLogger->AddRegisterRange(0x9000, 0x9003);		// // //
 	m_pRegisterLogger->AddRegisterRange(0xA000, 0xA002);
@@ -203,6 +203,13 @@ void CVRC6::Reset()
 	m_pPulse1->Reset();
 	m_pPulse2->Reset();
 	m_pSawtooth->Reset();
+
+	m_SynthVRC6.clear();
+}
+
+void CVRC6::UpdateFilter(blip_eq_t eq)
+{
+	m_SynthVRC6.treble_eq(eq);
 }
 
 void CVRC6::Write(uint16_t Address, uint8_t Value)
@@ -232,15 +239,25 @@ uint8_t CVRC6::Read(uint16_t Address, bool &Mapped)
 	return 0;
 }
 
-void CVRC6::EndFrame()
+void CVRC6::EndFrame(Blip_Buffer&, gsl::span<int16_t>)
 {
 	m_pPulse1->EndFrame();
 	m_pPulse2->EndFrame();
 	m_pSawtooth->EndFrame();
 }
 
-void CVRC6::Process(uint32_t Time)
+void CVRC6::SetOutput(Blip_Buffer& Output)		// // //
 {
+	// Channels write to Output directly, also during register writes
+	m_pPulse1->SetOutput(&Output);
+	m_pPulse2->SetOutput(&Output);
+	m_pSawtooth->SetOutput(&Output);
+}
+
+void CVRC6::Process(uint32_t Time, Blip_Buffer& Output)
+{
+	SetOutput(Output);
+
 	m_pPulse1->Process(Time);
 	m_pPulse2->Process(Time);
 	m_pSawtooth->Process(Time);
@@ -255,3 +272,52 @@ double CVRC6::GetFreq(int Channel) const		// // //
 	}
 	return 0.;
 }
+
+CChannel *CVRC6::GetChannel(int Channel) const
+{
+	switch (Channel) {
+	case 0: return m_pPulse1;
+	case 1: return m_pPulse2;
+	case 2: return m_pSawtooth;
+	}
+	return nullptr;
+}
+
+int CVRC6::GetChannelLevel(int Channel)
+{
+	ASSERT(0 <= Channel && Channel < 3);
+	if (CChannel *pChan = GetChannel(Channel))
+		return pChan->GetLevel();
+	return 0;
+}
+
+int CVRC6::GetChannelOutput(int Channel) const
+{
+	if (const CChannel *pChan = GetChannel(Channel))
+		return pChan->GetOutput();
+	return 0;
+}
+
+int CVRC6::GetChannelLevelRange(int Channel) const
+{
+	ASSERT(0 <= Channel && Channel < 3);
+	switch (Channel) {
+	case 0: case 1:
+		// pulse
+		return 15;
+	case 2:
+		// sawtooth, 5 highest bits of the accumulator
+		return 31;
+	default:
+		// unknown channel, return 1 to avoid division by 0
+		return 1;
+	}
+}
+
+void CVRC6::UpdateMixLevel(double v, bool UseSurveyMix)
+{
+	if (UseSurveyMix)
+		m_SynthVRC6.volume(v, 15 + 15 + 31);	// P1 + P2 + Saw, linear
+	else
+		m_SynthVRC6.volume(v * 3.98333f, 500);
+}
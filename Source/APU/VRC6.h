@@ -21,12 +21,12 @@
 
 #pragma once
 
-#include "SoundChip.h"
+#include "SoundChip2.h"
 #include "Channel.h"
 
 class CVRC6_Pulse : public CChannel {
 public:
-	CVRC6_Pulse(CMixer *pMixer, int ID);
+	CVRC6_Pulse(Blip_Synth<blip_good_quality> &Synth, int ID);
 	void Reset();
 	void Write(uint16_t Address, uint8_t Value);
 	void Process(int Time);
@@ -46,7 +46,7 @@ private:
 
 class CVRC6_Sawtooth : public CChannel {
 public:
-	CVRC6_Sawtooth(CMixer *pMixer, int ID);
+	CVRC6_Sawtooth(Blip_Synth<blip_good_quality> &Synth, int ID);
 	void Reset();
 	void Write(uint16_t Address, uint8_t Value);
 	void Process(int Time);
@@ -63,18 +63,31 @@ private:
 	int32_t	m_iCounter;
 };
 
-class CVRC6 : public CSoundChip {
+class CVRC6 : public CSoundChip2 {
 public:
-	CVRC6(CMixer *pMixer);
+	CVRC6();
 	virtual ~CVRC6();
-	void Reset();
-	void Write(uint16_t Address, uint8_t Value);
-	uint8_t Read(uint16_t Address, bool &Mapped);
-	void EndFrame();
-	void Process(uint32_t Time);
+	void Reset() override;
+	void UpdateFilter(blip_eq_t eq) override;
+	void Write(uint16_t Address, uint8_t Value) override;
+	uint8_t Read(uint16_t Address, bool &Mapped) override;
+	void EndFrame(Blip_Buffer& Output, gsl::span<int16_t> TempBuffer) override;
+	void Process(uint32_t Time, Blip_Buffer& Output) override;
+	void SetOutput(Blip_Buffer& Output) override;		// // //
 	double GetFreq(int Channel) const override;		// // //
+	int GetChannelLevel(int Channel) override;
+	int GetChannelOutput(int Channel) const override;
+	int GetChannelLevelRange(int Channel) const override;
+
+	void UpdateMixLevel(double v, bool UseSurveyMix = false);
 
 private:
+	CChannel *GetChannel(int Channel) const;
+
+private:
+	// Shared by all channels, must be declared before them
+	Blip_Synth<blip_good_quality> m_SynthVRC6;
+
 	CVRC6_Pulse	*m_pPulse1, *m_pPulse2;
 	CVRC6_Sawtooth *m_pSawtooth;
 };
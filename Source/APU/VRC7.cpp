@@ -183,6 +183,14 @@ int CVRC7::GetChannelLevel(int Channel)
 	return 0;
 }
 
+int CVRC7::GetChannelOutput(int Channel) const
+{
+	if (0 <= Channel && Channel < 6) {
+		return m_ChannelLevels[Channel].getCurrent();
+	}
+	return 0;
+}
+
 int CVRC7::GetChannelLevelRange(int Channel) const
 {
 	return 127;
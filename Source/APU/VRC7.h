@@ -42,6 +42,7 @@ public:
 
 	double GetFreq(int Channel) const override;		// // //
 	int GetChannelLevel(int Channel) override;
+	int GetChannelOutput(int Channel) const override;
 	int GetChannelLevelRange(int Channel) const override;
 
 	void SetSampleSpeed(uint32_t SampleRate, double ClockRate, uint32_t FrameRate);
@@ -166,6 +166,92 @@ public:
 		_updateCounter += clocks;
 	}
 
+	/// Equivalent to alternating ClockAudioMaxSkip(), SkipClockAudio() and
+	/// ClockAudio() for `clocks` cycles, assuming no register writes occur in
+	/// between. Channel registers are decoded once per call rather than on every
+	/// channel update, and the linear mix is kept as a running sum.
+	///
+	/// Calls `on_update(clock, output, channel)` whenever the output may have
+	/// changed, where `clock` is relative to the start of the call, `output` is
+	/// what ClockAudio() would have returned and `channel` is the channel that
+	/// was updated (or -1 if none was). Output is constant between calls.
+	template <typename F>
+	void RunClockAudio(uint32_t clocks, F &&on_update)
+	{
+		if (_disableSound) {
+			// ClockAudio() leaves every channel untouched, so only the first
+			// clock can produce a new output.
+			uint32_t skip = std::min(ClockAudioMaxSkip(), clocks);
+			SkipClockAudio(skip);
+			if (skip < clocks)
+				on_update(skip, UpdateOutputLevel(), -1);
+			return;
+		}
+
+		struct {
+			uint32_t phase;
+			uint32_t freq;
+			uint32_t modulo;
+			uint8_t offset;
+			uint8_t volume;
+		} regs[8];
+		for (int i = 0; i < 8; ++i) {
+			regs[i].phase = GetPhase(i);
+			regs[i].freq = GetFrequency(i);
+			regs[i].modulo = GetWaveLength(i) << 16;
+			regs[i].offset = GetWaveAddress(i);
+			regs[i].volume = GetVolume(i);
+		}
+
+		const int minChannel = 7 - GetNumberOfChannels();
+		int16_t summedOutput = 0;
+		for (int i = 7; i >= minChannel; i--)
+			summedOutput += _channelOutput[i];
+
+		uint32_t now = 0;
+		while (true) {
+			uint32_t skip = ClockAudioMaxSkip();
+			if (skip >= clocks - now) {
+				SkipClockAudio(clocks - now);
+				break;
+			}
+			now += skip;
+
+			// Same as UpdateChannel(), using the decoded registers
+			const int channel = _currentChannel;
+			auto &r = regs[channel];
+			if (r.modulo == 0)
+				r.phase = 0;
+			else
+				r.phase = (r.phase + r.freq) % r.modulo;
+
+			uint8_t samplePosition = ((r.phase >> 16) + r.offset) & 0xFF;
+			int8_t sample;
+			if ((samplePosition & 0x01)) {
+				sample = _internalRam[samplePosition / 2] >> 4;
+			} else {
+				sample = _internalRam[samplePosition / 2] & 0x0F;
+			}
+
+			// Waves may overlap the phase registers, so write the phase back immediately
+			SetPhase(channel, r.phase);
+
+			int16_t output = (sample - 8) * r.volume;
+			if (channel >= minChannel)
+				summedOutput += output - _channelOutput[channel];
+			_channelOutput[channel] = output;
+
+			_updateCounter = 0;
+			_currentChannel--;
+			if (_currentChannel < minChannel) {
+				_currentChannel = 7;
+			}
+
+			on_update(now, _mixLinear ? summedOutput : _channelOutput[_currentChannel], channel);
+			++now;
+		}
+	}
+
 	Namco163Audio()
 		: _channelOutput{}
 		, _internalRam{}
@@ -7,6 +7,33 @@
 
 namespace xgm
 {
+  static constexpr INT16 sqrtbl[4][16] = {
+    {0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0},
+    {1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}
+  };
+
+  // For each entry of sqrtbl, the number of steps until the next entry with another level.
+  struct sqr_runs_t {
+    UINT8 steps[4][16];
+  };
+
+  static constexpr sqr_runs_t make_sqr_runs()
+  {
+    sqr_runs_t runs = {};
+    for (int duty = 0; duty < 4; ++duty)
+      for (int phase = 0; phase < 16; ++phase) {
+        int step = 1;
+        while (sqrtbl[duty][(phase + step) & 15] == sqrtbl[duty][phase])
+          ++step;
+        runs.steps[duty][phase] = (UINT8)step;
+      }
+    return runs;
+  }
+
+  static constexpr sqr_runs_t sqr_runs = make_sqr_runs();
+
   void NES_APU::sweep_sqr (int i)
   {
       int shifted = freq[i] >> sweep_amount[i];
@@ -89,13 +116,6 @@ namespace xgm
 
   INT32 NES_APU::calc_sqr (int i, UINT32 clocks)
   {
-    static const INT16 sqrtbl[4][16] = {
-      {0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-      {0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-      {0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0},
-      {1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}
-    };
-
     scounter[i] -= clocks;
     while (scounter[i] < 0)
     {
@@ -139,6 +159,11 @@ namespace xgm
   }
 
   UINT32 NES_APU::ClocksUntilLevelChange()
+  {
+      return ClocksUntilLevelChange(false);
+  }
+
+  UINT32 NES_APU::ClocksUntilLevelChange(bool lookahead)
   {
       // We don't know how long until the frame sequencer kicks in.
       // But it doesn't matter, NES_DMC::ClocksUntilLevelChange() takes that into account,
@@ -148,7 +173,7 @@ namespace xgm
       UINT32 out = 1 << 24;
 
       // See calc_sqr().
-      auto check_level_change = [this](size_t sqr, auto& out) {
+      auto check_level_change = [this, lookahead](size_t sqr, auto& out) {
           // Only constrain "clocks until level change" if the channel is not muted by hardware,
           // and has a nonzero volume.
           if (length_counter[sqr] > 0 &&
@@ -169,9 +194,19 @@ namespace xgm
                   //
                   // `scounter` is the number of clocks before the next entry in the square wavetable.
                   // However, all but 2 entries have the same output level as before,
-                  // so this will run Render() more often than needed.
-                  // (But this is no more often than FamiTracker's original emulation at Square.cpp.)
-                  out = std::min(out, value_or(scounter[sqr], freq[sqr] + 1));
+                  // so skip over entries which don't change the level, using the precomputed
+                  // run lengths of the wavetable. calc_sqr() advances through them in a single
+                  // Tick() with the same result.
+                  if (!lookahead) {
+                      out = std::min(out, value_or(scounter[sqr], freq[sqr] + 1));
+                      return;
+                  }
+                  const UINT8 *steps = sqr_runs.steps[duty[sqr]];
+                  const int phase = sphase[sqr];
+                  out = std::min(out, scounter[sqr] > 0
+                      ? clocks_until_step((UINT32)scounter[sqr], (UINT32)freq[sqr] + 1, steps[phase])
+                      // The current entry is replaced on the next Tick() and never heard.
+                      : clocks_until_step(0, (UINT32)freq[sqr] + 1, 1 + steps[(phase + 1) & 15]));
               }
           }
       };
@@ -77,6 +77,10 @@ namespace xgm
     virtual void Reset ();
     virtual void Tick (UINT32 clocks);
     UINT32 ClocksUntilLevelChange() override;
+    /// If lookahead is true, skips over wavetable steps which don't change the output level.
+    /// Only valid if no frame sequencer step is pending (see NES_DMC::FrameSequencePending()),
+    /// since a sweep can change the period partway through.
+    UINT32 ClocksUntilLevelChange(bool lookahead);
     virtual UINT32 Render (INT32 b[2]);
     virtual bool Read (UINT32 adr, UINT32 & val, UINT32 id=0);
     virtual bool Write (UINT32 adr, UINT32 val, UINT32 id=0);
@@ -406,6 +406,12 @@ namespace xgm
       UINT32 out =
           (UINT32)value_or(frame_sequence_length - frame_sequence_count, frame_sequence_length);
 
+      // The lookahead below predicts levels from the current channel state.
+      // If a frame sequencer step is pending, the state is about to change
+      // (and channels which are currently silent aren't constrained at all),
+      // so only step one event at a time, like calc_*() do.
+      const bool lookahead = !FrameSequencePending();
+
       // See calc_tri().
       if (linear_counter > 0 && length_counter[0] > 0
           && (!option[OPT_TRI_MUTE] || tri_freq > 0)) {
@@ -413,13 +419,11 @@ namespace xgm
       }
 
       // See calc_noise().
-      // Unfortunately, at noise pitch $F, this updates every 4 clocks,
-      // which drains CPU especially in debug builds.
-      //
-      // One solution is to only update noise intermittently,
-      // However it's tricky to get right, and may require editing calc_noise().
-      //
-      // For now, just accept the increased CPU usage as a tradeoff.
+      // At noise pitch $F, the LFSR is clocked every 4 clocks, which drains CPU
+      // especially in debug builds. But the output only changes when bit 14 of the
+      // LFSR flips, so look ahead in the LFSR sequence and skip over clocks which
+      // don't change the level. calc_noise() averages the levels within a Tick(),
+      // which is exact when they're all equal.
       {
           UINT32 env = envelope_disable ? noise_volume : envelope_counter;
           if (length_counter[1] < 1) env = 0;
@@ -429,18 +433,37 @@ namespace xgm
                       // "only happens on startup when using the randomize noise option", idk what to return
                       return (UINT32)1;
                   }
-                  return value_or((UINT32) counter[1], nfreq);
+                  if (!lookahead) {
+                      return value_or((UINT32) counter[1], nfreq);
+                  }
+                  // Each clock shifts the LFSR right and feeds bit 0 ^ bit `tap` into bit 14,
+                  // which is the level. Until the feedback reaches bit `tap`, bit k of
+                  // `feedback` is the level after k + 1 clocks.
+                  const UINT32 tap = (noise_tap & (1 << 6)) ? 6 : 1;
+                  const UINT32 known = 15 - tap;
+                  const UINT32 feedback = (noise ^ (noise >> tap)) & ((1 << known) - 1);
+
+                  // If counter[1] is 0, the current level is replaced on the next Tick()
+                  // and never heard, so the run starts with the level after one clock.
+                  const UINT32 first = counter[1] > 0 ? 0 : 1;
+                  const UINT32 level = first ? (feedback & 1) : (noise >> 14) & 1;
+                  const UINT32 changes = (feedback ^ (level ? ~0u : 0u)) & ~((1u << first) - 1) & ((1 << known) - 1);
+                  return clocks_until_step((UINT32)counter[1], nfreq,
+                      changes ? lowest_set_bit(changes) + 1 : known + 1);
               }());
           }
       }
 
       // See calc_dmc().
-      // It's quite tricky to predict if the DMC is playing a sample or not,
-      // so always assume it's playing.
-      // But the amount of CPU overhead is minimal, because the DMC frequency never exceeds 33 kHz,
-      // equivalent to a clock-skip of 54 (on NTSC, see `NES_DMC::freq_table`).
-      auto clocks_until_dmc = value_or(counter[2], dfreq);
-      out = std::min(out, clocks_until_dmc);
+      // Once the sample has ended and the shift register is drained, the output level
+      // holds until the next register write, so the DMC doesn't need to be stepped.
+      // Otherwise assume it's playing. The amount of CPU overhead is minimal, because the
+      // DMC frequency never exceeds 33 kHz, equivalent to a clock-skip of 54
+      // (on NTSC, see `NES_DMC::freq_table`).
+      if (!lookahead || !(empty && dlength == 0)) {
+          auto clocks_until_dmc = value_or(counter[2], dfreq);
+          out = std::min(out, clocks_until_dmc);
+      }
 
       return out;
   }
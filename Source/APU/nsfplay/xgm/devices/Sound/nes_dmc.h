@@ -125,6 +125,9 @@ namespace xgm
     virtual void Reset ();
     virtual void Tick (UINT32 clocks);
     UINT32 ClocksUntilLevelChange() override;
+    /// True if the next nonzero TickFrameSequence() will clock the frame sequencer
+    /// before any time passes.
+    bool FrameSequencePending() const { return frame_sequence_count >= frame_sequence_length; }
     virtual UINT32 Render (INT32 b[2]);
     virtual bool Write (UINT32 adr, UINT32 val, UINT32 id=0);
     virtual bool Read (UINT32 adr, UINT32 & val, UINT32 id=0);
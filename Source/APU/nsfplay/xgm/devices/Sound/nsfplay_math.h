@@ -3,6 +3,9 @@
 #include "../../xtypes.h"  // UINT32
 #include <algorithm>  // std::max
 #include <cassert>
+#if defined(_MSC_VER)
+#include <intrin.h>  // _BitScanForward
+#endif
 
 namespace xgm {
     inline UINT32 value_or(UINT32 x, UINT32 period) {
@@ -14,4 +17,29 @@ namespace xgm {
         }
         return x;
     }
+
+    /// Used by ClocksUntilLevelChange() to skip over steps which leave a channel's
+    /// output level unchanged, so a single Tick() can cover a run of identical levels.
+    ///
+    /// - counter: clocks until the next step (0 means it occurs on the next nonzero Tick()).
+    /// - period: clocks between steps.
+    /// - step: the step which changes the level, 1 being the next one.
+    ///
+    /// Returns the number of clocks until that step.
+    inline UINT32 clocks_until_step(UINT32 counter, UINT32 period, UINT32 step) {
+        assert(period > 0 && step >= 1);
+        return counter + (step - 1) * period;
+    }
+
+    /// Returns the index of the lowest set bit of x, which must be nonzero.
+    inline UINT32 lowest_set_bit(UINT32 x) {
+        assert(x != 0);
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return (UINT32)index;
+#else
+        return (UINT32)__builtin_ctz(x);
+#endif
+    }
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#include "stdafx.h"
+#include "AudioLatency.h"
+#include <algorithm>
+
+using namespace std::chrono;
+
+unsigned int stLatencyStats::GetBin(unsigned int Ms)
+{
+	return std::min(Ms / BIN_WIDTH_MS, HISTOGRAM_BINS - 1);
+}
+
+void CAudioLatencyController::Reset(unsigned int SampleRate, uint32_t BufferFrames, uint32_t TargetFrames, bool Adaptive)
+{
+	std::unique_lock<std::mutex> lock(m_Lock);
+
+	m_iSampleRate = SampleRate;
+	m_iBufferFrames = BufferFrames;
+	m_bAdaptive = Adaptive;
+	m_iTargetFrames = Adaptive ? std::clamp(TargetFrames, std::min(MsToFrames(MIN_TARGET_MS), BufferFrames), BufferFrames) : BufferFrames;
+
+	m_Stats = stLatencyStats { };
+	m_Stats.bAdaptive = Adaptive;
+	m_Stats.iBufferMs = FramesToMs(m_iBufferFrames);
+	m_Stats.iTargetMs = FramesToMs(m_iTargetFrames);
+
+	m_WindowStart = clock_type::now();
+	m_bHasWoken = false;
+	m_WakeIntervalSum = { };
+	m_iWakeCount = 0;
+	m_MaxWakeInterval = { };
+	m_MaxEmulationTime = { };
+	m_iWindowUnderruns = 0;
+}
+
+uint32_t CAudioLatencyController::GetTargetFrames() const
+{
+	// Only written on the audio thread, which is also the only caller
+	return m_iTargetFrames;
+}
+
+void CAudioLatencyController::OnWake(clock_type::time_point Time)
+{
+	if (m_bHasWoken) {
+		auto Interval = Time - m_LastWake;
+		m_WakeIntervalSum += Interval;
+		++m_iWakeCount;
+		m_MaxWakeInterval = std::max(m_MaxWakeInterval, Interval);
+	}
+	m_LastWake = Time;
+	m_bHasWoken = true;
+}
+
+void CAudioLatencyController::OnWrite(uint32_t QueuedFrames)
+{
+	unsigned int Ms = FramesToMs(QueuedFrames);
+
+	std::unique_lock<std::mutex> lock(m_Lock);
+	m_Stats.iLatencyMs = Ms;
+	++m_Stats.LatencyHistogram[stLatencyStats::GetBin(Ms)];
+}
+
+void CAudioLatencyController::OnUnderrun()
+{
+	++m_iWindowUnderruns;
+
+	// A wake-up after an underrun says nothing about the regular period
+	m_bHasWoken = false;
+
+	std::unique_lock<std::mutex> lock(m_Lock);
+	++m_Stats.iUnderruns;
+	++m_Stats.UnderrunHistogram[stLatencyStats::GetBin(FramesToMs(m_iTargetFrames))];
+
+	if (m_bAdaptive) {
+		m_iTargetFrames = std::min(m_iBufferFrames, m_iTargetFrames + std::max(m_iTargetFrames / 4, MsToFrames(MARGIN_MS)));
+		m_Stats.iTargetMs = FramesToMs(m_iTargetFrames);
+	}
+}
+
+void CAudioLatencyController::OnFrameEmulated(clock_type::duration EmulationTime)
+{
+	m_MaxEmulationTime = std::max(m_MaxEmulationTime, EmulationTime);
+
+	if (clock_type::now() - m_WindowStart >= milliseconds(WINDOW_MS))
+		EndWindow();
+}
+
+void CAudioLatencyController::EndWindow()
+{
+	const auto MaxWake = duration_cast<microseconds>(m_MaxWakeInterval);
+	const auto MeanWake = m_iWakeCount ? duration_cast<microseconds>(m_WakeIntervalSum / m_iWakeCount) : microseconds::zero();
+	const auto MaxEmulation = duration_cast<microseconds>(m_MaxEmulationTime);
+
+	std::unique_lock<std::mutex> lock(m_Lock);
+	m_Stats.iMaxWakeIntervalUs = static_cast<unsigned int>(MaxWake.count());
+	m_Stats.iJitterUs = static_cast<unsigned int>((MaxWake - MeanWake).count());
+	m_Stats.iEmulationUs = static_cast<unsigned int>(MaxEmulation.count());
+
+	if (m_bAdaptive && !m_iWindowUnderruns && m_iWakeCount) {
+		// The buffer must cover the longest gap between wake-ups, plus the time it takes
+		// to emulate the frame that refills it
+		const auto RequiredMs = static_cast<unsigned int>((MaxWake + MaxEmulation).count() / 1000) + MARGIN_MS;
+		const uint32_t Floor = std::min(m_iBufferFrames, MsToFrames(std::max(RequiredMs, MIN_TARGET_MS)));
+		if (m_iTargetFrames > Floor) {
+			m_iTargetFrames = std::max(Floor, m_iTargetFrames - m_iTargetFrames / 8);
+			m_Stats.iTargetMs = FramesToMs(m_iTargetFrames);
+		}
+	}
+	lock.unlock();
+
+	m_WindowStart = clock_type::now();
+	m_WakeIntervalSum = { };
+	m_iWakeCount = 0;
+	m_MaxWakeInterval = { };
+	m_MaxEmulationTime = { };
+	m_iWindowUnderruns = 0;
+}
+
+stLatencyStats CAudioLatencyController::GetStats() const
+{
+	std::unique_lock<std::mutex> lock(m_Lock);
+	return m_Stats;
+}
+
+unsigned int CAudioLatencyController::FramesToMs(uint32_t Frames) const
+{
+	return m_iSampleRate ? static_cast<unsigned int>(uint64_t(Frames) * 1000 / m_iSampleRate) : 0;
+}
+
+uint32_t CAudioLatencyController::MsToFrames(unsigned int Ms) const
+{
+	return static_cast<uint32_t>(uint64_t(Ms) * m_iSampleRate / 1000);
+}
@@ -0,0 +1,115 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+/// Snapshot of the audio output telemetry, see CAudioLatencyController.
+struct stLatencyStats {
+	static constexpr unsigned int HISTOGRAM_BINS = 32;
+	static constexpr unsigned int BIN_WIDTH_MS = 4;		// The last bin also counts longer latencies
+
+	unsigned int iLatencyMs = 0;			// Audio queued after the most recent write, without the device's own latency
+	unsigned int iTargetMs = 0;				// Current buffer fill target
+	unsigned int iBufferMs = 0;				// Size of the device buffer
+	unsigned int iMaxWakeIntervalUs = 0;	// Longest gap between device wake-ups in the last window
+	unsigned int iJitterUs = 0;				// Longest wake-up gap minus the mean gap
+	unsigned int iEmulationUs = 0;			// Longest time spent emulating one frame in the last window
+	unsigned int iUnderruns = 0;
+	bool bAdaptive = false;
+
+	/// Number of writes which left the given amount of audio queued.
+	std::array<unsigned int, HISTOGRAM_BINS> LatencyHistogram = { };
+	/// Number of underruns which occurred at the given buffer fill target.
+	std::array<unsigned int, HISTOGRAM_BINS> UnderrunHistogram = { };
+
+	static unsigned int GetBin(unsigned int Ms);
+};
+
+/*!
+	\brief Tracks audio output latency, device wake-up jitter and emulation time, and in
+	adaptive mode picks how much of the device buffer CSoundGen keeps filled.
+
+	The fill target starts at the user's buffer length. Every underrun grows it by a
+	quarter; after a window without underruns it shrinks by an eighth, but never below
+	the longest observed wake-up gap plus emulation time and a safety margin.
+
+	Updated from the audio thread; GetStats() may be called from any thread.
+*/
+class CAudioLatencyController
+{
+public:
+	using clock_type = std::chrono::steady_clock;
+
+	/// Resets all telemetry.
+	/// \param SampleRate Output sample rate of the stream.
+	/// \param BufferFrames Size of the device buffer, the upper bound of the target.
+	/// \param TargetFrames Initial fill target, ignored unless Adaptive is true.
+	void Reset(unsigned int SampleRate, uint32_t BufferFrames, uint32_t TargetFrames, bool Adaptive);
+
+	/// Returns the number of frames CSoundGen should keep queued on the stream.
+	uint32_t GetTargetFrames() const;
+
+	/// Called when the stream signals that audio can be written.
+	void OnWake(clock_type::time_point Time);
+	/// Called after writing audio, with the number of frames now queued on the stream.
+	void OnWrite(uint32_t QueuedFrames);
+	/// Called when the stream has run dry.
+	void OnUnderrun();
+	/// Called once per emulated frame with the time spent outside of audio waits.
+	/// Adjusts the target at the end of each window in adaptive mode.
+	void OnFrameEmulated(clock_type::duration EmulationTime);
+
+	stLatencyStats GetStats() const;
+
+public:
+	static constexpr unsigned int WINDOW_MS = 2000;		// Interval between target adjustments
+	static constexpr unsigned int MARGIN_MS = 2;		// Headroom kept above the observed worst case
+	static constexpr unsigned int MIN_TARGET_MS = 4;
+
+private:
+	unsigned int FramesToMs(uint32_t Frames) const;
+	uint32_t MsToFrames(unsigned int Ms) const;
+	void EndWindow();
+
+private:
+	mutable std::mutex m_Lock;
+	stLatencyStats m_Stats;
+
+	unsigned int m_iSampleRate = 0;
+	uint32_t m_iBufferFrames = 0;
+	uint32_t m_iTargetFrames = 0;
+	bool m_bAdaptive = false;
+
+	// Current adjustment window
+	clock_type::time_point m_WindowStart;
+	clock_type::time_point m_LastWake;
+	bool m_bHasWoken = false;
+	clock_type::duration m_WakeIntervalSum = { };
+	unsigned int m_iWakeCount = 0;
+	clock_type::duration m_MaxWakeInterval = { };
+	clock_type::duration m_MaxEmulationTime = { };
+	unsigned int m_iWindowUnderruns = 0;
+};
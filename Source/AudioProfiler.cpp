@@ -0,0 +1,343 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#include "stdafx.h"
+#include "AudioProfiler.h"
+#include "json/json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+#define AUDIO_PROFILER_RDTSC
+#endif
+
+using namespace std::chrono;
+
+namespace {
+
+const char *const ENTRY_NAMES[] = {
+	"Frame",
+	"RunFrame",
+	"PlayChannelNotes",
+	"UpdatePlayer",
+	"UpdateChannels",
+	"UpdateAPU",
+	"Audio wait",
+};
+
+const char *const CHIP_NAMES[] = {
+	"2A03",
+	"VRC6",
+	"VRC7",
+	"FDS",
+	"MMC5",
+	"N163",
+	"5B",
+};
+
+static_assert(std::size(ENTRY_NAMES) == PROFILE_CHIP_PROCESS, "Missing profile entry names");
+static_assert(std::size(CHIP_NAMES) == PROFILE_CHIP_COUNT, "Missing profile chip names");
+
+// Only one thread writes each counter, so no read-modify-write is needed
+void Bump(std::atomic<uint64_t> &Counter, uint64_t Value) {
+	Counter.store(Counter.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+}
+
+// Minimum time measured before the tick rate is known
+const auto CALIBRATION_TIME = milliseconds(10);
+
+} // namespace
+
+struct CAudioProfiler::ThreadBuffer {
+	struct Entry {
+		std::atomic<uint64_t> Frames = 0;
+		std::atomic<uint64_t> Calls = 0;
+		std::atomic<uint64_t> TotalNs = 0;
+		std::atomic<uint64_t> MaxNs = 0;
+		std::array<std::atomic<uint64_t>, stProfileStats::HISTOGRAM_BINS> Histogram = { };
+	};
+
+	// Current frame, owning thread only
+	std::array<uint64_t, PROFILE_ENTRY_COUNT> FrameTicks = { };
+	std::array<uint32_t, PROFILE_ENTRY_COUNT> FrameCalls = { };
+	uint64_t iWaitTicks = 0;			// Running total of PROFILE_AUDIO_WAIT, subtracted by enclosing scopes
+
+	// Tick calibration, owning thread only
+	bool bCalibrating = false;
+	uint64_t iCalibrationTicks = 0;
+	clock_type::time_point CalibrationTime;
+	double fNsPerTick = 0.;
+
+	// Published statistics, written by the owning thread only
+	std::atomic<unsigned int> iResetCount = 0;
+	std::array<Entry, PROFILE_ENTRY_COUNT> Entries;
+};
+
+namespace {
+
+thread_local CAudioProfiler::ThreadBuffer *t_pProfileBuffer = nullptr;
+
+} // namespace
+
+double stProfileStats::GetMeanUs() const
+{
+	return iFrames ? iTotalNs / 1000. / iFrames : 0.;
+}
+
+unsigned int stProfileStats::GetQuantileUs(double Quantile) const
+{
+	const uint64_t Target = static_cast<uint64_t>(std::ceil(Quantile * iFrames));
+	uint64_t Count = 0;
+	for (unsigned int i = 0; i < HISTOGRAM_BINS; ++i) {
+		Count += Histogram[i];
+		if (Count >= Target && Count)
+			return GetBinLimitUs(i);
+	}
+	return 0;
+}
+
+unsigned int stProfileStats::GetBin(uint64_t Ns)
+{
+	unsigned int Bin = 0;
+	for (uint64_t Us = Ns / 1000; Us; Us >>= 1)
+		++Bin;
+	return std::min(Bin, HISTOGRAM_BINS - 1);
+}
+
+unsigned int stProfileStats::GetBinLimitUs(unsigned int Bin)
+{
+	return 1u << Bin;
+}
+
+CAudioProfiler &CAudioProfiler::Get()
+{
+	static CAudioProfiler Profiler;
+	return Profiler;
+}
+
+const char *CAudioProfiler::GetEntryName(unsigned int Entry)
+{
+	static std::array<std::string, PROFILE_ENTRY_COUNT> Names = [] {
+		std::array<std::string, PROFILE_ENTRY_COUNT> x;
+		for (unsigned int i = 0; i < PROFILE_CHIP_PROCESS; ++i)
+			x[i] = ENTRY_NAMES[i];
+		for (unsigned int i = 0; i < PROFILE_CHIP_COUNT; ++i) {
+			x[PROFILE_CHIP_PROCESS + i] = std::string {CHIP_NAMES[i]} + " Process";
+			x[PROFILE_CHIP_END_FRAME + i] = std::string {CHIP_NAMES[i]} + " EndFrame";
+		}
+		return x;
+	}();
+	return Entry < PROFILE_ENTRY_COUNT ? Names[Entry].c_str() : "";
+}
+
+void CAudioProfiler::Enable(bool bEnable)
+{
+	m_bEnabled.store(bEnable, std::memory_order_relaxed);
+}
+
+bool CAudioProfiler::IsEnabled() const
+{
+	return m_bEnabled.load(std::memory_order_relaxed);
+}
+
+void CAudioProfiler::Reset()
+{
+	m_iResetCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+profile_stats_t CAudioProfiler::GetStats() const
+{
+	profile_stats_t Stats { };
+	const unsigned int ResetCount = m_iResetCount.load(std::memory_order_relaxed);
+
+	std::unique_lock<std::mutex> lock(m_Lock);
+	for (const auto &pBuffer : m_Buffers) {
+		if (pBuffer->iResetCount.load(std::memory_order_acquire) != ResetCount)
+			continue;
+		for (unsigned int i = 0; i < PROFILE_ENTRY_COUNT; ++i) {
+			const auto &Entry = pBuffer->Entries[i];
+			auto &s = Stats[i];
+			s.iFrames += Entry.Frames.load(std::memory_order_relaxed);
+			s.iCalls += Entry.Calls.load(std::memory_order_relaxed);
+			s.iTotalNs += Entry.TotalNs.load(std::memory_order_relaxed);
+			s.iMaxNs = std::max(s.iMaxNs, Entry.MaxNs.load(std::memory_order_relaxed));
+			for (unsigned int j = 0; j < stProfileStats::HISTOGRAM_BINS; ++j)
+				s.Histogram[j] += Entry.Histogram[j].load(std::memory_order_relaxed);
+		}
+	}
+
+	return Stats;
+}
+
+std::string CAudioProfiler::ExportCSV(const profile_stats_t &Stats)
+{
+	std::string Out = "entry,frames,calls,total_us,mean_us,max_us,p50_us,p99_us";
+	for (unsigned int j = 0; j < stProfileStats::HISTOGRAM_BINS; ++j)
+		Out += ",under_" + std::to_string(stProfileStats::GetBinLimitUs(j)) + "_us";
+	Out += '\n';
+
+	char Buf[128];
+	for (unsigned int i = 0; i < PROFILE_ENTRY_COUNT; ++i) {
+		const auto &s = Stats[i];
+		std::snprintf(Buf, std::size(Buf), "%s,%llu,%llu,%.1f,%.2f,%.1f,%u,%u", GetEntryName(i),
+			static_cast<unsigned long long>(s.iFrames), static_cast<unsigned long long>(s.iCalls),
+			s.iTotalNs / 1000., s.GetMeanUs(), s.iMaxNs / 1000., s.GetQuantileUs(.5), s.GetQuantileUs(.99));
+		Out += Buf;
+		for (auto Count : s.Histogram)
+			Out += ',' + std::to_string(Count);
+		Out += '\n';
+	}
+
+	return Out;
+}
+
+std::string CAudioProfiler::ExportJSON(const profile_stats_t &Stats)
+{
+	nlohmann::json j = nlohmann::json::object();
+
+	auto &Bins = j["histogram_limits_us"] = nlohmann::json::array();
+	for (unsigned int i = 0; i < stProfileStats::HISTOGRAM_BINS; ++i)
+		Bins.push_back(stProfileStats::GetBinLimitUs(i));
+
+	auto &Entries = j["entries"] = nlohmann::json::array();
+	for (unsigned int i = 0; i < PROFILE_ENTRY_COUNT; ++i) {
+		const auto &s = Stats[i];
+		Entries.push_back({
+			{"name", GetEntryName(i)},
+			{"frames", s.iFrames},
+			{"calls", s.iCalls},
+			{"total_us", s.iTotalNs / 1000.},
+			{"mean_us", s.GetMeanUs()},
+			{"max_us", s.iMaxNs / 1000.},
+			{"p50_us", s.GetQuantileUs(.5)},
+			{"p99_us", s.GetQuantileUs(.99)},
+			{"histogram", s.Histogram},
+		});
+	}
+
+	return j.dump(1, '\t') + '\n';
+}
+
+CAudioProfiler::ThreadBuffer &CAudioProfiler::GetThreadBuffer()
+{
+	if (!t_pProfileBuffer) {
+		auto pBuffer = std::make_unique<ThreadBuffer>();
+		pBuffer->iResetCount = m_iResetCount.load(std::memory_order_relaxed);
+		t_pProfileBuffer = pBuffer.get();
+
+		std::unique_lock<std::mutex> lock(m_Lock);
+		m_Buffers.push_back(std::move(pBuffer));
+	}
+	return *t_pProfileBuffer;
+}
+
+uint64_t CAudioProfiler::ReadTicks()
+{
+#ifdef AUDIO_PROFILER_RDTSC
+	return __rdtsc();
+#else
+	return duration_cast<nanoseconds>(clock_type::now().time_since_epoch()).count();
+#endif
+}
+
+void CAudioProfiler::BeginFrame(ThreadBuffer &Buffer)
+{
+	Buffer.FrameTicks.fill(0);
+	Buffer.FrameCalls.fill(0);
+	Buffer.iWaitTicks = 0;
+}
+
+void CAudioProfiler::EndFrame(ThreadBuffer &Buffer)
+{
+	// Calibrate the tick rate over everything measured so far
+	const uint64_t Ticks = ReadTicks();
+	const auto Now = clock_type::now();
+	if (!Buffer.bCalibrating) {
+		Buffer.bCalibrating = true;
+		Buffer.iCalibrationTicks = Ticks;
+		Buffer.CalibrationTime = Now;
+	}
+	if (Now - Buffer.CalibrationTime < CALIBRATION_TIME || Ticks == Buffer.iCalibrationTicks)
+		return;
+	Buffer.fNsPerTick = duration<double, std::nano>(Now - Buffer.CalibrationTime).count() / (Ticks - Buffer.iCalibrationTicks);
+
+	// Apply pending resets
+	const unsigned int ResetCount = m_iResetCount.load(std::memory_order_relaxed);
+	if (Buffer.iResetCount.load(std::memory_order_relaxed) != ResetCount) {
+		for (auto &Entry : Buffer.Entries) {
+			Entry.Frames.store(0, std::memory_order_relaxed);
+			Entry.Calls.store(0, std::memory_order_relaxed);
+			Entry.TotalNs.store(0, std::memory_order_relaxed);
+			Entry.MaxNs.store(0, std::memory_order_relaxed);
+			for (auto &Count : Entry.Histogram)
+				Count.store(0, std::memory_order_relaxed);
+		}
+		Buffer.iResetCount.store(ResetCount, std::memory_order_release);
+	}
+
+	for (unsigned int i = 0; i < PROFILE_ENTRY_COUNT; ++i) {
+		if (!Buffer.FrameCalls[i])
+			continue;
+		auto &Entry = Buffer.Entries[i];
+		const uint64_t Ns = static_cast<uint64_t>(Buffer.FrameTicks[i] * Buffer.fNsPerTick);
+		Bump(Entry.Frames, 1);
+		Bump(Entry.Calls, Buffer.FrameCalls[i]);
+		Bump(Entry.TotalNs, Ns);
+		if (Ns > Entry.MaxNs.load(std::memory_order_relaxed))
+			Entry.MaxNs.store(Ns, std::memory_order_relaxed);
+		Bump(Entry.Histogram[stProfileStats::GetBin(Ns)], 1);
+	}
+}
+
+CAudioProfileScope::CAudioProfileScope(unsigned int Entry) :
+	m_pBuffer(nullptr),
+	m_iEntry(Entry),
+	m_iStart(0),
+	m_iWaitStart(0)
+{
+	CAudioProfiler &Profiler = CAudioProfiler::Get();
+	if (!Profiler.IsEnabled())
+		return;
+
+	m_pBuffer = &Profiler.GetThreadBuffer();
+	if (Entry == PROFILE_FRAME)
+		Profiler.BeginFrame(*m_pBuffer);
+	m_iWaitStart = m_pBuffer->iWaitTicks;
+	m_iStart = CAudioProfiler::ReadTicks();
+}
+
+CAudioProfileScope::~CAudioProfileScope()
+{
+	if (!m_pBuffer)
+		return;
+
+	const uint64_t Elapsed = CAudioProfiler::ReadTicks() - m_iStart;
+	const uint64_t Waited = m_pBuffer->iWaitTicks - m_iWaitStart;
+	m_pBuffer->FrameTicks[m_iEntry] += Elapsed > Waited ? Elapsed - Waited : 0;
+	++m_pBuffer->FrameCalls[m_iEntry];
+
+	if (m_iEntry == PROFILE_AUDIO_WAIT)
+		m_pBuffer->iWaitTicks += Elapsed;
+	else if (m_iEntry == PROFILE_FRAME)
+		CAudioProfiler::Get().EndFrame(*m_pBuffer);
+}
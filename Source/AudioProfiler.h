@@ -0,0 +1,161 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The profiling scopes are only compiled into the audio thread if ENABLE_AUDIO_PROFILER is defined,
+// which the build does for debug builds and for release builds configured with DN_AUDIO_PROFILER
+
+/// Sound chips timed by CAudioProfiler, in the order used by CAPU::SetExternalSound().
+enum profile_chip_t : unsigned int {
+	PROFILE_CHIP_2A03,
+	PROFILE_CHIP_VRC6,
+	PROFILE_CHIP_VRC7,
+	PROFILE_CHIP_FDS,
+	PROFILE_CHIP_MMC5,
+	PROFILE_CHIP_N163,
+	PROFILE_CHIP_S5B,
+	PROFILE_CHIP_COUNT,
+};
+
+/// Timed parts of an audio frame. Time spent waiting on the sound device is
+/// excluded from every entry and counted by PROFILE_AUDIO_WAIT instead.
+enum profile_entry_t : unsigned int {
+	PROFILE_FRAME,				// CSoundGen::OnIdle(), closing this scope ends the frame
+	PROFILE_RUN_FRAME,			// CSoundGen::RunFrame()
+	PROFILE_PLAY_NOTES,			// CSoundGen::PlayChannelNotes()
+	PROFILE_UPDATE_PLAYER,		// CSoundGen::UpdatePlayer()
+	PROFILE_UPDATE_CHANNELS,	// CSoundGen::UpdateChannels()
+	PROFILE_UPDATE_APU,			// CSoundGen::UpdateAPU(), includes all chip entries
+	PROFILE_AUDIO_WAIT,			// CSoundStream::WaitForReady()
+	PROFILE_CHIP_PROCESS,		// CSoundChip2::Process(), one entry per profile_chip_t
+	PROFILE_CHIP_END_FRAME = PROFILE_CHIP_PROCESS + PROFILE_CHIP_COUNT,	// CSoundChip2::EndFrame()
+	PROFILE_ENTRY_COUNT = PROFILE_CHIP_END_FRAME + PROFILE_CHIP_COUNT,
+};
+
+/// Timing of one profile entry, accumulated per frame. See CAudioProfiler.
+struct stProfileStats {
+	static constexpr unsigned int HISTOGRAM_BINS = 20;	// Bin 0 counts frames under 1 us, bin n under 2^n us
+
+	uint64_t iFrames = 0;		// Frames in which the entry was timed
+	uint64_t iCalls = 0;
+	uint64_t iTotalNs = 0;
+	uint64_t iMaxNs = 0;		// Longest time spent in one frame
+	/// Number of frames by time spent in the entry. The last bin also counts longer frames.
+	std::array<uint64_t, HISTOGRAM_BINS> Histogram = { };
+
+	double GetMeanUs() const;
+	/// Returns the upper bound in microseconds of the bin containing the given quantile.
+	unsigned int GetQuantileUs(double Quantile) const;
+
+	static unsigned int GetBin(uint64_t Ns);
+	static unsigned int GetBinLimitUs(unsigned int Bin);
+};
+
+using profile_stats_t = std::array<stProfileStats, PROFILE_ENTRY_COUNT>;
+
+/*!
+	\brief Lightweight timing of the audio thread, aggregated per frame into per-entry
+	histograms of the time spent in each stage of CSoundGen and each sound chip.
+
+	Every thread that opens a scope gets its own buffer. The current frame is only
+	touched by the owning thread, and the totals are published with relaxed atomic
+	stores when a PROFILE_FRAME scope closes, so the audio thread never takes a lock
+	after its first scope. Scopes read the time stamp counter where available and
+	calibrate it against std::chrono::steady_clock once per frame.
+
+	Scopes do nothing while the profiler is disabled. GetStats(), Reset() and the
+	exporters may be called from any thread.
+*/
+class CAudioProfiler
+{
+public:
+	using clock_type = std::chrono::steady_clock;
+
+	/// Returns the profiler shared by all sound generators.
+	static CAudioProfiler &Get();
+
+	static const char *GetEntryName(unsigned int Entry);
+
+	void Enable(bool bEnable);
+	bool IsEnabled() const;
+	/// Discards all statistics. Buffers are cleared by their owning threads at the end
+	/// of their next frame and ignored by GetStats() until then.
+	void Reset();
+
+	/// Sums the statistics of all threads.
+	profile_stats_t GetStats() const;
+
+	static std::string ExportCSV(const profile_stats_t &Stats);
+	static std::string ExportJSON(const profile_stats_t &Stats);
+
+public:
+	struct ThreadBuffer;
+
+	/// Returns the calling thread's buffer, creating it if needed.
+	ThreadBuffer &GetThreadBuffer();
+	/// Reads the time stamp counter, or the steady clock in nanoseconds.
+	static uint64_t ReadTicks();
+
+	void BeginFrame(ThreadBuffer &Buffer);
+	void EndFrame(ThreadBuffer &Buffer);
+
+private:
+	std::atomic<bool> m_bEnabled = false;
+	std::atomic<unsigned int> m_iResetCount = 0;
+
+	mutable std::mutex m_Lock;		// Guards m_Buffers, never taken by the audio thread after registration
+	std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers;
+};
+
+/// Times the enclosing block, see AUDIO_PROFILE_SCOPE.
+class CAudioProfileScope
+{
+public:
+	explicit CAudioProfileScope(unsigned int Entry);
+	~CAudioProfileScope();
+
+	CAudioProfileScope(const CAudioProfileScope &) = delete;
+	CAudioProfileScope &operator=(const CAudioProfileScope &) = delete;
+
+private:
+	CAudioProfiler::ThreadBuffer *m_pBuffer;		// NULL while disabled
+	unsigned int m_iEntry;
+	uint64_t m_iStart;
+	uint64_t m_iWaitStart;
+};
+
+#ifdef ENABLE_AUDIO_PROFILER
+#define AUDIO_PROFILE_CONCAT_(a, b) a##b
+#define AUDIO_PROFILE_CONCAT(a, b) AUDIO_PROFILE_CONCAT_(a, b)
+#define AUDIO_PROFILE_SCOPE(Entry) CAudioProfileScope AUDIO_PROFILE_CONCAT(AudioProfileScope_, __LINE__) {(Entry)}
+#else
+#define AUDIO_PROFILE_SCOPE(Entry) ((void)0)
+#endif
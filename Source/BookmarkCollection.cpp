@@ -27,6 +27,7 @@
 #include "Bookmark.h"
 #include "BookmarkCollection.h"
 #include "FamiTrackerTypes.h" // constants
+#include "PatternData.h" // stHighlight
 
 CBookmarkCollection::CBookmarkCollection()
 {
@@ -46,6 +47,7 @@ bool CBookmarkCollection::AddBookmark(CBookmark *const pMark)
 {
 	try {
 		m_pBookmark.emplace_back(std::unique_ptr<CBookmark>(pMark));
+		RebuildIndex();		// // //
 		return true;
 	}
 	catch (std::exception) {
@@ -57,6 +59,7 @@ bool CBookmarkCollection::SetBookmark(unsigned Index, CBookmark *const pMark)
 {
 	if (m_pBookmark[Index].get()->IsEqual(*pMark)) return false;
 	m_pBookmark[Index].reset(pMark);
+	RebuildIndex();		// // //
 	return true;
 }
 
@@ -64,6 +67,7 @@ bool CBookmarkCollection::InsertBookmark(unsigned Index, CBookmark *const pMark)
 {
 	if (Index > m_pBookmark.size()) return false;
 	m_pBookmark.insert(m_pBookmark.begin() + Index, std::unique_ptr<CBookmark>(pMark));
+	RebuildIndex();		// // //
 	return true;
 }
 
@@ -71,6 +75,7 @@ bool CBookmarkCollection::RemoveBookmark(unsigned Index)
 {
 	if (Index >= m_pBookmark.size()) return false;
 	m_pBookmark.erase(m_pBookmark.begin() + Index);
+	RebuildIndex();		// // //
 	return true;
 }
 
@@ -78,6 +83,7 @@ bool CBookmarkCollection::ClearBookmarks()
 {
 	if (m_pBookmark.empty()) return false;
 	m_pBookmark.clear();
+	RebuildIndex();		// // //
 	return true;
 }
 
@@ -85,6 +91,7 @@ bool CBookmarkCollection::SwapBookmarks(unsigned A, unsigned B)
 {
 	if (A == B) return false;
 	m_pBookmark[A].swap(m_pBookmark[B]);
+	RebuildIndex();		// // //
 	return true;
 }
 
@@ -92,6 +99,7 @@ void CBookmarkCollection::InsertFrames(unsigned Frame, unsigned Count)
 {
 	std::for_each(m_pBookmark.begin(), m_pBookmark.end(),
 				  [&] (std::unique_ptr<CBookmark> &a) { if (a->m_iFrame >= Frame) a->m_iFrame += Count; });
+	RebuildIndex();		// // //
 }
 
 void CBookmarkCollection::RemoveFrames(unsigned Frame, unsigned Count)
@@ -102,6 +110,7 @@ void CBookmarkCollection::RemoveFrames(unsigned Frame, unsigned Count)
 		m_pBookmark.end());
 	std::for_each(m_pBookmark.begin(), m_pBookmark.end(),
 				  [&] (std::unique_ptr<CBookmark> &a) { if (a->m_iFrame >= Frame) a->m_iFrame -= Count; });
+	RebuildIndex();		// // //
 }
 
 void CBookmarkCollection::SwapFrames(unsigned A, unsigned B)
@@ -110,6 +119,7 @@ void CBookmarkCollection::SwapFrames(unsigned A, unsigned B)
 		if (a->m_iFrame == A) a->m_iFrame = B;
 		else if (a->m_iFrame == B) a->m_iFrame = A;
 	});
+	RebuildIndex();		// // //
 }
 
 int CBookmarkCollection::GetBookmarkIndex(const CBookmark *const pMark) const
@@ -123,11 +133,11 @@ int CBookmarkCollection::GetBookmarkIndex(const CBookmark *const pMark) const
 
 CBookmark *CBookmarkCollection::FindAt(unsigned Frame, unsigned Row) const
 {
-	const CBookmark tmp(Frame, Row);
-	auto it = std::find_if(m_pBookmark.begin(), m_pBookmark.end(), [&] (const std::unique_ptr<CBookmark> &a) {
-		return *a.get() == tmp;
+	const unsigned Position = Frame * MAX_PATTERN_LENGTH + Row;		// // //
+	auto it = std::lower_bound(m_Index.begin(), m_Index.end(), Position, [] (const stIndexEntry &a, unsigned b) {
+		return a.Position < b;
 	});
-	return it == m_pBookmark.end() ? nullptr : it->get();
+	return it != m_Index.end() && it->Position == Position ? it->pMark : nullptr;
 }
 
 void CBookmarkCollection::RemoveAt(unsigned Frame, unsigned Row)
@@ -137,6 +147,28 @@ void CBookmarkCollection::RemoveAt(unsigned Frame, unsigned Row)
 		std::remove_if(m_pBookmark.begin(), m_pBookmark.end(),
 			[&] (const std::unique_ptr<CBookmark> &a) { return *a.get() == tmp; }),
 		m_pBookmark.end());
+	RebuildIndex();		// // //
+}
+
+stHighlight CBookmarkCollection::GetHighlightAt(unsigned Frame, unsigned Row, const stHighlight &Default) const		// // //
+{
+	stHighlight Hl = Default;
+
+	const unsigned Position = Frame * MAX_PATTERN_LENGTH + Row;
+	auto it = std::upper_bound(m_Index.begin(), m_Index.end(), Position, [] (unsigned a, const stIndexEntry &b) {
+		return a < b.Position;
+	});
+	if (it != m_Index.begin()) {
+		const stIndexEntry &Entry = *--it;
+		const bool SameFrame = Entry.pMark->m_iFrame == Frame;
+		if (int First = SameFrame ? Entry.First : Entry.PersistFirst; First != -1)
+			Hl.First = First;
+		if (int Second = SameFrame ? Entry.Second : Entry.PersistSecond; Second != -1)
+			Hl.Second = Second;
+		Hl.Offset = Entry.pMark->m_Highlight.Offset + Entry.pMark->m_iRow;
+	}
+
+	return Hl;
 }
 
 CBookmark *CBookmarkCollection::FindNext(unsigned Frame, unsigned Row) const
@@ -170,6 +202,7 @@ bool CBookmarkCollection::SortByName(bool Desc)
 	if (!Change) return false;
 	std::stable_sort(m_pBookmark.begin(), m_pBookmark.end(), sortFunc);
 	if (Desc) std::reverse(m_pBookmark.begin(), m_pBookmark.end());
+	RebuildIndex();		// // //
 	return true;
 }
 
@@ -184,5 +217,39 @@ bool CBookmarkCollection::SortByPosition(bool Desc)
 	if (!Change) return false;
 	std::stable_sort(m_pBookmark.begin(), m_pBookmark.end(), sortFunc);
 	if (Desc) std::reverse(m_pBookmark.begin(), m_pBookmark.end());
+	RebuildIndex();		// // //
 	return true;
 }
+
+void CBookmarkCollection::RebuildIndex()		// // //
+{
+	m_Index.clear();
+	m_Index.reserve(m_pBookmark.size());
+	for (const auto &x : m_pBookmark)
+		m_Index.push_back({x->m_iFrame * MAX_PATTERN_LENGTH + x->m_iRow, x.get()});
+	std::stable_sort(m_Index.begin(), m_Index.end(), [] (const stIndexEntry &a, const stIndexEntry &b) {
+		return a.Position < b.Position;
+	});
+
+	// Non-persistent highlights only apply until the end of their frame
+	int PersistFirst = -1, PersistSecond = -1;
+	for (std::size_t i = 0; i < m_Index.size(); ++i) {
+		stIndexEntry &Entry = m_Index[i];
+		const CBookmark &Mark = *Entry.pMark;
+		const bool NewFrame = !i || m_Index[i - 1].pMark->m_iFrame != Mark.m_iFrame;
+		Entry.First = NewFrame ? PersistFirst : m_Index[i - 1].First;
+		Entry.Second = NewFrame ? PersistSecond : m_Index[i - 1].Second;
+		if (Mark.m_Highlight.First != -1) {
+			Entry.First = Mark.m_Highlight.First;
+			if (Mark.m_bPersist)
+				PersistFirst = Mark.m_Highlight.First;
+		}
+		if (Mark.m_Highlight.Second != -1) {
+			Entry.Second = Mark.m_Highlight.Second;
+			if (Mark.m_bPersist)
+				PersistSecond = Mark.m_Highlight.Second;
+		}
+		Entry.PersistFirst = PersistFirst;
+		Entry.PersistSecond = PersistSecond;
+	}
+}
@@ -22,6 +22,7 @@
 
 
 class CBookmark;
+struct stHighlight;		// // //
 
 /*!
 	\brief A class that manages a dynamic list of bookmarks for a single track.
@@ -121,7 +122,7 @@ public:
 	CBookmark *FindPrevious(unsigned Frame, unsigned Row) const;
 	/*!	\brief Locates the bookmark at a given position.
 		\details This method returns the bookmark with the least index if multiple bookmarks for the
-		same location exist.
+		same location exist. It performs a binary search on the position index.
 		\param Frame The frame index.
 		\param Row The row index.
 		\return Pointer to the bookmark, or nullptr if no bookmarks exist at the position.
@@ -132,6 +133,16 @@ public:
 		\param Row The row index.
 	*/
 	void RemoveAt(unsigned Frame, unsigned Row);
+	/*!	\brief Computes the effective row highlight at a given position.
+		\details The nearest bookmark at or above the position determines the highlight offset. Each
+		highlight value comes from the nearest bookmark above that defines it, either persistent or in
+		the same frame. This method performs a binary search on the position index.
+		\param Frame The frame index.
+		\param Row The row index.
+		\param Default The highlight used when no bookmark defines a value.
+		\return The highlight settings.
+	*/
+	stHighlight GetHighlightAt(unsigned Frame, unsigned Row, const stHighlight &Default) const;
 
 	/*!	\brief Sorts the contained bookmarks by their names.
 		\details The method performs a stable sort; relative positions of equal bookmarks remain
@@ -149,5 +160,18 @@ public:
 	bool SortByPosition(bool Desc);
 
 private:
+	/*!	\brief Rebuilds the position index after the bookmarks are modified. */
+	void RebuildIndex();
+
+private:
+	/*!	\brief An entry of the position index. */
+	struct stIndexEntry {
+		unsigned Position;			// frame * MAX_PATTERN_LENGTH + row
+		CBookmark *pMark;
+		int First, Second;			// highlight for the remaining rows of the same frame, -1 if none
+		int PersistFirst, PersistSecond;	// highlight inherited by the following frames, -1 if none
+	};
+
 	std::vector<std::unique_ptr<CBookmark>> m_pBookmark;
+	std::vector<stIndexEntry> m_Index;		// // // bookmarks sorted by position, ties in collection order
 };
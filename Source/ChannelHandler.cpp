@@ -33,7 +33,7 @@
 #include "TrackerChannel.h"		// // //
 #include "APU/Types.h"		// // //
 #include "SoundGen.h"
-#include "Settings.h"		// // //
+#include "PlayerSettings.h"		// // //
 #include "ChannelHandler.h"
 #include "APU/APU.h"
 #include "InstHandler.h"		// // //
@@ -50,6 +50,7 @@ CChannelHandler::CChannelHandler(int MaxPeriod, int MaxVolume) :
 	m_pNoteLookupTable(nullptr),
 	m_pVibratoTable(nullptr),
 	m_pAPU(nullptr),
+	m_pPlayerSettings(nullptr),		// // //
 	m_pInstHandler(),		// // //
 	m_iPitch(0),
 	m_iNote(0),
@@ -69,13 +70,14 @@ CChannelHandler::CChannelHandler(int MaxPeriod, int MaxVolume) :
 
 CChannelHandler::~CChannelHandler() = default;
 
-void CChannelHandler::InitChannel(CAPU *pAPU, int *pVibTable, CSoundGen *pSoundGen)
+void CChannelHandler::InitChannel(CAPU *pAPU, int *pVibTable, CSoundGen *pSoundGen, const stPlayerSettings *pSettings)
 {
 	// Called from main thread
 
 	m_pAPU = pAPU;
 	m_pVibratoTable = pVibTable;
 	m_pSoundGen = pSoundGen;
+	m_pPlayerSettings = pSettings;		// // //
 
 	m_bDelayEnabled = false;
 }
@@ -903,6 +905,11 @@ void CChannelHandler::ProcessChannel()
 	// instruments are updated after running effects and before writing to sound registers
 }
 
+bool CChannelHandler::GetSequencePlayPos(const CSequence *pSequence, int &Pos) const		// // //
+{
+	return m_pInstHandler && m_pInstHandler->GetSequencePlayPos(pSequence, Pos);
+}
+
 int CChannelHandler::GetVibrato() const
 {
 	// Vibrato offset (4xx)
@@ -1014,7 +1021,7 @@ int CChannelHandler::LimitVolume(int Volume) const		// // //
 		return 0;
 
 	Volume = std::max(0, std::min(m_iMaxVolume, Volume));
-	if (Volume == 0 && !theApp.GetSettings()->General.bCutVolume && m_iInstVolume > 0 && m_iVolume > 0)		// // //
+	if (Volume == 0 && !m_pPlayerSettings->bCutVolume && m_iInstVolume > 0 && m_iVolume > 0)		// // //
 		return 1;
 	return Volume;
 }
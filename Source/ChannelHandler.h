@@ -26,8 +26,10 @@ static const int DUTY_2A03_FROM_VRC6[] = {0, 0, 1, 1, 1, 1, 2, 2};		// // //
 static const int DUTY_VRC6_FROM_2A03[] = {1, 3, 7, 3};		// // //
 
 class CInstHandler;
+class CSequence;
 class stChannelState;
 class CSoundGen;		// // //
+struct stPlayerSettings;
 
 #include "ChannelHandlerInterface.h"
 #include <memory>		// // //
@@ -56,8 +58,9 @@ public:
 	/*!	\brief Initializes the channel handler and sets up member pointers.
 		\param pAPU Pointer to the sound channel object.
 		\param pVibTable Pointer to the vibrato lookup table.
-		\param pSoundGen Pointer to the sound generator object. */
-	void	InitChannel(CAPU *pAPU, int *pVibTable, CSoundGen *pSoundGen);
+		\param pSoundGen Pointer to the sound generator object.
+		\param pSettings Pointer to the playback options of the sound generator. */
+	void	InitChannel(CAPU *pAPU, int *pVibTable, CSoundGen *pSoundGen, const stPlayerSettings *pSettings);
 	/*!	\brief Called by the MIDI auto-arpeggio function to play a given note value.
 		\param Note The note value. */
 	void	Arpeggiate(unsigned int Note);
@@ -65,6 +68,12 @@ public:
 		\details This method overrides the case where the same instrument is used to play
 		successive notes. */
 	void	ForceReloadInstrument();		// // //
+	/*!	\brief Obtains the play position of a sequence used by the current instrument.
+		\param pSequence Pointer to the sequence.
+		\param Pos Receives the current item index, or -1 if the sequence has just finished.
+		\return Whether the sequence was run during the last tick.
+		\sa CInstHandler::GetSequencePlayPos */
+	bool	GetSequencePlayPos(const CSequence *pSequence, int &Pos) const;		// // //
 
 	/*!	\brief Updates properties of the channel handler that are obtained from the current module file. */
 	/*!	\brief Chooses between linear pitch space and the default pitch space provided by the sound chip.
@@ -501,6 +510,9 @@ protected:
 	CAPU			*m_pAPU;
 	/*!	\brief A pointer to the sound generator object. */
 	CSoundGen		*m_pSoundGen;
+	/*!	\brief A pointer to the playback options owned by the sound generator.
+		\details Channel handlers must read application settings only from this object. */
+	const stPlayerSettings *m_pPlayerSettings;
 
 	/*!	\brief A pointer to the channel's note lookup table.
 		\details The lookup table contains either period or frequency register values according to
@@ -29,7 +29,8 @@
 #include "Instrument.h"
 #include "ChannelHandler.h"
 #include "Channels2A03.h"
-#include "Settings.h"
+#include "SoundGen.h"
+#include "PlayerSettings.h"		// // //
 #include "InstHandler.h"		// // //
 #include "SeqInstHandler.h"		// // //
 #include "InstHandlerDPCM.h"		// // //
@@ -747,7 +748,7 @@ void CDPCMChan::RefreshChannel()
 		// Cut sample
 		WriteRegister(0x4015, 0x0F);
 
-		if (!theApp.GetSettings()->General.bNoDPCMReset || theApp.IsPlaying()) {
+		if (!m_pPlayerSettings->bNoDPCMReset || m_pSoundGen->IsPlaying()) {
 			WriteRegister(0x4011, 0);	// regain full volume for TN
 		}
 
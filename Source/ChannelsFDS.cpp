@@ -29,8 +29,7 @@
 #include "InstHandler.h"		// // //
 #include "SeqInstHandler.h"		// // //
 #include "SeqInstHandlerFDS.h"		// // //
-#include "FamiTracker.h"		// // //
-#include "Settings.h"		// // //
+#include "PlayerSettings.h"		// // //
 
 CChannelHandlerFDS::CChannelHandlerFDS() : 
 	FrequencyChannelHandler(0xFFF, 32)
@@ -132,7 +131,7 @@ void CChannelHandlerFDS::HandleRelease()
 
 int CChannelHandlerFDS::CalculateVolume() const		// // //
 {
-	if (!theApp.GetSettings()->General.bFDSOldVolume)		// // // match NSF setting
+	if (!m_pPlayerSettings->bFDSOldVolume)		// // // match NSF setting
 		return LimitVolume(((m_iInstVolume + 1) * ((m_iVolume >> VOL_COLUMN_SHIFT) + 1) - 1) / 16 - GetTremolo());
 	return CChannelHandler::CalculateVolume();
 }
@@ -29,8 +29,7 @@
 #include "InstHandler.h"		// // //
 #include "SeqInstHandler.h"		// // //
 #include "SeqInstHandlerSawtooth.h"		// // //
-#include "FamiTracker.h"		// // //
-#include "Settings.h"		// // //
+#include "PlayerSettings.h"		// // //
 
 CChannelHandlerVRC6::CChannelHandlerVRC6(int MaxPeriod, int MaxVolume) :		// // //
 	CChannelHandler(MaxPeriod, MaxVolume)
@@ -191,7 +190,7 @@ int CVRC6Sawtooth::CalculateVolume() const		// // //
 		_64_step = pHandler->IsDutyIgnored();
 
 	if (_64_step) {
-		if (!theApp.GetSettings()->General.bFDSOldVolume)		// // // match NSF setting
+		if (!m_pPlayerSettings->bFDSOldVolume)		// // // match NSF setting
 			return LimitVolume(((m_iInstVolume + 1) * ((m_iVolume >> VOL_COLUMN_SHIFT) + 1) - 1) / 16 - GetTremolo());
 		return CChannelHandler::CalculateVolume();
 	}
@@ -0,0 +1,286 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#include "stdafx.h"
+#include "FamiTracker.h"
+#include "FamiTrackerDoc.h"
+#include "SoundGen.h"
+#include "APU/Types.h"
+#include "CommandLineRegression.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace {
+
+const char *const CHIP_NAMES[] = {"2A03", "VRC6", "VRC7", "FDS", "MMC5", "N163", "5B"};
+
+bool IsModuleFile(const CString &Name)
+{
+	const int Pos = Name.ReverseFind(_T('.'));
+	if (Pos < 0)
+		return false;
+	const CString Ext = Name.Mid(Pos);
+	return !Ext.CompareNoCase(_T(".dnm")) || !Ext.CompareNoCase(_T(".0cc")) || !Ext.CompareNoCase(_T(".ftm"));
+}
+
+} // namespace
+
+CCommandLineRegression::CCommandLineRegression(CSettings *pSettings, CSoundGen *pSoundGen) :
+	m_pSettings(pSettings),
+	m_pSoundGen(pSoundGen),
+	m_SavedSound(pSettings->Sound),
+	m_SavedChipLevels(pSettings->ChipLevels),
+	m_SavedEmulation(pSettings->Emulation),
+	m_SavedPlayerSettings(pSoundGen->GetPlayerSettings())
+{
+	// Golden hashes depend on the filters, mixer levels and chip emulation options
+	m_pSettings->DefaultSettings(_T("Sound"));
+	m_pSettings->DefaultSettings(_T("Mixer"));
+	m_pSettings->DefaultSettings(_T("Emulation"));
+
+	// and on the sample rate, and the regression run must not need a sound card
+	m_pSettings->Sound.iSampleRate = SAMPLE_RATE;
+	m_pSettings->Sound.bNullDevice = true;
+
+	// The player options of the general settings were already passed to the sound generator
+	m_pSoundGen->SetPlayerSettings(stPlayerSettings { });
+}
+
+CCommandLineRegression::~CCommandLineRegression()
+{
+	// Restore the user's settings before they are saved on exit
+	m_pSettings->Sound = m_SavedSound;
+	m_pSettings->ChipLevels = m_SavedChipLevels;
+	m_pSettings->Emulation = m_SavedEmulation;
+	m_pSoundGen->SetPlayerSettings(m_SavedPlayerSettings);
+}
+
+bool CCommandLineRegression::Run(const CString &Corpus, const CString &GoldenFile, const CString &LogFile, bool Update)
+{
+	std::string LogText;
+
+	// Collect the modules of the corpus
+	CString Folder = Corpus;
+	std::vector<CString> Names;
+	if (PathIsDirectory(Corpus)) {
+		CFileFind Finder;
+		BOOL Working = Finder.FindFile(Corpus + _T("\\*.*"));
+		while (Working) {
+			Working = Finder.FindNextFile();
+			if (!Finder.IsDirectory() && IsModuleFile(Finder.GetFileName()))
+				Names.push_back(Finder.GetFileName());
+		}
+		std::sort(Names.begin(), Names.end());
+	}
+	else {
+		const int Pos = Corpus.ReverseFind(_T('\\'));
+		Folder = Pos < 0 ? CString(_T(".")) : Corpus.Left(Pos);
+		Names.push_back(Corpus.Mid(Pos + 1));
+	}
+
+	if (Names.empty()) {
+		Report(LogText, _T("Error: no modules found in: ") + Corpus + _T("\n"));
+		WriteLog(LogFile, LogText);
+		return false;
+	}
+
+	const CString Golden = GoldenFile.GetLength() > 0 ? GoldenFile : Folder + _T("\\golden.txt");
+
+	// Read the golden hashes, one "<hash> <file name>" pair per line
+	std::map<CString, uint64_t> Expected;
+	if (!Update) {
+		CStdioFile File;
+		if (!File.Open(Golden, CFile::modeRead | CFile::typeText)) {
+			Report(LogText, _T("Error: unable to open golden hash list: ") + Golden + _T("\n"));
+			WriteLog(LogFile, LogText);
+			return false;
+		}
+		CString Line;
+		while (File.ReadString(Line)) {
+			Line.Trim();
+			const int Pos = Line.Find(_T(' '));
+			if (Line.IsEmpty() || Line[0] == _T('#') || Pos < 0)
+				continue;
+			Expected[Line.Mid(Pos + 1).Trim()] = _tcstoui64(Line.Left(Pos), nullptr, 16);
+		}
+	}
+
+	CString WavePath;
+	GetTempPath(MAX_PATH, WavePath.GetBuffer(MAX_PATH));
+	WavePath.ReleaseBuffer();
+	WavePath += _T("DnFamiTrackerRegression.wav");
+
+	std::array<double, std::size(CHIP_NAMES)> ChipEmulated = { };
+	std::array<double, std::size(CHIP_NAMES)> ChipWall = { };
+	CString GoldenText = _T("# Dn-FamiTracker golden render hashes (FNV-1a of the 16-bit mono samples)\n");
+	int Failed = 0;
+
+	for (const auto &Name : Names) {
+		stRenderResult Result;
+		CString Line;
+		if (!RenderModule(Folder + _T("\\") + Name, WavePath, Result)) {
+			++Failed;
+			Report(LogText, _T("ERROR ") + Name + _T(": unable to render\n"));
+			continue;
+		}
+
+		LPCTSTR Status = _T("HASH");
+		if (!Update) {
+			auto it = Expected.find(Name);
+			if (it == Expected.end())
+				Status = _T("NEW");
+			else if (it->second == Result.Hash)
+				Status = _T("PASS");
+			else
+				Status = _T("FAIL");
+			if (it == Expected.end() || it->second != Result.Hash)
+				++Failed;
+		}
+		const double Speed = Result.WallSeconds > 0. ? Result.EmulatedSeconds / Result.WallSeconds : 0.;
+		Line.Format(_T("%-5s %016I64X %8.2f s %8.1fx  %s\n"), Status, Result.Hash, Result.EmulatedSeconds, Speed, (LPCTSTR)Name);
+		Report(LogText, Line);
+
+		Line.Format(_T("%016I64X %s\n"), Result.Hash, (LPCTSTR)Name);
+		GoldenText += Line;
+
+		// The 2A03 is always present
+		for (std::size_t i = 0; i < std::size(CHIP_NAMES); ++i)
+			if (i == 0 || (Result.Chips & (1u << (i - 1)))) {
+				ChipEmulated[i] += Result.EmulatedSeconds;
+				ChipWall[i] += Result.WallSeconds;
+			}
+	}
+
+	DeleteFile(WavePath);
+
+	Report(LogText, _T("\nRender speed of modules using each chip (emulated seconds per second):\n"));
+	for (std::size_t i = 0; i < std::size(CHIP_NAMES); ++i)
+		if (ChipWall[i] > 0.) {
+			CString Line;
+			Line.Format(_T("%-5s %10.2f s in %8.2f s, %8.1fx\n"), CHIP_NAMES[i], ChipEmulated[i], ChipWall[i], ChipEmulated[i] / ChipWall[i]);
+			Report(LogText, Line);
+		}
+
+	if (Update) {
+		CStdioFile File;
+		if (!File.Open(Golden, CFile::modeCreate | CFile::modeWrite | CFile::typeText)) {
+			Report(LogText, _T("Error: unable to write golden hash list: ") + Golden + _T("\n"));
+			WriteLog(LogFile, LogText);
+			return false;
+		}
+		File.WriteString(GoldenText);
+		Report(LogText, _T("\nUpdated: ") + Golden + _T("\n"));
+	}
+	else {
+		CString Line;
+		Line.Format(_T("\n%d of %d modules failed.\n"), Failed, static_cast<int>(Names.size()));
+		Report(LogText, Line);
+	}
+
+	WriteLog(LogFile, LogText);
+	return Failed == 0;
+}
+
+bool CCommandLineRegression::RenderModule(const CString &Path, const CString &WavePath, stRenderResult &Result) const
+{
+	auto pDoc = dynamic_cast<CFamiTrackerDoc*>(theApp.OpenDocumentFile(Path, FALSE));
+	if (pDoc == nullptr || !pDoc->IsFileLoaded())
+		return false;
+	Result.Chips = pDoc->GetExpansionChip();
+
+	// Render the first track until it loops once, the same as the WAV export default
+	CSoundGen *pSoundGen = theApp.GetSoundGenerator();
+	CString File = WavePath;
+	const auto Start = std::chrono::steady_clock::now();
+	const bool Started = pSoundGen->RenderToFile(File.GetBuffer(), SONG_LOOP_LIMIT, 1, 0);
+	File.ReleaseBuffer();
+	if (!Started)
+		return false;
+
+	while (true) {
+		auto l = pSoundGen->Lock();
+		const bool Rendering = pSoundGen->IsRendering();
+		l.unlock();
+		if (!Rendering)
+			break;
+
+		// The player thread may post to the main window while rendering
+		MSG msg;
+		while (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+			::TranslateMessage(&msg);
+			::DispatchMessage(&msg);
+		}
+		Sleep(1);
+	}
+	Result.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+	return HashWaveData(WavePath, Result);
+}
+
+bool CCommandLineRegression::HashWaveData(const CString &WavePath, stRenderResult &Result) const
+{
+	CFile File;
+	if (!File.Open(WavePath, CFile::modeRead | CFile::shareDenyWrite))
+		return false;
+	std::vector<unsigned char> Data(static_cast<std::size_t>(File.GetLength()));
+	const UINT Size = File.Read(Data.data(), static_cast<UINT>(Data.size()));
+	File.Close();
+
+	auto ReadDWord = [&] (std::size_t Pos) {
+		return Data[Pos] | (Data[Pos + 1] << 8) | (Data[Pos + 2] << 16) | (static_cast<uint32_t>(Data[Pos + 3]) << 24);
+	};
+
+	// Skip the RIFF header and find the data chunk
+	std::size_t Pos = 12;
+	while (Pos + 8 <= Size) {
+		const uint32_t ChunkSize = ReadDWord(Pos + 4);
+		if (!memcmp(&Data[Pos], "data", 4)) {
+			const std::size_t Begin = Pos + 8;
+			const std::size_t End = std::min<std::size_t>(Begin + ChunkSize, Size);
+			uint64_t Hash = 0xCBF29CE484222325ull;
+			for (std::size_t i = Begin; i < End; ++i)
+				Hash = (Hash ^ Data[i]) * 0x100000001B3ull;
+			Result.Hash = Hash;
+			Result.EmulatedSeconds = static_cast<double>(End - Begin) / (2. * SAMPLE_RATE);
+			return true;
+		}
+		Pos += 8 + ChunkSize + (ChunkSize & 1);
+	}
+
+	return false;
+}
+
+void CCommandLineRegression::Report(std::string &LogText, const CString &Text) const
+{
+	LogText += Text;
+	fprintf(stdout, "%s", (LPCTSTR)Text);
+	fflush(stdout);
+}
+
+void CCommandLineRegression::WriteLog(const CString &LogFile, const std::string &LogText) const
+{
+	CStdioFile File;
+	if (LogFile.GetLength() > 0 && File.Open(LogFile, CFile::modeCreate | CFile::modeWrite | CFile::typeText))
+		File.WriteString(LogText.c_str());
+}
@@ -0,0 +1,79 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "Settings.h"
+#include "PlayerSettings.h"
+
+class CSoundGen;
+
+/*!
+	\brief Renders a corpus of modules without showing the main window and compares the output
+	against golden hashes.
+	\details Each module is rendered through the regular WAV export path at a fixed sample rate
+	and without an audio device, so the hashes change only if the player or the emulation
+	produces different samples. Render speed is reported as emulated seconds per wall-clock
+	second, grouped by the sound chips of each module.
+*/
+class CCommandLineRegression
+{
+public:
+	/*!	\brief Resets every setting affecting the rendered samples to its default until the
+		object is destroyed, so that golden hashes do not depend on the user's profile.
+		\details Covers the sound, mixer and emulation settings, and the player options of
+		the general settings. Must be constructed before the sound generator thread is started. */
+	CCommandLineRegression(CSettings *pSettings, CSoundGen *pSoundGen);
+	~CCommandLineRegression();
+
+	/*!	\brief Renders every module of the corpus.
+		\param Corpus A module file, or a folder containing .dnm, .0cc and .ftm files.
+		\param GoldenFile The golden hash list, defaults to golden.txt in the corpus folder.
+		\param LogFile An optional file receiving a copy of the report.
+		\param Update Whether to rewrite the golden hash list instead of comparing against it.
+		\return True if every module was rendered and matched its golden hash. */
+	bool Run(const CString &Corpus, const CString &GoldenFile, const CString &LogFile, bool Update);
+
+private:
+	struct stRenderResult {
+		uint64_t Hash = 0;
+		double EmulatedSeconds = 0.;
+		double WallSeconds = 0.;
+		unsigned Chips = 0;
+	};
+
+	bool RenderModule(const CString &Path, const CString &WavePath, stRenderResult &Result) const;
+	bool HashWaveData(const CString &WavePath, stRenderResult &Result) const;
+	void Report(std::string &LogText, const CString &Text) const;
+	void WriteLog(const CString &LogFile, const std::string &LogText) const;
+
+private:
+	static const int SAMPLE_RATE = 44100;
+
+	CSettings *m_pSettings;
+	CSoundGen *m_pSoundGen;
+	decltype(CSettings::Sound) m_SavedSound;
+	decltype(CSettings::ChipLevels) m_SavedChipLevels;
+	decltype(CSettings::Emulation) m_SavedEmulation;
+	stPlayerSettings m_SavedPlayerSettings;
+};
@@ -21,6 +21,7 @@
 #include "ConfigGeneral.h"
 #include "FamiTracker.h"
 #include "Settings.h"
+#include "SoundGen.h"		// // //
 
 // parallel arrays are evil. burn this with fire. each config option must be added to:
 
@@ -180,6 +181,8 @@ BOOL CConfigGeneral::OnApply()
 	theApp.GetSettings()->Keys.iKeyRepeat			= m_iKeyRepeat;
 	theApp.GetSettings()->Keys.iKeyEchoBuffer		= m_iKeyEchoBuffer;		// // //
 
+	theApp.GetSoundGenerator()->SetPlayerSettings(theApp.GetSettings()->GetPlayerSettings());		// // //
+
 	return CPropertyPage::OnApply();
 }
 
@@ -49,6 +49,8 @@ BEGIN_MESSAGE_MAP(CConfigSound, CPropertyPage)
 	ON_WM_HSCROLL()
 	ON_CBN_SELCHANGE(IDC_SAMPLE_RATE, OnCbnSelchangeSampleRate)
 	ON_CBN_SELCHANGE(IDC_DEVICES, OnCbnSelchangeDevices)
+	ON_BN_CLICKED(IDC_ADAPTIVE_BUFFER, OnBnClickedAdaptiveBuffer)
+	ON_BN_CLICKED(IDC_SUBFRAME_INPUT, OnBnClickedSubFrameInput)		// // //
 END_MESSAGE_MAP()
 
 const int MAX_BUFFER_LEN = 500;	// 500 ms
@@ -91,6 +93,8 @@ BOOL CConfigSound::OnInitDialog()
 	pTrebleSliderFreq->SetPos(pSettings->Sound.iTrebleFilter);
 	pTrebleSliderDamping->SetPos(pSettings->Sound.iTrebleDamping);
 	pVolumeSlider->SetPos(pSettings->Sound.iMixVolume);
+	CheckDlgButton(IDC_ADAPTIVE_BUFFER, pSettings->Sound.bAdaptiveBuffer ? BST_CHECKED : BST_UNCHECKED);
+	CheckDlgButton(IDC_SUBFRAME_INPUT, pSettings->Sound.bSubFrameInput ? BST_CHECKED : BST_UNCHECKED);		// // //
 
 	UpdateTexts();
 
@@ -130,6 +134,8 @@ BOOL CConfigSound::OnApply()
 	}
 
 	pSettings->Sound.iBufferLength = pBufSlider->GetPos();
+	pSettings->Sound.bAdaptiveBuffer = IsDlgButtonChecked(IDC_ADAPTIVE_BUFFER) != 0;
+	pSettings->Sound.bSubFrameInput = IsDlgButtonChecked(IDC_SUBFRAME_INPUT) != 0;		// // //
 
 	pSettings->Sound.iBassFilter	= static_cast<CSliderCtrl*>(GetDlgItem(IDC_BASS_FREQ))->GetPos();
 	pSettings->Sound.iTrebleFilter	= static_cast<CSliderCtrl*>(GetDlgItem(IDC_TREBLE_FREQ))->GetPos();
@@ -153,6 +159,16 @@ void CConfigSound::OnCbnSelchangeDevices()
 	SetModified();
 }
 
+void CConfigSound::OnBnClickedAdaptiveBuffer()
+{
+	SetModified();
+}
+
+void CConfigSound::OnBnClickedSubFrameInput()		// // //
+{
+	SetModified();
+}
+
 void CConfigSound::UpdateTexts()
 {
 	CString Text;
@@ -47,4 +47,6 @@ public:
 	afx_msg void OnCbnSelchangeSampleRate();
 	afx_msg void OnCbnSelchangeSampleSize();
 	afx_msg void OnCbnSelchangeDevices();
+	afx_msg void OnBnClickedAdaptiveBuffer();
+	afx_msg void OnBnClickedSubFrameInput();		// // //
 };
@@ -21,36 +21,42 @@
 
 #pragma once
 
-#include "FftComplex.hpp"
+#include "FftReal.hpp"
 #include <algorithm>
+#include <cmath>
 
 namespace details {
 
 template <typename T, std::size_t N>
 constexpr std::array<T, N> make_hann_window() {
 	std::array<T, N> window = { };
-	T fraction = FFT::details::PI / (N - 1);
-	for (int i = 0; i < N; ++i)
-		window[i] = [] (T x) { return x * x; }(FFT::details::remez_sin(-i * fraction));
+	double fraction = FFT::details::PI / (N - 1);
+	for (std::size_t i = 0; i < N; ++i)
+		window[i] = static_cast<T>([] (double x) { return x * x; }(FFT::details::remez_sin(-(double)i * fraction)));
 	return window;
 }
 
 } // namespace details
 
+// // // real-input single precision transform; only the N / 2 + 1 non-redundant bins are kept
 template <std::size_t N>
 class FftBuffer {
+	static_assert(N >= 4 && !(N & (N - 1)), "FFT size must be a power of 2");
+
 public:
 	static constexpr std::size_t GetPoints() noexcept {
 		return N;
 	}
 
 	void Reset() {
-		samples_.fill({ });
-		buffer_.fill({ });
+		samples_.fill(0.f);
+		re_.fill(0.f);
+		im_.fill(0.f);
 	}
 
 	void Transform() {
-		FFT::transform_fwd(samples_, buffer_, window.cbegin());
+		FFT::transform_real_fwd<N>(samples_.cbegin(), window.cbegin(),
+			scratch_re_.data(), scratch_im_.data(), re_.data(), im_.data());
 	}
 
 	template <typename InputIt>
@@ -61,17 +67,23 @@ public:
 		}
 		std::copy(samples_.cbegin() + SampleCount, samples_.cend(), samples_.begin());
 		std::transform(Samples, Samples + SampleCount, samples_.end() - SampleCount, [] (auto x) {
-			return std::complex<double>(x, 0);
+			return static_cast<float>(x);
 		});
 	}
 
 	double GetIntensity(int i) const {
 		const double sqrtpoints = 1 << (FFT::details::floor_log2(N) / 2);
-		return std::abs(buffer_[i]) / sqrtpoints;
+		std::size_t k = static_cast<std::size_t>(i) % N;
+		if (k > N / 2)		// spectrum of a real signal is conjugate symmetric
+			k = N - k;
+		return std::sqrt(double(re_[k]) * re_[k] + double(im_[k]) * im_[k]) / sqrtpoints;
 	}
 
 private:
-	std::array<std::complex<double>, N> samples_;
-	std::array<std::complex<double>, N> buffer_;
-	static constexpr auto window = details::make_hann_window<double, N>();
+	std::array<float, N> samples_ = { };
+	std::array<float, N / 2 + 1> re_ = { };
+	std::array<float, N / 2 + 1> im_ = { };
+	std::array<float, N / 2> scratch_re_ = { };
+	std::array<float, N / 2> scratch_im_ = { };
+	static constexpr auto window = details::make_hann_window<float, N>();
 };
@@ -0,0 +1,168 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include "FftComplex.hpp"
+#include <array>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FFT_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace FFT {
+
+namespace details {
+
+// Twiddle factors of every radix-2 stage of an M-point transform, stored
+// back-to-back (stage of size s starts at offset s / 2 - 1) so that each
+// stage reads its factors sequentially.
+template <std::size_t M>
+struct StageTwiddles {
+	std::array<float, M> re = { };
+	std::array<float, M> im = { };
+};
+
+template <std::size_t M>
+constexpr StageTwiddles<M> make_stage_twiddles() {
+	StageTwiddles<M> tw = { };
+	for (std::size_t size = 2; size <= M; size <<= 1)
+		for (std::size_t j = 0; j < size / 2; ++j) {
+			double angle = -2 * PI * j / size;
+			tw.re[size / 2 - 1 + j] = static_cast<float>(remez_cos(angle));
+			tw.im[size / 2 - 1 + j] = static_cast<float>(remez_sin(angle));
+		}
+	return tw;
+}
+
+// Twiddle factors exp(-2 pi i k / N) for 0 <= k < N / 2, used to split the
+// half-length complex transform into the spectrum of the real input.
+template <std::size_t N>
+constexpr StageTwiddles<N / 2> make_split_twiddles() {
+	StageTwiddles<N / 2> tw = { };
+	for (std::size_t k = 0; k < N / 2; ++k) {
+		double angle = -2 * PI * k / N;
+		tw.re[k] = static_cast<float>(remez_cos(angle));
+		tw.im[k] = static_cast<float>(remez_sin(angle));
+	}
+	return tw;
+}
+
+/*
+ * Real-input FFT of N points. The input is packed into an N / 2-point complex
+ * vector (even samples in the real part, odd samples in the imaginary part),
+ * transformed with a split-format radix-2 FFT and then untangled into the
+ * N / 2 + 1 non-redundant bins of the real spectrum.
+ */
+template <std::size_t Levels>
+class RealRadix2Transformer {
+	static constexpr auto Points = static_cast<std::size_t>(1) << Levels;
+	static constexpr auto Half = Points / 2;
+
+	static constexpr auto stage_twiddles = make_stage_twiddles<Half>();
+	static constexpr auto split_twiddles = make_split_twiddles<Points>();
+
+	static void Butterflies(float *re, float *im, std::size_t halfsize, const float *wr, const float *wi, std::size_t i) {
+		std::size_t j = 0;
+#ifdef FFT_USE_SSE
+		for (; j + 4 <= halfsize; j += 4) {
+			float *ar = re + i + j, *ai = im + i + j;
+			float *br = ar + halfsize, *bi = ai + halfsize;
+			const __m128 xwr = _mm_loadu_ps(wr + j);
+			const __m128 xwi = _mm_loadu_ps(wi + j);
+			const __m128 xbr = _mm_loadu_ps(br);
+			const __m128 xbi = _mm_loadu_ps(bi);
+			const __m128 tr = _mm_sub_ps(_mm_mul_ps(xbr, xwr), _mm_mul_ps(xbi, xwi));
+			const __m128 ti = _mm_add_ps(_mm_mul_ps(xbr, xwi), _mm_mul_ps(xbi, xwr));
+			const __m128 xar = _mm_loadu_ps(ar);
+			const __m128 xai = _mm_loadu_ps(ai);
+			_mm_storeu_ps(br, _mm_sub_ps(xar, tr));
+			_mm_storeu_ps(bi, _mm_sub_ps(xai, ti));
+			_mm_storeu_ps(ar, _mm_add_ps(xar, tr));
+			_mm_storeu_ps(ai, _mm_add_ps(xai, ti));
+		}
+#endif
+		for (; j < halfsize; ++j) {
+			const std::size_t a = i + j, b = a + halfsize;
+			const float tr = re[b] * wr[j] - im[b] * wi[j];
+			const float ti = re[b] * wi[j] + im[b] * wr[j];
+			re[b] = re[a] - tr;
+			im[b] = im[a] - ti;
+			re[a] += tr;
+			im[a] += ti;
+		}
+	}
+
+public:
+	// Writes Points / 2 + 1 bins to out_re / out_im. The scratch arrays must
+	// hold Points / 2 elements each.
+	template <typename InputIt, typename InputIt2>
+	void operator()(InputIt first, InputIt2 window, float *re, float *im, float *out_re, float *out_im) {
+		// Bit-reversed addressing permutation of the packed input
+		for (std::size_t n = 0; n < Half; ++n) {
+			const std::size_t r = reverseBits(n, Levels - 1);
+			re[r] = static_cast<float>(*first++ * *window++);
+			im[r] = static_cast<float>(*first++ * *window++);
+		}
+
+		// Cooley-Tukey decimation-in-time radix-2 FFT
+		for (std::size_t size = 2; size <= Half; size <<= 1) {
+			const std::size_t halfsize = size / 2;
+			const float *wr = stage_twiddles.re.data() + halfsize - 1;
+			const float *wi = stage_twiddles.im.data() + halfsize - 1;
+			for (std::size_t i = 0; i < Half; i += size)
+				Butterflies(re, im, halfsize, wr, wi, i);
+		}
+
+		// X[k] = E[k] + W^k O[k], where E and O are recovered from Z[k] and conj(Z[M - k])
+		out_re[0] = re[0] + im[0];
+		out_im[0] = 0.f;
+		out_re[Half] = re[0] - im[0];
+		out_im[Half] = 0.f;
+		for (std::size_t k = 1; k < Half; ++k) {
+			const float zr = re[k], zi = im[k];
+			const float cr = re[Half - k], ci = -im[Half - k];
+			const float er = .5f * (zr + cr), ei = .5f * (zi + ci);
+			const float or_ = .5f * (zi - ci), oi = -.5f * (zr - cr);
+			const float wr = split_twiddles.re[k], wi = split_twiddles.im[k];
+			out_re[k] = er + or_ * wr - oi * wi;
+			out_im[k] = ei + or_ * wi + oi * wr;
+		}
+	}
+};
+
+} // namespace details
+
+/*
+ * Computes the non-redundant half of the discrete Fourier transform of the
+ * given real vector multiplied by `window`. `out_re` and `out_im` receive
+ * N / 2 + 1 bins; `scratch_re` and `scratch_im` must hold N / 2 elements.
+ * The vector's length must be a power of 2 and at least 4.
+ */
+template <std::size_t N, typename InputIt, typename InputIt2>
+void transform_real_fwd(InputIt first, InputIt2 window, float *scratch_re, float *scratch_im, float *out_re, float *out_im) {
+	if constexpr (N >= 4 && !(N & (N - 1)))
+		details::RealRadix2Transformer<details::floor_log2(N)>()(first, window, scratch_re, scratch_im, out_re, out_im);
+}
+
+} // namespace FFT
@@ -37,6 +37,7 @@
 #include "ChannelMap.h"
 #include "CustomExporters.h"
 #include "CommandLineExport.h"
+#include "CommandLineRegression.h"		// // //
 #include "WinSDK/VersionHelpers.h"		// // //
 #include "VisualizerWnd.h"		// // //
 #include "htmlhelp.h"		// // !!
@@ -171,6 +172,7 @@ BOOL CFamiTrackerApp::InitInstance()
 
 	// Create sound generator
 	m_pSoundGenerator = std::make_shared<CSoundGen>();
+	m_pSoundGenerator->SetPlayerSettings(m_pSettings->GetPlayerSettings());		// // //
 
 	// Create channel map
 	m_pChannelMap = new CChannelMap();
@@ -232,6 +234,8 @@ BOOL CFamiTrackerApp::InitInstance()
 	if (cmdInfo.m_bHelp) {		// !! !!
 		return FALSE;
 	}
+	if (cmdInfo.m_bRegress)		// // // the file name is the module folder, start with an empty document
+		cmdInfo.m_nShellCommand = CCommandLineInfo::FileNew;
 
 	// Dispatch commands specified on the command line.  Will return FALSE if
 	// app was launched with /RegServer, /Register, /Unregserver or /Unregister.
@@ -249,13 +253,20 @@ BOOL CFamiTrackerApp::InitInstance()
 	}
 
 	// The one and only window has been initialized, so show and update it
-	m_pMainWnd->ShowWindow(m_nCmdShow);
-	m_pMainWnd->UpdateWindow();
+	if (!cmdInfo.m_bRegress) {		// // // regression runs stay hidden
+		m_pMainWnd->ShowWindow(m_nCmdShow);
+		m_pMainWnd->UpdateWindow();
+	}
 	// call DragAcceptFiles only if there's a suffix
 	//  In an SDI app, this should occur after ProcessShellCommand
 	// Enable drag/drop open
 	m_pMainWnd->DragAcceptFiles();
 
+	// Regression runs override the audio and player settings until they finish
+	std::unique_ptr<CCommandLineRegression> pRegression;		// // //
+	if (cmdInfo.m_bRegress)
+		pRegression = std::make_unique<CCommandLineRegression>(m_pSettings, m_pSoundGenerator.get());
+
 	// Initialize the sound interface, also starts the thread
 	if (!m_pSoundGenerator->BeginThread(m_pSoundGenerator)) {
 		// If failed, restore and save default settings
@@ -266,6 +277,12 @@ BOOL CFamiTrackerApp::InitInstance()
 		return FALSE;
 	}
 
+	// Handle command line regression run
+	if (pRegression) {		// // //
+		m_bRegressionFailed = !pRegression->Run(cmdInfo.m_strFileName, cmdInfo.m_strRegressGolden, cmdInfo.m_strRegressLogFile, cmdInfo.m_bRegressUpdate);
+		return FALSE;
+	}
+
 	// Initialize midi unit
 	m_pMIDI->Init();
 
@@ -345,7 +362,8 @@ int CFamiTrackerApp::ExitInstance()
 
 	TRACE("App: End ExitInstance\n");
 
-	return CWinApp::ExitInstance();
+	const int ExitCode = CWinApp::ExitInstance();
+	return m_bRegressionFailed ? 1 : ExitCode;		// // //
 }
 
 BOOL CFamiTrackerApp::PreTranslateMessage(MSG* pMsg)
@@ -583,7 +601,7 @@ bool CFamiTrackerApp::CheckSingleInstance(CFTCommandLineInfo &cmdInfo)
 	if (!GetSettings()->General.bSingleInstance)
 		return false;
 
-	if (cmdInfo.m_bExport)
+	if (cmdInfo.m_bExport || cmdInfo.m_bRegress)		// // //
 		return false;
 
 	m_pInstanceMutex = new CMutex(FALSE, FT_SHARED_MUTEX_NAME);
@@ -957,6 +975,8 @@ CFTCommandLineInfo::CFTCommandLineInfo() : CCommandLineInfo(),
 	m_bLog(false),
 	m_bExport(false),
 	m_bPlay(false),
+	m_bRegress(false),		// // //
+	m_bRegressUpdate(false),
 	m_bHelp(false),		// // !!
 	m_strExportFile(_T("")),
 	m_strExportLogFile(_T("")),
@@ -975,6 +995,12 @@ void CFTCommandLineInfo::ParseParam(const TCHAR* pszParam, BOOL bFlag, BOOL bLas
 			m_bExport = true;
 			return;
 		}
+		// Render regression (/regress), /regressupdate rewrites the golden hashes
+		else if (!_tcsicmp(pszParam, _T("regress")) || !_tcsicmp(pszParam, _T("regressupdate"))) {		// // //
+			m_bRegress = true;
+			m_bRegressUpdate = !_tcsicmp(pszParam, _T("regressupdate"));
+			return;
+		}
 		// Auto play (/play or /p)
 		else if (!_tcsicmp(pszParam, _T("play")) || !_tcsicmp(pszParam, _T("p"))) {
 			m_bPlay = true;
@@ -1002,13 +1028,16 @@ void CFTCommandLineInfo::ParseParam(const TCHAR* pszParam, BOOL bFlag, BOOL bLas
 			errno_t err = freopen_s(&cout, "CON", "w", stdout);
 			// TODO: format this better
 			std::string helpmessage = "Dn-FamiTracker commandline help";
-;			helpmessage += "\nusage: Dn-FamiTracker [module file] [-play | -export | -nodump | -log]\n";
+;			helpmessage += "\nusage: Dn-FamiTracker [module file] [-play | -export | -regress | -nodump | -log]\n";
 			helpmessage += "options:\n";
 			helpmessage += "play\t: automatically plays when the program starts\n";
 			helpmessage += "export\t: exports the module to a specified format. the format is determined by the filetype of the output.\n";
 			helpmessage += "\t-export [output file] [optional log file] [DPCM file for BIN export]\n";
 			helpmessage += "\tthe following formats are available:\n";
 			helpmessage += "\t\t.nsf\n\t\t.nsfe\n\t\t.nsf2\t\t\t(generates NSF2 formatted file)\n\t\t.nes\n\t\t.bin\n\t\t.bin_aux\t\t(generates auxiliary data)\n\t\t.prg\n\t\t.asm\n\t\t.asm_aux\t\t(generates auxiliary data)\n\t\t.txt\n";
+			helpmessage += "regress\t: renders every module of a folder without a sound device and compares the output against golden hashes\n";
+			helpmessage += "\t-regress [module folder] [optional golden hash file] [optional log file]\n";
+			helpmessage += "\t-regressupdate writes the golden hash file instead, which defaults to golden.txt in the module folder\n";
 			helpmessage += "nodump\t: disables the crash dump generation, for cases where these are undesirable\n";
 			helpmessage += "log\t: enables the register logger, available in debug builds only\n";
 			helpmessage += "Press enter to continue . . .";
@@ -1036,6 +1065,14 @@ void CFTCommandLineInfo::ParseParam(const TCHAR* pszParam, BOOL bFlag, BOOL bLas
 				return;
 			}
 		}
+		// Store golden hash file, then log filename
+		else if (m_bRegress) {		// // //
+			if (m_strFileName != pszParam && m_strRegressGolden.GetLength() == 0)
+				m_strRegressGolden = CString(pszParam);
+			else if (m_strFileName != pszParam && m_strRegressLogFile.GetLength() == 0)
+				m_strRegressLogFile = CString(pszParam);
+			return;
+		}
 	}
 }
 
@@ -53,9 +53,13 @@ public:
 	bool m_bLog;
 	bool m_bExport;
 	bool m_bPlay;
+	bool m_bRegress;		// // //
+	bool m_bRegressUpdate;
 	CString m_strExportFile;
 	CString m_strExportLogFile;
 	CString m_strExportDPCMFile;
+	CString m_strRegressGolden;
+	CString m_strRegressLogFile;
 };
 
 class CMainFrame;		// // //
@@ -172,6 +176,7 @@ private:
 	bool m_CoInitialized;
 	bool			m_bRunning = false;		// // //
 	bool			m_bIsCLI = false;
+	bool			m_bRegressionFailed = false;		// // // sets the exit code of /regress
 	bool			m_bThemeActive;
 
 	bool			m_bVersionReady;
@@ -432,6 +432,7 @@ void CFamiTrackerDoc::DeleteContents()
 	// Delete all patterns
 	for (int i = 0; i < MAX_TRACKS; ++i)
 		SAFE_RELEASE(m_pTracks[i]);
+	m_PatternDamage.AddAll();		// // //
 
 	// // // Grooves
 	for (int i = 0; i < MAX_GROOVE; ++i)
@@ -3407,6 +3408,7 @@ void CFamiTrackerDoc::SetFrameCount(unsigned int Track, unsigned int Count)
 	unsigned int Old = pTrack->GetFrameCount();
 	if (Old != Count) {
 		pTrack->SetFrameCount(Count);
+		m_PatternDamage.AddAll();		// // //
 		if (Count < Old)
 			m_pBookmarkManager->GetCollection(Track)->RemoveFrames(Count, Old - Count);
 		SetModifiedFlag();
@@ -3422,6 +3424,7 @@ void CFamiTrackerDoc::SetPatternLength(unsigned int Track, unsigned int Length)
 	CPatternData *pTrack = GetTrack(Track);
 	if (pTrack->GetPatternLength() != Length) {
 		pTrack->SetPatternLength(Length);
+		m_PatternDamage.AddAll();		// // //
 		SetModifiedFlag();
 	}
 }
@@ -3521,6 +3524,7 @@ void CFamiTrackerDoc::SetEffColumns(unsigned int Track, unsigned int Channel, un
 
 	GetChannel(Channel)->SetColumnCount(Columns);
 	GetTrack(Track)->SetEffectColumnCount(Channel, Columns);
+	m_PatternDamage.AddAll();		// // //
 
 	SetModifiedFlag();
 }
@@ -3589,6 +3593,7 @@ void CFamiTrackerDoc::SetPatternAtFrame(unsigned int Track, unsigned int Frame,
 	ASSERT(Pattern < MAX_PATTERN);
 
 	GetTrack(Track)->SetFramePattern(Frame, Channel, Pattern);
+	m_PatternDamage.AddAll();		// // //
 }
 
 unsigned int CFamiTrackerDoc::GetFrameRate() const
@@ -3612,6 +3617,7 @@ void CFamiTrackerDoc::SetNoteData(unsigned int Track, unsigned int Frame, unsign
 	CPatternData *pTrack = GetTrack(Track);
 	int Pattern = pTrack->GetFramePattern(Frame, Channel);
 	memcpy(pTrack->GetPatternData(Channel, Pattern, Row), pData, sizeof(stChanNote));
+	m_PatternDamage.Add(Track, Channel, Pattern, Row, Row);		// // //
 	SetModifiedFlag();
 }
 
@@ -3638,6 +3644,7 @@ void CFamiTrackerDoc::SetDataAtPattern(unsigned int Track, unsigned int Pattern,
 	// Set a note to a direct pattern
 	CPatternData *pTrack = GetTrack(Track);
 	memcpy(pTrack->GetPatternData(Channel, Pattern, Row), pData, sizeof(stChanNote));
+	m_PatternDamage.Add(Track, Channel, Pattern, Row, Row);		// // //
 	SetModifiedFlag();
 }
 
@@ -3654,6 +3661,16 @@ void CFamiTrackerDoc::GetDataAtPattern(unsigned int Track, unsigned int Pattern,
 	memcpy(pData, pTrack->GetPatternData(Channel, Pattern, Row), sizeof(stChanNote));
 }
 
+const stChanNote *CFamiTrackerDoc::GetPatternRows(unsigned int Track, unsigned int Pattern, unsigned int Channel) const		// // //
+{
+	ASSERT(Track < MAX_TRACKS);
+	ASSERT(Pattern < MAX_PATTERN);
+	ASSERT(Channel < MAX_CHANNELS);
+
+	// Read-only access which never allocates, safe to use from worker threads
+	return GetTrack(Track)->GetPatternRows(Channel, Pattern);
+}
+
 bool CFamiTrackerDoc::InsertRow(unsigned int Track, unsigned int Frame, unsigned int Channel, unsigned int Row)
 {
 	ASSERT(Track < MAX_TRACKS);
@@ -3674,6 +3691,7 @@ bool CFamiTrackerDoc::InsertRow(unsigned int Track, unsigned int Frame, unsigned
 	}
 
 	*pTrack->GetPatternData(Channel, Pattern, Row) = Note;
+	m_PatternDamage.Add(Track, Channel, Pattern, Row, MAX_PATTERN_LENGTH - 1);		// // //
 
 	SetModifiedFlag();
 
@@ -3686,6 +3704,7 @@ void CFamiTrackerDoc::ClearPatterns(unsigned int Track)
 
 	CPatternData *pTrack = GetTrack(Track);
 	pTrack->ClearEverything();
+	m_PatternDamage.AddAll();		// // //
 
 	SetModifiedFlag();
 }
@@ -3700,6 +3719,7 @@ void CFamiTrackerDoc::ClearPattern(unsigned int Track, unsigned int Frame, unsig
 	CPatternData *pTrack = GetTrack(Track);
 	int Pattern = pTrack->GetFramePattern(Frame, Channel);
 	pTrack->ClearPattern(Channel, Pattern);
+	m_PatternDamage.Add(Track, Channel, Pattern, 0, MAX_PATTERN_LENGTH - 1);		// // //
 
 	SetModifiedFlag();
 }
@@ -3714,6 +3734,7 @@ bool CFamiTrackerDoc::ClearRow(unsigned int Track, unsigned int Frame, unsigned
 	CPatternData *pTrack = GetTrack(Track);
 	int Pattern = pTrack->GetFramePattern(Frame, Channel);
 	*pTrack->GetPatternData(Channel, Pattern, Row) = stChanNote { };		// // //
+	m_PatternDamage.Add(Track, Channel, Pattern, Row, Row);		// // //
 	
 	SetModifiedFlag();
 
@@ -3770,6 +3791,7 @@ bool CFamiTrackerDoc::ClearRowField(unsigned int Track, unsigned int Frame, unsi
 			pNote->EffParam[3] = 0;
 			break;
 	}
+	m_PatternDamage.Add(Track, Channel, Pattern, Row, Row);		// // //
 	
 	SetModifiedFlag();
 
@@ -3797,6 +3819,7 @@ bool CFamiTrackerDoc::RemoveNote(unsigned int Track, unsigned int Frame, unsigne
 	}
 
 	*pTrack->GetPatternData(Channel, Pattern, PatternLen - 1) = Note;
+	m_PatternDamage.Add(Track, Channel, Pattern, Row ? Row - 1 : 0, MAX_PATTERN_LENGTH - 1);		// // //
 
 	SetModifiedFlag();
 
@@ -3856,6 +3879,16 @@ void CFamiTrackerDoc::SwapChannels(unsigned int Track, unsigned int First, unsig
 	SetModifiedFlag();
 }
 
+CPatternDamage *CFamiTrackerDoc::GetPatternDamage()		// // //
+{
+	return &m_PatternDamage;
+}
+
+void CFamiTrackerDoc::ClearPatternDamage()		// // //
+{
+	m_PatternDamage.Clear();
+}
+
 //// Frame functions //////////////////////////////////////////////////////////////////////////////////
 
 bool CFamiTrackerDoc::InsertFrame(unsigned int Track, unsigned int Frame)
@@ -4787,28 +4820,7 @@ stHighlight CFamiTrackerDoc::GetHighlightAt(unsigned int Track, unsigned int Fra
 	while (Frame < 0) Frame += GetFrameCount(Track);
 	Frame %= GetFrameCount(Track);
 
-	stHighlight Hl = m_vHighlight;
-	
-	const CBookmark Zero { };
-	CBookmarkCollection *pCol = m_pBookmarkManager->GetCollection(Track);
-	if (const unsigned Count = pCol->GetCount()) {
-		CBookmark tmp(Frame, Row);
-		unsigned int Min = tmp.Distance(Zero);
-		for (unsigned i = 0; i < Count; ++i) {
-			CBookmark *pMark = pCol->GetBookmark(i);
-			unsigned Dist = tmp.Distance(*pMark);
-			if (Dist <= Min) {
-				Min = Dist;
-				if (pMark->m_Highlight.First != -1 && (pMark->m_bPersist || pMark->m_iFrame == Frame))
-					Hl.First = pMark->m_Highlight.First;
-				if (pMark->m_Highlight.Second != -1 && (pMark->m_bPersist || pMark->m_iFrame == Frame))
-					Hl.Second = pMark->m_Highlight.Second;
-				Hl.Offset = pMark->m_Highlight.Offset + pMark->m_iRow;
-			}
-		}
-	}
-
-	return Hl;
+	return m_pBookmarkManager->GetCollection(Track)->GetHighlightAt(Frame, Row, m_vHighlight);
 }
 
 unsigned int CFamiTrackerDoc::GetHighlightState(unsigned int Track, unsigned int Frame, unsigned int Row) const		// // //
@@ -4823,13 +4835,8 @@ unsigned int CFamiTrackerDoc::GetHighlightState(unsigned int Track, unsigned int
 
 CBookmark *CFamiTrackerDoc::GetBookmarkAt(unsigned int Track, unsigned int Frame, unsigned int Row) const		// // //
 {
-	if (CBookmarkCollection *pCol = m_pBookmarkManager->GetCollection(Track)) {
-		for (unsigned i = 0, Count = pCol->GetCount(); i < Count; ++i) {
-			CBookmark *pMark = pCol->GetBookmark(i);
-			if (pMark->m_iFrame == Frame && pMark->m_iRow == Row)
-				return pMark;
-		}
-	}
+	if (CBookmarkCollection *pCol = m_pBookmarkManager->GetCollection(Track))
+		return pCol->FindAt(Frame, Row);
 	return nullptr;
 }
 
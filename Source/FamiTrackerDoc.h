@@ -94,6 +94,7 @@ struct stJSONOptionalData {
 #include "OldSequence.h"		// // //
 #include "Groove.h"		// // //
 #include "Bookmark.h"		// // //
+#include "PatternDamage.h"		// // //
 
 #include "PatternEditorTypes.h"		// // //
 // #include "FrameEditorTypes.h"		// // //
@@ -198,6 +199,7 @@ public:
 
 	void			SetDataAtPattern(unsigned int Track, unsigned int Pattern, unsigned int Channel, unsigned int Row, const stChanNote *pData);
 	void			GetDataAtPattern(unsigned int Track, unsigned int Pattern, unsigned int Channel, unsigned int Row, stChanNote *pData) const;
+	const stChanNote *GetPatternRows(unsigned int Track, unsigned int Pattern, unsigned int Channel) const;		// // //
 
 	void			ClearPatterns(unsigned int Track);
 	void			ClearPattern(unsigned int Track, unsigned int Frame, unsigned int Channel);
@@ -213,6 +215,9 @@ public:
 
 	void			SwapChannels(unsigned int Track, unsigned int First, unsigned int Second);		// // //
 
+	CPatternDamage	*GetPatternDamage();		// // //
+	void			ClearPatternDamage();		// // //
+
 	// Frame editing
 	bool			InsertFrame(unsigned int Track, unsigned int Frame);
 	bool			RemoveFrame(unsigned int Track, unsigned int Frame);
@@ -553,6 +558,7 @@ private:
 	// Instruments, samples and sequences
 	CInstrumentManager *m_pInstrumentManager;					// // //
 	CBookmarkManager *m_pBookmarkManager;						// // //
+	CPatternDamage	m_PatternDamage;							// // // Pattern rows edited since the last view update
 	CGroove			*m_pGrooveTable[MAX_GROOVE];				// // // Grooves
 
 	// Module properties
@@ -45,6 +45,7 @@
 #include "SplitKeyboardDlg.h"
 #include "NoteQueue.h"
 
+#include <algorithm>		// // //
 #include <cmath>
 #include <assert.h>
 #include <synchapi.h>  // CreateEvent
@@ -129,7 +130,7 @@ BEGIN_MESSAGE_MAP(CFamiTrackerView, CView)
 	ON_COMMAND(ID_BLOCK_END, OnBlockEnd)
 	ON_COMMAND(ID_POPUP_PICKUPROW, OnPickupRow)
 	ON_MESSAGE(WM_USER_MIDI_EVENT, OnUserMidiEvent)
-	ON_MESSAGE(AM_PLAYER, OnUserPlayerEvent)
+	ON_MESSAGE(WM_USER_GUI_UPDATE, OnUserGuiUpdate)		// // //
 	ON_MESSAGE(AM_NOTE_EVENT, OnUserNoteEvent)
 	ON_MESSAGE(AM_ERROR, &CFamiTrackerView::OnAudioThreadError)
 	ON_WM_CLOSE()
@@ -180,6 +181,13 @@ bool CFamiTrackerView::PostAudioMessage(AudioMessageId message, WPARAM wParam, L
 	return false;
 }
 
+void CFamiTrackerView::PostGuiUpdate(unsigned Flags)		// // //
+{
+	// Only the first update since the last redraw has to wake the receive thread
+	if (m_iPendingUpdates.fetch_or(Flags) == 0)
+		SetEvent(m_hQueueEvent.get());
+}
+
 // Convert keys 0-F to numbers, -1 = invalid key
 static int ConvertKeyToHex(Keycode Key)
 {
@@ -227,6 +235,9 @@ static int ConvertKeyExtra(Keycode Key)		// // //
 
 CFamiTrackerView::CFamiTrackerView() :
 	m_MessageQueue(8192),
+	m_iPendingUpdates(0),		// // //
+	m_bGuiUpdatePosted(false),
+	m_iRefreshPeriod(16),
 	mClipboardFormat(0),
 	m_iMenuChannel(-1),
 	m_iInsertKeyStepping(1),
@@ -287,6 +298,10 @@ CFamiTrackerView::CFamiTrackerView() :
 				PostMessage(msg.message, msg.wParam, msg.lParam);
 			}
 
+			// // // Coalesce GUI updates, UpdateGui() will pick up everything published until then
+			if (m_iPendingUpdates.load() != 0 && !m_bGuiUpdatePosted.exchange(true))
+				PostMessage(WM_USER_GUI_UPDATE);
+
 			if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0) {
 				break;
 			}
@@ -359,9 +374,13 @@ int CFamiTrackerView::OnCreate(LPCREATESTRUCT lpCreateStruct)
 	if (CView::OnCreate(lpCreateStruct) == -1)
 		return -1;
 
-	TimerDelayer = 100;
-	// Install a timer for screen updates, 20ms
-	SetTimer(TMR_UPDATE, TimerDelayer, NULL);
+	// // // Screen updates are paced to the display refresh rate
+	if (CDC *pDC = GetDC()) {
+		int Rate = pDC->GetDeviceCaps(VREFRESH);
+		if (Rate > 1)		// 0 or 1 means hardware default
+			m_iRefreshPeriod = std::max(1, 1000 / Rate);
+		ReleaseDC(pDC);
+	}
 
 	m_DropTarget.Register(this);
 
@@ -547,18 +566,18 @@ LRESULT CFamiTrackerView::OnUserMidiEvent(WPARAM wParam, LPARAM lParam)
 	return 0;
 }
 
-LRESULT CFamiTrackerView::OnUserPlayerEvent(WPARAM wParam, LPARAM lParam)
+LRESULT CFamiTrackerView::OnUserGuiUpdate(WPARAM wParam, LPARAM lParam)		// // //
 {
-	// Player is playing
-	// TODO clean up
-	int Frame = (int)wParam;
-	int Row = (int)lParam;
+	// Run at most one update per display refresh, defer the rest to the update timer
+	const auto Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - m_GuiUpdateTime).count();
+	const int Period = GetGuiUpdatePeriod();
 
-	m_pPatternEditor->InvalidateCursor();
-	RedrawPatternEditor();
+	if (Elapsed < Period)
+		SetTimer(TMR_UPDATE, static_cast<UINT>(Period - Elapsed), NULL);
+	else
+		UpdateGui();
 
-	//m_pPatternEditor->AdjustCursor();	// Fix frame editor cursor
-	RedrawFrameEditor();
 	return 0;
 }
 
@@ -811,20 +830,11 @@ void CFamiTrackerView::OnSetFocus(CWnd* pOldWnd)
 void CFamiTrackerView::OnTimer(UINT_PTR nIDEvent)
 {
 	// Timer callback function
-	if (theApp.IsPlaying()) {
-		KillTimer(TMR_UPDATE);
-		TimerDelayer = 16;
-		SetTimer(TMR_UPDATE, TimerDelayer, NULL);
-	}
-	else {
-		KillTimer(TMR_UPDATE);
-		TimerDelayer = theApp.GetSettings()->GUI.iLowRefreshRate;
-		SetTimer(TMR_UPDATE, TimerDelayer, NULL);
-	}
 	switch (nIDEvent) {
-		// Drawing updates when playing
-		case TMR_UPDATE:
-			PeriodicUpdate();
+		// Deferred GUI update, one-shot
+		case TMR_UPDATE:		// // //
+			KillTimer(TMR_UPDATE);
+			UpdateGui();
 			break;
 
 		// Auto-scroll timer
@@ -839,9 +849,25 @@ void CFamiTrackerView::OnTimer(UINT_PTR nIDEvent)
 	CView::OnTimer(nIDEvent);
 }
 
-void CFamiTrackerView::PeriodicUpdate()
+int CFamiTrackerView::GetGuiUpdatePeriod() const		// // //
+{
+	// Follow playback at the display refresh rate, throttle idle updates
+	if (theApp.IsPlaying())
+		return m_iRefreshPeriod;
+	return std::max(m_iRefreshPeriod, theApp.GetSettings()->GUI.iLowRefreshRate);
+}
+
+void CFamiTrackerView::UpdateGui()		// // //
 {
-	// Called periodically by an background timer
+	// Called when the audio thread or the view has published changes with PostGuiUpdate()
+
+	// Clear the posted flag first, updates published after the exchange below will post again
+	m_bGuiUpdatePosted = false;
+	const unsigned Flags = m_iPendingUpdates.exchange(0);
+	m_GuiUpdateTime = std::chrono::steady_clock::now();
+
+	if (Flags == 0)
+		return;
 
 	CFamiTrackerDoc* pDoc = GetDocument();
 	ASSERT_VALID(pDoc);
@@ -851,10 +877,9 @@ void CFamiTrackerView::PeriodicUpdate()
 
 	CSoundGen *pSoundGen = theApp.GetSoundGenerator();
 
-	if (pSoundGen != NULL) {
-		// Skip updates when doing background tasks (WAV render for example)
-		if (!pSoundGen->IsBackgroundTask()) {
-
+	// Skip player updates when doing background tasks (WAV render for example)
+	if (pSoundGen != NULL && !pSoundGen->IsBackgroundTask()) {
+		if (Flags & GUI_UPDATE_TIME) {
 			int PlayTicks = pSoundGen->GetPlayerTicks();
 			int PlayTime = (PlayTicks * 10) / pDoc->GetFrameRate();
 
@@ -864,33 +889,31 @@ void CFamiTrackerView::PeriodicUpdate()
 			int mSec = PlayTime % 10;
 
 			pMainFrm->SetIndicatorTime(Min, Sec, mSec);
+		}
 
-			int Frame = pSoundGen->GetPlayerFrame();
-			int Row = pSoundGen->GetPlayerRow();
+		if (Flags & GUI_UPDATE_POSITION) {
+			pMainFrm->SetIndicatorPos(pSoundGen->GetPlayerFrame(), pSoundGen->GetPlayerRow());
 
-			pMainFrm->SetIndicatorPos(Frame, Row);
+			m_pPatternEditor->InvalidateCursor();
+			RedrawPatternEditor();
+			RedrawFrameEditor();
+		}
 
+		if (Flags & GUI_UPDATE_METERS) {
 			// DPCM info
 			stDPCMState DPCMState = pSoundGen->GetDPCMState();
 			m_pPatternEditor->SetDPCMState(DPCMState);
 
-			if (pDoc->IsFileLoaded()) {
+			if (pDoc->IsFileLoaded())
 				UpdateMeters();
-				// // //
-			}
 		}
 	}
 
-	// TODO get rid of static variables
-	static int LastNoteState;
-
-	if (LastNoteState != m_iKeyboardNote)
+	if (Flags & GUI_UPDATE_NOTE_STATE)
 		pMainFrm->ChangeNoteState(m_iKeyboardNote);
 
-	LastNoteState = m_iKeyboardNote;
-
 	// Switch instrument
-	if (m_iSwitchToInstrument != -1) {
+	if ((Flags & GUI_UPDATE_INSTRUMENT) && m_iSwitchToInstrument != -1) {
 		SetInstrument(m_iSwitchToInstrument);
 		m_iSwitchToInstrument = -1;
 	}
@@ -1314,6 +1337,7 @@ void CFamiTrackerView::OnInitialUpdate()
 	}
 
 	UpdateNoteQueues();		// // //
+	PostGuiUpdate(GUI_UPDATE_ALL);		// // //
 
 	// Draw screen
 	m_pPatternEditor->InvalidateBackground();
@@ -1359,12 +1383,15 @@ void CFamiTrackerView::RefreshFrameEditor()
 	RedrawFrameEditor();
 }
 
-void CFamiTrackerView::OnUpdate(CView* /*pSender*/, LPARAM lHint, CObject* /*pHint*/)
+void CFamiTrackerView::OnUpdate(CView* /*pSender*/, LPARAM lHint, CObject* pHint)
 {
 	// Called when the document has changed
 	CMainFrame *pMainFrm = static_cast<CMainFrame*>(GetParentFrame());
 	ASSERT_VALID(pMainFrm);
 
+	// // // Pattern edits may carry the changed rows, other notifications redraw everything
+	const CPatternDamage *pDamage = dynamic_cast<const CPatternDamage*>(pHint);
+
 	// Handle new flags
 	switch (lHint) {
 	// Track has been added, removed or changed
@@ -1379,14 +1406,20 @@ void CFamiTrackerView::OnUpdate(CView* /*pSender*/, LPARAM lHint, CObject* /*pHi
 		break;
 	// Pattern data has been edited
 	case UPDATE_PATTERN:
-		m_pPatternEditor->InvalidatePatternData();
+		if (pDamage)		// // //
+			m_pPatternEditor->InvalidatePatternData(*pDamage);
+		else
+			m_pPatternEditor->InvalidatePatternData();
 		RedrawPatternEditor();
 		break;
 	// Frame data has been edited
 	case UPDATE_FRAME:
 		InvalidateFrameEditor();
 
-		m_pPatternEditor->InvalidatePatternData();
+		if (pDamage)		// // //
+			m_pPatternEditor->InvalidatePatternData(*pDamage);
+		else
+			m_pPatternEditor->InvalidatePatternData();
 		RedrawPatternEditor();
 		pMainFrm->UpdateBookmarkList();		// // //
 		break;
@@ -1615,6 +1648,7 @@ void CFamiTrackerView::PlayerPlayNote(int Channel, stChanNote *pNote)
 
 	if (pNote->Instrument < MAX_INSTRUMENTS && pNote->Note > 0 && Channel == m_pPatternEditor->GetChannel() && m_bSwitchToInstrument) {
 		m_iSwitchToInstrument = pNote->Instrument;
+		PostGuiUpdate(GUI_UPDATE_INSTRUMENT);		// // //
 	}
 }
 
@@ -1668,8 +1702,10 @@ void CFamiTrackerView::RegisterKeyState(int Channel, int Note)
 	CFamiTrackerDoc *pDoc = GetDocument();
 	CTrackerChannel *pChannel = pDoc->GetChannel(m_pPatternEditor->GetChannel());
 
-	if (pChannel->GetID() == Channel)
+	if (pChannel->GetID() == Channel && m_iKeyboardNote != Note) {		// // //
 		m_iKeyboardNote = Note;
+		PostGuiUpdate(GUI_UPDATE_NOTE_STATE);
+	}
 
 	/*
 	if (Channel == m_pPatternEditor->GetChannel())
@@ -2147,7 +2183,13 @@ void CFamiTrackerView::PlayNote(unsigned int Channel, unsigned int Note, unsigne
 		if (ret != -1) {
 			if (IsSplitEnabled(MidiNote, ret)) 	// // //
 				SplitKeyboardAdjust(NoteData);
-			pDoc->GetChannel(ret)->SetNote(NoteData, NOTE_PRIO_2);
+			stLiveEvent Event;		// // // Played by the audio thread, without MIDI echo
+			Event.Type = LIVE_EVENT_NOTE;
+			Event.Channel = ret;
+			Event.Priority = NOTE_PRIO_2;
+			Event.Note = NoteData;
+			Event.Time = m_NoteInputTime;
+			theApp.GetSoundGenerator()->QueueLiveEvent(Event);
 			theApp.GetSoundGenerator()->ForceReloadInstrument(ret);		// // //
 		}
 	}
@@ -2162,7 +2204,7 @@ void CFamiTrackerView::PlayNote(unsigned int Channel, unsigned int Note, unsigne
 		for (int i = 0; i < Channels; ++i) {
 			pDoc->GetNoteData(Track, Frame, i, Row, &ChanNote);
 			if (!m_bMuteChannels[i] && i != Channel)
-				theApp.GetSoundGenerator()->QueueNote(i, ChanNote, (i == Channel) ? NOTE_PRIO_2 : NOTE_PRIO_1);
+				theApp.GetSoundGenerator()->QueueNote(i, ChanNote, (i == Channel) ? NOTE_PRIO_2 : NOTE_PRIO_1, m_NoteInputTime);
 		}
 	}
 }
@@ -2181,7 +2223,7 @@ void CFamiTrackerView::ReleaseNote(unsigned int Channel, unsigned int Note, unsi
 		int ch = pDoc->GetChannelIndex(m_pNoteQueue->Cut(MIDI_NOTE(Octave, Note), pDoc->GetChannelType(Channel)));
 	//	int ch = pDoc->GetChannelIndex(m_pNoteQueue->Release(MIDI_NOTE(Octave, Note), pDoc->GetChannelType(Channel)));
 		if (ch != -1)
-			theApp.GetSoundGenerator()->QueueNote(ch, NoteData, NOTE_PRIO_2);
+			theApp.GetSoundGenerator()->QueueNote(ch, NoteData, NOTE_PRIO_2, m_NoteInputTime);
 
 		if (theApp.GetSettings()->General.bPreviewFullRow) {
 			NoteData.Note = HALT;
@@ -2190,7 +2232,7 @@ void CFamiTrackerView::ReleaseNote(unsigned int Channel, unsigned int Note, unsi
 			int Channels = pDoc->GetChannelCount();
 			for (int i = 0; i < Channels; ++i) {
 				if (i != ch)
-					theApp.GetSoundGenerator()->QueueNote(i, NoteData, NOTE_PRIO_1);
+					theApp.GetSoundGenerator()->QueueNote(i, NoteData, NOTE_PRIO_1, m_NoteInputTime);
 			}
 		}
 	}
@@ -2209,7 +2251,7 @@ void CFamiTrackerView::HaltNote(unsigned int Channel, unsigned int Note, unsigne
 	if (Channel < static_cast<unsigned>(pDoc->GetChannelCount())) {
 		int ch = pDoc->GetChannelIndex(m_pNoteQueue->Cut(MIDI_NOTE(Octave, Note), pDoc->GetChannelType(Channel)));
 		if (ch != -1)
-			theApp.GetSoundGenerator()->QueueNote(ch, NoteData, NOTE_PRIO_2);
+			theApp.GetSoundGenerator()->QueueNote(ch, NoteData, NOTE_PRIO_2, m_NoteInputTime);
 
 		if (theApp.GetSettings()->General.bPreviewFullRow) {
 			NoteData.Instrument = MAX_INSTRUMENTS;
@@ -2217,7 +2259,7 @@ void CFamiTrackerView::HaltNote(unsigned int Channel, unsigned int Note, unsigne
 			int Channels = pDoc->GetChannelCount();
 			for (int i = 0; i < Channels; ++i) {
 				if (i != ch)
-					theApp.GetSoundGenerator()->QueueNote(i, NoteData, NOTE_PRIO_1);
+					theApp.GetSoundGenerator()->QueueNote(i, NoteData, NOTE_PRIO_1, m_NoteInputTime);
 			}
 		}
 	}
@@ -2237,12 +2279,12 @@ void CFamiTrackerView::HaltNoteSingle(unsigned int Channel) const
 		for (const auto &i : m_pNoteQueue->StopChannel(pDoc->GetChannelType(Channel))) {
 			int ch = pDoc->GetChannelIndex(i);
 			if (ch != -1)
-				theApp.GetSoundGenerator()->QueueNote(ch, NoteData, NOTE_PRIO_2);
+				theApp.GetSoundGenerator()->QueueNote(ch, NoteData, NOTE_PRIO_2, m_NoteInputTime);
 		}
 	}
 
 	if (theApp.GetSoundGenerator()->IsPlaying())
-		theApp.GetSoundGenerator()->QueueNote(Channel, NoteData, NOTE_PRIO_2);
+		theApp.GetSoundGenerator()->QueueNote(Channel, NoteData, NOTE_PRIO_2, m_NoteInputTime);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3614,7 +3656,7 @@ void CFamiTrackerView::TranslateMidiMessage()
 		return;
 
 	unsigned char Message, Channel, Data1, Data2;
-	while (pMIDI->ReadMessage(Message, Channel, Data1, Data2)) {
+	while (pMIDI->ReadMessage(Message, Channel, Data1, Data2, m_NoteInputTime)) {		// // //
 
 		if (Message != 0x0F) {
 			if (!theApp.GetSettings()->Midi.bMidiChannelMap)
@@ -3655,9 +3697,8 @@ void CFamiTrackerView::TranslateMidiMessage()
 
 			case MIDI_MSG_PITCH_WHEEL:
 				{
-					CTrackerChannel *pChannel = pDoc->GetChannel(Channel);
 					int PitchValue = 0x2000 - ((Data1 & 0x7F) | ((Data2 & 0x7F) << 7));
-					pChannel->SetPitch(-PitchValue / 0x10);
+					theApp.GetSoundGenerator()->QueuePitch(Channel, -PitchValue / 0x10, m_NoteInputTime);		// // //
 				}
 				break;
 
@@ -3670,6 +3711,8 @@ void CFamiTrackerView::TranslateMidiMessage()
 		}
 	}
 
+	m_NoteInputTime = { };		// // //
+
 	if (Status.GetLength() > 0)
 		GetParentFrame()->SetMessageText(Status);
 }
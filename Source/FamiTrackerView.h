@@ -25,6 +25,8 @@
 
 #include "rigtorp/SPSCQueue.h"
 #include "utils/handle_ptr.h"
+#include <atomic>		// // //
+#include <chrono>		// // //
 #include <mutex>
 #include <thread>
 #include <unordered_map>		// // //
@@ -161,9 +163,8 @@ private:
 	void	RedrawPatternEditor();
 	void	RedrawFrameEditor();
 
-	void	PeriodicUpdate();
-
-	int		TimerDelayer; // Refresh rate depending on playback
+	void	UpdateGui();		// // //
+	int		GetGuiUpdatePeriod() const;		// // //
 
 	// Instruments
 	void		 SetInstrument(int Instrument);
@@ -269,6 +270,18 @@ private:
 	/// receive thread.
 	rigtorp::SPSCQueue<AudioMessage> m_MessageQueue;
 
+	// // // GUI update scheduling
+	/// gui_update_t flags published since the last UpdateGui().
+	std::atomic<unsigned> m_iPendingUpdates;
+	/// Set by receive thread after posting WM_USER_GUI_UPDATE, cleared by UpdateGui().
+	std::atomic<bool> m_bGuiUpdatePosted;
+	/// Time of the last UpdateGui(), used to pace updates to the display refresh.
+	std::chrono::steady_clock::time_point m_GuiUpdateTime;
+	/// Display refresh period in milliseconds.
+	int m_iRefreshPeriod;
+	/// // // Arrival time of the MIDI message being translated, empty for keyboard input.
+	std::chrono::steady_clock::time_point m_NoteInputTime;
+
 	// General
 	bool				m_bHasFocus;
 	UINT				mClipboardFormat;
@@ -357,6 +370,8 @@ protected:
 	DECLARE_MESSAGE_MAP()
 public:
 	bool PostAudioMessage(AudioMessageId message, WPARAM wParam = 0, LPARAM lParam = 0);
+	/// Marks parts of the GUI (gui_update_t flags) as out of date. Callable from any thread.
+	void PostGuiUpdate(unsigned Flags);		// // //
 
 	virtual void OnDraw(CDC* /*pDC*/);
 	virtual void CalcWindowRect(LPRECT lpClientRect, UINT nAdjustType = adjustBorder);
@@ -419,7 +434,7 @@ public:
 	afx_msg void OnBlockEnd();
 	afx_msg void OnPickupRow();
 	afx_msg LRESULT OnUserMidiEvent(WPARAM wParam, LPARAM lParam);
-	afx_msg LRESULT OnUserPlayerEvent(WPARAM wParam, LPARAM lParam);
+	afx_msg LRESULT OnUserGuiUpdate(WPARAM wParam, LPARAM lParam);		// // //
 	afx_msg LRESULT OnUserNoteEvent(WPARAM wParam, LPARAM lParam);
 	afx_msg LRESULT OnAudioThreadError(WPARAM wParam, LPARAM lParam);
 	virtual void OnInitialUpdate();
@@ -26,14 +26,27 @@
 // Custom window messages for CFamiTrackerView
 enum {
 	WM_USER_MIDI_EVENT = WM_USER,				// There is a new MIDI command
+	WM_USER_GUI_UPDATE,							// // // Parts of the GUI are out of date, see gui_update_t
 	WM_USER_GUI_COUNT,
 };
 
+/// // // Parts of the GUI which need refreshing. Published from any thread by
+/// CFamiTrackerView::PostGuiUpdate() and coalesced into at most one update per
+/// display refresh.
+enum gui_update_t : unsigned {
+	GUI_UPDATE_POSITION		= 1 << 0,	// Player row or frame has changed, or playback has stopped
+	GUI_UPDATE_TIME			= 1 << 1,	// Player ticks have advanced
+	GUI_UPDATE_METERS		= 1 << 2,	// Volume meters, registers or DPCM state have changed
+	GUI_UPDATE_NOTE_STATE	= 1 << 3,	// Note playing on the selected channel has changed
+	GUI_UPDATE_INSTRUMENT	= 1 << 4,	// Player has switched the selected instrument
+
+	GUI_UPDATE_ALL			= (1 << 5) - 1,
+};
+
 /// Sent from audio to GUI thread. Only pass into CFamiTrackerView::PostQueueMessage()
 /// to avoid blocking the audio thread!
 enum AudioMessageId {
-	AM_PLAYER = WM_USER_GUI_COUNT,  // Pattern play row has changed
-	AM_NOTE_EVENT,  // There is a new note command (by player)
+	AM_NOTE_EVENT = WM_USER_GUI_COUNT,  // There is a new note command (by player)
 	AM_DUMP_INST,  // // // End of track, add instrument
 
 	AM_ERROR,  // audio thread error, (nIDPrompt, nType)
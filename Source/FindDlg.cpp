@@ -23,6 +23,7 @@
 #include <stdexcept>
 #include "stdafx.h"
 #include <map>
+#include "utils/parallel_for.h"		// // //
 #include "FamiTracker.h"
 #include "FamiTrackerDoc.h"
 #include "FamiTrackerView.h"
@@ -203,6 +204,11 @@ bool CFindCursor::Contains() const
 		return InStart && InEnd;
 }
 
+const CSelection &CFindCursor::GetScope() const
+{
+	return m_Scope;
+}
+
 
 
 // CFileResultsBox dialog
@@ -230,58 +236,68 @@ void CFindResultsBox::DoDataExchange(CDataExchange* pDX)
 	CDialog::DoDataExchange(pDX);
 }
 
-void CFindResultsBox::AddResult(const stChanNote *pNote, const CFindCursor *pCursor, bool Noise) const
+void CFindResultsBox::AddResults(int Track, const std::vector<stFindResult> &Results) const		// // //
 {
+	const auto pDoc = static_cast<CFamiTrackerDoc*>(((CFrameWnd*)AfxGetMainWnd())->GetActiveDocument());
 	int Pos = m_cListResults->GetItemCount();
+	m_cListResults->SetItemCount(Pos + static_cast<int>(Results.size()));		// reserve all rows at once
 	CString str;
-	str.Format(_T("%d"), Pos + 1);
-	m_cListResults->InsertItem(Pos, str);
 
-	const auto pDoc = static_cast<CFamiTrackerDoc*>(((CFrameWnd*)AfxGetMainWnd())->GetActiveDocument());
-	m_cListResults->SetItemText(Pos, CHANNEL, pDoc->GetChannel(pCursor->m_iChannel)->GetChannelName());
-	str.Format(_T("%02X"), pDoc->GetPatternAtFrame(pCursor->m_iTrack, pCursor->m_iFrame, pCursor->m_iChannel));
-	m_cListResults->SetItemText(Pos, PATTERN, str);
+	for (const auto &Result : Results) {
+		const CCursorPos &Cursor = Result.Pos;
+		const stChanNote *pNote = &Result.Note;
+		const bool Noise = Cursor.m_iChannel == CHANID_NOISE;
 
-	str.Format(_T("%02X"), pCursor->m_iFrame);
-	m_cListResults->SetItemText(Pos, FRAME, str);
-	str.Format(_T("%02X"), pCursor->m_iRow);
-	m_cListResults->SetItemText(Pos, ROW, str);
+		str.Format(_T("%d"), Pos + 1);
+		m_cListResults->InsertItem(Pos, str);
 
-	switch (pNote->Note) {
-	case NONE:
-		break;
-	case HALT:
-		m_cListResults->SetItemText(Pos, NOTE, _T("---")); break;
-	case RELEASE:
-		m_cListResults->SetItemText(Pos, NOTE, _T("===")); break;
-	case ECHO:
-		str.Format(_T("^-%d"), pNote->Octave);
-		m_cListResults->SetItemText(Pos, NOTE, str); break;
-	default:
-		if (Noise) {
-			str.Format(_T("%X-#"), MIDI_NOTE(pNote->Octave, pNote->Note) & 0x0F);
-			m_cListResults->SetItemText(Pos, NOTE, str);
-		}
-		else
-			m_cListResults->SetItemText(Pos, NOTE, pNote->ToString());
-	}
+		m_cListResults->SetItemText(Pos, CHANNEL, pDoc->GetChannel(Cursor.m_iChannel)->GetChannelName());
+		str.Format(_T("%02X"), pDoc->GetPatternAtFrame(Track, Cursor.m_iFrame, Cursor.m_iChannel));
+		m_cListResults->SetItemText(Pos, PATTERN, str);
 
-	if (pNote->Instrument == HOLD_INSTRUMENT)		// // // 050B
-		m_cListResults->SetItemText(Pos, INST, _T("&&"));
-	else if (pNote->Instrument != MAX_INSTRUMENTS) {
-		str.Format(_T("%02X"), pNote->Instrument);
-		m_cListResults->SetItemText(Pos, INST, str);
-	}
-	if (pNote->Vol != MAX_VOLUME) {
-		str.Format(_T("%X"), pNote->Vol);
-		m_cListResults->SetItemText(Pos, VOL, str);
-	}
+		str.Format(_T("%02X"), Cursor.m_iFrame);
+		m_cListResults->SetItemText(Pos, FRAME, str);
+		str.Format(_T("%02X"), Cursor.m_iRow);
+		m_cListResults->SetItemText(Pos, ROW, str);
+
+		switch (pNote->Note) {
+		case NONE:
+			break;
+		case HALT:
+			m_cListResults->SetItemText(Pos, NOTE, _T("---")); break;
+		case RELEASE:
+			m_cListResults->SetItemText(Pos, NOTE, _T("===")); break;
+		case ECHO:
+			str.Format(_T("^-%d"), pNote->Octave);
+			m_cListResults->SetItemText(Pos, NOTE, str); break;
+		default:
+			if (Noise) {
+				str.Format(_T("%X-#"), MIDI_NOTE(pNote->Octave, pNote->Note) & 0x0F);
+				m_cListResults->SetItemText(Pos, NOTE, str);
+			}
+			else
+				m_cListResults->SetItemText(Pos, NOTE, pNote->ToString());
+		}
 
-	for (int i = 0; i < MAX_EFFECT_COLUMNS; ++i)
-		if (pNote->EffNumber[i] != EF_NONE) {
-			str.Format(_T("%c%02X"), EFF_CHAR[pNote->EffNumber[i]], pNote->EffParam[i]);
-			m_cListResults->SetItemText(Pos, EFFECT + i, str);
+		if (pNote->Instrument == HOLD_INSTRUMENT)		// // // 050B
+			m_cListResults->SetItemText(Pos, INST, _T("&&"));
+		else if (pNote->Instrument != MAX_INSTRUMENTS) {
+			str.Format(_T("%02X"), pNote->Instrument);
+			m_cListResults->SetItemText(Pos, INST, str);
 		}
+		if (pNote->Vol != MAX_VOLUME) {
+			str.Format(_T("%X"), pNote->Vol);
+			m_cListResults->SetItemText(Pos, VOL, str);
+		}
+
+		for (int i = 0; i < MAX_EFFECT_COLUMNS; ++i)
+			if (pNote->EffNumber[i] != EF_NONE) {
+				str.Format(_T("%c%02X"), EFF_CHAR[pNote->EffNumber[i]], pNote->EffParam[i]);
+				m_cListResults->SetItemText(Pos, EFFECT + i, str);
+			}
+
+		++Pos;
+	}
 
 	UpdateCount();
 }
@@ -583,7 +599,9 @@ CFindDlg::CFindDlg(CWnd* pParent /*=NULL*/) : CDialog(CFindDlg::IDD, pParent),
 	m_bFound(false),
 	m_bSkipFirst(true),
 	m_pFindCursor(nullptr),
-	m_iSearchDirection(CFindCursor::direction_t::RIGHT)
+	m_iSearchDirection(CFindCursor::direction_t::RIGHT),
+	m_iEffColumn(4),
+	m_bNegate(false)
 {
 	//memset(&m_searchTerm, 0, sizeof(searchTerm));
 	//memset(&m_replaceTerm, 0, sizeof(replaceTerm));
@@ -1041,11 +1059,12 @@ replaceTerm CFindDlg::toReplace(const searchTerm *x)
 	return Term;
 }
 
-bool CFindDlg::CompareFields(const stChanNote Target, bool Noise, int EffCount)
+bool CFindDlg::CompareFields(const stChanNote &Target, bool Noise, int EffCount) const
 {
-	int EffColumn = m_cEffectColumn->GetCurSel();
+	// // // Must not touch any window, as this is also called from worker threads
+	int EffColumn = m_iEffColumn;
 	if (EffColumn > EffCount && EffColumn != 4) EffColumn = EffCount;
-	bool Negate = IsDlgButtonChecked(IDC_CHECK_FIND_NEGATE) == BST_CHECKED;
+	const bool Negate = m_bNegate;
 	bool EffectMatch = false;
 
 	bool Melodic = m_searchTerm.Note->Min >= NOTE_C && m_searchTerm.Note->Min <= NOTE_B && // ||
@@ -1100,6 +1119,50 @@ bool CFindDlg::CompareFields(const stChanNote Target, bool Noise, int EffCount)
 	return !Negate;
 }
 
+std::vector<std::bitset<MAX_PATTERN_LENGTH>> CFindDlg::MatchPatterns(int Track, const CSelection &Scope) const		// // //
+{
+	// Evaluates the search term on every row of each pattern used by the frames within the scope,
+	// visiting each pattern only once regardless of how many frames refer to it; the results are
+	// indexed by Channel * MAX_PATTERN + Pattern
+	const int Frames = m_pDocument->GetFrameCount(Track);
+	const unsigned int Rows = m_pDocument->GetPatternLength(Track);
+	const int FrameCount = std::max(1, std::min(Scope.m_cpEnd.m_iFrame - Scope.m_cpStart.m_iFrame + 1, Frames));
+
+	std::vector<std::bitset<MAX_PATTERN_LENGTH>> Matches(MAX_CHANNELS * MAX_PATTERN);
+	std::vector<bool> Used(MAX_CHANNELS * MAX_PATTERN, false);
+	std::vector<std::pair<int, int>> Patterns;
+	int EffColumns[MAX_CHANNELS] = { };
+
+	for (int Channel = Scope.m_cpStart.m_iChannel; Channel <= Scope.m_cpEnd.m_iChannel; ++Channel) {
+		EffColumns[Channel] = m_pDocument->GetEffColumns(Track, Channel);
+		for (int i = 0; i < FrameCount; ++i) {
+			int Frame = (Scope.m_cpStart.m_iFrame + i) % Frames;
+			if (Frame < 0) Frame += Frames;
+			const int Pattern = m_pDocument->GetPatternAtFrame(Track, Frame, Channel);
+			if (!Used[Channel * MAX_PATTERN + Pattern]) {
+				Used[Channel * MAX_PATTERN + Pattern] = true;
+				Patterns.emplace_back(Channel, Pattern);
+			}
+		}
+	}
+
+	// Patterns are only read here, the document cannot change until the workers are joined
+	parallel_for(Patterns.size(), [&] (size_t i) {		// // //
+		const int Channel = Patterns[i].first;
+		const int Pattern = Patterns[i].second;
+		const bool Noise = Channel == CHANID_NOISE;
+		auto &Match = Matches[Channel * MAX_PATTERN + Pattern];
+		if (const stChanNote *pRows = m_pDocument->GetPatternRows(Track, Pattern, Channel)) {
+			for (unsigned int Row = 0; Row < Rows; ++Row)
+				Match[Row] = CompareFields(pRows[Row], Noise, EffColumns[Channel]);
+		}
+		else if (CompareFields(stChanNote { }, Noise, EffColumns[Channel]))		// unallocated patterns are empty
+			Match.set();
+	});
+
+	return Matches;
+}
+
 template <typename... T>
 void CFindDlg::RaiseIf(bool Check, LPCTSTR Str, T... args)
 {
@@ -1225,6 +1288,9 @@ bool CFindDlg::PrepareFind()
 		return false;
 	}
 
+	m_iEffColumn = m_cEffectColumn->GetCurSel();		// // //
+	m_bNegate = IsDlgButtonChecked(IDC_CHECK_FIND_NEGATE) == BST_CHECKED;
+
 	return true;
 }
 
@@ -1358,17 +1424,27 @@ void CFindDlg::OnBnClickedButtonFindAll()
 		CFindCursor::direction_t::DOWN : CFindCursor::direction_t::RIGHT;
 
 	PrepareCursor(true);
-	stChanNote Target;
-	m_cResultsBox->SetRedraw(FALSE);
-	m_cResultsBox->ClearResults();
+	CWaitCursor wait;		// // //
+	const auto Matches = MatchPatterns(Track, m_pFindCursor->GetScope());
+	const int Frames = m_pDocument->GetFrameCount(Track);
+
+	// Walk the scope in search order, only looking up the rows matched above
+	std::vector<stFindResult> Results;
 	do {
-		m_pFindCursor->Get(&Target);
-		if (CompareFields(Target, m_pFindCursor->m_iChannel == CHANID_NOISE,
-							m_pDocument->GetEffColumns(Track, m_pFindCursor->m_iChannel)))
-			m_cResultsBox->AddResult(&Target, m_pFindCursor, m_pFindCursor->m_iChannel == CHANID_NOISE);
+		int Frame = m_pFindCursor->m_iFrame % Frames;
+		if (Frame < 0) Frame += Frames;
+		const int Channel = m_pFindCursor->m_iChannel;
+		const int Pattern = m_pDocument->GetPatternAtFrame(Track, Frame, Channel);
+		if (Matches[Channel * MAX_PATTERN + Pattern][m_pFindCursor->m_iRow]) {
+			Results.push_back({*m_pFindCursor, stChanNote { }});
+			m_pFindCursor->Get(&Results.back().Note);
+		}
 		m_pFindCursor->Move(m_iSearchDirection);
 	} while (!m_pFindCursor->AtStart());
 
+	m_cResultsBox->SetRedraw(FALSE);
+	m_cResultsBox->ClearResults();
+	m_cResultsBox->AddResults(Track, Results);
 	m_cResultsBox->SetRedraw();
 	m_cResultsBox->ShowWindow(SW_SHOW);
 	m_cResultsBox->RedrawWindow();
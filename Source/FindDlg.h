@@ -23,6 +23,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <bitset>
 
 #include "PatternNote.h"
 #include "PatternEditorTypes.h"
@@ -118,11 +120,23 @@ public:
 		\return True if the scope contains the cursor itself. */
 	bool Contains() const;
 
+	/*!	\brief Obtains the area that the cursor operates on.
+		\return The normalized scope. */
+	const CSelection &GetScope() const;
+
 private:
 	CCursorPos m_cpBeginPos;
 	const CSelection m_Scope;
 };
 
+// // // A single match of the find all command
+
+struct stFindResult
+{
+	CCursorPos Pos;
+	stChanNote Note;
+};
+
 // Exception for find dialog
 
 class CFindException : public std::runtime_error
@@ -142,7 +156,7 @@ public:
 	
 	virtual void DoDataExchange(CDataExchange* pDX);
 
-	void AddResult(const stChanNote *pNote, const CFindCursor *pCursor, bool Noise) const;
+	void AddResults(int Track, const std::vector<stFindResult> &Results) const;		// // //
 	void ClearResults();
 
 protected:
@@ -204,7 +218,8 @@ protected:
 	void GetFindTerm();
 	void GetReplaceTerm();
 
-	bool CompareFields(const stChanNote Target, bool Noise, int EffCount);
+	bool CompareFields(const stChanNote &Target, bool Noise, int EffCount) const;
+	std::vector<std::bitset<MAX_PATTERN_LENGTH>> MatchPatterns(int Track, const CSelection &Scope) const;		// // //
 
 	template <typename... T>
 	void RaiseIf(bool Check, LPCTSTR Str, T... args);
@@ -229,6 +244,8 @@ protected:
 	searchTerm m_searchTerm;
 	replaceTerm m_replaceTerm;
 	bool m_bFound, m_bSkipFirst, m_bReplacing;
+	int m_iEffColumn;		// // // cached by PrepareFind
+	bool m_bNegate;
 
 	CFindCursor *m_pFindCursor;
 	CFindCursor::direction_t m_iSearchDirection;
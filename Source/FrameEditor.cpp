@@ -40,6 +40,17 @@
 #include "DPI.h"		// // //
 #include "TrackerChannel.h"
 
+namespace {
+
+// // // Appends the bytes of a value to a frame row cache key
+template <typename T>
+void AppendRowKey(std::string &Key, const T &Value)
+{
+	Key.append(reinterpret_cast<const char *>(&Value), sizeof(T));
+}
+
+} // namespace
+
 /*
  * CFrameEditor
  * This is the frame(order) editor to the left in the control panel
@@ -54,6 +65,8 @@ CFrameEditor::CFrameEditor(CMainFrame *pMainFrm) :
 	m_pMainFrame(pMainFrm),
 	m_pDocument(NULL),
 	m_pView(NULL),
+	m_iRowCacheHeight(0),		// // //
+	m_iRowCacheStamp(0),
 	mClipboardFormat(0),
 	m_iChannelView(theApp.GetSettings()->ChannelViewCount),		// // !!
 	m_iMaxChannelView(theApp.GetSettings()->GUI.iMaxChannelView),		// // !!
@@ -313,26 +326,118 @@ void CFrameEditor::DrawFrameEditor(CDC *pDC)
 
 	// Draw rows
 	CBookmarkCollection *pCol = m_pDocument->GetBookmarkManager()->GetCollection(Track);		// // //
-	
+
+	// // // Only channels which intersect the window are drawn
+	const auto ChannelX = [&] (int j) {
+		return DPI::SX(28 + (j * FRAME_ITEM_WIDTH + FRAME_ITEM_WIDTH / 2) - ChannelOffset * FRAME_ITEM_WIDTH);
+	};
+	int ChanFirst = 0;
+	int ChanEnd = ChannelCount;
+	while (ChanFirst < ChanEnd && ChannelX(ChanFirst + 1) <= DPI::SX(ROW_COLUMN_WIDTH - 1))
+		++ChanFirst;
+	while (ChanEnd > ChanFirst && ChannelX(ChanEnd - 1) - DPI::SX(FRAME_ITEM_WIDTH) >= m_iWinWidth)
+		--ChanEnd;
+
+	// // // Rows other than the cursor row are rendered once into the row cache and reused while they look the same
+	PrepareRowCache();
+
+	std::string Context;
+	AppendRowKey(Context, Track);
+	AppendRowKey(Context, ChannelOffset);
+	AppendRowKey(Context, m_iFirstChannel);
+	AppendRowKey(Context, ChanFirst);
+	AppendRowKey(Context, ChanEnd);
+	AppendRowKey(Context, ColBackground);
+	AppendRowKey(Context, ColText);
+	AppendRowKey(Context, ColSelect);
+	AppendRowKey(Context, ColCursor);
+	AppendRowKey(Context, theApp.GetSettings()->Appearance.iColBackgroundHilite);
+	AppendRowKey(Context, theApp.GetSettings()->Appearance.iColCurrentRowPlaying);
+	if (Context != m_strRowCacheContext) {
+		ClearRowCache();
+		m_strRowCacheContext = Context;
+	}
+	++m_iRowCacheStamp;
+
+	const int QueueFrame = theApp.GetSoundGenerator()->GetQueueFrame();
+	const int CursorX = ((ActiveChannel - m_iFirstChannel) * FRAME_ITEM_WIDTH) - ChannelOffset * FRAME_ITEM_WIDTH;		// Cursor box offset
+	const bool bShowPlayFrame = !m_pView->GetFollowMode() && theApp.IsPlaying();
+	std::string Key;
+
 	for (int i = Start; i <= End; ++i) {
 		CRect RowRect = DPI::Rect(0, i * ROW_HEIGHT + 4, m_iWinWidth, ROW_HEIGHT - 1);		// // //
+		const int Top = DPI::SY(i * ROW_HEIGHT + 3);		// // //
+		const int Bottom = DPI::SY((i + 1) * ROW_HEIGHT + 3);
 
+		bool bBookmarked = false;
 		// // // Highlight by bookmarks
 		if (i != m_iMiddleRow) if (const unsigned Count = pCol->GetCount()) for (unsigned j = 0; j < Count; ++j)
 			if (pCol->GetBookmark(j)->m_iFrame == Frame) {
-				GradientBar(&m_dcBack, RowRect, theApp.GetSettings()->Appearance.iColBackgroundHilite, ColBackground);
+				bBookmarked = true;
 				break;
 			}
 
+		const bool bSelectedRow = m_bSelecting && (Frame >= SelectStart) && (Frame <= SelectEnd);
+		const bool bBright = i == m_iHiglightLine || m_iHiglightLine == -1;
+		const COLORREF CurrentColor = bBright ? ColText : ColTextDimmed;
+
+		CDC *pRowDC = &m_dcBack;		// // //
+		int Slot = -1;
+
+		if (i != m_iMiddleRow) {
+			// Everything that affects the look of the row goes into its key
+			Key.clear();
+			AppendRowKey(Key, RowRect.top - Top);
+			AppendRowKey(Key, Bottom - Top);
+			AppendRowKey(Key, static_cast<char>(bBookmarked | (PlayFrame == Frame && bShowPlayFrame) << 1 | (QueueFrame == Frame) << 2 |
+				bSelectedRow << 3 | bBright << 4 | (i == End) << 5 | (i == m_iMiddleRow + 1) << 6));
+			if (bSelectedRow) {
+				AppendRowKey(Key, static_cast<char>((Frame == SelectStart) | (Frame == SelectEnd) << 1));
+				AppendRowKey(Key, CBegin);
+				AppendRowKey(Key, CEnd);
+			}
+			if (i == m_iMiddleRow + 1) {
+				AppendRowKey(Key, RowColor);
+				AppendRowKey(Key, CursorX);
+			}
+			if (i != End) for (int j = ChanFirst; j < ChanEnd; ++j) {
+				int Chan = j + m_iFirstChannel;
+				const unsigned Pattern = m_pDocument->GetPatternAtFrame(Track, Frame, Chan);
+				const bool bCurrent = !m_bLastRow && Pattern == m_pDocument->GetPatternAtFrame(Track, ActiveFrame, Chan) || bSelectedRow;
+				AppendRowKey(Key, static_cast<unsigned char>(Pattern));
+				AppendRowKey(Key, bCurrent);
+			}
+
+			bool bHit;
+			Slot = GetRowCacheSlot(Key, bHit);
+			if (bHit) {
+				m_dcBack.BitBlt(0, Top, m_iWinWidth, Bottom - Top, &m_dcRowCache, 0, Slot * m_iRowCacheHeight, SRCCOPY);
+				++Frame;
+				continue;
+			}
+
+			// Render into the cache slot, using the same coordinates as the back buffer
+			pRowDC = &m_dcRowCache;
+			pRowDC->SetViewportOrg(0, Slot * m_iRowCacheHeight - Top);
+			pRowDC->IntersectClipRect(0, Top, m_iWinWidth, Bottom);
+			pRowDC->FillSolidRect(0, Top, m_iWinWidth, Bottom - Top, ColBackground);
+			if (i == m_iMiddleRow + 1) {
+				// The selected row and the cursor box overlap the first line of the next row
+				GradientBar(pRowDC, DPI::Rect(0, m_iMiddleRow * ROW_HEIGHT + 3, m_iWinWidth, ROW_HEIGHT + 1), RowColor, ColBackground);
+				DrawFrameCursor(pRowDC, CursorX);
+			}
+		}
+
+		if (bBookmarked)
+			GradientBar(pRowDC, RowRect, theApp.GetSettings()->Appearance.iColBackgroundHilite, ColBackground);
+
 		// Play cursor
-		if (PlayFrame == Frame && !m_pView->GetFollowMode() && theApp.IsPlaying())
-			GradientBar(&m_dcBack, RowRect, theApp.GetSettings()->Appearance.iColCurrentRowPlaying, ColBackground);		// // //
+		if (PlayFrame == Frame && bShowPlayFrame)
+			GradientBar(pRowDC, RowRect, theApp.GetSettings()->Appearance.iColCurrentRowPlaying, ColBackground);		// // //
 
 		// Queue cursor
-		if (theApp.GetSoundGenerator()->GetQueueFrame() == Frame)
-			GradientBar(&m_dcBack, RowRect, QUEUE_COLOR, ColBackground);
-
-		bool bSelectedRow = m_bSelecting && (Frame >= SelectStart) && (Frame <= SelectEnd);
+		if (QueueFrame == Frame)
+			GradientBar(pRowDC, RowRect, QUEUE_COLOR, ColBackground);
 
 		// Selection
 		if (bSelectedRow) {//28 + (j * FRAME_ITEM_WIDTH + FRAME_ITEM_WIDTH / 2) 
@@ -340,64 +445,55 @@ void CFrameEditor::DrawFrameEditor(CDC *pDC)
 										i * ROW_HEIGHT + 3, FRAME_ITEM_WIDTH * (CEnd - CBegin + 1), ROW_HEIGHT);		// // !!
 			RowRect.OffsetRect(2, 0);
 			RowRect.InflateRect(1, 0);
-			m_dcBack.FillSolidRect(RowRect, ColSelect);
+			pRowDC->FillSolidRect(RowRect, ColSelect);
 			if (Frame == SelectStart)
-				m_dcBack.FillSolidRect(RowRect.left, RowRect.top, RowRect.Width(), 1, ColSelectEdge);
+				pRowDC->FillSolidRect(RowRect.left, RowRect.top, RowRect.Width(), 1, ColSelectEdge);
 			if (Frame == SelectEnd) 
-				m_dcBack.FillSolidRect(RowRect.left, RowRect.bottom - 1, RowRect.Width(), 1, ColSelectEdge);
-			m_dcBack.FillSolidRect(RowRect.left, RowRect.top, 1, RowRect.Height(), ColSelectEdge);		// // //
-			m_dcBack.FillSolidRect(RowRect.right - 1, RowRect.top, 1, RowRect.Height(), ColSelectEdge);		// // //
+				pRowDC->FillSolidRect(RowRect.left, RowRect.bottom - 1, RowRect.Width(), 1, ColSelectEdge);
+			pRowDC->FillSolidRect(RowRect.left, RowRect.top, 1, RowRect.Height(), ColSelectEdge);		// // //
+			pRowDC->FillSolidRect(RowRect.right - 1, RowRect.top, 1, RowRect.Height(), ColSelectEdge);		// // //
 		}
 
 		if (i == m_iMiddleRow) {
-			// Cursor box w and h
-			int x = ((ActiveChannel - m_iFirstChannel) * FRAME_ITEM_WIDTH) - ChannelOffset * FRAME_ITEM_WIDTH;
-			int y = m_iMiddleRow * ROW_HEIGHT + 3;
-
-			GradientBar(&m_dcBack, DPI::Rect(ROW_COLUMN_WIDTH + 2 + x, y, FRAME_ITEM_WIDTH, ROW_HEIGHT + 1), ColCursor, ColBackground);
-			m_dcBack.Draw3dRect(DPI::Rect(ROW_COLUMN_WIDTH + 2 + x, y, FRAME_ITEM_WIDTH, ROW_HEIGHT + 1), BLEND(ColCursor, 0xFFFFFF, 90), BLEND(ColCursor, ColBackground, 60));
+			DrawFrameCursor(&m_dcBack, CursorX);		// // //
 
 			if (m_bInputEnable && m_bCursor) {
 				// Flashing black box indicating that input is active
-				m_dcBack.FillSolidRect(DPI::Rect(ROW_COLUMN_WIDTH + 4 + x + CURSOR_WIDTH * m_iCursorPos, y + 2, CURSOR_WIDTH, ROW_HEIGHT - 3), ColBackground);
+				m_dcBack.FillSolidRect(DPI::Rect(ROW_COLUMN_WIDTH + 4 + CursorX + CURSOR_WIDTH * m_iCursorPos, m_iMiddleRow * ROW_HEIGHT + 5, CURSOR_WIDTH, ROW_HEIGHT - 3), ColBackground);
 			}
 		}
 
 		if (i == End) {
-			m_dcBack.SetTextColor(ColTextHilite);
-			m_dcBack.TextOut(DPI::SX(3 + FRAME_ITEM_WIDTH / 2), DPI::SY(i * ROW_HEIGHT + 3), _T(">>"));
+			for (int j = ChanFirst; j < ChanEnd; ++j) {		// // //
+				//pRowDC->SetTextColor(CurrentColor);
+				pRowDC->SetTextColor(DIM(CurrentColor, 70));
 
-			COLORREF CurrentColor = (i == m_iHiglightLine || m_iHiglightLine == -1) ? ColText : ColTextDimmed;
-
-			for (int j = 0; j < ChannelCount; ++j) {
-				int Chan = j + m_iFirstChannel;
-
-				//m_dcBack.SetTextColor(CurrentColor);
-				m_dcBack.SetTextColor(DIM(CurrentColor, 70));
-
-				m_dcBack.DrawText(_T("--"), DPI::Rect(28 + (j * FRAME_ITEM_WIDTH + FRAME_ITEM_WIDTH / 2) - ChannelOffset * FRAME_ITEM_WIDTH,
+				pRowDC->DrawText(_T("--"), DPI::Rect(28 + (j * FRAME_ITEM_WIDTH + FRAME_ITEM_WIDTH / 2) - ChannelOffset * FRAME_ITEM_WIDTH,
 					i * ROW_HEIGHT + 3, FRAME_ITEM_WIDTH - 2, 20), DT_LEFT | DT_TOP | DT_NOCLIP);
 			}
 		}
 		else {
-
-			COLORREF CurrentColor = (i == m_iHiglightLine || m_iHiglightLine == -1) ? ColText : ColTextDimmed;
-
-			for (int j = 0; j < ChannelCount; ++j) {
+			for (int j = ChanFirst; j < ChanEnd; ++j) {		// // //
 				int Chan = j + m_iFirstChannel;
 				// Dim patterns that are different from current
 				if (!m_bLastRow && m_pDocument->GetPatternAtFrame(Track, Frame, Chan) == m_pDocument->GetPatternAtFrame(Track, ActiveFrame, Chan)
 								|| bSelectedRow)
-					m_dcBack.SetTextColor(CurrentColor);
+					pRowDC->SetTextColor(CurrentColor);
 				else
-					m_dcBack.SetTextColor(DIM(CurrentColor, 70));
+					pRowDC->SetTextColor(DIM(CurrentColor, 70));
 
 				// Pattern number
-				m_dcBack.DrawText(MakeIntString(m_pDocument->GetPatternAtFrame(Track, Frame, Chan), _T("%02X")),		// // //
+				pRowDC->DrawText(MakeIntString(m_pDocument->GetPatternAtFrame(Track, Frame, Chan), _T("%02X")),		// // //
 					DPI::Rect(28 + (j * FRAME_ITEM_WIDTH + FRAME_ITEM_WIDTH / 2) - ChannelOffset * FRAME_ITEM_WIDTH,
 					i * ROW_HEIGHT + 3, FRAME_ITEM_WIDTH - 2, 20), DT_LEFT | DT_TOP | DT_NOCLIP);
 			}
 		}
+
+		if (Slot != -1) {		// // //
+			pRowDC->SelectClipRgn(NULL);
+			pRowDC->SetViewportOrg(0, 0);
+			m_dcBack.BitBlt(0, Top, m_iWinWidth, Bottom - Top, &m_dcRowCache, 0, Slot * m_iRowCacheHeight, SRCCOPY);
+		}
 		++Frame;
 	}
 	// Channel name bg
@@ -527,6 +623,73 @@ void CFrameEditor::DrawFrameEditor(CDC *pDC)
 	SetScrollPos(SB_HORZ, ActiveChannel);
 }
 
+void CFrameEditor::PrepareRowCache()		// // //
+{
+	// Allocate enough cached rows for two screens, so that a row can always be rendered without evicting
+	// another row of the same paint
+	const int SlotHeight = DPI::SY(ROW_HEIGHT) + 2;
+	const int Slots = 2 * (m_iRowsVisible + 2);
+
+	if (m_bmpRowCache.m_hObject != NULL) {
+		CSize size = m_bmpRowCache.GetBitmapDimension();
+		if (size.cx != m_iWinWidth || size.cy != SlotHeight * Slots) {
+			m_dcRowCache.DeleteDC();
+			m_bmpRowCache.DeleteObject();
+		}
+	}
+
+	if (m_dcRowCache.m_hDC == NULL) {
+		m_bmpRowCache.CreateCompatibleBitmap(&m_dcBack, m_iWinWidth, SlotHeight * Slots);
+		m_bmpRowCache.SetBitmapDimension(m_iWinWidth, SlotHeight * Slots);
+		m_dcRowCache.CreateCompatibleDC(&m_dcBack);
+		m_dcRowCache.SelectObject(&m_bmpRowCache);
+		m_dcRowCache.SelectObject(&m_Font);
+		m_dcRowCache.SetBkMode(TRANSPARENT);
+		m_dcRowCache.SetTextAlign(TA_CENTER);
+		m_iRowCacheHeight = SlotHeight;
+		m_RowCacheKeys.assign(Slots, std::string());
+		ClearRowCache();
+	}
+}
+
+void CFrameEditor::ClearRowCache()		// // //
+{
+	m_RowCacheMap.clear();
+	std::fill(m_RowCacheKeys.begin(), m_RowCacheKeys.end(), std::string());
+	m_RowCacheStamps.assign(m_RowCacheKeys.size(), 0U);
+}
+
+int CFrameEditor::GetRowCacheSlot(const std::string &Key, bool &bHit)		// // //
+{
+	// Returns the cache slot of a row, on a miss the least recently used slot is assigned to it
+	auto it = m_RowCacheMap.find(Key);
+	if (it != m_RowCacheMap.end()) {
+		bHit = true;
+		m_RowCacheStamps[it->second] = m_iRowCacheStamp;
+		return it->second;
+	}
+
+	bHit = false;
+	const int Slot = std::min_element(m_RowCacheStamps.begin(), m_RowCacheStamps.end()) - m_RowCacheStamps.begin();
+	if (!m_RowCacheKeys[Slot].empty())
+		m_RowCacheMap.erase(m_RowCacheKeys[Slot]);
+	m_RowCacheKeys[Slot] = Key;
+	m_RowCacheMap[Key] = Slot;
+	m_RowCacheStamps[Slot] = m_iRowCacheStamp;
+	return Slot;
+}
+
+void CFrameEditor::DrawFrameCursor(CDC *pDC, int x) const		// // //
+{
+	// Cursor box w and h
+	const COLORREF ColBackground = theApp.GetSettings()->Appearance.iColBackground;
+	const COLORREF ColCursor = theApp.GetSettings()->Appearance.iColCursor;
+	const int y = m_iMiddleRow * ROW_HEIGHT + 3;
+
+	GradientBar(pDC, DPI::Rect(ROW_COLUMN_WIDTH + 2 + x, y, FRAME_ITEM_WIDTH, ROW_HEIGHT + 1), ColCursor, ColBackground);
+	pDC->Draw3dRect(DPI::Rect(ROW_COLUMN_WIDTH + 2 + x, y, FRAME_ITEM_WIDTH, ROW_HEIGHT + 1), BLEND(ColCursor, 0xFFFFFF, 90), BLEND(ColCursor, ColBackground, 60));
+}
+
 void CFrameEditor::SetupColors()
 {
 	// Color scheme has changed
@@ -21,6 +21,9 @@
 #pragma once
 
 #include "FrameEditorTypes.h"		// // //
+#include <string>		// // //
+#include <vector>
+#include <unordered_map>
 
 class CFamiTrackerDoc;
 class CFamiTrackerView;
@@ -112,6 +115,12 @@ private:
 	// Drawing
 	void DrawFrameEditor(CDC *pDC);
 	bool NeedUpdate() const;
+	void DrawFrameCursor(CDC *pDC, int x) const;		// // //
+
+	// // // Row cache
+	void PrepareRowCache();
+	void ClearRowCache();
+	int GetRowCacheSlot(const std::string &Key, bool &bHit);
 
 	// Translation
 	int GetChannelOffset() const;		// // !!
@@ -157,6 +166,16 @@ private:
 	CBitmap m_bmpBack;
 	CDC		m_dcBack;
 
+	// // // Rendered frame rows, one slot of m_iRowCacheHeight pixels per row
+	CBitmap m_bmpRowCache;
+	CDC		m_dcRowCache;
+	int		m_iRowCacheHeight;
+	unsigned m_iRowCacheStamp;						// Incremented on every redraw
+	std::string m_strRowCacheContext;				// Drawing parameters shared by all cached rows
+	std::unordered_map<std::string, int> m_RowCacheMap;	// Row key to slot
+	std::vector<std::string> m_RowCacheKeys;		// Row key of each slot
+	std::vector<unsigned> m_RowCacheStamps;			// Redraw in which each slot was last used
+
 	UINT	mClipboardFormat;
 
 	// Window size
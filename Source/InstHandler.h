@@ -25,6 +25,7 @@
 
 class CChannelHandlerInterface;
 class CInstrument;
+class CSequence;
 
 /*!
 	\brief Base class for instrument handlers.
@@ -69,6 +70,13 @@ public:
 		\details The method does not specify whether a note can be released for multiple times until
 		another new note is triggered. */
 	virtual void ReleaseInstrument() = 0;
+	/*!	\brief Obtains the play position of a sequence after the last tick.
+		\details Sound generators query this once per frame for the sequence editor, instead of
+		having every instrument handler report its position on each tick.
+		\param pSequence Pointer to the sequence.
+		\param Pos Receives the current item index, or -1 if the sequence has just finished.
+		\return Whether the sequence was run by this instrument handler during the last tick. */
+	virtual bool GetSequencePlayPos(const CSequence *pSequence, int &Pos) const { return false; }
 
 protected:
 	/*!	\brief An interface to the underlying channel handler.
@@ -394,12 +394,13 @@ void CInstrumentEditorDPCM::OnNMClickSampleList(NMHDR *pNMHDR, LRESULT *pResult)
 void CInstrumentEditorDPCM::OnBnClickedImport()
 {
 	CPCMImport	ImportDialog;
-	CDSample	*pImported;
 
-	if (!(pImported = ImportDialog.ShowDialog()))
+	std::vector<CDSample *> Imported = ImportDialog.ShowDialog();
+	if (Imported.empty())
 		return;
 
-	InsertSample(pImported);
+	for (CDSample *pImported : Imported)
+		InsertSample(pImported);
 	BuildSampleList();
 }
 
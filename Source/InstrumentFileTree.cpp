@@ -18,17 +18,147 @@
 ** along with this program. If not, see https://www.gnu.org/licenses/.
 */
 
+
 // The instrument file tree, used in the instrument toolbar to quickly load an instrument
+// The library is scanned on a worker thread and the result is kept in a small
+// on-disk index, so that the menu can be shown immediately and refreshed later
 
 #include "stdafx.h"
 #include "InstrumentFileTree.h"
+#include "Instrument.h"
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+const DWORD INDEX_MAGIC = 0x49494E44;	// "DNII"
+const DWORD INDEX_VERSION = 1;
+
+using entry_map_t = std::unordered_map<std::string, const stInstrumentIndexEntry *>;
+
+LPCTSTR GetInstrumentChipName(int Type)
+{
+	switch (Type) {
+	case INST_2A03: return _T("2A03");
+	case INST_VRC6: return _T("VRC6");
+	case INST_VRC7: return _T("VRC7");
+	case INST_FDS:  return _T("FDS");
+	case INST_N163: return _T("N163");
+	case INST_S5B:  return _T("5B");
+	}
+	return nullptr;
+}
+
+// Reads the instrument type and name from the header of an .fti file
+void ReadInstrumentHeader(const CString &path, stInstrumentIndexEntry &Entry)
+{
+	Entry.InstType = INST_NONE;
+	Entry.InstName.Empty();
+
+	CFile file;
+	if (!file.Open(path, CFile::modeRead | CFile::shareDenyWrite))
+		return;
+
+	// "FTI", version, type, name length, name
+	char Header[11 + CInstrument::INST_NAME_MAX] = { };
+	UINT Size = 0;
+	try {
+		Size = file.Read(Header, sizeof(Header));
+	}
+	catch (CFileException *e) {
+		e->Delete();
+		return;
+	}
+
+	if (Size < 11 || memcmp(Header, "FTI", 3) != 0)
+		return;
+
+	Entry.InstType = Header[6] == INST_NONE ? INST_2A03 : Header[6];
+	int NameLen;
+	memcpy(&NameLen, Header + 7, sizeof(NameLen));
+	if (NameLen >= 0 && NameLen <= CInstrument::INST_NAME_MAX && 11 + static_cast<UINT>(NameLen) <= Size)
+		Entry.InstName = CString(Header + 11, NameLen);
+}
+
+ULONGLONG GetWriteTime(const CFileFind &finder)
+{
+	FILETIME Time;
+	finder.GetLastWriteTime(&Time);
+	return (static_cast<ULONGLONG>(Time.dwHighDateTime) << 32) | Time.dwLowDateTime;
+}
+
+bool ScanDirectory(const CString &path, const CString &relPath, int level, stInstrumentIndex &Index,
+				   const entry_map_t &Previous, int &menus, const std::atomic<bool> &cancel)
+{
+	CFileFind fileFinder;
+	bool bNoFile = true;
+
+	if (level > CInstrumentFileTree::RECURSION_LIMIT || cancel)
+		return false;
+
+	BOOL working = fileFinder.FindFile(path + _T("\\*.*"));
+
+	// First scan directories
+	while (working) {
+		working = fileFinder.FindNextFile();
 
-CInstrumentFileTree::CInstrumentFileTree() : m_pRootMenu(NULL), m_iFileIndex(0), m_bShouldRebuild(true)
+		if (fileFinder.IsDirectory() && !fileFinder.IsHidden() && !fileFinder.IsDots() && menus++ < CInstrumentFileTree::MAX_MENUS) {
+			stInstrumentIndexEntry Dir;
+			Dir.Name = fileFinder.GetFileName();
+			Dir.Depth = level;
+			Dir.IsDirectory = true;
+			Index.Entries.push_back(Dir);
+			// Recursive scan
+			ScanDirectory(path + _T("\\") + Dir.Name, relPath + Dir.Name + _T("\\"), level + 1, Index, Previous, menus, cancel);
+			bNoFile = false;
+		}
+	}
+
+	working = fileFinder.FindFile(path + _T("\\*.fti"));
+
+	// Then files, only reading those that changed since the last scan
+	while (working && !cancel) {
+		working = fileFinder.FindNextFile();
+
+		stInstrumentIndexEntry File;
+		File.Name = fileFinder.GetFileName();
+		File.Depth = level;
+		File.WriteTime = GetWriteTime(fileFinder);
+		File.Size = fileFinder.GetLength();
+
+		auto it = Previous.find(std::string(static_cast<LPCTSTR>(relPath + File.Name)));
+		if (it != Previous.end() && it->second->WriteTime == File.WriteTime && it->second->Size == File.Size) {
+			File.InstType = it->second->InstType;
+			File.InstName = it->second->InstName;
+		}
+		else
+			ReadInstrumentHeader(path + _T("\\") + File.Name, File);
+
+		Index.Entries.push_back(File);
+		bNoFile = false;
+	}
+
+	return !bNoFile;
+}
+
+} // namespace
+
+CInstrumentFileTree::CInstrumentFileTree() :
+	m_pRootMenu(NULL),
+	m_iFileIndex(0),
+	m_iTimeout(0),
+	m_bShouldRebuild(true),
+	m_iTotalMenusAdded(0),
+	m_bRescanPending(false),
+	m_bScanning(false),
+	m_bCancelScan(false),
+	m_bIndexUpdated(false)
 {
 }
 
 CInstrumentFileTree::~CInstrumentFileTree()
 {
+	StopScan();
 	DeleteMenuObjects();
 }
 
@@ -60,7 +190,7 @@ void CInstrumentFileTree::Changed()
 bool CInstrumentFileTree::ShouldRebuild() const
 {
 	// Check if tree expired, to allow changes in the file system to be visible
-	return (GetTickCount() > m_iTimeout) || m_bShouldRebuild;
+	return (GetTickCount() > m_iTimeout) || m_bShouldRebuild || m_bIndexUpdated;
 }
 
 bool CInstrumentFileTree::BuildMenuTree(CString instrumentPath)
@@ -85,19 +215,45 @@ bool CInstrumentFileTree::BuildMenuTree(CString instrumentPath)
 		m_pRootMenu->AppendMenu(MF_STRING | MF_DISABLED, MENU_BASE + 2, _T("(select a directory)"));
 	}
 	else {
+		if (instrumentPath != m_strIndexRoot) {
+			// Another library, start from its saved index if there is one
+			StopScan();
+			m_strIndexRoot = instrumentPath;
+			auto pIndex = LoadIndex(instrumentPath);
+			std::lock_guard<std::mutex> lock(m_IndexMutex);
+			m_pIndex = std::move(pIndex);
+			m_bShouldRebuild = true;
+		}
+
+		if (m_bShouldRebuild || GetTickCount() > m_iTimeout) {
+			StartScan(instrumentPath);
+			m_iTimeout = GetTickCount() + CACHE_TIMEOUT;
+			m_bShouldRebuild = false;
+		}
+
+		m_bIndexUpdated = false;
+		auto pIndex = GetIndex();
+		if (!pIndex) {
+			// Nothing to show yet, give small libraries a chance to finish scanning
+			std::unique_lock<std::mutex> lock(m_IndexMutex);
+			m_ScanDone.wait_for(lock, std::chrono::milliseconds(FIRST_SCAN_WAIT), [&] { return !m_bScanning; });
+			m_bIndexUpdated = false;
+			pIndex = m_pIndex;
+		}
+
 		m_iFileIndex = 2;
+		if (pIndex)
+			BuildMenus(*pIndex);
 
-		if (!ScanDirectory(instrumentPath, m_pRootMenu, 0)) {
+		if (pIndex == nullptr || pIndex->Entries.empty()) {
 			// No files found
-			m_pRootMenu->AppendMenu(MF_STRING | MF_DISABLED, MENU_BASE + 2, _T("(no files found)"));
-			m_bShouldRebuild = true;
+			m_pRootMenu->AppendMenu(MF_STRING | MF_DISABLED, MENU_BASE + 2, m_bScanning ? _T("(scanning...)") : _T("(no files found)"));
+			if (!m_bScanning)
+				m_bShouldRebuild = true;
 		}
 		else {
 			m_fileList.FreeExtra();
 			m_menuArray.FreeExtra();
-
-			m_iTimeout = GetTickCount() + CACHE_TIMEOUT;
-			m_bShouldRebuild = false;
 		}
 	}
 
@@ -106,47 +262,200 @@ bool CInstrumentFileTree::BuildMenuTree(CString instrumentPath)
 	return true;
 }
 
-bool CInstrumentFileTree::ScanDirectory(CString path, CMenu *pMenu, int level)
+void CInstrumentFileTree::BuildMenus(const stInstrumentIndex &Index)
 {
-	CFileFind fileFinder;
-	bool bNoFile = true;
-
-	if (level > RECURSION_LIMIT)
-		return false;
+	// Entries are in scan order: each directory is followed by its contents
+	std::vector<CMenu *> Menus { m_pRootMenu };
+	CString Dir = Index.Root + _T("\\");
+	std::vector<int> DirLength { Dir.GetLength() };
 
-	BOOL working = fileFinder.FindFile(path + _T("\\*.*"));
-
-	// First scan directories
-	while (working) {
-		working = fileFinder.FindNextFile();
+	const auto &Entries = Index.Entries;
+	for (std::size_t i = 0; i < Entries.size(); ++i) {
+		const auto &Entry = Entries[i];
+		if (Entry.Depth >= static_cast<int>(Menus.size()))		// parent was skipped
+			continue;
+		Menus.resize(Entry.Depth + 1);
+		DirLength.resize(Entry.Depth + 1);
+		Dir.Truncate(DirLength.back());
+		CMenu *pMenu = Menus.back();
 
-		if (fileFinder.IsDirectory() && !fileFinder.IsHidden() && !fileFinder.IsDots() && m_iTotalMenusAdded++ < MAX_MENUS) {
+		if (Entry.IsDirectory) {
 			CMenu *pSubMenu = new CMenu();
 			m_menuArray.Add(pSubMenu);
+			++m_iTotalMenusAdded;
 			pSubMenu->CreatePopupMenu();
-			// Recursive scan
-			bool bDisabled = false;
-			if (!ScanDirectory(path + _T("\\") + fileFinder.GetFileName(), pSubMenu, level + 1))
-				bDisabled = true;
-			pMenu->AppendMenuA(MF_STRING | MF_POPUP | (bDisabled ? MF_DISABLED : MF_ENABLED), reinterpret_cast<UINT_PTR>(pSubMenu->m_hMenu), fileFinder.GetFileName());
-			bNoFile = false;
+			bool bDisabled = i + 1 == Entries.size() || Entries[i + 1].Depth <= Entry.Depth;
+			pMenu->AppendMenu(MF_STRING | MF_POPUP | (bDisabled ? MF_DISABLED : MF_ENABLED), reinterpret_cast<UINT_PTR>(pSubMenu->m_hMenu), Entry.Name);
+			Menus.push_back(pSubMenu);
+			Dir += Entry.Name + _T("\\");
+			DirLength.push_back(Dir.GetLength());
+		}
+		else {
+			CString Text = Entry.Name;
+			int Ext = Text.ReverseFind('.');
+			if (Ext > 0)
+				Text.Truncate(Ext);
+			if (LPCTSTR Chip = GetInstrumentChipName(Entry.InstType))
+				Text += CString(_T("\t")) + Chip;
+			pMenu->AppendMenu(MF_STRING | MF_ENABLED, MENU_BASE + m_iFileIndex++, Text);
+			m_fileList.Add(Dir + Entry.Name);
 		}
 	}
+}
 
-	working = fileFinder.FindFile(path + _T("\\*.fti"));
+CMenu *CInstrumentFileTree::GetMenu() const
+{
+	return m_pRootMenu;
+}
 
-	// Then files
-	while (working) {
-		working = fileFinder.FindNextFile();
-		pMenu->AppendMenu(MF_STRING | MF_ENABLED, MENU_BASE + m_iFileIndex++, fileFinder.GetFileTitle());
-		m_fileList.Add(path + _T("\\") + fileFinder.GetFileName());
-		bNoFile = false;
+std::shared_ptr<const stInstrumentIndex> CInstrumentFileTree::GetIndex() const
+{
+	std::lock_guard<std::mutex> lock(m_IndexMutex);
+	return m_pIndex;
+}
+
+void CInstrumentFileTree::StartScan(const CString &path)
+{
+	{
+		// The running scan may have missed the change, let it scan once more
+		std::lock_guard<std::mutex> lock(m_IndexMutex);
+		if (m_bScanning) {
+			m_bRescanPending = true;
+			return;
+		}
 	}
+	if (m_ScanThread.joinable())
+		m_ScanThread.join();
 
-	return !bNoFile;
+	m_bCancelScan = false;
+	m_bScanning = true;
+	m_ScanThread = std::thread(&CInstrumentFileTree::ScanThread, this, path, GetIndex());
 }
 
-CMenu *CInstrumentFileTree::GetMenu() const
+void CInstrumentFileTree::StopScan()
 {
-	return m_pRootMenu;
+	m_bCancelScan = true;
+	if (m_ScanThread.joinable())
+		m_ScanThread.join();
+	m_bScanning = false;
+	m_bRescanPending = false;
+}
+
+void CInstrumentFileTree::ScanThread(CString path, std::shared_ptr<const stInstrumentIndex> pPrevious)
+{
+	while (true) {
+		ScanLibrary(path, pPrevious);
+
+		std::lock_guard<std::mutex> lock(m_IndexMutex);
+		if (!m_bRescanPending || m_bCancelScan) {
+			m_bScanning = false;
+			m_ScanDone.notify_all();
+			return;
+		}
+		m_bRescanPending = false;
+		pPrevious = m_pIndex;
+	}
+}
+
+void CInstrumentFileTree::ScanLibrary(const CString &path, std::shared_ptr<const stInstrumentIndex> pPrevious)
+{
+	TRACE("Scanning instrument library %s\n", (LPCTSTR)path);
+
+	// Files are looked up by their path relative to the library root
+	entry_map_t Previous;
+	if (pPrevious) {
+		std::vector<CString> Dirs;
+		for (const auto &Entry : pPrevious->Entries) {
+			Dirs.resize(Entry.Depth);
+			if (Entry.IsDirectory)
+				Dirs.push_back(Entry.Name);
+			else {
+				CString Rel;
+				for (const auto &Dir : Dirs)
+					Rel += Dir + _T("\\");
+				Previous.emplace(std::string(static_cast<LPCTSTR>(Rel + Entry.Name)), &Entry);
+			}
+		}
+	}
+
+	auto pIndex = std::make_shared<stInstrumentIndex>();
+	pIndex->Root = path;
+	int Menus = 0;
+	ScanDirectory(path, _T(""), 0, *pIndex, Previous, Menus, m_bCancelScan);
+
+	if (!m_bCancelScan) {
+		{
+			std::lock_guard<std::mutex> lock(m_IndexMutex);
+			m_pIndex = pIndex;
+			m_bIndexUpdated = true;
+		}
+		SaveIndex(*pIndex);
+	}
+}
+
+CString CInstrumentFileTree::GetIndexFilePath()
+{
+	TCHAR Path[MAX_PATH];
+	if (FAILED(SHGetFolderPath(NULL, CSIDL_LOCAL_APPDATA | CSIDL_FLAG_CREATE, NULL, SHGFP_TYPE_CURRENT, Path)))
+		return _T("");
+
+	CString Dir = CString(Path) + _T("\\" APP_NAME);
+	CreateDirectory(Dir, NULL);
+	return Dir + _T("\\InstrumentIndex.dat");
+}
+
+std::shared_ptr<const stInstrumentIndex> CInstrumentFileTree::LoadIndex(const CString &path)
+{
+	CString IndexPath = GetIndexFilePath();
+	CFile file;
+	if (IndexPath.IsEmpty() || !file.Open(IndexPath, CFile::modeRead | CFile::shareDenyWrite))
+		return nullptr;
+
+	CArchive ar(&file, CArchive::load);
+	try {
+		DWORD Magic, Version, Count;
+		CString Root;
+		ar >> Magic >> Version;
+		if (Magic != INDEX_MAGIC || Version != INDEX_VERSION)
+			return nullptr;
+		ar >> Root >> Count;
+		if (Root.CompareNoCase(path) != 0 || Count > static_cast<DWORD>(file.GetLength()))
+			return nullptr;
+
+		auto pIndex = std::make_shared<stInstrumentIndex>();
+		pIndex->Root = path;
+		pIndex->Entries.resize(Count);
+		for (auto &Entry : pIndex->Entries) {
+			BYTE IsDirectory;
+			ar >> Entry.Name >> Entry.Depth >> IsDirectory >> Entry.WriteTime >> Entry.Size >> Entry.InstType >> Entry.InstName;
+			Entry.IsDirectory = IsDirectory != 0;
+		}
+		TRACE("Loaded instrument index with %u entries\n", Count);
+		return pIndex;
+	}
+	catch (CException *e) {
+		ar.Abort();
+		e->Delete();
+		return nullptr;
+	}
+}
+
+void CInstrumentFileTree::SaveIndex(const stInstrumentIndex &Index)
+{
+	CString IndexPath = GetIndexFilePath();
+	CFile file;
+	if (IndexPath.IsEmpty() || !file.Open(IndexPath, CFile::modeCreate | CFile::modeWrite | CFile::shareExclusive))
+		return;
+
+	CArchive ar(&file, CArchive::store);
+	try {
+		ar << INDEX_MAGIC << INDEX_VERSION << Index.Root << static_cast<DWORD>(Index.Entries.size());
+		for (const auto &Entry : Index.Entries)
+			ar << Entry.Name << Entry.Depth << static_cast<BYTE>(Entry.IsDirectory) << Entry.WriteTime << Entry.Size << Entry.InstType << Entry.InstName;
+		ar.Close();
+	}
+	catch (CException *e) {
+		ar.Abort();
+		e->Delete();
+	}
 }
@@ -20,6 +20,31 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One directory or instrument file of the instrument library, in scan order
+struct stInstrumentIndexEntry
+{
+	CString Name;				// directory name or file name
+	int Depth = 0;				// nesting level below the library root
+	bool IsDirectory = false;
+	ULONGLONG WriteTime = 0;
+	ULONGLONG Size = 0;
+	int InstType = 0;			// inst_type_t, INST_NONE if the file could not be read
+	CString InstName;
+};
+
+// Flattened snapshot of a scanned instrument library
+struct stInstrumentIndex
+{
+	CString Root;
+	std::vector<stInstrumentIndexEntry> Entries;
+};
 
 // CInstrumentFileTree
 
@@ -43,11 +68,22 @@ public:
 	static const int MENU_BASE = 0x9000;	// Choose a range where no strings are located
 
 	static const int CACHE_TIMEOUT = 60000;	// 1 minute
+	static const int FIRST_SCAN_WAIT = 500;	// Time to wait for a scan when nothing is indexed yet
 
 protected:
-	bool ScanDirectory(CString path, CMenu *pMenu, int level);
+	void BuildMenus(const stInstrumentIndex &Index);
 	void DeleteMenuObjects();
 
+	std::shared_ptr<const stInstrumentIndex> GetIndex() const;
+	void StartScan(const CString &path);
+	void StopScan();
+	void ScanThread(CString path, std::shared_ptr<const stInstrumentIndex> pPrevious);
+	void ScanLibrary(const CString &path, std::shared_ptr<const stInstrumentIndex> pPrevious);
+
+	static CString GetIndexFilePath();
+	static std::shared_ptr<const stInstrumentIndex> LoadIndex(const CString &path);
+	static void SaveIndex(const stInstrumentIndex &Index);
+
 private:
 	CMenu *m_pRootMenu;
 	int m_iFileIndex;
@@ -56,4 +92,15 @@ private:
 	DWORD m_iTimeout;
 	bool m_bShouldRebuild;
 	int m_iTotalMenusAdded;
+
+	// Background indexer
+	CString m_strIndexRoot;
+	std::shared_ptr<const stInstrumentIndex> m_pIndex;		// guarded by m_IndexMutex
+	bool m_bRescanPending;		// guarded by m_IndexMutex, scan again when the current scan ends
+	mutable std::mutex m_IndexMutex;
+	std::condition_variable m_ScanDone;
+	std::thread m_ScanThread;
+	std::atomic<bool> m_bScanning;
+	std::atomic<bool> m_bCancelScan;
+	std::atomic<bool> m_bIndexUpdated;
 };
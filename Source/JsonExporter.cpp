@@ -43,6 +43,8 @@
 #include "InstrumentFactory.h"
 
 #include <optional>
+#include <string_view>
+#include <vector>
 
 #define DEBUG_OUT(...) { CString s__; s__.Format(__VA_ARGS__); OutputDebugString(s__); }
 
@@ -241,17 +243,6 @@ void to_json(json& j, const CDSample& dpcm) {
 	}
 }
 
-void to_json(json& j, const CDSampleManager& dmanager) {
-	j = json::array();
-	for (unsigned i = 0; i < MAX_DSAMPLES; ++i) {
-		if (const CDSample* sample = dmanager.GetDSample(i)) {
-			json dj = json(*sample);
-			dj["index"] = i;
-			j.push_back(std::move(dj));
-		}
-	}
-}
-
 namespace {
 
 	void to_json_common(json& j, const CInstrument& inst) {
@@ -381,141 +372,228 @@ void to_json(json& j, const CGroove& groove) {
 		j["values"].push_back(groove.GetEntry(i));
 }
 
-// TODO: compartmentalize all blocks within their own subclass?
-void to_json(json& j, const CFamiTrackerDoc& modfile) {
-
-	const auto GenerateChannelSubindex = [&](CTrackerChannel* ch, auto &chip_type, auto &subindex) {
-		chip_type = ch->GetChip();
-		subindex = ch->GetID();
-
-		switch (chip_type) {	// see chan_id_t
-			case SNDCHIP_VRC6: subindex -= CHANID_VRC6_PULSE1; break;
-			case SNDCHIP_MMC5: subindex -= CHANID_MMC5_SQUARE1; break;
-			case SNDCHIP_N163: subindex -= CHANID_N163_CH1; break;
-			case SNDCHIP_FDS: subindex -= CHANID_FDS; break;
-			case SNDCHIP_VRC7: subindex -= CHANID_VRC7_CH1; break;
-			case SNDCHIP_S5B: subindex -= CHANID_S5B_CH1; break;
-			default: break;
+namespace {
+
+// Writes a JSON document to a file incrementally, one value at a time, so
+// that only the value currently being emitted has to exist as a json DOM.
+// Output is identical to json::dump() of the equivalent tree, provided that
+// object keys are written in sorted order like nlohmann::json's std::map.
+class CJsonStreamWriter
+{
+public:
+	explicit CJsonStreamWriter(CFile &File) : m_File(File) {
+		m_Buffer.reserve(FLUSH_SIZE + 0x1000);
+	}
+	~CJsonStreamWriter() {
+		ASSERT(m_Scopes.empty());
+	}
+
+	void BeginObject() {
+		Open('{');
+	}
+	void EndObject() {
+		Close('}');
+	}
+	void BeginArray() {
+		Open('[');
+	}
+	void EndArray() {
+		Close(']');
+	}
+
+	void Key(std::string_view Name) {
+		Separate();
+		m_Buffer += json(Name).dump();
+		m_Buffer += ':';
+		m_bAfterKey = true;
+	}
+
+	void Value(const json &j) {
+		Separate();
+		m_Buffer += j.dump();
+		FlushIfFull();
+	}
+
+	template <typename T>
+	void Field(std::string_view Name, const T &v) {
+		Key(Name);
+		Value(json(v));
+	}
+
+	void Flush() {
+		if (!m_Buffer.empty()) {
+			m_File.Write(m_Buffer.data(), static_cast<UINT>(m_Buffer.size()));
+			m_Buffer.clear();
 		}
-	};
+	}
 
-	j = json{
-		{"_dn_famitracker_module_version", CDocumentFile::FILE_VER},
-		{"_json_export_version", JSON_VER},
-		{"metadata", {
-			{"title", std::string {modfile.GetSongName()}},
-			{"artist", std::string {modfile.GetSongArtist()}},
-			{"copyright", std::string {modfile.GetSongCopyright()}},
-			{"comment", std::string {modfile.GetComment()}},
-			{"show_comment_on_open", modfile.ShowCommentOnOpen()},
-		}},
-		{"global", {
-			{"machine", modfile.GetMachine() == machine_t::PAL ? "pal" : "ntsc"},
-			{"engine_speed", modfile.GetEngineSpeed()},
-			{"vibrato_style", modfile.GetVibratoStyle() == vibrato_t::VIBRATO_OLD ? "old" : "new"},
-			{"linear_pitch", modfile.GetLinearPitch()},
-			{"fxx_split_point", modfile.GetSpeedSplitPoint()},
-			{"detune", {
-				{"semitones", modfile.GetTuningSemitone()},
-				{"cents", modfile.GetTuningCent()},
-			}},
-			{ "optional_json_data", modfile.InterfaceToOptionalJSON() },
-			{ "emulation_parameters", json::array() },
-		}},
-		{"channels", json::array()},
-		{"songs", json::array()},
-		{"instruments", json::array()},
-		{"sequences", json::array()},
-		{"dpcm_samples", json(*modfile.GetInstrumentManager()->GetDSampleManager())},
-		{"detunes", json::array()},
-		{"grooves", json::array()},
-	};
+private:
+	void Separate() {
+		if (m_bAfterKey)
+			m_bAfterKey = false;
+		else if (!m_Scopes.empty()) {
+			if (!m_Scopes.back())
+				m_Buffer += ',';
+			m_Scopes.back() = false;
+		}
+	}
 
-	// CSongData
-	for (unsigned int Track = 0; Track < modfile.GetTrackCount(); ++Track)
-	{
-		auto sj = json{
-			{"speed", modfile.GetSongSpeed(Track)},
-			{"tempo", modfile.GetSongTempo(Track)},
-			{"frames", modfile.GetFrameCount(Track)},
-			{"rows", modfile.GetPatternLength(Track)},
-			{"title", std::string {modfile.GetTrackTitle(Track)}},
-			{"uses_groove", modfile.GetSongGroove(Track)},
-			{"tracks", json::array()},
-			{"highlight", json(modfile.GetHighlight()) },
-			{"bookmarks", json(*modfile.GetBookmarkManager()->GetCollection(Track))},
-		};
+	void Open(char c) {
+		Separate();
+		m_Buffer += c;
+		m_Scopes.push_back(true);
+	}
 
-		// TODO
-		for (int Channel = 0; Channel < modfile.GetChannelCount(); ++Channel)
-		{
-			CTrackerChannel* ch = modfile.GetChannel(Channel);
-			uint8_t chip_type;
-			uint8_t subindex;
-			GenerateChannelSubindex(ch, chip_type, subindex);
-
-			// CTrackData
-			json cj = json{
-				{ "frame_list", json::array() },
-				{ "patterns", json::array() },
-				{ "effect_columns", (modfile.GetEffColumns(Track, Channel)+1) },		// off-by-one
-				{ "chip", GetChannelChipName(chip_type) },
-				{ "subindex", subindex },
-			};
-
-			for (unsigned int Frame = 0; Frame < modfile.GetFrameCount(Track); ++Frame)
-			{
-				cj["frame_list"].push_back(modfile.GetPatternAtFrame(Track, Frame, Channel));
-			}
+	void Close(char c) {
+		ASSERT(!m_Scopes.empty() && !m_bAfterKey);
+		m_Scopes.pop_back();
+		m_Buffer += c;
+		FlushIfFull();
+	}
 
-			// TODO
-			for (unsigned int Pattern = 0; Pattern < MAX_PATTERN; ++Pattern)
-			{
-				// TODO
-				json pj = json {
-					{"index", Pattern},
-					{"notes", json::array()}
-				};
-				int notes = 0;
-				for (unsigned int row = 0; row < modfile.GetPatternLength(Track); ++row)
-				{
-					stChanNote note;
-					modfile.GetDataAtPattern(Track, Pattern, Channel, row, &note);
-					if (note != stChanNote{}) {
-						notes++;
-						json jn;
-						to_json(jn, note);
-						pj["notes"].push_back(json{
-							{"row", row},
-							{"note", jn},
-						});
-					}
-				}
+	void FlushIfFull() {
+		if (m_Buffer.size() >= FLUSH_SIZE)
+			Flush();
+	}
 
-				if (notes > 0) {
-					cj["patterns"].push_back(std::move(pj));
-				}
+private:
+	static constexpr std::size_t FLUSH_SIZE = 0x10000;
+
+	CFile &m_File;
+	std::string m_Buffer;
+	std::vector<bool> m_Scopes;		// true until the first element of each open container
+	bool m_bAfterKey = false;
+};
+
+void GenerateChannelSubindex(const CTrackerChannel *ch, uint8_t &chip_type, uint8_t &subindex) {
+	chip_type = ch->GetChip();
+	subindex = ch->GetID();
+
+	switch (chip_type) {	// see chan_id_t
+		case SNDCHIP_VRC6: subindex -= CHANID_VRC6_PULSE1; break;
+		case SNDCHIP_MMC5: subindex -= CHANID_MMC5_SQUARE1; break;
+		case SNDCHIP_N163: subindex -= CHANID_N163_CH1; break;
+		case SNDCHIP_FDS: subindex -= CHANID_FDS; break;
+		case SNDCHIP_VRC7: subindex -= CHANID_VRC7_CH1; break;
+		case SNDCHIP_S5B: subindex -= CHANID_S5B_CH1; break;
+		default: break;
+	}
+}
+
+// CTrackData, with patterns emitted one at a time
+void WriteTrack(CJsonStreamWriter &w, const CFamiTrackerDoc &modfile, unsigned int Track, int Channel) {
+	uint8_t chip_type;
+	uint8_t subindex;
+	GenerateChannelSubindex(modfile.GetChannel(Channel), chip_type, subindex);
+
+	const unsigned int Frames = modfile.GetFrameCount(Track);
+	const unsigned int Rows = modfile.GetPatternLength(Track);
+
+	w.BeginObject();
+	w.Field("chip", GetChannelChipName(chip_type));
+	w.Field("effect_columns", modfile.GetEffColumns(Track, Channel) + 1);		// off-by-one
+
+	w.Key("frame_list");
+	w.BeginArray();
+	for (unsigned int Frame = 0; Frame < Frames; ++Frame)
+		w.Value(modfile.GetPatternAtFrame(Track, Frame, Channel));
+	w.EndArray();
+
+	w.Key("patterns");
+	w.BeginArray();
+	for (unsigned int Pattern = 0; Pattern < MAX_PATTERN; ++Pattern) {
+		json notes = json::array();
+		for (unsigned int row = 0; row < Rows; ++row) {
+			stChanNote note;
+			modfile.GetDataAtPattern(Track, Pattern, Channel, row, &note);
+			if (note != stChanNote{}) {
+				json jn;
+				to_json(jn, note);
+				notes.push_back(json{
+					{"row", row},
+					{"note", std::move(jn)},
+				});
 			}
-			sj["tracks"].push_back(std::move(cj));
 		}
-		j["songs"].push_back(std::move(sj));
+		if (!notes.empty())
+			w.Value(json{
+				{"index", Pattern},
+				{"notes", std::move(notes)},
+			});
 	}
+	w.EndArray();
 
-	for (int i = 0; i < modfile.GetChannelCount(); ++i)
-	{
-		CTrackerChannel* ch = modfile.GetChannel(i);
+	w.Field("subindex", subindex);
+	w.EndObject();
+}
+
+// CSongData
+void WriteSong(CJsonStreamWriter &w, const CFamiTrackerDoc &modfile, unsigned int Track) {
+	w.BeginObject();
+	w.Field("bookmarks", *modfile.GetBookmarkManager()->GetCollection(Track));
+	w.Field("frames", modfile.GetFrameCount(Track));
+	w.Field("highlight", modfile.GetHighlight());
+	w.Field("rows", modfile.GetPatternLength(Track));
+	w.Field("speed", modfile.GetSongSpeed(Track));
+	w.Field("tempo", modfile.GetSongTempo(Track));
+	w.Field("title", std::string {modfile.GetTrackTitle(Track)});
+
+	w.Key("tracks");
+	w.BeginArray();
+	for (int Channel = 0; Channel < modfile.GetChannelCount(); ++Channel)
+		WriteTrack(w, modfile, Track, Channel);
+	w.EndArray();
+
+	w.Field("uses_groove", modfile.GetSongGroove(Track));
+	w.EndObject();
+}
+
+// TODO: compartmentalize all blocks within their own subclass?
+// Keys are written in alphabetical order to match json::dump() of a full DOM.
+void WriteModule(CJsonStreamWriter &w, const CFamiTrackerDoc &modfile) {
+	w.BeginObject();
+	w.Field("_dn_famitracker_module_version", CDocumentFile::FILE_VER);
+	w.Field("_json_export_version", JSON_VER);
+
+	w.Key("channels");
+	w.BeginArray();
+	for (int i = 0; i < modfile.GetChannelCount(); ++i) {
 		uint8_t chip_type;
 		uint8_t subindex;
-		GenerateChannelSubindex(ch, chip_type, subindex);
-
-		j["channels"].push_back({
+		GenerateChannelSubindex(modfile.GetChannel(i), chip_type, subindex);
+		w.Value(json{
 			{ "chip", GetChannelChipName(chip_type) },
 			{ "subindex", subindex },
 		});
 	}
+	w.EndArray();
+
+	w.Key("detunes");
+	w.BeginArray();
+	for (int i = 0; i < 6; ++i)
+		for (int n = 0; n < NOTE_COUNT; ++n)
+			if (auto offs = modfile.GetDetuneOffset(i, n))
+				w.Value(json{
+					{"table_id", i},
+					{"note", n},
+					{"offset", offs},
+					});
+	w.EndArray();
+
+	w.Key("dpcm_samples");
+	w.BeginArray();
+	const CDSampleManager &dmanager = *modfile.GetInstrumentManager()->GetDSampleManager();
+	for (unsigned i = 0; i < MAX_DSAMPLES; ++i)
+		if (const CDSample* sample = dmanager.GetDSample(i)) {
+			json dj = json(*sample);
+			dj["index"] = i;
+			w.Value(dj);
+		}
+	w.EndArray();
 
 	// emulator params
 	// VRC7
+	json emulation_parameters = json::array();
 	if (modfile.GetExpansionChip() & SNDCHIP_VRC7) {
 		auto opll_patch_data = json();
 
@@ -529,34 +607,53 @@ void to_json(json& j, const CFamiTrackerDoc& modfile) {
 			});
 		}
 
-		j["emulation_parameters"].push_back({
+		emulation_parameters.push_back({
 			{ "use_external_OPLL", modfile.GetExternalOPLLChipCheck() },
 			{ "OPLL_patch_data", opll_patch_data },
 		});
 	}
 
-	for (unsigned i = 0; i < MAX_INSTRUMENTS; ++i)
-		if (auto pInst = modfile.GetInstrumentManager()->GetInstrument(i)) {
-			auto ij = json(*pInst);
-			ij["index"] = i;
-			j["instruments"].push_back(std::move(ij));
-		}
-
-	for (int i = 0; i < 6; ++i)
-		for (int n = 0; n < NOTE_COUNT; ++n)
-			if (auto offs = modfile.GetDetuneOffset(i, n))
-				j["detunes"].push_back(json{
-					{"table_id", i},
-					{"note", n},
-					{"offset", offs},
-					});
+	w.Field("global", json{
+		{"machine", modfile.GetMachine() == machine_t::PAL ? "pal" : "ntsc"},
+		{"engine_speed", modfile.GetEngineSpeed()},
+		{"vibrato_style", modfile.GetVibratoStyle() == vibrato_t::VIBRATO_OLD ? "old" : "new"},
+		{"linear_pitch", modfile.GetLinearPitch()},
+		{"fxx_split_point", modfile.GetSpeedSplitPoint()},
+		{"detune", {
+			{"semitones", modfile.GetTuningSemitone()},
+			{"cents", modfile.GetTuningCent()},
+		}},
+		{ "optional_json_data", modfile.InterfaceToOptionalJSON() },
+		{ "emulation_parameters", std::move(emulation_parameters) },
+	});
 
+	w.Key("grooves");
+	w.BeginArray();
 	for (unsigned i = 0; i < MAX_GROOVE; ++i)
 		if (auto pGroove = modfile.GetGroove(i)) {
 			auto gj = json(*pGroove);
 			gj["index"] = i;
-			j["grooves"].push_back(std::move(gj));
+			w.Value(gj);
 		}
+	w.EndArray();
+
+	w.Key("instruments");
+	w.BeginArray();
+	for (unsigned i = 0; i < MAX_INSTRUMENTS; ++i)
+		if (auto pInst = modfile.GetInstrumentManager()->GetInstrument(i)) {
+			auto ij = json(*pInst);
+			ij["index"] = i;
+			w.Value(ij);
+		}
+	w.EndArray();
+
+	w.Field("metadata", json{
+		{"title", std::string {modfile.GetSongName()}},
+		{"artist", std::string {modfile.GetSongArtist()}},
+		{"copyright", std::string {modfile.GetSongCopyright()}},
+		{"comment", std::string {modfile.GetComment()}},
+		{"show_comment_on_open", modfile.ShowCommentOnOpen()},
+	});
 
 	const auto InsertSequences = [&](inst_type_t inst_type) {
 		const CSequenceManager& smanager = *modfile.GetInstrumentManager()->GetSequenceManager(inst_type);
@@ -570,18 +667,31 @@ void to_json(json& j, const CFamiTrackerDoc& modfile) {
 						sj["chip"] = name;
 						sj["macro_id"] = (unsigned int)(t);
 						sj["index"] = i;
-						j["sequences"].push_back(std::move(sj));
+						w.Value(sj);
 					}
 				}
 	};
 
+	w.Key("sequences");
+	w.BeginArray();
 	InsertSequences(INST_2A03);
 	InsertSequences(INST_VRC6);
 //	InsertSequences(INST_FDS);
 	InsertSequences(INST_N163);
 	InsertSequences(INST_S5B);
+	w.EndArray();
+
+	w.Key("songs");
+	w.BeginArray();
+	for (unsigned int Track = 0; Track < modfile.GetTrackCount(); ++Track)
+		WriteSong(w, modfile, Track);
+	w.EndArray();
+
+	w.EndObject();
 }
 
+} // namespace
+
 const CString& CJsonExport::ExportFile(LPCTSTR FileName, CFamiTrackerDoc* Doc)
 {
 	static CString sResult;
@@ -598,7 +708,9 @@ const CString& CJsonExport::ExportFile(LPCTSTR FileName, CFamiTrackerDoc* Doc)
 		return sResult;
 	}
 
-	std::string s = nlohmann::json(*Doc).dump();
-	f.WriteString(s.c_str());
+	// Compact output never contains raw newlines, so text mode does not alter it
+	CJsonStreamWriter Writer(f);
+	WriteModule(Writer, *Doc);
+	Writer.Flush();
 	return sResult;
-}
\ No newline at end of file
+}
@@ -0,0 +1,74 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#include "stdafx.h"
+#include "LiveInputQueue.h"
+#include <cstdint>
+
+CLiveInputQueue::CLiveInputQueue(std::size_t Capacity) :
+	m_iEnqueuePos(0),
+	m_iDequeuePos(0)
+{
+	std::size_t Size = 2;
+	while (Size < Capacity)
+		Size <<= 1;
+
+	m_pSlots = std::make_unique<Slot[]>(Size);
+	m_iMask = Size - 1;
+	for (std::size_t i = 0; i < Size; ++i)
+		m_pSlots[i].Sequence.store(i, std::memory_order_relaxed);
+}
+
+bool CLiveInputQueue::Push(const stLiveEvent &Event)
+{
+	std::size_t Pos = m_iEnqueuePos.load(std::memory_order_relaxed);
+	Slot *pSlot;
+
+	while (true) {
+		pSlot = &m_pSlots[Pos & m_iMask];
+		const std::size_t Sequence = pSlot->Sequence.load(std::memory_order_acquire);
+		const auto Diff = static_cast<std::intptr_t>(Sequence) - static_cast<std::intptr_t>(Pos);
+		if (Diff == 0) {
+			// The slot is free, claim it
+			if (m_iEnqueuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (Diff < 0)		// The consumer has not released the slot yet
+			return false;
+		else					// Another producer claimed the slot
+			Pos = m_iEnqueuePos.load(std::memory_order_relaxed);
+	}
+
+	pSlot->Event = Event;
+	pSlot->Sequence.store(Pos + 1, std::memory_order_release);
+	return true;
+}
+
+bool CLiveInputQueue::Pop(stLiveEvent &Event)
+{
+	Slot &Current = m_pSlots[m_iDequeuePos & m_iMask];
+	if (Current.Sequence.load(std::memory_order_acquire) != m_iDequeuePos + 1)
+		return false;
+
+	Event = Current.Event;
+	Current.Sequence.store(m_iDequeuePos + m_iMask + 1, std::memory_order_release);
+	++m_iDequeuePos;
+	return true;
+}
@@ -0,0 +1,83 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include "PatternNote.h"
+#include "TrackerChannel.h"
+
+/// Kind of a live input event, see stLiveEvent.
+enum live_event_t : unsigned char {
+	LIVE_EVENT_NOTE,				// Play Note on Channel
+	LIVE_EVENT_PITCH,				// Set the pitch wheel offset of Channel to Value
+	LIVE_EVENT_RELOAD_INSTRUMENT,	// Reload the instrument of Channel on its next note
+};
+
+/// Input for the sound player, stamped with the time it was received.
+struct stLiveEvent {
+	using clock_type = std::chrono::steady_clock;
+
+	live_event_t Type = LIVE_EVENT_NOTE;
+	int Channel = 0;						// Document channel index
+	note_prio_t Priority = NOTE_PRIO_0;		// LIVE_EVENT_NOTE only
+	stChanNote Note;						// LIVE_EVENT_NOTE only
+	int Value = 0;							// LIVE_EVENT_PITCH only
+	clock_type::time_point Time;
+};
+
+/*!
+	\brief Bounded lock-free queue of live input events from any number of threads to
+	the audio thread.
+
+	Every slot carries a sequence number which tells producers and the consumer whose
+	turn it is (D. Vyukov's bounded MPMC queue, with a single consumer). Producers only
+	contend on a compare-and-swap of the enqueue position and never wait for the
+	consumer; Push() fails when the queue is full.
+*/
+class CLiveInputQueue
+{
+public:
+	/// \param Capacity Maximum number of queued events, rounded up to a power of 2.
+	explicit CLiveInputQueue(std::size_t Capacity);
+
+	/// Appends an event. May be called from any thread.
+	/// \return False if the queue is full and the event was dropped.
+	bool Push(const stLiveEvent &Event);
+	/// Removes the oldest event. Must only be called from the consuming thread.
+	/// \return False if the queue is empty.
+	bool Pop(stLiveEvent &Event);
+
+private:
+	struct Slot {
+		std::atomic<std::size_t> Sequence;
+		stLiveEvent Event;
+	};
+
+	std::unique_ptr<Slot[]> m_pSlots;
+	std::size_t m_iMask;
+
+	alignas(64) std::atomic<std::size_t> m_iEnqueuePos;
+	alignas(64) std::size_t m_iDequeuePos;		// Consumer only
+};
@@ -216,6 +216,7 @@ void CMIDI::Enqueue(unsigned char MsgType, unsigned char MsgChannel, unsigned ch
 		(char)Data1,
 		(char)Data2,
 		(char)m_iTimingCounter,
+		std::chrono::steady_clock::now(),		// // //
 	});
 }
 
@@ -258,7 +259,8 @@ void CMIDI::Event(unsigned char Status, unsigned char Data1, unsigned char Data2
 	}
 }
 
-bool CMIDI::ReadMessage(unsigned char & Message, unsigned char & Channel, unsigned char & Data1, unsigned char & Data2)
+bool CMIDI::ReadMessage(unsigned char & Message, unsigned char & Channel, unsigned char & Data1, unsigned char & Data2,
+						std::chrono::steady_clock::time_point & Time)		// // //
 {
 	bool Result = false;
 
@@ -270,6 +272,7 @@ bool CMIDI::ReadMessage(unsigned char & Message, unsigned char & Channel, unsign
 		Data1	= pMidiMessage->Data1;
 		Data2	= pMidiMessage->Data2;
 		m_iQuant = pMidiMessage->Quantization;
+		Time	= pMidiMessage->Time;		// // //
 
 		m_MidiQueue.pop();
 	}
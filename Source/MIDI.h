@@ -22,6 +22,7 @@
 
 #include <mmsystem.h>
 #include "rigtorp/SPSCQueue.h"
+#include <chrono>		// // //
 
 const int MIDI_MSG_NOTE_OFF			= 0x08;
 const int MIDI_MSG_NOTE_ON			= 0x09;
@@ -39,6 +40,7 @@ struct MidiMessage {
 	char Data1;
 	char Data2;
 	char Quantization;
+	std::chrono::steady_clock::time_point Time;		// // // Arrival time
 };
 
 class CMIDI : public CObject
@@ -53,7 +55,8 @@ public:
 	bool	OpenDevices(void);
 	bool	CloseDevices(void);
 
-	bool	ReadMessage(unsigned char & Message, unsigned char & Channel, unsigned char & Data1, unsigned char & Data2);
+	bool	ReadMessage(unsigned char & Message, unsigned char & Channel, unsigned char & Data1, unsigned char & Data2,
+						std::chrono::steady_clock::time_point & Time);		// // //
 	void	WriteNote(unsigned char Channel, unsigned char Note, unsigned char Octave, unsigned char Velocity);
 	void	ResetOutput();
 	void	ToggleInput();
@@ -31,107 +31,264 @@
 #include "APU/nsfplay/xgm/devices/Sound/nes_dmc.h"
 #include "resampler/resample.hpp"
 #include "resampler/resample.inl"
+#include "utils/parallel_for.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PCM_IMPORT_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 const int CPCMImport::QUALITY_RANGE = 16;
 const int CPCMImport::VOLUME_RANGE = 12;		// +/- dB
 
 const uint32_t* DMC_PERIODS_NTSC = xgm::NES_DMC::freq_table[0];
 
-// Implement a resampler using CRTP idiom
-class resampler : public jarh::resample<resampler>
+namespace {
+
+const int DMC_BIAS = 32;
+const int DMC_LEVELS = 64;		// delta counter states
+
+// Encodes each level by stepping towards it, one bit at a time
+void EncodeDeltaGreedy(const float *pLevel, int Bytes, char *pOut)
+{
+	unsigned char DeltaAcc = 0;	// DPCM sample accumulator
+	int Delta = DMC_BIAS;		// Delta counter
+
+	for (int i = 0; i < Bytes * 8; ++i) {
+		int Sample = (int)pLevel[i] + DMC_BIAS;
+
+		DeltaAcc >>= 1;
+
+		if (Sample >= Delta) {
+			++Delta;
+			if (Delta > DMC_LEVELS - 1)
+				Delta = DMC_LEVELS - 1;
+			DeltaAcc |= 0x80;
+		}
+		else if (Sample < Delta) {
+			--Delta;
+			if (Delta < 0)
+				Delta = 0;
+		}
+
+		if ((i & 0x07) == 0x07)
+			pOut[i >> 3] = DeltaAcc;
+	}
+}
+
+// Finds the bit sequence whose delta counter output has the least squared
+// error against the levels, with a Viterbi search over all counter states.
+// The path starts and ends at the bias, so the sample ends centered.
+void EncodeDeltaTrellis(const float *pLevel, int Bytes, char *pOut)
+{
+	const size_t Bits = Bytes * 8;
+	const float UNREACHABLE = 1e30f;
+
+	// Bit n of Choice[i] is set if state n after bit i was reached from the state above it
+	std::vector<uint64_t> Choice(Bits);
+
+	alignas(16) float State[DMC_LEVELS];
+	alignas(16) float Cost[DMC_LEVELS];
+	float Ext[DMC_LEVELS + 2];		// costs padded with the clamped neighbours at both ends
+	for (int s = 0; s < DMC_LEVELS; ++s) {
+		State[s] = float(s - DMC_BIAS);
+		Cost[s] = UNREACHABLE;
+	}
+	Cost[DMC_BIAS] = 0.f;
+	float MinCost = 0.f;
+
+	for (size_t i = 0; i < Bits; ++i) {
+		Ext[0] = Cost[0];
+		std::copy_n(Cost, DMC_LEVELS, Ext + 1);
+		Ext[DMC_LEVELS + 1] = Cost[DMC_LEVELS - 1];
+
+		// Costs are kept relative to the best state of the previous bit
+		uint64_t Mask = 0;
+		float NextMin = UNREACHABLE;
+		int s = 0;
+#ifdef PCM_IMPORT_USE_SSE2
+		const __m128 Target = _mm_set1_ps(pLevel[i]);
+		const __m128 Offset = _mm_set1_ps(MinCost);
+		__m128 Best = _mm_set1_ps(UNREACHABLE);
+		for (; s < DMC_LEVELS; s += 4) {
+			const __m128 Lo = _mm_loadu_ps(Ext + s);
+			const __m128 Hi = _mm_loadu_ps(Ext + s + 2);
+			const __m128 TakeHi = _mm_cmplt_ps(Hi, Lo);
+			const __m128 Diff = _mm_sub_ps(_mm_load_ps(State + s), Target);
+			const __m128 c = _mm_add_ps(_mm_sub_ps(_mm_min_ps(Lo, Hi), Offset), _mm_mul_ps(Diff, Diff));
+			_mm_store_ps(Cost + s, c);
+			Best = _mm_min_ps(Best, c);
+			Mask |= static_cast<uint64_t>(_mm_movemask_ps(TakeHi)) << s;
+		}
+		Best = _mm_min_ps(Best, _mm_shuffle_ps(Best, Best, _MM_SHUFFLE(1, 0, 3, 2)));
+		Best = _mm_min_ps(Best, _mm_shuffle_ps(Best, Best, _MM_SHUFFLE(2, 3, 0, 1)));
+		NextMin = _mm_cvtss_f32(Best);
+#endif
+		for (; s < DMC_LEVELS; ++s) {
+			const float Lo = Ext[s];
+			const float Hi = Ext[s + 2];
+			const float Diff = State[s] - pLevel[i];
+			Cost[s] = (Hi < Lo ? Hi : Lo) - MinCost + Diff * Diff;
+			NextMin = std::min(NextMin, Cost[s]);
+			if (Hi < Lo)
+				Mask |= uint64_t(1) << s;
+		}
+
+		Choice[i] = Mask;
+		MinCost = NextMin;
+	}
+
+	// Trace the path back from the bias
+	std::fill_n(pOut, Bytes, 0);
+	int Delta = DMC_BIAS;
+	for (size_t i = Bits; i-- > 0; ) {
+		const int Prev = (Choice[i] >> Delta & 1) ? std::min(Delta + 1, DMC_LEVELS - 1) : std::max(Delta - 1, 0);
+		if (Delta > Prev || (Delta == DMC_LEVELS - 1 && Prev == Delta))
+			pOut[i >> 3] |= 1 << (i & 0x07);
+		Delta = Prev;
+	}
+}
+
+} // namespace
+
+// Reads the data chunk of a PCM wave file in large blocks and converts each
+// block to mono samples in the range of 16-bit audio
+class CWaveBlockDecoder
 {
-	typedef jarh::resample<resampler> base;
 public:
-	resampler(const jarh::sinc &sinc, float ratio, int channels, int smpsize,
-			  size_t nbsamples, CFile &cfile)
-	// TODO: cutoff is currently fixed to a value (.9f), make it modifiable.
-	 : base(sinc), channels_(channels), smpsize_(smpsize),
-	   nbsamples_(nbsamples), remain_(nbsamples), cfile_(cfile)
+	CWaveBlockDecoder(CFile &File, const stWaveInfo &Info) :
+		m_File(File),
+		m_iBlockAlign(Info.BlockAlign),
+		m_iSampleSize(Info.SampleSize),
+		m_bStereo(Info.Channels == 2),
+		m_ullStart(Info.SampleStart),
+		m_iTotalFrames(Info.WaveSize / Info.BlockAlign),
+		m_iRemaining(m_iTotalFrames),
+		m_Raw(BLOCK_FRAMES * Info.BlockAlign),
+		m_Decoded(BLOCK_FRAMES)
 	{
-		init(ratio, .9f);
 	}
 
-	bool initstream()
-	{
-		// Don't seek to the begin of wave chunk, as it is already done.
-		// This stream will not be reinitialized, then.
-		remain_ = nbsamples_;
-		return true;
+	void Rewind() {
+		m_File.Seek(m_ullStart, CFile::begin);
+		m_iRemaining = m_iTotalFrames;
+		m_iPos = m_iSize = 0;
 	}
 
-	float *fill(float *first, float *end)
-	{
-		int val;
-		for(;first != end && remain_ && ReadSample(val); ++first, --remain_)
-		{
-			*first = (float)val;
+	// Returns the number of samples written, less than Count only at the end of the data
+	size_t Read(float *pOut, size_t Count) {
+		size_t Total = 0;
+		while (Total < Count) {
+			if (m_iPos == m_iSize && !ReadBlock())
+				break;
+			size_t n = std::min(Count - Total, m_iSize - m_iPos);
+			std::copy_n(m_Decoded.data() + m_iPos, n, pOut + Total);
+			m_iPos += n;
+			Total += n;
 		}
-		return first;
+		return Total;
 	}
 
 private:
-	bool ReadSample(int &v)
-	{
-		int ret, nbytes;
-		if (smpsize_ == 2) {
-			// 16 bit samples
-			short sample_word[2];
-			if (channels_ == 2) {
-				ret = cfile_.Read(sample_word, nbytes = 2*sizeof(short));
-				v = (sample_word[0] + sample_word[1]) / 2;
-			}
-			else {
-				ret = cfile_.Read(sample_word, nbytes = sizeof(short));
-				v = *sample_word;
-			}
-		}
-		else if (smpsize_ == 1) {
-			// 8 bit samples
-			unsigned char sample_byte[2];
-			if (channels_ == 2) {
-				ret = cfile_.Read(sample_byte, nbytes = 2);
-				// convert to a proper signed representation
-				// shift left only by 7; because we want a mean
-				v = ((int)sample_byte[0] + (int)sample_byte[1] - 256) << 7;
-			}
-			else {
-				ret = cfile_.Read(sample_byte, nbytes = 1);
-				v = ((int)(*sample_byte) - 128) << 8;
-			}
+	bool ReadBlock() {
+		size_t Frames = std::min(BLOCK_FRAMES, m_iRemaining);
+		if (Frames == 0)
+			return false;
+		UINT Bytes = m_File.Read(m_Raw.data(), static_cast<UINT>(Frames * m_iBlockAlign));
+		if (Bytes < Frames * m_iBlockAlign) {
+			Frames = Bytes / m_iBlockAlign;		// truncated file
+			m_iRemaining = 0;
 		}
-		else if (smpsize_ == 3) {
-			// 24 bit samples
-	        unsigned char sample_byte[6];
-			if (channels_ == 2) {
-				ret = cfile_.Read(sample_byte, nbytes = 6);
-				v = (*((signed short*)(sample_byte + 1)) + *((signed short*)(sample_byte + 4))) / 2;
+		else
+			m_iRemaining -= Frames;
+		Decode(m_Raw.data(), m_Decoded.data(), Frames);
+		m_iPos = 0;
+		m_iSize = Frames;
+		return Frames > 0;
+	}
+
+	// 8-bit samples are unsigned; wider samples are truncated to their top 16 bits
+	int Sample(const unsigned char *p) const {
+		if (m_iSampleSize == 1)
+			return (p[0] - 128) * 256;
+		return static_cast<int16_t>(p[m_iSampleSize - 2] | (p[m_iSampleSize - 1] << 8));
+	}
+
+	void Decode(const unsigned char *pData, float *pOut, size_t Frames) const {
+		size_t i = 0;
+#ifdef PCM_IMPORT_USE_SSE2
+		if (m_iSampleSize == 2 && m_iBlockAlign == (m_bStereo ? 4 : 2)) {
+			if (m_bStereo) {
+				const __m128i Ones = _mm_set1_epi16(1);
+				for (; i + 4 <= Frames; i += 4) {
+					__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pData + i * 4));
+					__m128i Sum = _mm_madd_epi16(x, Ones);		// left + right
+					Sum = _mm_add_epi32(Sum, _mm_srli_epi32(Sum, 31));		// round towards zero
+					_mm_storeu_ps(pOut + i, _mm_cvtepi32_ps(_mm_srai_epi32(Sum, 1)));
+				}
 			}
 			else {
-				ret = cfile_.Read(sample_byte, nbytes = 3);
-				v = *((signed short*)(sample_byte + 1));
+				for (; i + 8 <= Frames; i += 8) {
+					__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pData + i * 2));
+					__m128i Lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+					__m128i Hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+					_mm_storeu_ps(pOut + i, _mm_cvtepi32_ps(Lo));
+					_mm_storeu_ps(pOut + i + 4, _mm_cvtepi32_ps(Hi));
+				}
 			}
 		}
-		else if (smpsize_ == 4) {
-			// 32 bit samples
-	        int sample_word[2];
-			if (channels_ == 2) {
-				ret = cfile_.Read(sample_word, nbytes = 8);
-				v = ((sample_word[0] >> 16) + (sample_word[1] >> 16)) / 2;
-			}
-			else {
-				ret = cfile_.Read(sample_word, nbytes = 4);
-				v = sample_word[0] >> 16;
-			}
+#endif
+		for (; i < Frames; ++i) {
+			const unsigned char *p = pData + i * m_iBlockAlign;
+			if (m_bStereo)
+				pOut[i] = static_cast<float>((Sample(p) + Sample(p + m_iSampleSize)) / 2);
+			else
+				pOut[i] = static_cast<float>(Sample(p));
 		}
+	}
+
+private:
+	static constexpr size_t BLOCK_FRAMES = 0x4000;
+
+	CFile &m_File;
+	const int m_iBlockAlign;
+	const int m_iSampleSize;
+	const bool m_bStereo;
+	const ULONGLONG m_ullStart;
+	const size_t m_iTotalFrames;
+	size_t m_iRemaining;
+	std::vector<unsigned char> m_Raw;
+	std::vector<float> m_Decoded;
+	size_t m_iPos = 0;
+	size_t m_iSize = 0;
+};
 
-		return ret == nbytes;
+// Implement a resampler using CRTP idiom
+class resampler : public jarh::resample<resampler>
+{
+	typedef jarh::resample<resampler> base;
+public:
+	resampler(const jarh::sinc &sinc, float ratio, CWaveBlockDecoder &decoder)
+	// TODO: cutoff is currently fixed to a value (.9f), make it modifiable.
+	 : base(sinc), decoder_(decoder)
+	{
+		init(ratio, .9f);
+	}
+
+	bool initstream()
+	{
+		// Seek to start of samples
+		decoder_.Rewind();
+		return true;
+	}
+
+	float *fill(float *first, float *end)
+	{
+		return first + decoder_.Read(first, end - first);
 	}
 
-	CFile &cfile_;
-	int    channels_;
-	int    smpsize_;
-	size_t nbsamples_;
-	size_t remain_;
+private:
+	CWaveBlockDecoder &decoder_;
 };
 
 // Derive a new class from CFileDialog with implemented preview of audio files
@@ -175,8 +332,10 @@ IMPLEMENT_DYNAMIC(CPCMImport, CDialog)
 CPCMImport::CPCMImport(CWnd* pParent /*=NULL*/)
 	: CDialog(CPCMImport::IDD, pParent),
 	m_pCachedSample(NULL),
+	m_bLookahead(true),
 	m_iCachedQuality(0),
 	m_iCachedVolume(0),
+	m_bCachedLookahead(true),
 	m_psinc(new jarh::sinc(512, 32)) // sinc object. TODO: parametrise
 {
 }
@@ -198,39 +357,53 @@ BEGIN_MESSAGE_MAP(CPCMImport, CDialog)
 	ON_BN_CLICKED(IDCANCEL, OnBnClickedCancel)
 	ON_BN_CLICKED(IDOK, OnBnClickedOk)
 	ON_BN_CLICKED(IDC_PREVIEW, &CPCMImport::OnBnClickedPreview)
+	ON_BN_CLICKED(IDC_DPCM_LOOKAHEAD, &CPCMImport::OnBnClickedLookahead)
 END_MESSAGE_MAP()
 
-CDSample *CPCMImport::ShowDialog()
+std::vector<CDSample *> CPCMImport::ShowDialog()
 {
-	// Return imported sample, or NULL if cancel/error
+	// Return imported samples, or an empty list if cancel/error
 
 	CString fileFilter = LoadDefaultFilter(IDS_FILTER_WAV, _T(".wav"));	
-	CFileSoundDialog OpenFileDialog(TRUE, 0, 0, OFN_HIDEREADONLY, fileFilter);
+	CFileSoundDialog OpenFileDialog(TRUE, 0, 0, OFN_HIDEREADONLY | OFN_FILEMUSTEXIST | OFN_ALLOWMULTISELECT | OFN_EXPLORER, fileFilter);
 
 	OpenFileDialog.m_pOFN->lpstrInitialDir = theApp.GetSettings()->GetPath(PATH_WAV_IMPORT);
 
+	// Leave room for selecting a whole sample pack
+	std::vector<TCHAR> FileNames(0x10000, _T('\0'));
+	OpenFileDialog.m_pOFN->lpstrFile = FileNames.data();
+	OpenFileDialog.m_pOFN->nMaxFile = static_cast<DWORD>(FileNames.size());
+
 	if (OpenFileDialog.DoModal() == IDCANCEL)
-		return NULL;
+		return { };
 
 	// Stop any preview
 	PlaySound(NULL, NULL, SND_NODEFAULT | SND_SYNC);
 
-	theApp.GetSettings()->SetPath(OpenFileDialog.GetPathName(), PATH_WAV_IMPORT);
+	m_BatchPaths.clear();
+	POSITION Pos = OpenFileDialog.GetStartPosition();
+	while (Pos)
+		m_BatchPaths.push_back(OpenFileDialog.GetNextPathName(Pos));
+	if (m_BatchPaths.empty())
+		return { };
+
+	// Settings are chosen with the first file and applied to every selected file
+	m_strPath	  = m_BatchPaths.front();
+	m_strFileName = m_strPath.Right(m_strPath.GetLength() - m_strPath.ReverseFind('\\') - 1);
+	m_Imported.clear();
 
-	m_strPath	  = OpenFileDialog.GetPathName();
-	m_strFileName = OpenFileDialog.GetFileName();
-	m_pImported	  = NULL;
+	theApp.GetSettings()->SetPath(m_strPath, PATH_WAV_IMPORT);
 
 	// Open file and read header
 	if (!OpenWaveFile())
-		return NULL;
+		return { };
 
 	CDialog::DoModal();
 
 	// Close file
 	m_fSampleFile.Close();
 
-	return m_pImported;
+	return std::move(m_Imported);
 }
 
 // CPCMImport message handlers
@@ -252,6 +425,7 @@ BOOL CPCMImport::OnInitDialog()
 	pVolumeSlider->SetRange(0, VOLUME_RANGE * 2);
 	pVolumeSlider->SetPos(m_iVolume + VOLUME_RANGE);
 	pVolumeSlider->SetTicFreq(3);	// 3dB/tick
+	CheckDlgButton(IDC_DPCM_LOOKAHEAD, m_bLookahead ? BST_CHECKED : BST_UNCHECKED);
 
 	UpdateText();
 
@@ -261,8 +435,11 @@ BOOL CPCMImport::OnInitDialog()
 
 	UpdateFileInfo();
 
+	CString Name = m_strFileName;
+	if (m_BatchPaths.size() > 1)
+		Name.AppendFormat(_T(" +%u"), static_cast<unsigned>(m_BatchPaths.size() - 1));
 	CString Title;
-	AfxFormatString1(Title, IDS_DPCM_IMPORT_TITLE_FORMAT, m_strFileName);
+	AfxFormatString1(Title, IDS_DPCM_IMPORT_TITLE_FORMAT, Name);
 	SetWindowText(Title);
 
 	return TRUE;  // return TRUE unless you set the focus to a control
@@ -296,7 +473,7 @@ void CPCMImport::OnBnClickedCancel()
 {
 	m_iQuality = 0;
 	m_iVolume = 0;
-	m_pImported = NULL;
+	m_Imported.clear();
 
 	theApp.GetSoundGenerator()->CancelPreviewSample();
 
@@ -305,6 +482,12 @@ void CPCMImport::OnBnClickedCancel()
 
 void CPCMImport::OnBnClickedOk()
 {
+	if (m_BatchPaths.size() > 1) {
+		ConvertBatch();
+		OnOK();
+		return;
+	}
+
 	CDSample *pSample = GetSample();
 
 	if (pSample == NULL)
@@ -316,7 +499,7 @@ void CPCMImport::OnBnClickedOk()
 	// Set the name
 	pSample->SetName((LPCSTR)m_strFileName);
 
-	m_pImported = pSample;
+	m_Imported.push_back(pSample);
 	m_pCachedSample = NULL;
 
 	OnOK();
@@ -337,14 +520,19 @@ void CPCMImport::OnBnClickedPreview()
 	theApp.GetSoundGenerator()->PreviewSample(pSample, 0, m_iQuality);
 }
 
+void CPCMImport::OnBnClickedLookahead()
+{
+	m_bLookahead = IsDlgButtonChecked(IDC_DPCM_LOOKAHEAD) != 0;
+}
+
 void CPCMImport::UpdateFileInfo()
 {
 	CString SampleRate;
 	
 	AfxFormatString3(SampleRate, IDS_DPCM_IMPORT_WAVE_FORMAT, 
-		MakeIntString(m_iSamplesPerSec), 
-		MakeIntString(m_iSampleSize * 8),
-		(m_iChannels == 2) ? _T("Stereo") : _T("Mono"));
+		MakeIntString(m_WaveInfo.SamplesPerSec), 
+		MakeIntString(m_WaveInfo.SampleSize * 8),
+		(m_WaveInfo.Channels == 2) ? _T("Stereo") : _T("Mono"));
 
 	SetDlgItemText(IDC_SAMPLE_RATE, SampleRate);
 
@@ -357,116 +545,119 @@ void CPCMImport::UpdateFileInfo()
 
 CDSample *CPCMImport::GetSample()
 {
-	if (m_pCachedSample == NULL || m_iCachedQuality != m_iQuality || m_iCachedVolume != m_iVolume) {
+	if (m_pCachedSample == NULL || m_iCachedQuality != m_iQuality || m_iCachedVolume != m_iVolume || m_bCachedLookahead != m_bLookahead) {
 		SAFE_RELEASE(m_pCachedSample);
-		m_pCachedSample = ConvertFile();
+		CWaitCursor wait;
+		m_pCachedSample = ConvertFile(m_fSampleFile, m_WaveInfo, m_iQuality, m_iVolume, m_bLookahead, *m_psinc);
 		// This sample may not be auto-deleted, so give it a name
 		m_pCachedSample->SetName("cached");
 	}
 
 	m_iCachedQuality = m_iQuality;
 	m_iCachedVolume = m_iVolume;
+	m_bCachedLookahead = m_bLookahead;
 
 	return m_pCachedSample;
 }
 
-CDSample *CPCMImport::ConvertFile()
+void CPCMImport::ConvertBatch()
 {
-	// Converts a WAV file to a DPCM sample
-	static const int DMC_BIAS = 32;
-
-	unsigned char DeltaAcc = 0;	// DPCM sample accumulator
-	int Delta = DMC_BIAS;		// Delta counter
-	int AccReady = 8;
-
-	float volume = powf(10, float(m_iVolume) / 20.0f);		// Convert dB to linear
-
-	// Display wait cursor
+	// Converts every selected file with the current settings, one file per thread at a time
 	CWaitCursor wait;
+	theApp.GetSoundGenerator()->CancelPreviewSample();
 
-	// Seek to start of samples
-	m_fSampleFile.Seek(m_ullSampleStart, CFile::begin);
+	const size_t Count = m_BatchPaths.size();
+	std::vector<CDSample *> Samples(Count, nullptr);
+
+	parallel_for(Count, [&] (size_t i) {		// // //
+		CFile File;
+		stWaveInfo Info;
+		if (!File.Open(m_BatchPaths[i], CFile::modeRead | CFile::shareDenyWrite))
+			return;
+		try {
+			if (ReadWaveInfo(File, Info))
+				Samples[i] = ConvertFile(File, Info, m_iQuality, m_iVolume, m_bLookahead, *m_psinc);
+		}
+		catch (CFileException *e) {
+			e->Delete();
+		}
+		File.Abort();
+	});
+
+	int Failed = 0;
+	for (size_t i = 0; i < Count; ++i) {
+		if (CDSample *pSample = Samples[i]) {
+			CString Name = m_BatchPaths[i].Right(m_BatchPaths[i].GetLength() - m_BatchPaths[i].ReverseFind('\\') - 1);
+			if (int Ext = Name.ReverseFind('.'); Ext >= 0)		// // // remove the extension, whatever its length
+				Name.Truncate(Ext);
+			pSample->SetName((LPCSTR)Name);
+			m_Imported.push_back(pSample);
+		}
+		else
+			++Failed;
+	}
 
-	// Allocate space
-	char *pSamples = new char[CDSample::MAX_SIZE];		// // //
-	int iSamples = 0;
+	if (Failed > 0) {
+		CString message;
+		AfxFormatString2(message, IDS_DPCM_IMPORT_BATCH_FAILED_FORMAT, MakeIntString(Failed), MakeIntString(static_cast<int>(Count)));
+		AfxMessageBox(message, MB_ICONEXCLAMATION);
+	}
+}
+
+CDSample *CPCMImport::ConvertFile(CFile &File, const stWaveInfo &Info, int Quality, int Volume, bool Lookahead, const jarh::sinc &Sinc)
+{
+	// Converts a WAV file to a DPCM sample
+	// Safe to call from several threads at once, as long as each uses its own file
+	float volume = powf(10, float(Volume) / 20.0f);		// Convert dB to linear
 
 	// Determine resampling factor
-	float base_freq = (float)CAPU::BASE_FREQ_NTSC / (float)DMC_PERIODS_NTSC[m_iQuality];
-	float resample_factor = base_freq / (float)m_iSamplesPerSec;
+	float base_freq = (float)CAPU::BASE_FREQ_NTSC / (float)DMC_PERIODS_NTSC[Quality];
+	float resample_factor = base_freq / (float)Info.SamplesPerSec;
 
-	resampler resmpler(*m_psinc, resample_factor, m_iChannels, m_iSampleSize, m_iWaveSize, m_fSampleFile);
-	float val;
-	// Conversion
-	while (resmpler.get(val) && (iSamples < CDSample::MAX_SIZE)) {		// // //
+	CWaveBlockDecoder decoder(File, Info);
+	resampler resmpler(Sinc, resample_factor, decoder);
 
+	// Resample into delta counter levels, relative to the bias
+	std::vector<float> Levels;
+	Levels.reserve(std::min<size_t>(CDSample::MAX_SIZE * 8, size_t(Info.WaveSize / Info.BlockAlign * resample_factor) + 1));
+	float val;
+	while (Levels.size() < CDSample::MAX_SIZE * 8 && resmpler.get(val)) {		// // //
 		// when resampling we must clip because of possible ringing.
 		static const int MAX_AMP =  (1 << 16) - 1;
 		static const int MIN_AMP = -(1 << 16) + 1; // just being symetric
 		val = (std::max<float>(std::min<float>(val, (float)MAX_AMP), (float)MIN_AMP));
 
 		// Volume done this way so it acts as before
-		int Sample = (int)((val * volume) / 1024.f) + DMC_BIAS;
-
-		DeltaAcc >>= 1;
-
-		// PCM -> DPCM
-		if (Sample >= Delta) {
-			++Delta;
-			if (Delta > 63)
-				Delta = 63;
-			DeltaAcc |= 0x80;
-		}
-		else if (Sample < Delta) {
-			--Delta;
-			if (Delta < 0)
-				Delta = 0;
-		}
-
-		if (--AccReady == 0) {
-			// Store sample
-			pSamples[iSamples++] = DeltaAcc;
-			AccReady = 8;
-		}
+		Levels.push_back((val * volume) / 1024.f);
 	}
 
 	// TODO: error handling with th efile
 	// if (!resmpler.eof())
 	//      throw ?? or something else.
 
+	// Allocate space
+	char *pSamples = new char[CDSample::MAX_SIZE];		// // //
+	int iSamples = static_cast<int>(Levels.size() / 8);
+
+	// PCM -> DPCM
+	if (Lookahead)
+		EncodeDeltaTrellis(Levels.data(), iSamples, pSamples);
+	else
+		EncodeDeltaGreedy(Levels.data(), iSamples, pSamples);
+
 	// Adjust sample until size is x * $10 + 1 bytes
 	while (iSamples < CDSample::MAX_SIZE && ((iSamples & 0x0F) - 1) != 0)		// // //
 		pSamples[iSamples++] = 0x55;
 
-	// Center end of sample (not yet working)
-#if 0
-	int CenterPos = (iSamples << 3) - 1;
-	while (Delta != DMC_BIAS && CenterPos > 0) {
-		if (Delta > DMC_BIAS) {
-			int BitPos = CenterPos & 0x07;
-			if ((pSamples[CenterPos >> 3] & (1 << BitPos)))
-				--Delta;
-			pSamples[CenterPos >> 3] = pSamples[CenterPos >> 3] & ~(1 << BitPos);
-		}
-		else if (Delta < DMC_BIAS) {
-			int BitPos = CenterPos & 0x07;
-			if ((pSamples[CenterPos >> 3] & (1 << BitPos)) == 0)
-				++Delta;
-			pSamples[CenterPos >> 3] = pSamples[CenterPos >> 3] | (1 << BitPos);
-		}
-		--CenterPos;
-	}
-#endif
-
 	// Return a sample object
 	CDSample *pSamp = new CDSample();
 	pSamp->SetData(iSamples, pSamples);
 	return pSamp;
 }
 
-bool CPCMImport::OpenWaveFile()
+bool CPCMImport::ReadWaveInfo(CFile &File, stWaveInfo &Info)
 {
-	// Open and read wave file header
+	// Read wave file header, leaves the file position undefined
 	PCMWAVEFORMAT WaveFormat;
 	char Header[4];
 	bool Scanning = true;
@@ -474,24 +665,11 @@ bool CPCMImport::OpenWaveFile()
 	bool ValidWave = false;
 	unsigned int BlockSize;
 	unsigned int FileSize;
-	CFileException ex;
 
 	ZeroMemory(&WaveFormat, sizeof(PCMWAVEFORMAT));
-	m_iWaveSize = 0;
-	m_ullSampleStart = 0;
-
-	TRACE(_T("DPCM import: Loading wave file %s...\n"), m_strPath);
-
-	if (!m_fSampleFile.Open(m_strPath, CFile::modeRead, &ex)) {
-		TCHAR   szCause[255];
-		CString strFormatted;
-		ex.GetErrorMessage(szCause, 255);
-		AfxFormatString1(strFormatted, IDS_OPEN_FILE_ERROR, szCause);
-		AfxMessageBox(strFormatted);
-		return false;
-	}
+	Info = stWaveInfo { };
 
-	m_fSampleFile.Read(Header, 4);
+	File.Read(Header, 4);
 
 	if (memcmp(Header, "RIFF", 4) != 0) {
 		// Invalid format
@@ -500,12 +678,12 @@ bool CPCMImport::OpenWaveFile()
 	}
 	else {
 		// Read file size
-		m_fSampleFile.Read(&FileSize, 4);
+		File.Read(&FileSize, 4);
 	}
 
 	// Now improved, should handle most files
 	while (Scanning) {
-		if (m_fSampleFile.Read(Header, 4) < 4) {
+		if (File.Read(Header, 4) < 4) {
 			Scanning = false;
 			TRACE(_T("DPCM import: End of file reached\n"));
 		}
@@ -514,7 +692,7 @@ bool CPCMImport::OpenWaveFile()
 			ValidWave = true;
 		}
 		else if (Scanning) {
-			m_fSampleFile.Read(&BlockSize, 4);
+			File.Read(&BlockSize, 4);
 
 			if (!memcmp(Header, "fmt ", 4)) {
 				// Read the wave-format
@@ -523,8 +701,8 @@ bool CPCMImport::OpenWaveFile()
 				if (ReadSize > sizeof(PCMWAVEFORMAT))
 					ReadSize = sizeof(PCMWAVEFORMAT);
 
-				m_fSampleFile.Read(&WaveFormat, ReadSize);
-				m_fSampleFile.Seek(BlockSize - ReadSize, CFile::current);
+				File.Read(&WaveFormat, ReadSize);
+				File.Seek(BlockSize - ReadSize, CFile::current);
 				WaveFormatFound = true;
 
 				if (WaveFormat.wf.wFormatTag != WAVE_FORMAT_PCM) {
@@ -538,19 +716,54 @@ bool CPCMImport::OpenWaveFile()
 			else if (!memcmp(Header, "data", 4)) {
 				// Actual wave-data, store the position
 				TRACE(_T("DPCM import: Found data block\n"));
-				m_iWaveSize = BlockSize;
-				m_ullSampleStart = m_fSampleFile.GetPosition();
-				m_fSampleFile.Seek(BlockSize, CFile::current);
+				Info.WaveSize = BlockSize;
+				Info.SampleStart = File.GetPosition();
+				File.Seek(BlockSize, CFile::current);
 			}
 			else {
 				// Unrecognized block
 				TRACE(_T("DPCM import: Unrecognized block %c%c%c%c\n"), Header[0], Header[1], Header[2], Header[3]);
-				m_fSampleFile.Seek(BlockSize, CFile::current);
+				File.Seek(BlockSize, CFile::current);
 			}
 		}
 	}
 
-	if (!ValidWave || !WaveFormatFound || m_iWaveSize == 0) {
+	if (!ValidWave || !WaveFormatFound || Info.WaveSize == 0 || WaveFormat.wf.nChannels == 0)
+		return false;
+
+	// Save file info
+	Info.Channels		= WaveFormat.wf.nChannels;
+	Info.SampleSize		= WaveFormat.wf.nBlockAlign / WaveFormat.wf.nChannels;
+	Info.BlockAlign		= WaveFormat.wf.nBlockAlign;
+	Info.AvgBytesPerSec = WaveFormat.wf.nAvgBytesPerSec;
+	Info.SamplesPerSec	= WaveFormat.wf.nSamplesPerSec;
+
+	if (Info.SampleSize < 1 || Info.SampleSize > 4)
+		return false;
+
+	TRACE(_T("DPCM import: Scan done (%i Hz, %i bits, %i channels)\n"), Info.SamplesPerSec, Info.SampleSize * 8, Info.Channels);
+
+	return true;
+}
+
+bool CPCMImport::OpenWaveFile()
+{
+	// Open and read wave file header
+	CFileException ex;
+
+	TRACE(_T("DPCM import: Loading wave file %s...\n"), m_strPath);
+
+	// // // Allow ConvertBatch to open the file again while it is being previewed
+	if (!m_fSampleFile.Open(m_strPath, CFile::modeRead | CFile::shareDenyWrite, &ex)) {
+		TCHAR   szCause[255];
+		CString strFormatted;
+		ex.GetErrorMessage(szCause, 255);
+		AfxFormatString1(strFormatted, IDS_OPEN_FILE_ERROR, szCause);
+		AfxMessageBox(strFormatted);
+		return false;
+	}
+
+	if (!ReadWaveInfo(m_fSampleFile, m_WaveInfo)) {
 		// Failed to load file properly, display error message and quit
 		TRACE(_T("DPCM import: Unsupported or invalid wave file\n"));
 		m_fSampleFile.Close();
@@ -558,14 +771,5 @@ bool CPCMImport::OpenWaveFile()
 		return false;
 	}
 
-	// Save file info
-	m_iChannels		  = WaveFormat.wf.nChannels;
-	m_iSampleSize	  = WaveFormat.wf.nBlockAlign / WaveFormat.wf.nChannels;
-	m_iBlockAlign	  = WaveFormat.wf.nBlockAlign;
-	m_iAvgBytesPerSec = WaveFormat.wf.nAvgBytesPerSec;
-	m_iSamplesPerSec  = WaveFormat.wf.nSamplesPerSec;
-
-	TRACE(_T("DPCM import: Scan done (%i Hz, %i bits, %i channels)\n"), m_iSamplesPerSec, m_iSampleSize, m_iChannels);
-
 	return true;
 }
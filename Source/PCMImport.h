@@ -20,10 +20,25 @@
 
 #pragma once
 
+#include <vector>
+
 namespace jarh {
 	class sinc;
 }
 
+class CDSample;
+
+// Location and format of the sample data in a PCM wave file
+struct stWaveInfo {
+	int Channels = 0;
+	int SampleSize = 0;		// bytes per channel
+	int BlockAlign = 0;
+	int AvgBytesPerSec = 0;
+	int SamplesPerSec = 0;
+	unsigned int WaveSize = 0;		// bytes in the data chunk
+	ULONGLONG SampleStart = 0;
+};
+
 class CPCMImport : public CDialog
 {
 	DECLARE_DYNAMIC(CPCMImport)
@@ -35,26 +50,27 @@ public:
 // Dialog Data
 	enum { IDD = IDD_PCMIMPORT };
 
-	CDSample *ShowDialog();
+	// Returns the imported samples, or an empty list on cancel/error
+	std::vector<CDSample *> ShowDialog();
+
+	static bool ReadWaveInfo(CFile &File, stWaveInfo &Info);
+	static CDSample *ConvertFile(CFile &File, const stWaveInfo &Info, int Quality, int Volume, bool Lookahead, const jarh::sinc &Sinc);
 
 protected:
-	CDSample *m_pImported;
+	std::vector<CDSample *> m_Imported;
 	CDSample *m_pCachedSample;
 
 	CString		m_strPath, m_strFileName;
+	std::vector<CString> m_BatchPaths;		// all selected files, including m_strPath
 	CFile		m_fSampleFile;
-	ULONGLONG	m_ullSampleStart;
+	stWaveInfo	m_WaveInfo;
 
 	int m_iQuality;
 	int m_iVolume;
-	int m_iSampleSize;
-	int m_iChannels;
-	int m_iBlockAlign;
-	int m_iAvgBytesPerSec;
-	int m_iSamplesPerSec;
+	bool m_bLookahead;
 	int m_iCachedQuality;
 	int m_iCachedVolume;
-	unsigned int m_iWaveSize;
+	bool m_bCachedLookahead;
 
 	jarh::sinc *m_psinc;
 
@@ -64,7 +80,7 @@ protected:
 
 protected:
 	CDSample *GetSample();
-	CDSample *ConvertFile();
+	void ConvertBatch();
 
 	bool OpenWaveFile();
 	void UpdateFileInfo();
@@ -80,4 +96,5 @@ public:
 	afx_msg void OnBnClickedCancel();
 	afx_msg void OnBnClickedOk();
 	afx_msg void OnBnClickedPreview();
+	afx_msg void OnBnClickedLookahead();
 };
@@ -259,8 +259,10 @@ bool CPatternAction::ValidateSelection(const CMainFrame *pMainFrm) const		// //
 
 void CPatternAction::UpdateView(CFamiTrackerDoc *pDoc) const		// // //
 {
-	pDoc->UpdateAllViews(NULL, UPDATE_PATTERN);
-	pDoc->UpdateAllViews(NULL, UPDATE_FRAME); // cursor might have moved to different channel
+	// // // Pass the edited rows along so that the pattern editor only repaints those
+	pDoc->UpdateAllViews(NULL, UPDATE_PATTERN, pDoc->GetPatternDamage());
+	pDoc->UpdateAllViews(NULL, UPDATE_FRAME, pDoc->GetPatternDamage()); // cursor might have moved to different channel
+	pDoc->ClearPatternDamage();
 }
 
 std::pair<CPatternIterator, CPatternIterator> CPatternAction::GetIterators(const CMainFrame *pMainFrm) const
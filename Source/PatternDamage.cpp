@@ -0,0 +1,94 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#include "stdafx.h"
+#include <algorithm>
+#include "PatternDamage.h"
+
+CPatternDamage::CPatternDamage() : m_bAll(false), m_iTrack(0)
+{
+}
+
+void CPatternDamage::Add(unsigned Track, unsigned Channel, unsigned Pattern, unsigned RowStart, unsigned RowEnd)
+{
+	if (m_bAll)
+		return;
+	if (!m_Ranges.empty() && Track != m_iTrack) {
+		AddAll();
+		return;
+	}
+	m_iTrack = Track;
+
+	// Extend the range of the same pattern if there is one
+	for (auto &x : m_Ranges)
+		if (x.Channel == Channel && x.Pattern == Pattern) {
+			x.RowStart = std::min(x.RowStart, RowStart);
+			x.RowEnd = std::max(x.RowEnd, RowEnd);
+			return;
+		}
+
+	if (m_Ranges.size() >= MAX_RANGES)
+		AddAll();
+	else
+		m_Ranges.push_back({Channel, Pattern, RowStart, RowEnd});
+}
+
+void CPatternDamage::AddAll()
+{
+	m_bAll = true;
+	m_Ranges.clear();
+}
+
+void CPatternDamage::Merge(const CPatternDamage &Other)
+{
+	if (Other.m_bAll)
+		AddAll();
+	else
+		for (const auto &x : Other.m_Ranges)
+			Add(Other.m_iTrack, x.Channel, x.Pattern, x.RowStart, x.RowEnd);
+}
+
+void CPatternDamage::Clear()
+{
+	m_bAll = false;
+	m_Ranges.clear();
+}
+
+bool CPatternDamage::IsEmpty() const
+{
+	return !m_bAll && m_Ranges.empty();
+}
+
+bool CPatternDamage::IsAll() const
+{
+	return m_bAll;
+}
+
+bool CPatternDamage::Contains(unsigned Track, unsigned Channel, unsigned Pattern, unsigned Row) const
+{
+	if (m_bAll)
+		return true;
+	if (Track != m_iTrack)
+		return false;
+	for (const auto &x : m_Ranges)
+		if (x.Channel == Channel && x.Pattern == Pattern && x.RowStart <= Row && Row <= x.RowEnd)
+			return true;
+	return false;
+}
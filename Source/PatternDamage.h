@@ -0,0 +1,88 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+/*!
+	\brief A region of pattern data changed by an edit, passed to the views as the hint object of
+	an UPDATE_PATTERN or UPDATE_FRAME notification.
+	\details The region consists of row ranges of individual patterns of a single track. Changes
+	which are not limited to known rows, or which affect too many patterns, mark the entire
+	document as changed instead.
+*/
+class CPatternDamage : public CObject
+{
+public:
+	/*!	\brief Constructor of the pattern damage region. The region is initially empty. */
+	CPatternDamage();
+
+	/*!	\brief Adds consecutive rows of a single pattern to the region.
+		\param Track The track index.
+		\param Channel The channel index.
+		\param Pattern The pattern index.
+		\param RowStart The first changed row.
+		\param RowEnd The last changed row.
+	*/
+	void Add(unsigned Track, unsigned Channel, unsigned Pattern, unsigned RowStart, unsigned RowEnd);
+	/*!	\brief Marks all pattern data as changed. */
+	void AddAll();
+	/*!	\brief Adds another region to this region.
+		\param Other The other region.
+	*/
+	void Merge(const CPatternDamage &Other);
+	/*!	\brief Empties the region. */
+	void Clear();
+
+	/*!	\brief Checks whether the region is empty.
+		\return True if no pattern data has changed.
+	*/
+	bool IsEmpty() const;
+	/*!	\brief Checks whether all pattern data is considered changed.
+		\return True if the views need a full redraw.
+	*/
+	bool IsAll() const;
+	/*!	\brief Checks whether a row of a pattern lies in the region.
+		\param Track The track index.
+		\param Channel The channel index.
+		\param Pattern The pattern index.
+		\param Row The row index.
+		\return True if the row has changed.
+	*/
+	bool Contains(unsigned Track, unsigned Channel, unsigned Pattern, unsigned Row) const;
+
+private:
+	struct stRange
+	{
+		unsigned Channel;
+		unsigned Pattern;
+		unsigned RowStart;
+		unsigned RowEnd;
+	};
+
+	/*!	\brief Number of distinct patterns above which the entire document is marked changed. */
+	static const size_t MAX_RANGES = 64;
+
+	bool m_bAll;
+	unsigned m_iTrack;
+	std::vector<stRange> m_Ranges;
+};
@@ -103,6 +103,12 @@ stChanNote *CPatternData::GetPatternData(unsigned int Channel, unsigned int Patt
 	return m_pPatternData[Channel][Pattern] + Row;
 }
 
+const stChanNote *CPatternData::GetPatternRows(unsigned int Channel, unsigned int Pattern) const		// // //
+{
+	// Does not allocate the pattern, unallocated patterns return NULL and are empty
+	return m_pPatternData[Channel][Pattern];
+}
+
 stChanNote *CPatternData::GetPatternData(unsigned int Channel, unsigned int Pattern, unsigned int Row)
 {
 	if (!m_pPatternData[Channel][Pattern])		// Allocate pattern if accessed for the first time
@@ -60,6 +60,7 @@ public:
 	void ClearPattern(unsigned int Channel, unsigned int Pattern);
 
 	stChanNote *GetPatternData(unsigned int Channel, unsigned int Pattern, unsigned int Row);
+	const stChanNote *GetPatternRows(unsigned int Channel, unsigned int Pattern) const;		// // //
 
 	CString GetTitle() const;
 	unsigned int GetPatternLength() const;
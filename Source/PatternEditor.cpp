@@ -61,6 +61,20 @@ static constexpr LPCTSTR DEFAULT_HEADER_FONT = _T("Tahoma");
 
 static constexpr int DEFAULT_HEADER_FONT_SIZE = 11;
 
+// // // Creates a top-down 32-bit bitmap whose pixels can be accessed directly
+static HBITMAP CreateDIB32(HDC hDC, int Width, int Height, void **ppBits)
+{
+	BITMAPINFO bmi = { };
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = Width;
+	bmi.bmiHeader.biHeight = -Height;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+	*ppBits = nullptr;
+	return ::CreateDIBSection(hDC, &bmi, DIB_RGB_COLORS, ppBits, NULL, 0);
+}
+
 // // //
 
 void CopyNoteSection(stChanNote *Target, const stChanNote *Source, paste_mode_t Mode, column_t Begin, column_t End)		// // //
@@ -217,6 +231,8 @@ CPatternEditor::CPatternEditor() :
 	m_iWarpCount(0),		// // //
 	m_iDragBeginWarp(0),		// // //
 	m_iSelectionCondition(SEL_CLEAN),		// // //
+	m_bSelectionDrawn(false),		// // //
+	m_iSelConditionDrawn(SEL_CLEAN),		// // //
 	// Benchmarking
 	m_iRedraws(0),
 	m_iFullRedraws(0),
@@ -233,6 +249,8 @@ CPatternEditor::CPatternEditor() :
 
 	memset(m_iChannelWidths, 0, sizeof(int) * MAX_CHANNELS);
 	memset(m_iColumns, 0, sizeof(int) * MAX_CHANNELS);
+
+	m_Rasterizer.SetAtlas(&m_GlyphAtlas);		// // //
 }
 
 CPatternEditor::~CPatternEditor()
@@ -287,6 +305,7 @@ void CPatternEditor::ApplyColorScheme()
 		m_fontPattern.DeleteObject();
 
 	m_fontPattern.CreateFontIndirect(&LogFont);
+	CreateGlyphAtlas();		// // //
 
 	// Create header font
 	memset(&LogFont, 0, sizeof(LOGFONT));
@@ -316,11 +335,73 @@ void CPatternEditor::ApplyColorScheme()
 	m_colHead4 = BLEND(m_colHead3, 0x4040F0, 80);
 	m_colHead5 = BLEND(m_colHead3, 0x40F040, 60);		// // //
 
+	m_colCursor				= settings->Appearance.iColCursor;		// // //
+	m_colBackground			= settings->Appearance.iColBackground;
+	m_colBackgroundHilite	= settings->Appearance.iColBackgroundHilite;
+	m_colBackgroundHilite2	= settings->Appearance.iColBackgroundHilite2;
+	m_colSelection			= settings->Appearance.iColSelection;
+	m_colText				= settings->Appearance.iColPatternText;
+	m_colTextHilite			= settings->Appearance.iColPatternTextHilite;
+	m_colTextHilite2		= settings->Appearance.iColPatternTextHilite2;
+	m_colInstrument			= settings->Appearance.iColPatternInstrument;
+	m_colVolume				= settings->Appearance.iColPatternVolume;
+	m_colEffect				= settings->Appearance.iColPatternEffect;
+	m_colCurrentRowNormal	= settings->Appearance.iColCurrentRowNormal;
+	m_colCurrentRowEdit		= settings->Appearance.iColCurrentRowEdit;
+	m_colCurrentRowPlaying	= settings->Appearance.iColCurrentRowPlaying;
+	m_bPatternColor			= settings->Appearance.bPatternColor;
+	m_bDisplayFlats			= settings->Appearance.bDisplayFlats;
+
 	InvalidateBackground();
 	InvalidatePatternData();
 	InvalidateHeader();
 }
 
+void CPatternEditor::CreateGlyphAtlas()		// // //
+{
+	// Render each character of the pattern font once, white on black, and keep
+	// the brightness as coverage. Cells are large enough for any glyph of the font.
+	const int Size = std::max(m_iPatternFontSize, m_iRowHeight);
+	const int Width = Size * 2;
+	const int Height = Size * 2;
+	const int OriginX = Size;
+	const int OriginY = Size * 3 / 2;
+
+	void *pBits = nullptr;
+	HBITMAP hBmp = CreateDIB32(NULL, Width, Height, &pBits);
+	if (hBmp == NULL) {
+		m_GlyphAtlas.Clear();
+		return;
+	}
+
+	CDC dc;
+	dc.CreateCompatibleDC(NULL);
+	HGDIOBJ hOldBmp = ::SelectObject(dc.GetSafeHdc(), hBmp);
+	CFont *pOldFont = dc.SelectObject(&m_fontPattern);
+	dc.SetBkMode(TRANSPARENT);
+	dc.SetTextAlign(TA_CENTER | TA_BASELINE);
+	dc.SetTextColor(0xFFFFFF);
+
+	m_GlyphAtlas.Create(Width, Height, OriginX, OriginY);
+	const uint32_t *pPixels = static_cast<const uint32_t *>(pBits);
+
+	for (int c = CGlyphAtlas::FIRST_CHAR; c <= CGlyphAtlas::LAST_CHAR; ++c) {
+		const TCHAR Char = c;
+		dc.FillSolidRect(0, 0, Width, Height, 0);
+		dc.TextOut(OriginX, OriginY, &Char, 1);
+		::GdiFlush();
+		uint8_t *pMask = m_GlyphAtlas.GetMask(static_cast<char>(c));
+		// ClearType renders per-subpixel coverage, the atlas keeps the average
+		for (int i = 0; i < Width * Height; ++i)
+			pMask[i] = (RED(pPixels[i]) + GREEN(pPixels[i]) + BLUE(pPixels[i])) / 3;
+	}
+	m_GlyphAtlas.Finish();
+
+	dc.SelectObject(pOldFont);
+	::SelectObject(dc.GetSafeHdc(), hOldBmp);
+	::DeleteObject(hBmp);
+}
+
 void CPatternEditor::SetDocument(CFamiTrackerDoc *pDoc, CFamiTrackerView *pView)
 {
 	// Set a new document and view, reset everything
@@ -371,6 +452,12 @@ void CPatternEditor::InvalidatePatternData()
 	m_bPatternInvalidated = true;
 }
 
+void CPatternEditor::InvalidatePatternData(const CPatternDamage &Damage)		// // //
+{
+	// Only some rows of pattern data have changed
+	m_PatternDamage.Merge(Damage);
+}
+
 void CPatternEditor::InvalidateCursor()
 {
 	// Cursor has moved
@@ -437,15 +524,20 @@ void CPatternEditor::DrawScreen(CDC *pDC, CFamiTrackerView *pView)
 	// Draw the pattern area, if necessary
 	//
 
-	bool bDrawPattern = m_bCursorInvalidated || m_bPatternInvalidated || m_bBackgroundInvalidated;
-	bool bQuickRedraw = !m_bPatternInvalidated && !m_bBackgroundInvalidated;
+	// // // Edited rows and selection changes only repaint the affected lines
+	const bool bDamaged = !m_PatternDamage.IsEmpty() || m_bSelectionInvalidated;
+	bool bDrawPattern = m_bCursorInvalidated || m_bPatternInvalidated || m_bBackgroundInvalidated || bDamaged;
+	bool bQuickRedraw = !m_bPatternInvalidated && !m_bBackgroundInvalidated && !m_PatternDamage.IsAll();
 
-	if (m_bSelectionInvalidated) {
-		// Selection has changed, do full redraw
+	if (m_bSelectionInvalidated && m_iSelectionCondition != m_iSelConditionDrawn) {
+		// Selection outline has changed, do full redraw
 		bDrawPattern = true;
 		bQuickRedraw = false;
 	}
 
+	if (m_LineStates.size() != static_cast<unsigned>(m_iLinesVisible + 1))		// // //
+		bQuickRedraw = false;
+
 	// Drag & drop
 	if (m_bDragging) {
 		bDrawPattern = true;
@@ -485,13 +577,19 @@ void CPatternEditor::DrawScreen(CDC *pDC, CFamiTrackerView *pView)
 		// Todo: remove
 		m_iDrawCursorRow = m_cpCursorPos.m_iRow;
 
+		// // // The pattern area is written directly, make sure GDI is done with it
+		::GdiFlush();
+
 		if (bQuickRedraw) {
 			// Quick redraw is possible
-			PerformQuickRedraw(m_pPatternDC);
+			if (m_bCursorInvalidated || m_iCenterRow != m_iLastCenterRow || m_iPlayRow != m_iLastPlayRow)		// // //
+				PerformQuickRedraw();
+			if (bDamaged)
+				PerformDamageRedraw();
 		}
 		else {
 			// Perform a full redraw
-			PerformFullRedraw(m_pPatternDC);
+			PerformFullRedraw();
 		}
 
 		++m_iRedraws;
@@ -522,6 +620,7 @@ void CPatternEditor::DrawScreen(CDC *pDC, CFamiTrackerView *pView)
 	m_bBackgroundInvalidated = false;
 	m_bHeaderInvalidated = false;
 	m_bSelectionInvalidated = false;
+	m_PatternDamage.Clear();		// // //
 
 	//
 	// Blit to visible surface
@@ -856,10 +955,12 @@ void CPatternEditor::CreateBackground(CDC *pDC)
 		int Width  = m_iRowColumnWidth + m_iPatternWidth;
 		int Height = m_iPatternHeight;
 
-		// Setup pattern dc
-		m_pPatternBmp->CreateCompatibleBitmap(pDC, Width, Height);
+		// Setup pattern dc, the pattern area is rasterized directly into its bits
+		void *pBits = nullptr;		// // //
+		m_pPatternBmp->Attach(CreateDIB32(pDC->GetSafeHdc(), Width, Height, &pBits));
 		m_pPatternDC->CreateCompatibleDC(pDC);
 		m_pPatternDC->SelectObject(m_pPatternBmp);
+		m_Rasterizer.SetTarget(static_cast<uint32_t *>(pBits), Width, Height, Width);
 
 		// Setup header dc
 		m_pHeaderBmp->CreateCompatibleBitmap(pDC, m_iWinWidth, HEADER_HEIGHT);		// // //
@@ -895,7 +996,7 @@ void CPatternEditor::DrawUnbufferedArea(CDC *pDC)
 	}
 }
 
-void CPatternEditor::PerformFullRedraw(CDC *pDC)
+void CPatternEditor::PerformFullRedraw()
 {
 	// Draw entire pattern area
 	
@@ -903,37 +1004,38 @@ void CPatternEditor::PerformFullRedraw(CDC *pDC)
 	const int FrameCount = GetFrameCount();		// // //
 	int Row = m_iCenterRow - m_iLinesVisible / 2;
 
-	CFont *pOldFont = pDC->SelectObject(&m_fontPattern);
-
-	pDC->SetBkMode(TRANSPARENT);
+	m_LineStates.assign(m_iLinesVisible + 1, stLineState { });		// // //
 
 	for (int i = 0; i < m_iLinesVisible; ++i)
-		PrintRow(pDC, Row++, i, m_cpCursorPos.m_iFrame);		// // //
+		PrintRow(Row++, i, m_cpCursorPos.m_iFrame);		// // //
 
 	// Last unvisible row
-	ClearRow(pDC, m_iLinesVisible);
+	ClearRow(m_iLinesVisible);
 
-	pDC->SetWindowOrg(-m_iRowColumnWidth, 0);
+	m_Rasterizer.SetOrigin(m_iRowColumnWidth, 0);		// // //
 
 	// Lines between channels
 	int Offset = m_iChannelWidths[m_iFirstChannel];
 	
 	for (int i = m_iFirstChannel; i < Channels; ++i) {
-		pDC->FillSolidRect(Offset - 1, 0, 1, m_iPatternHeight, m_colSeparator);
+		m_Rasterizer.FillRect(Offset - 1, 0, 1, m_iPatternHeight, m_colSeparator);
 		Offset += m_iChannelWidths[i + 1];
 	}
 
 	// First line (after row number column)
-	pDC->FillSolidRect(-1, 0, 1, m_iPatternHeight, m_colSeparator);
+	m_Rasterizer.FillRect(-1, 0, 1, m_iPatternHeight, m_colSeparator);
 
 	// Restore
-	pDC->SetWindowOrg(0, 0);
-	pDC->SelectObject(pOldFont);
+	m_Rasterizer.SetOrigin(0, 0);
+
+	m_selDrawn = m_selection;		// // //
+	m_bSelectionDrawn = m_bSelecting;
+	m_iSelConditionDrawn = m_iSelectionCondition;
 
 	++m_iFullRedraws;
 }
 
-void CPatternEditor::PerformQuickRedraw(CDC *pDC)
+void CPatternEditor::PerformQuickRedraw()
 {
 	// Draw specific parts of pattern area
 	ASSERT(m_cpCursorPos.m_iFrame == m_iLastFrame);
@@ -941,82 +1043,156 @@ void CPatternEditor::PerformQuickRedraw(CDC *pDC)
 	// Number of rows that has changed
 	const int DiffRows = m_iCenterRow - m_iLastCenterRow;
 
-	CFont *pOldFont = pDC->SelectObject(&m_fontPattern);
-
-	ScrollPatternArea(pDC, DiffRows);
+	ScrollPatternArea(DiffRows);
 
 	// Play cursor
 	if (theApp.IsPlaying() && !m_bFollowMode) {
-		//PrintRow(pDC, m_iPlayRow, 
+		//PrintRow(m_iPlayRow, 
 	}
 	else if (!theApp.IsPlaying() && m_iLastPlayRow != -1) {
 		if (m_iPlayFrame == m_cpCursorPos.m_iFrame) {
 			int Line = RowToLine(m_iLastPlayRow);
 			if (Line >= 0 && Line <= m_iLinesVisible) {
 				// Erase 
-				PrintRow(pDC, m_iLastPlayRow, Line, m_cpCursorPos.m_iFrame);
+				PrintRow(m_iLastPlayRow, Line, m_cpCursorPos.m_iFrame);
 			}
 		}
 	}
 
 	// Restore
-	pDC->SetWindowOrg(0, 0);
-	pDC->SelectObject(pOldFont);
+	m_Rasterizer.SetOrigin(0, 0);
 
 	UpdateVerticalScroll();
 
 	++m_iQuickRedraws;
 }
 
-void CPatternEditor::PrintRow(CDC *pDC, int Row, int Line, int Frame) const
+void CPatternEditor::PerformDamageRedraw()		// // //
 {
-	const int FrameCount = GetFrameCount();		// // //
-	const int rEnd = (theApp.IsPlaying() && m_bFollowMode) ? std::max(m_iPlayRow + 1, m_iPatternLength) : m_iPatternLength;
-	if (Row >= 0 && Row < rEnd) {
-		DrawRow(pDC, Row, Line, Frame, false);
-	}
-	else if (theApp.GetSettings()->General.bFramePreview) {
-		if (Row >= rEnd) { // first frame
-			Row -= rEnd;
-			Frame++;
-		}
-		while (Row >= GetCurrentPatternLength(Frame)) {		// // //
-			Row -= GetCurrentPatternLength(Frame++);
-			/*if (Frame >= FrameCount) {
-				Frame = 0;
-				// if (Row) Row--; else { ClearRow(pDC, Line); return; }
-			}*/
+	// Draw the channels of each line which show changed rows or a changed selection
+	const int Track = GetSelectedTrack();
+	const int Frames = GetFrameCount();
+	const int ChanFirst = m_iFirstChannel;
+	const int ChanLast = m_iFirstChannel + m_iChannelsVisible - 1;
+	const bool bSelChanged = m_bSelecting != m_bSelectionDrawn || (m_bSelecting &&
+		(m_selection.m_cpStart != m_selDrawn.m_cpStart || m_selection.m_cpEnd != m_selDrawn.m_cpEnd));
+
+	int Row = m_iCenterRow - m_iLinesVisible / 2;
+
+	for (int Line = 0; Line < m_iLinesVisible; ++Line, ++Row) {
+		int r = Row;
+		int f = m_cpCursorPos.m_iFrame;
+		bool bPreview = false;
+		const bool bVisible = ResolveRow(r, f, bPreview);
+
+		// Pattern lengths may have changed, redraw lines which now show another row
+		const stLineState &State = m_LineStates[Line];
+		if (bVisible != State.bVisible || (bVisible && (r != State.Row || f != State.Frame || bPreview != State.bPreview))) {
+			PrintRow(Row, Line, m_cpCursorPos.m_iFrame);
+			continue;
 		}
-		while (Row < 0) {		// // //
-			/*if (Frame <= 0) {
-				Frame = FrameCount;
-				// if (Row != -1) Row++; else { ClearRow(pDC, Line); return; }
-			}*/
-			Row += GetCurrentPatternLength(--Frame);
+		if (!bVisible)
+			continue;
+
+		const bool bOldSel = bSelChanged && m_bSelectionDrawn && IsRowInRange(m_selDrawn, f, r);
+		const bool bNewSel = bSelChanged && m_bSelecting && IsRowInRange(m_selection, f, r);
+
+		int nf = f % Frames;
+		if (nf < 0) nf += Frames;
+
+		int First = ChanLast + 1;
+		int Last = ChanFirst - 1;
+		for (int i = ChanFirst; i <= ChanLast; ++i) {
+			bool bDirty = m_PatternDamage.Contains(Track, i, m_pDocument->GetPatternAtFrame(Track, nf, i), r);
+			if (bOldSel && i >= m_selDrawn.GetChanStart() && i <= m_selDrawn.GetChanEnd())
+				bDirty = true;
+			if (bNewSel && i >= m_selection.GetChanStart() && i <= m_selection.GetChanEnd())
+				bDirty = true;
+			if (bDirty) {
+				First = std::min(First, i);
+				Last = std::max(Last, i);
+			}
 		}
-		DrawRow(pDC, Row, Line, Frame, true);
+
+		if (First <= Last)
+			DrawRow(r, Line, f, bPreview, First, Last);
 	}
-	else {
-		ClearRow(pDC, Line);
+
+	m_Rasterizer.SetOrigin(0, 0);
+
+	m_selDrawn = m_selection;
+	m_bSelectionDrawn = m_bSelecting;
+	m_iSelConditionDrawn = m_iSelectionCondition;
+}
+
+bool CPatternEditor::ResolveRow(int &Row, int &Frame, bool &bPreview) const		// // //
+{
+	// Translate a row relative to the given frame into the row and frame which are displayed there
+	bPreview = false;
+	const int rEnd = (theApp.IsPlaying() && m_bFollowMode) ? std::max(m_iPlayRow + 1, m_iPatternLength) : m_iPatternLength;
+	if (Row >= 0 && Row < rEnd)
+		return true;
+	if (!theApp.GetSettings()->General.bFramePreview)
+		return false;
+
+	bPreview = true;
+	if (Row >= rEnd) { // first frame
+		Row -= rEnd;
+		Frame++;
+	}
+	while (Row >= GetCurrentPatternLength(Frame)) {		// // //
+		Row -= GetCurrentPatternLength(Frame++);
+		/*if (Frame >= FrameCount) {
+			Frame = 0;
+			// if (Row) Row--; else { ClearRow(Line); return; }
+		}*/
+	}
+	while (Row < 0) {		// // //
+		/*if (Frame <= 0) {
+			Frame = FrameCount;
+			// if (Row != -1) Row++; else { ClearRow(Line); return; }
+		}*/
+		Row += GetCurrentPatternLength(--Frame);
 	}
+	return true;
+}
+
+void CPatternEditor::PrintRow(int Row, int Line, int Frame) const
+{
+	bool bPreview;		// // //
+	const bool bVisible = ResolveRow(Row, Frame, bPreview);
+	if (bVisible)
+		DrawRow(Row, Line, Frame, bPreview, m_iFirstChannel, m_iFirstChannel + m_iChannelsVisible - 1);
+	else
+		ClearRow(Line);
+
+	if (Line >= 0 && Line < static_cast<int>(m_LineStates.size()))
+		m_LineStates[Line] = stLineState {bVisible, Row, Frame, bPreview};
 }
 
-void CPatternEditor::MovePatternArea(CDC *pDC, int FromRow, int ToRow, int NumRows) const
+void CPatternEditor::MovePatternArea(int FromRow, int ToRow, int NumRows) const
 {
 	// Move a part of the pattern area
 	const int Width = m_iRowColumnWidth + m_iPatternWidth - 1;
 	const int SrcY = FromRow * m_iRowHeight;
 	const int DestY = ToRow * m_iRowHeight;
 	const int Height = NumRows * m_iRowHeight;
-	pDC->BitBlt(1, DestY, Width, Height, pDC, 1, SrcY, SRCCOPY); 
+	m_Rasterizer.MoveArea(1, SrcY, DestY, Width, Height);		// // //
+
+	// // // Lines keep what they show
+	if (NumRows > 0 && std::max(FromRow, ToRow) + NumRows <= static_cast<int>(m_LineStates.size())) {
+		auto First = m_LineStates.begin() + FromRow;
+		if (ToRow < FromRow)
+			std::copy(First, First + NumRows, m_LineStates.begin() + ToRow);
+		else
+			std::copy_backward(First, First + NumRows, m_LineStates.begin() + ToRow + NumRows);
+	}
 }
 
-void CPatternEditor::ScrollPatternArea(CDC *pDC, int Rows) const
+void CPatternEditor::ScrollPatternArea(int Rows) const
 {
 	ASSERT(Rows < (m_iLinesVisible / 2));
 
-	pDC->SetBkMode(TRANSPARENT);
-
 	const int FrameCount = GetFrameCount();		// // //
 	const int MiddleLine = m_iLinesVisible / 2;
 	const int Frame = m_cpCursorPos.m_iFrame;		// // //
@@ -1026,12 +1202,12 @@ void CPatternEditor::ScrollPatternArea(CDC *pDC, int Rows) const
 
 	// Move existing areas
 	if (Rows > 0) {
-		MovePatternArea(pDC, Rows, 0, FirstLineCount - Rows);
-		MovePatternArea(pDC, MiddleLine + Rows + 1, MiddleLine + 1, SecondLineCount - Rows);
+		MovePatternArea(Rows, 0, FirstLineCount - Rows);
+		MovePatternArea(MiddleLine + Rows + 1, MiddleLine + 1, SecondLineCount - Rows);
 	}
 	else if (Rows < 0) {
-		MovePatternArea(pDC, 0, -Rows, FirstLineCount + Rows);
-		MovePatternArea(pDC, MiddleLine + 1, MiddleLine - Rows + 1, SecondLineCount + Rows);
+		MovePatternArea(0, -Rows, FirstLineCount + Rows);
+		MovePatternArea(MiddleLine + 1, MiddleLine - Rows + 1, SecondLineCount + Rows);
 	}
 
 	// Fill new sections
@@ -1040,13 +1216,13 @@ void CPatternEditor::ScrollPatternArea(CDC *pDC, int Rows) const
 		for (int i = 0; i < Rows; ++i) {
 			int Row = m_iDrawCursorRow - 1 - i;
 			int Line = MiddleLine - 1 - i;
-			PrintRow(pDC, Row, Line, Frame);
+			PrintRow(Row, Line, Frame);
 		}
 		// Bottom of screen
 		for (int i = 0; i < Rows; ++i) {
 			int Row = m_iDrawCursorRow + SecondLineCount - i;
 			int Line = m_iLinesVisible - 1 - i;
-			PrintRow(pDC, Row, Line, Frame);
+			PrintRow(Row, Line, Frame);
 		}
 	}
 	else if (Rows < 0) {
@@ -1054,33 +1230,33 @@ void CPatternEditor::ScrollPatternArea(CDC *pDC, int Rows) const
 		for (int i = 0; i < -Rows; ++i) {
 			int Row = m_iDrawCursorRow - FirstLineCount + i;
 			int Line = i;
-			PrintRow(pDC, Row, Line, Frame);
+			PrintRow(Row, Line, Frame);
 		}
 		// Below cursor
 		for (int i = 0; i < -Rows; ++i) {
 			int Row = m_iDrawCursorRow + 1 + i;
 			int Line = MiddleLine + 1 + i;
-			PrintRow(pDC, Row, Line, Frame);
+			PrintRow(Row, Line, Frame);
 		}
 	}
 
 	// Draw cursor line, draw separately to allow calling this with zero rows
 	const int Row = m_iDrawCursorRow;
-	PrintRow(pDC, Row, MiddleLine, Frame);
+	PrintRow(Row, MiddleLine, Frame);
 }
 
-void CPatternEditor::ClearRow(CDC *pDC, int Line) const
+void CPatternEditor::ClearRow(int Line) const
 {
-	pDC->SetWindowOrg(0, 0);	
+	m_Rasterizer.SetOrigin(0, 0);		// // //
 
 	int Offset = m_iRowColumnWidth;
 	for (int i = m_iFirstChannel; i < m_iFirstChannel + m_iChannelsVisible; ++i) {
-		pDC->FillSolidRect(Offset, Line * m_iRowHeight, m_iChannelWidths[i] - 1, m_iRowHeight, m_colEmptyBg);
+		m_Rasterizer.FillRect(Offset, Line * m_iRowHeight, m_iChannelWidths[i] - 1, m_iRowHeight, m_colEmptyBg);
 		Offset += m_iChannelWidths[i];
 	}
 
 	// Row number
-	pDC->FillSolidRect(1, Line * m_iRowHeight, m_iRowColumnWidth - 2, m_iRowHeight, m_colEmptyBg);
+	m_Rasterizer.FillRect(1, Line * m_iRowHeight, m_iRowColumnWidth - 2, m_iRowHeight, m_colEmptyBg);
 }
 
 // // // gone
@@ -1093,6 +1269,12 @@ bool CPatternEditor::IsInRange(const CSelection &sel, int Frame, int Row, int Ch
 	if (Channel >= sel.GetChanEnd() && (Channel != sel.GetChanEnd() || Column > sel.GetColEnd()))
 		return false;
 
+	return IsRowInRange(sel, Frame, Row);
+}
+
+bool CPatternEditor::IsRowInRange(const CSelection &sel, int Frame, int Row) const		// // //
+{
+	// Return true if the row lies between the first and last rows of the selection
 	const int Frames = GetFrameCount();
 	int fStart = sel.GetFrameStart() % Frames;
 	if (fStart < 0) fStart += Frames;
@@ -1110,10 +1292,11 @@ bool CPatternEditor::IsInRange(const CSelection &sel, int Frame, int Row, int Ch
 }
 
 // Draw a single row
-void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPreview) const
+void CPatternEditor::DrawRow(int Row, int Line, int Frame, bool bPreview, int ChanFirst, int ChanLast) const
 {
 	// Row is row from pattern to display
 	// Line is (absolute) screen line
+	// // // Only channels ChanFirst to ChanLast are drawn, the row number column only if all visible channels are
 
 	const COLORREF GRAY_BAR_COLOR = 0x606060;
 	const COLORREF SEL_DRAG_COL	  = 0xA08080;
@@ -1125,11 +1308,11 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 
 	const CSettings *pSettings = theApp.GetSettings();		// // //
 
-	COLORREF ColCursor	= pSettings->Appearance.iColCursor;
-	COLORREF ColBg		= pSettings->Appearance.iColBackground;
-	COLORREF ColHiBg	= pSettings->Appearance.iColBackgroundHilite;
-	COLORREF ColHiBg2	= pSettings->Appearance.iColBackgroundHilite2;
-	COLORREF ColSelect	= pSettings->Appearance.iColSelection;
+	COLORREF ColCursor	= m_colCursor;		// // // cached by ApplyColorScheme
+	COLORREF ColBg		= m_colBackground;
+	COLORREF ColHiBg	= m_colBackgroundHilite;
+	COLORREF ColHiBg2	= m_colBackgroundHilite2;
+	COLORREF ColSelect	= m_colSelection;
 
 	const bool bEditMode = m_pView->GetEditMode();
 
@@ -1140,29 +1323,33 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 	stChanNote NoteData;
 
 	// Start at row number column
-	pDC->SetWindowOrg(0, 0);
+	m_Rasterizer.SetOrigin(0, 0);
 
 	if (Frame != m_cpCursorPos.m_iFrame && !pSettings->General.bFramePreview) {
-		ClearRow(pDC, Line);
+		ClearRow(Line);
 		return;
 	}
 
+	const bool bRowNumber = ChanFirst <= m_iFirstChannel && ChanLast >= m_iFirstChannel + m_iChannelsVisible - 1;		// // //
+
 	// Highlight
 	unsigned int Highlight = m_pDocument->GetHighlightState(Track, Frame, Row);		// // //
 
 	// Clear
-	pDC->FillSolidRect(1, Line * m_iRowHeight, m_iRowColumnWidth - 2, m_iRowHeight, ColBg);
-	if (m_pDocument->GetBookmarkAt(Track, Frame, Row))
-		pDC->FillSolidRect(1, Line * m_iRowHeight, m_iRowColumnWidth - 2, m_iRowHeight, ColHiBg);
+	if (bRowNumber) {		// // //
+		m_Rasterizer.FillRect(1, Line * m_iRowHeight, m_iRowColumnWidth - 2, m_iRowHeight, ColBg);
+		if (m_pDocument->GetBookmarkAt(Track, Frame, Row))
+			m_Rasterizer.FillRect(1, Line * m_iRowHeight, m_iRowColumnWidth - 2, m_iRowHeight, ColHiBg);
+	}
 
 	COLORREF TextColor;
 
 	if (Highlight == 2)
-		TextColor = pSettings->Appearance.iColPatternTextHilite2;
+		TextColor = m_colTextHilite2;
 	else if (Highlight == 1)
-		TextColor = pSettings->Appearance.iColPatternTextHilite;
+		TextColor = m_colTextHilite;
 	else
-		TextColor = pSettings->Appearance.iColPatternText;
+		TextColor = m_colText;
 
 	if (bPreview) {
 		ColHiBg2 = DIM(ColHiBg2, PREVIEW_SHADE_LEVEL);
@@ -1173,30 +1360,28 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 
 	// // // 050B
 	// Draw row marker
-	if (!((Frame - m_pView->GetMarkerFrame()) % GetFrameCount()) && Row == m_pView->GetMarkerRow())
-		GradientBar(pDC, 2, Line * m_iRowHeight, m_iRowColumnWidth - 5, m_iRowHeight, ColCursor, DIM(ColCursor, 30));
+	if (bRowNumber && !((Frame - m_pView->GetMarkerFrame()) % GetFrameCount()) && Row == m_pView->GetMarkerRow())		// // //
+		m_Rasterizer.GradientBar(2, Line * m_iRowHeight, m_iRowColumnWidth - 5, m_iRowHeight, ColCursor, DIM(ColCursor, 30));
 
 	// Draw row number
-	pDC->SetTextAlign(TA_CENTER | TA_BASELINE);		// // //
-
 	CString Text;
 
-	if (pSettings->General.bRowInHex) {
-		// // // Hex display
-		Text.Format(_T("%02X"), Row);
-		DrawChar(pDC, (m_iRowColumnWidth - m_iCharWidth) / 2, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[0], TextColor);
-		DrawChar(pDC, (m_iRowColumnWidth + m_iCharWidth) / 2, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[1], TextColor);
-	}
-	else {
-		// // // Decimal display
-		Text.Format(_T("%03d"), Row);
-		DrawChar(pDC, m_iRowColumnWidth / 2 - m_iCharWidth, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[0], TextColor);
-		DrawChar(pDC, m_iRowColumnWidth / 2				  , (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[1], TextColor);
-		DrawChar(pDC, m_iRowColumnWidth / 2 + m_iCharWidth, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[2], TextColor);
+	if (bRowNumber) {		// // //
+		if (pSettings->General.bRowInHex) {
+			// // // Hex display
+			Text.Format(_T("%02X"), Row);
+			DrawChar((m_iRowColumnWidth - m_iCharWidth) / 2, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[0], TextColor);
+			DrawChar((m_iRowColumnWidth + m_iCharWidth) / 2, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[1], TextColor);
+		}
+		else {
+			// // // Decimal display
+			Text.Format(_T("%03d"), Row);
+			DrawChar(m_iRowColumnWidth / 2 - m_iCharWidth, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[0], TextColor);
+			DrawChar(m_iRowColumnWidth / 2				  , (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[1], TextColor);
+			DrawChar(m_iRowColumnWidth / 2 + m_iCharWidth, (Line + 1) * m_iRowHeight - m_iRowHeight / 8, Text[2], TextColor);
+		}
 	}
 
-	pDC->SetTextAlign(TA_LEFT);		// // //
-
 	COLORREF BackColor;
 	if (Highlight == 2)
 		BackColor = ColHiBg2;	// Highlighted row
@@ -1210,9 +1395,9 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 		if (!m_bHasFocus)
 			BackColor = BLEND(GRAY_BAR_COLOR, BackColor, SHADE_LEVEL.UNFOCUSED);	// Gray
 		else if (bEditMode)
-			BackColor = BLEND(pSettings->Appearance.iColCurrentRowEdit, BackColor, SHADE_LEVEL.FOCUSED);		// Red
+			BackColor = BLEND(m_colCurrentRowEdit, BackColor, SHADE_LEVEL.FOCUSED);		// Red
 		else
-			BackColor = BLEND(pSettings->Appearance.iColCurrentRowNormal, BackColor, SHADE_LEVEL.FOCUSED);		// Blue
+			BackColor = BLEND(m_colCurrentRowNormal, BackColor, SHADE_LEVEL.FOCUSED);		// Blue
 	}
 
 	const COLORREF SelectColor = DIM(BLEND(ColSelect, BackColor, SHADE_LEVEL.SELECT),		// // //
@@ -1228,22 +1413,22 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 	colorInfo.Note = TextColor;
 
 	if (Highlight == 2)
-		colorInfo.Back = pSettings->Appearance.iColBackgroundHilite2;
+		colorInfo.Back = m_colBackgroundHilite2;
 	else if (Highlight == 1)
-		colorInfo.Back = pSettings->Appearance.iColBackgroundHilite;
+		colorInfo.Back = m_colBackgroundHilite;
 	else
-		colorInfo.Back = pSettings->Appearance.iColBackground;
+		colorInfo.Back = m_colBackground;
 
 	colorInfo.Shaded = BLEND(TextColor, colorInfo.Back, SHADE_LEVEL.UNUSED);
 	colorInfo.Compact = BLEND(TextColor, colorInfo.Back, SHADE_LEVEL.PREVIEW);		// // //
 
-	if (!pSettings->Appearance.bPatternColor) {		// // //
+	if (!m_bPatternColor) {		// // //
 		colorInfo.Instrument = colorInfo.Volume = colorInfo.Effect = colorInfo.Note;
 	}
 	else {
-		colorInfo.Instrument = pSettings->Appearance.iColPatternInstrument;
-		colorInfo.Volume = pSettings->Appearance.iColPatternVolume;
-		colorInfo.Effect = pSettings->Appearance.iColPatternEffect;
+		colorInfo.Instrument = m_colInstrument;
+		colorInfo.Volume = m_colVolume;
+		colorInfo.Effect = m_colEffect;
 	}
 
 	if (bPreview) {
@@ -1257,12 +1442,17 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 
 	// Draw channels
 	for (int i = m_iFirstChannel; i < m_iFirstChannel + m_iChannelsVisible; ++i) {
+		if (i < ChanFirst || i > ChanLast) {		// // //
+			OffsetX += m_iChannelWidths[i];
+			continue;
+		}
+
 		int f = Frame % GetFrameCount();
 		if (f < 0) f += GetFrameCount();
 
 		m_pDocument->GetNoteData(Track, f, i, Row, &NoteData);
 
-		pDC->SetWindowOrg(-OffsetX, - (signed)Line * m_iRowHeight);
+		m_Rasterizer.SetOrigin(OffsetX, Line * m_iRowHeight);		// // //
 
 		int PosX	 = m_iColumnSpacing;
 		int SelStart = m_iColumnSpacing;
@@ -1270,13 +1460,13 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 		int Width	 = m_iChannelWidths[i] - 1;		// Remove 1, spacing between channels
 
 		if (BackColor == ColBg)
-			pDC->FillSolidRect(0, 0, Width, m_iRowHeight, BackColor);
+			m_Rasterizer.FillRect(0, 0, Width, m_iRowHeight, BackColor);
 		else
-			GradientBar(pDC, 0, 0, Width, m_iRowHeight, BackColor, ColBg);
+			m_Rasterizer.GradientBar(0, 0, Width, m_iRowHeight, BackColor, ColBg);
 
 		if (!m_bFollowMode && Row == m_iPlayRow && f == m_iPlayFrame && theApp.IsPlaying()) {
 			// Play row
-			GradientBar(pDC, 0, 0, Width, m_iRowHeight, pSettings->Appearance.iColCurrentRowPlaying, ColBg);		// // //
+			m_Rasterizer.GradientBar(0, 0, Width, m_iRowHeight, m_colCurrentRowPlaying, ColBg);		// // //
 		}
 
 		// Draw each column
@@ -1288,24 +1478,24 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 			// Selection
 			if (m_bSelecting) {		// // //
 				if (IsInRange(m_selection, Frame, Row, i, j)) {		// // //
-					pDC->FillSolidRect(SelStart - m_iColumnSpacing, 0, SelWidth, m_iRowHeight, SelectColor);
+					m_Rasterizer.FillRect(SelStart - m_iColumnSpacing, 0, SelWidth, m_iRowHeight, SelectColor);
 
 					// Outline
 					if (Row == m_selection.GetRowStart() && !((f - m_selection.GetFrameStart()) % GetFrameCount()))
-						pDC->FillSolidRect(SelStart - m_iColumnSpacing, 0, SelWidth, BorderWidth, SelectEdgeCol);
+						m_Rasterizer.FillRect(SelStart - m_iColumnSpacing, 0, SelWidth, BorderWidth, SelectEdgeCol);
 					if (Row == m_selection.GetRowEnd() && !((f - m_selection.GetFrameEnd()) % GetFrameCount()))
-						pDC->FillSolidRect(SelStart - m_iColumnSpacing, m_iRowHeight - BorderWidth, SelWidth, BorderWidth, SelectEdgeCol);
+						m_Rasterizer.FillRect(SelStart - m_iColumnSpacing, m_iRowHeight - BorderWidth, SelWidth, BorderWidth, SelectEdgeCol);
 					if (i == m_selection.GetChanStart() && (j == m_selection.GetColStart() || m_bCompactMode))		// // //
-						pDC->FillSolidRect(SelStart - m_iColumnSpacing, 0, BorderWidth, m_iRowHeight, SelectEdgeCol);
+						m_Rasterizer.FillRect(SelStart - m_iColumnSpacing, 0, BorderWidth, m_iRowHeight, SelectEdgeCol);
 					if (i == m_selection.GetChanEnd() && (j == m_selection.GetColEnd() || m_bCompactMode))		// // //
-						pDC->FillSolidRect(SelStart - m_iColumnSpacing + SelWidth - BorderWidth, 0, BorderWidth, m_iRowHeight, SelectEdgeCol);
+						m_Rasterizer.FillRect(SelStart - m_iColumnSpacing + SelWidth - BorderWidth, 0, BorderWidth, m_iRowHeight, SelectEdgeCol);
 				}
 			}
 
 			// Dragging
 			if (m_bDragging) {		// // //
 				if (IsInRange(m_selDrag, Frame, Row, i, j)) {		// // //
-					pDC->FillSolidRect(SelStart - m_iColumnSpacing, 0, SelWidth, m_iRowHeight, DragColor);
+					m_Rasterizer.FillRect(SelStart - m_iColumnSpacing, 0, SelWidth, m_iRowHeight, DragColor);
 				}
 			}
 
@@ -1313,13 +1503,13 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 
 			// Draw cursor box
 			if (i == m_cpCursorPos.m_iChannel && j == m_cpCursorPos.m_iColumn && Row == m_iDrawCursorRow && !bPreview) {
-				GradientBar(pDC, PosX - m_iColumnSpacing / 2, 0, GetColumnWidth(j), m_iRowHeight, ColCursor, ColBg);		// // //
-				pDC->Draw3dRect(PosX - m_iColumnSpacing / 2, 0, GetColumnWidth(j), m_iRowHeight, ColCursor, DIM(ColCursor, 50));
-				//pDC->Draw3dRect(PosX - m_iColumnSpacing / 2 - 1, -1, GetColumnWidth(j) + 2, m_iRowHeight + 2, ColCursor, DIM(ColCursor, 50));
+				m_Rasterizer.GradientBar(PosX - m_iColumnSpacing / 2, 0, GetColumnWidth(j), m_iRowHeight, ColCursor, ColBg);		// // //
+				m_Rasterizer.Draw3dRect(PosX - m_iColumnSpacing / 2, 0, GetColumnWidth(j), m_iRowHeight, ColCursor, DIM(ColCursor, 50));
+				//m_Rasterizer.Draw3dRect(PosX - m_iColumnSpacing / 2 - 1, -1, GetColumnWidth(j) + 2, m_iRowHeight + 2, ColCursor, DIM(ColCursor, 50));
 				bInvert = true;
 			}
 
-			DrawCell(pDC, PosX - m_iColumnSpacing / 2, j, i, bInvert, &NoteData, &colorInfo);		// // //
+			DrawCell(PosX - m_iColumnSpacing / 2, j, i, bInvert, &NoteData, &colorInfo);		// // //
 			PosX += GetColumnSpace(j);
 			if (!m_bCompactMode)		// // //
 				SelStart += GetSelectWidth(j);
@@ -1331,7 +1521,7 @@ void CPatternEditor::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPrevi
 
 static const int HEIGHT_OFFSET = 6;
 
-void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Channel, bool bInvert, stChanNote *pNoteData, RowColorInfo_t *pColorInfo) const
+void CPatternEditor::DrawCell(int PosX, cursor_column_t Column, int Channel, bool bInvert, stChanNote *pNoteData, RowColorInfo_t *pColorInfo) const
 {
 	// Sharps
 	static const char NOTES_A_SHARP[] = {'C', 'C', 'D', 'D', 'E', 'F', 'F', 'G', 'G', 'A', 'A', 'B'};
@@ -1344,10 +1534,8 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 	// Hex numbers
 	static const char HEX[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
 
-	const bool m_bDisplayFlat = theApp.GetSettings()->Appearance.bDisplayFlats;		// // //
-
-	const char *NOTES_A = m_bDisplayFlat ? NOTES_A_FLAT : NOTES_A_SHARP;
-	const char *NOTES_B = m_bDisplayFlat ? NOTES_B_FLAT : NOTES_B_SHARP;
+	const char *NOTES_A = m_bDisplayFlats ? NOTES_A_FLAT : NOTES_A_SHARP;		// // //
+	const char *NOTES_B = m_bDisplayFlats ? NOTES_B_FLAT : NOTES_B_SHARP;
 
 	// Compute font vertical position
 	// TODO resize font about center = avg(cap, base + descender/2)?
@@ -1362,7 +1550,7 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 	const int BAR_WIDTH = m_iRowHeight * 1 / 3;
 	const int BAR_HEIGHT = std::max(m_iRowHeight / 12, 1);
 	auto BAR = [&](int x) {
-		pDC->FillSolidRect(
+		m_Rasterizer.FillRect(
 				x + halfX - BAR_WIDTH / 2,
 				halfY - BAR_HEIGHT / 2,
 				BAR_WIDTH,
@@ -1370,8 +1558,6 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 				pColorInfo->Shaded);
 	};
 
-	pDC->SetTextAlign(TA_CENTER | TA_BASELINE);		// // //
-
 	const CTrackerChannel *pTrackerChannel = m_pDocument->GetChannel(Channel);
 
 	effect_t EffNumber = Column >= 4 ? pNoteData->EffNumber[(Column - 4) / 3] : EF_NONE;		// // //
@@ -1389,12 +1575,12 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 		switch (Column) {
 		case C_NOTE:
 			if (pNoteData->Note > ECHO || pNoteData->Octave > 8) {
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
-				DrawChar(pDC, PosX + m_iCharWidth * 3 / 2, PosY, '?', ErrorColor);
+				DrawChar(PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
+				DrawChar(PosX + m_iCharWidth * 3 / 2, PosY, '?', ErrorColor);
 				if (pNoteData->Octave > 8)
-					DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, '?', ErrorColor);
+					DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, '?', ErrorColor);
 				else
-					DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, NOTES_C[pNoteData->Octave], WarningColor);
+					DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, NOTES_C[pNoteData->Octave], WarningColor);
 				break;
 			}
 			else {
@@ -1405,23 +1591,23 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 			break;
 		case C_INSTRUMENT1: case C_INSTRUMENT2:
 			if (pNoteData->Instrument > MAX_INSTRUMENTS && pNoteData->Instrument != HOLD_INSTRUMENT)
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
 			else
 				BAR(PosX);
 			break;
 		case C_VOLUME:
 			if (pNoteData->Vol > MAX_VOLUME)
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
 			else
 				BAR(PosX);
 			break;
 		case C_EFF1_NUM: case C_EFF2_NUM: case C_EFF3_NUM: case C_EFF4_NUM:
 			if (EffNumber >= EF_COUNT)
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, '?', ErrorColor);		// // //
 			else if (EffNumber == 0)
 				BAR(PosX);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, EFF_CHAR[EffNumber], WarningColor);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, EFF_CHAR[EffNumber], WarningColor);		// // //
 			break;
 		// draw effect param as normal
 		case C_EFF1_PARAM1: case C_EFF2_PARAM1: case C_EFF3_PARAM1: case C_EFF4_PARAM1:
@@ -1429,14 +1615,14 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 			if (EffNumber == EF_NONE)
 				BAR(PosX);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[(EffParam >> 4) & 0x0F], pColorInfo->Note);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[(EffParam >> 4) & 0x0F], pColorInfo->Note);		// // //
 			break;
 		case C_EFF1_PARAM2: case C_EFF2_PARAM2: case C_EFF3_PARAM2: case C_EFF4_PARAM2:
 			// Effect param y
 			if (EffNumber == EF_NONE)
 				BAR(PosX);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[EffParam & 0x0F], pColorInfo->Note);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[EffParam & 0x0F], pColorInfo->Note);		// // //
 			break;
 		}
 		return;
@@ -1466,26 +1652,26 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 					if (m_bCompactMode) {		// // //
 						if (pNoteData->Instrument != MAX_INSTRUMENTS) {
 							if (pNoteData->Instrument == HOLD_INSTRUMENT) {		// // // 050B
-								DrawChar(pDC, PosX + m_iCharWidth * 3 / 2, PosY, '&', DimInst);
-								DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, '&', DimInst);
+								DrawChar(PosX + m_iCharWidth * 3 / 2, PosY, '&', DimInst);
+								DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, '&', DimInst);
 							}
 							else {
-								DrawChar(pDC, PosX + m_iCharWidth * 3 / 2, PosY, HEX[pNoteData->Instrument >> 4], DimInst);
-								DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, HEX[pNoteData->Instrument & 0x0F], DimInst);
+								DrawChar(PosX + m_iCharWidth * 3 / 2, PosY, HEX[pNoteData->Instrument >> 4], DimInst);
+								DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, HEX[pNoteData->Instrument & 0x0F], DimInst);
 							}
 							break;
 						}
 						else if (pNoteData->Vol != MAX_VOLUME) {
-							DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, HEX[pNoteData->Vol], pColorInfo->Compact);
+							DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, HEX[pNoteData->Vol], pColorInfo->Compact);
 							break;
 						}
 						else {
 							bool Found = false;
 							for (unsigned int i = 0; i <= m_pDocument->GetEffColumns(GetSelectedTrack(), Channel); i++) {
 								if (pNoteData->EffNumber[i] != EF_NONE) {
-									DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, EFF_CHAR[pNoteData->EffNumber[i]], DimEff);
-									DrawChar(pDC, PosX + m_iCharWidth * 3 / 2, PosY, HEX[pNoteData->EffParam[i] >> 4], DimEff);
-									DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, HEX[pNoteData->EffParam[i] & 0x0F], DimEff);
+									DrawChar(PosX + m_iCharWidth / 2, PosY, EFF_CHAR[pNoteData->EffNumber[i]], DimEff);
+									DrawChar(PosX + m_iCharWidth * 3 / 2, PosY, HEX[pNoteData->EffParam[i] >> 4], DimEff);
+									DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, HEX[pNoteData->EffParam[i] & 0x0F], DimEff);
 									Found = true;
 									break;
 								}
@@ -1504,25 +1690,25 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 					break;		// // // same below
 				case HALT:
 					// Note stop
-					GradientBar(pDC, PosX + 5, (m_iRowHeight / 2) - 2, m_iCharWidth * 3 - 11, m_iRowHeight / 4, pColorInfo->Note, pColorInfo->Back);
+					m_Rasterizer.GradientBar(PosX + 5, (m_iRowHeight / 2) - 2, m_iCharWidth * 3 - 11, m_iRowHeight / 4, pColorInfo->Note, pColorInfo->Back);
 					break;
 				case RELEASE:
 					// Note release
-					pDC->FillSolidRect(PosX + 5, m_iRowHeight / 2 - 3, m_iCharWidth * 3 - 11, 2, pColorInfo->Note);		// // //
-					pDC->FillSolidRect(PosX + 5, m_iRowHeight / 2 + 1, m_iCharWidth * 3 - 11, 2, pColorInfo->Note);
+					m_Rasterizer.FillRect(PosX + 5, m_iRowHeight / 2 - 3, m_iCharWidth * 3 - 11, 2, pColorInfo->Note);		// // //
+					m_Rasterizer.FillRect(PosX + 5, m_iRowHeight / 2 + 1, m_iCharWidth * 3 - 11, 2, pColorInfo->Note);
 					break;
 				case ECHO:
 					// // // Echo buffer access
-					DrawChar(pDC, PosX + m_iCharWidth, PosY, _T('^'), pColorInfo->Note);
-					DrawChar(pDC, PosX + m_iCharWidth * 2, PosY, NOTES_C[pNoteData->Octave], pColorInfo->Note);
+					DrawChar(PosX + m_iCharWidth, PosY, _T('^'), pColorInfo->Note);
+					DrawChar(PosX + m_iCharWidth * 2, PosY, NOTES_C[pNoteData->Octave], pColorInfo->Note);
 					break;
 				default:
 					if (pTrackerChannel->GetID() == CHANID_NOISE) {
 						// Noise
 						char NoiseFreq = (pNoteData->Note - 1 + pNoteData->Octave * 12) & 0x0F;
-						DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[NoiseFreq], pColorInfo->Note);		// // //
-						DrawChar(pDC, PosX + m_iCharWidth * 3 / 2, PosY, '-', pColorInfo->Note);
-						DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, '#', pColorInfo->Note);
+						DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[NoiseFreq], pColorInfo->Note);		// // //
+						DrawChar(PosX + m_iCharWidth * 3 / 2, PosY, '-', pColorInfo->Note);
+						DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, '#', pColorInfo->Note);
 					}
 					else {
 						// The rest
@@ -1545,9 +1731,9 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 							noteCol = WarningColor;
 					
 						
-						DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, NOTES_A[pNoteData->Note - 1], noteCol);		// // //
-						DrawChar(pDC, PosX + m_iCharWidth * 3 / 2, PosY, NOTES_B[pNoteData->Note - 1], noteCol);
-						DrawChar(pDC, PosX + m_iCharWidth * 5 / 2, PosY, NOTES_C[pNoteData->Octave], noteCol);
+						DrawChar(PosX + m_iCharWidth / 2, PosY, NOTES_A[pNoteData->Note - 1], noteCol);		// // //
+						DrawChar(PosX + m_iCharWidth * 3 / 2, PosY, NOTES_B[pNoteData->Note - 1], noteCol);
+						DrawChar(PosX + m_iCharWidth * 5 / 2, PosY, NOTES_C[pNoteData->Octave], noteCol);
 					}
 					break;
 			}
@@ -1557,50 +1743,49 @@ void CPatternEditor::DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Ch
 			if (pNoteData->Instrument == MAX_INSTRUMENTS || pNoteData->Note == HALT || pNoteData->Note == RELEASE)
 				BAR(PosX);
 			else if (pNoteData->Instrument == HOLD_INSTRUMENT)		// // // 050B
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, '&', InstColor);
+				DrawChar(PosX + m_iCharWidth / 2, PosY, '&', InstColor);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[pNoteData->Instrument >> 4], InstColor);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[pNoteData->Instrument >> 4], InstColor);		// // //
 			break;
 		case C_INSTRUMENT2:
 			// Instrument 0x
 			if (pNoteData->Instrument == MAX_INSTRUMENTS || pNoteData->Note == HALT || pNoteData->Note == RELEASE)
 				BAR(PosX);
 			else if (pNoteData->Instrument == HOLD_INSTRUMENT)		// // // 050B
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, '&', InstColor);
+				DrawChar(PosX + m_iCharWidth / 2, PosY, '&', InstColor);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[pNoteData->Instrument & 0x0F], InstColor);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[pNoteData->Instrument & 0x0F], InstColor);		// // //
 			break;
 		case C_VOLUME: 
 			// Volume
 			if (pNoteData->Vol == MAX_VOLUME || pTrackerChannel->GetID() == CHANID_DPCM)
 				BAR(PosX);
 			else 
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[pNoteData->Vol & 0x0F], pColorInfo->Volume);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[pNoteData->Vol & 0x0F], pColorInfo->Volume);		// // //
 			break;
 		case C_EFF1_NUM: case C_EFF2_NUM: case C_EFF3_NUM: case C_EFF4_NUM:
 			// Effect type
 			if (EffNumber == 0)
 				BAR(PosX);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, EFF_CHAR[EffNumber], EffColor);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, EFF_CHAR[EffNumber], EffColor);		// // //
 			break;
 		case C_EFF1_PARAM1: case C_EFF2_PARAM1: case C_EFF3_PARAM1: case C_EFF4_PARAM1:
 			// Effect param x
 			if (EffNumber == 0)
 				BAR(PosX);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[(EffParam >> 4) & 0x0F], pColorInfo->Note);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[(EffParam >> 4) & 0x0F], pColorInfo->Note);		// // //
 			break;
 		case C_EFF1_PARAM2: case C_EFF2_PARAM2: case C_EFF3_PARAM2: case C_EFF4_PARAM2:
 			// Effect param y
 			if (EffNumber == 0)
 				BAR(PosX);
 			else
-				DrawChar(pDC, PosX + m_iCharWidth / 2, PosY, HEX[EffParam & 0x0F], pColorInfo->Note);		// // //
+				DrawChar(PosX + m_iCharWidth / 2, PosY, HEX[EffParam & 0x0F], pColorInfo->Note);		// // //
 			break;
 	}
 
-	pDC->SetTextAlign(TA_LEFT);		// // //
 	return;
 }
 
@@ -2355,11 +2540,10 @@ void CPatternEditor::DrawRegisters(CDC *pDC)
 
 }
 
-// Draws a colored character
-void CPatternEditor::DrawChar(CDC *pDC, int x, int y, TCHAR c, COLORREF Color) const
+// Draws a colored character, centered at x with its baseline at y
+void CPatternEditor::DrawChar(int x, int y, TCHAR c, COLORREF Color) const
 {
-	pDC->SetTextColor(Color);
-	pDC->TextOut(x, y, &c, 1);
+	m_Rasterizer.DrawChar(x, y, static_cast<char>(c), Color);		// // //
 	++m_iCharsDrawn;
 }
 
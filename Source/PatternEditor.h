@@ -25,6 +25,9 @@
 
 #include "Common.h"
 #include "PatternEditorTypes.h"
+#include "PatternRasterizer.h"		// // //
+#include "PatternDamage.h"		// // //
+#include <vector>		// // //
 
 
 // Row color cache
@@ -59,6 +62,7 @@ public:
 
 	// Invalidation
 	void InvalidatePatternData();
+	void InvalidatePatternData(const CPatternDamage &Damage);		// // //
 	void InvalidateCursor();
 	void InvalidateBackground();
 	void InvalidateHeader();
@@ -161,6 +165,7 @@ public:
 	// Various
 	int GetCurrentPatternLength(int Frame) const;		// // // allow negative frames
 	bool IsInRange(const CSelection &sel, int Frame, int Row, int Channel, cursor_column_t Column) const;		// // //
+	bool IsRowInRange(const CSelection &sel, int Frame, int Row) const;		// // //
 
 	// Settings
 	void SetHighlight(const stHighlight Hl);		// // //
@@ -212,20 +217,23 @@ private:
 	unsigned int GetChannelWidth(int EffColumns) const;
 
 	// Main draw methods
-	void PerformFullRedraw(CDC *pDC);
-	void PerformQuickRedraw(CDC *pDC);
+	void PerformFullRedraw();
+	void PerformQuickRedraw();
+	void PerformDamageRedraw();		// // //
 	void DrawUnbufferedArea(CDC *pDC);
 	void DrawHeader(CDC *pDC);
 
 	// Helper draw methods
-	void MovePatternArea(CDC *pDC, int FromRow, int ToRow, int NumRows) const;
-	void ScrollPatternArea(CDC *pDC, int Rows) const;
-	void ClearRow(CDC *pDC, int Line) const;
-	void PrintRow(CDC *pDC, int Row, int Line, int Frame) const;
-	void DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPreview) const;
+	void CreateGlyphAtlas();		// // //
+	void MovePatternArea(int FromRow, int ToRow, int NumRows) const;
+	void ScrollPatternArea(int Rows) const;
+	void ClearRow(int Line) const;
+	bool ResolveRow(int &Row, int &Frame, bool &bPreview) const;		// // //
+	void PrintRow(int Row, int Line, int Frame) const;
+	void DrawRow(int Row, int Line, int Frame, bool bPreview, int ChanFirst, int ChanLast) const;		// // //
 	// // //
-	void DrawCell(CDC *pDC, int PosX, cursor_column_t Column, int Channel, bool bInvert, stChanNote *pNoteData, RowColorInfo_t *pColorInfo) const;
-	void DrawChar(CDC *pDC, int x, int y, TCHAR c, COLORREF Color) const;
+	void DrawCell(int PosX, cursor_column_t Column, int Channel, bool bInvert, stChanNote *pNoteData, RowColorInfo_t *pColorInfo) const;
+	void DrawChar(int x, int y, TCHAR c, COLORREF Color) const;
 
 	// Other drawing
 	void DrawChannelStates(CDC *pDC);
@@ -299,6 +307,10 @@ private:
 	CFont	m_fontPattern;
 	CFont	m_fontCourierNew;
 
+	// // // Pattern area renderer, draws into the bits of m_pPatternBmp
+	CGlyphAtlas m_GlyphAtlas;
+	mutable CPatternRasterizer m_Rasterizer;
+
 	// Window
 	int		m_iWinWidth;					// Window height & width
 	int		m_iWinHeight;
@@ -322,6 +334,19 @@ private:
 	int		m_iLastFirstChannel;			// Previous first visible channel
 	int		m_iLastPlayRow;					// Previous play row
 
+	// // // Damage tracking
+	struct stLineState {
+		bool	bVisible;						// Line shows pattern data
+		int		Row;
+		int		Frame;
+		bool	bPreview;
+	};
+	mutable std::vector<stLineState> m_LineStates;	// What each screen line currently shows
+	CPatternDamage m_PatternDamage;			// Pattern rows changed since the last redraw
+	CSelection m_selDrawn;					// Selection as last drawn
+	bool	m_bSelectionDrawn;
+	sel_condition_t m_iSelConditionDrawn;
+
 	// Play cursor
 	int		m_iPlayRow;
 	int		m_iPlayFrame;
@@ -365,6 +390,24 @@ private:
 	COLORREF m_colHead4;
 	COLORREF m_colHead5;		// // //
 
+	// // // Pattern colors, cached from the settings
+	COLORREF m_colCursor;
+	COLORREF m_colBackground;
+	COLORREF m_colBackgroundHilite;
+	COLORREF m_colBackgroundHilite2;
+	COLORREF m_colSelection;
+	COLORREF m_colText;
+	COLORREF m_colTextHilite;
+	COLORREF m_colTextHilite2;
+	COLORREF m_colInstrument;
+	COLORREF m_colVolume;
+	COLORREF m_colEffect;
+	COLORREF m_colCurrentRowNormal;
+	COLORREF m_colCurrentRowEdit;
+	COLORREF m_colCurrentRowPlaying;
+	bool	 m_bPatternColor;
+	bool	 m_bDisplayFlats;
+
 	// Meters and DPCM
 	stDPCMState m_DPCMState;
 
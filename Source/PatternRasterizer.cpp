@@ -0,0 +1,317 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#include "PatternRasterizer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// COLORREF (0x00BBGGRR) to 0x00RRGGBB
+inline uint32_t ToPixel(uint32_t Color) {
+	return ((Color & 0xFF) << 16) | (Color & 0xFF00) | ((Color >> 16) & 0xFF);
+}
+
+// Same as BLEND() in Graphics.h, works on either byte order
+inline uint32_t Blend(uint32_t c1, uint32_t c2, uint32_t Level) {
+	uint32_t Result = 0;
+	for (int Shift = 0; Shift <= 16; Shift += 8) {
+		const uint32_t a = (c1 >> Shift) & 0xFF;
+		const uint32_t b = (c2 >> Shift) & 0xFF;
+		Result |= ((a * Level) / 100 + (b * (100 - Level)) / 100) << Shift;
+	}
+	return Result;
+}
+
+// Blends Color over Pixel, Alpha is 0 to 256
+inline uint32_t Mix(uint32_t Pixel, uint32_t Color, uint32_t Alpha) {
+	const uint32_t rb = ((Color & 0xFF00FF) * Alpha + (Pixel & 0xFF00FF) * (256 - Alpha)) >> 8;
+	const uint32_t g = ((Color & 0x00FF00) * Alpha + (Pixel & 0x00FF00) * (256 - Alpha)) >> 8;
+	return (rb & 0xFF00FF) | (g & 0x00FF00);
+}
+
+} // namespace
+
+// CGlyphAtlas
+
+void CGlyphAtlas::Create(int Width, int Height, int OriginX, int OriginY)
+{
+	m_iWidth = std::max(Width, 0);
+	m_iHeight = std::max(Height, 0);
+	m_iOriginX = OriginX;
+	m_iOriginY = OriginY;
+	m_Coverage.assign(static_cast<size_t>(m_iWidth) * m_iHeight * (LAST_CHAR - FIRST_CHAR + 1), 0);
+	m_Glyphs.assign(LAST_CHAR - FIRST_CHAR + 1, stGlyph { });
+	m_Spans.clear();
+}
+
+void CGlyphAtlas::Clear()
+{
+	m_iWidth = m_iHeight = 0;
+	m_Coverage.clear();
+	m_Glyphs.clear();
+	m_Spans.clear();
+}
+
+bool CGlyphAtlas::IsEmpty() const
+{
+	return m_Glyphs.empty();
+}
+
+int CGlyphAtlas::GetWidth() const
+{
+	return m_iWidth;
+}
+
+int CGlyphAtlas::GetHeight() const
+{
+	return m_iHeight;
+}
+
+int CGlyphAtlas::GetOriginX() const
+{
+	return m_iOriginX;
+}
+
+int CGlyphAtlas::GetOriginY() const
+{
+	return m_iOriginY;
+}
+
+uint8_t *CGlyphAtlas::GetMask(char c)
+{
+	if (IsEmpty() || c < FIRST_CHAR || c > LAST_CHAR)
+		return nullptr;
+	return m_Coverage.data() + static_cast<size_t>(c - FIRST_CHAR) * m_iWidth * m_iHeight;
+}
+
+void CGlyphAtlas::Finish()
+{
+	m_Spans.clear();
+	for (int c = FIRST_CHAR; c <= LAST_CHAR; ++c) {
+		const uint8_t *pMask = GetMask(static_cast<char>(c));
+		stGlyph Box = {m_iWidth, m_iHeight, 0, 0, m_Spans.size(), 0, 0};
+		std::vector<stSpan> Partial;
+		for (int y = 0; y < m_iHeight; ++y)
+			for (int x = 0; x < m_iWidth; ) {
+				const uint8_t Alpha = pMask[y * m_iWidth + x];
+				int End = x + 1;
+				while (End < m_iWidth && pMask[y * m_iWidth + End] == Alpha)
+					++End;
+				if (Alpha) {
+					Box.Left = std::min(Box.Left, x);
+					Box.Top = std::min(Box.Top, y);
+					Box.Right = std::max(Box.Right, End);
+					Box.Bottom = std::max(Box.Bottom, y + 1);
+					(Alpha == 0xFF ? m_Spans : Partial).push_back({static_cast<int16_t>(x - m_iOriginX),
+						static_cast<int16_t>(y - m_iOriginY), static_cast<int16_t>(End - x), Alpha});
+				}
+				x = End;
+			}
+		if (Box.Left >= Box.Right)
+			Box.Left = Box.Top = Box.Right = Box.Bottom = 0;
+		Box.FirstPartial = m_Spans.size();
+		m_Spans.insert(m_Spans.end(), Partial.begin(), Partial.end());
+		Box.EndSpan = m_Spans.size();
+		m_Glyphs[c - FIRST_CHAR] = Box;
+	}
+}
+
+// CPatternRasterizer
+
+void CPatternRasterizer::SetTarget(uint32_t *pBits, int Width, int Height, int Pitch)
+{
+	m_pBits = pBits;
+	m_iWidth = pBits ? Width : 0;
+	m_iHeight = pBits ? Height : 0;
+	m_iPitch = Pitch;
+	m_iOriginX = m_iOriginY = 0;
+}
+
+void CPatternRasterizer::SetAtlas(const CGlyphAtlas *pAtlas)
+{
+	m_pAtlas = pAtlas;
+}
+
+void CPatternRasterizer::SetOrigin(int x, int y)
+{
+	m_iOriginX = x;
+	m_iOriginY = y;
+}
+
+bool CPatternRasterizer::Clip(int &x, int &y, int &w, int &h) const
+{
+	// Takes target coordinates
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	if (y < 0) {
+		h += y;
+		y = 0;
+	}
+	w = std::min(w, m_iWidth - x);
+	h = std::min(h, m_iHeight - y);
+	return w > 0 && h > 0;
+}
+
+void CPatternRasterizer::FillPixels(int x, int y, int w, int h, uint32_t Pixel)
+{
+	if (!Clip(x, y, w, h))
+		return;
+	// Fill one row, then copy it; memcpy is vectorized even where fill_n is not
+	uint32_t *pFirst = m_pBits + y * m_iPitch + x;
+	std::fill_n(pFirst, w, Pixel);
+	uint32_t *pRow = pFirst;
+	for (int i = 1; i < h; ++i)
+		std::memcpy(pRow += m_iPitch, pFirst, w * sizeof(uint32_t));
+}
+
+void CPatternRasterizer::FillRect(int x, int y, int w, int h, uint32_t Color)
+{
+	// Negative sizes are normalized, as with CDC::FillSolidRect()
+	if (w < 0) {
+		x += w;
+		w = -w;
+	}
+	if (h < 0) {
+		y += h;
+		h = -h;
+	}
+	FillPixels(x + m_iOriginX, y + m_iOriginY, w, h, ToPixel(Color));
+}
+
+void CPatternRasterizer::GradientBar(int x, int y, int w, int h, uint32_t ColFg, uint32_t ColBg)
+{
+	if (w <= 0 || h <= 0)
+		return;
+
+	FillRect(x, y, w, 1, Blend(ColFg, 0xFFFFFF, 95));
+
+	// Vertical gradient from the foreground color to 60% of it, one row at a time
+	const uint32_t Top = ToPixel(ColFg);
+	const uint32_t Bottom = ToPixel(Blend(ColFg, ColBg, 60));
+	const int Rows = h - 1;
+	for (int i = 0; i < Rows; ++i) {
+		uint32_t Pixel = 0;
+		for (int Shift = 0; Shift <= 16; Shift += 8) {
+			const int a = (Top >> Shift) & 0xFF;
+			const int b = (Bottom >> Shift) & 0xFF;
+			Pixel |= static_cast<uint32_t>(a + (b - a) * i / Rows) << Shift;
+		}
+		FillPixels(x + m_iOriginX, y + 1 + i + m_iOriginY, w, 1, Pixel);
+	}
+}
+
+void CPatternRasterizer::Draw3dRect(int x, int y, int w, int h, uint32_t ColTopLeft, uint32_t ColBottomRight)
+{
+	FillRect(x, y, w - 1, 1, ColTopLeft);
+	FillRect(x, y, 1, h - 1, ColTopLeft);
+	FillRect(x + w, y, -1, h, ColBottomRight);
+	FillRect(x, y + h, w, -1, ColBottomRight);
+}
+
+void CPatternRasterizer::DrawChar(int x, int y, char c, uint32_t Color)
+{
+	if (!m_pAtlas || m_pAtlas->IsEmpty() || c < CGlyphAtlas::FIRST_CHAR || c > CGlyphAtlas::LAST_CHAR)
+		return;
+
+	const CGlyphAtlas::stGlyph &Glyph = m_pAtlas->m_Glyphs[c - CGlyphAtlas::FIRST_CHAR];
+	if (Glyph.Left == Glyph.Right)
+		return;
+
+	x += m_iOriginX;
+	y += m_iOriginY;
+	const uint32_t Pixel = ToPixel(Color);
+
+	// Glyphs inside the target are drawn span by span
+	const int Left = x - m_pAtlas->m_iOriginX + Glyph.Left;
+	const int Top = y - m_pAtlas->m_iOriginY + Glyph.Top;
+	const int Right = x - m_pAtlas->m_iOriginX + Glyph.Right;
+	const int Bottom = y - m_pAtlas->m_iOriginY + Glyph.Bottom;
+	if (Left >= 0 && Top >= 0 && Right <= m_iWidth && Bottom <= m_iHeight) {
+		uint32_t *pAnchor = m_pBits + y * m_iPitch + x;
+		const CGlyphAtlas::stSpan *pSpan = m_pAtlas->m_Spans.data() + Glyph.FirstSpan;
+		const CGlyphAtlas::stSpan *pPartial = m_pAtlas->m_Spans.data() + Glyph.FirstPartial;
+		const CGlyphAtlas::stSpan *pEnd = m_pAtlas->m_Spans.data() + Glyph.EndSpan;
+		for (; pSpan != pPartial; ++pSpan) {
+			uint32_t *pDest = pAnchor + pSpan->y * m_iPitch + pSpan->x;
+			std::fill_n(pDest, pSpan->Length, Pixel);
+		}
+		for (; pSpan != pEnd; ++pSpan) {
+			uint32_t *pDest = pAnchor + pSpan->y * m_iPitch + pSpan->x;
+			const uint32_t Alpha = pSpan->Alpha + (pSpan->Alpha >> 7);
+			for (int i = 0; i < pSpan->Length; ++i)
+				pDest[i] = Mix(pDest[i], Pixel, Alpha);
+		}
+		return;
+	}
+
+	// Clipped glyphs are read from the mask
+	int DestX = Left, DestY = Top;
+	int w = Right - Left, h = Bottom - Top;
+	const int SkipX = std::max(-DestX, 0);
+	const int SkipY = std::max(-DestY, 0);
+	if (!Clip(DestX, DestY, w, h))
+		return;
+
+	const int MaskPitch = m_pAtlas->m_iWidth;
+	const uint8_t *pMask = m_pAtlas->m_Coverage.data()
+		+ static_cast<size_t>(c - CGlyphAtlas::FIRST_CHAR) * MaskPitch * m_pAtlas->m_iHeight
+		+ (Glyph.Top + SkipY) * MaskPitch + Glyph.Left + SkipX;
+	uint32_t *pRow = m_pBits + DestY * m_iPitch + DestX;
+
+	for (int j = 0; j < h; ++j, pRow += m_iPitch, pMask += MaskPitch)
+		for (int i = 0; i < w; ++i) {
+			const uint32_t Alpha = pMask[i];
+			if (Alpha == 0xFF)
+				pRow[i] = Pixel;
+			else if (Alpha)
+				pRow[i] = Mix(pRow[i], Pixel, Alpha + (Alpha >> 7));
+		}
+}
+
+void CPatternRasterizer::MoveArea(int x, int SrcY, int DestY, int w, int NumRows)
+{
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	w = std::min(w, m_iWidth - x);
+	const int Top = std::min(SrcY, DestY);
+	if (Top < 0) {
+		SrcY -= Top;
+		DestY -= Top;
+		NumRows += Top;
+	}
+	NumRows = std::min(NumRows, m_iHeight - std::max(SrcY, DestY));
+	if (w <= 0 || NumRows <= 0 || SrcY == DestY)
+		return;
+
+	const size_t Bytes = w * sizeof(uint32_t);
+	if (DestY < SrcY) {
+		for (int i = 0; i < NumRows; ++i)
+			std::memcpy(m_pBits + (DestY + i) * m_iPitch + x, m_pBits + (SrcY + i) * m_iPitch + x, Bytes);
+	}
+	else {
+		for (int i = NumRows - 1; i >= 0; --i)
+			std::memcpy(m_pBits + (DestY + i) * m_iPitch + x, m_pBits + (SrcY + i) * m_iPitch + x, Bytes);
+	}
+}
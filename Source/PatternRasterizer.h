@@ -0,0 +1,125 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Coverage masks of the printable ASCII characters of one font, rendered
+/// once and blended into the pattern buffer by CPatternRasterizer.
+///
+/// Every glyph occupies a cell of the same size. The text anchor (horizontal
+/// center, baseline) lies at the same point of every cell, so a character is
+/// placed exactly as TextOut() with TA_CENTER | TA_BASELINE would place it.
+/// Masks store coverage only; the color is applied when drawing, so a single
+/// atlas serves every text color of the color scheme. Coverage is the average
+/// of the three color channels, any ClearType subpixel detail is lost.
+class CGlyphAtlas {
+public:
+	static constexpr int FIRST_CHAR = 0x20;
+	static constexpr int LAST_CHAR = 0x7E;
+
+	/// Allocates cleared masks of Width by Height pixels with the text anchor
+	/// at (OriginX, OriginY).
+	void Create(int Width, int Height, int OriginX, int OriginY);
+	/// Frees all masks.
+	void Clear();
+	bool IsEmpty() const;
+
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetOriginX() const;
+	int GetOriginY() const;
+
+	/// Returns the mask of a character for filling, one byte per pixel with a
+	/// pitch of GetWidth(), or nullptr if the character is not in the atlas.
+	/// Call Finish() once every mask is filled.
+	uint8_t *GetMask(char c);
+	/// Converts the masks into runs of covered pixels, so that drawing skips
+	/// uncovered pixels and fills opaque runs at once. Opaque runs are stored
+	/// ahead of partially covered ones, so each kind is drawn without a branch.
+	void Finish();
+
+private:
+	friend class CPatternRasterizer;
+
+	struct stGlyph {
+		int Left, Top, Right, Bottom;		// Covered area, empty if Left == Right
+		size_t FirstSpan, EndSpan;			// Spans of the glyph in m_Spans
+		size_t FirstPartial;				// Opaque spans come before this one
+	};
+
+	// Horizontal run of pixels with the same coverage, relative to the anchor
+	struct stSpan {
+		int16_t x, y, Length;
+		uint8_t Alpha;
+	};
+
+	int m_iWidth = 0;
+	int m_iHeight = 0;
+	int m_iOriginX = 0;
+	int m_iOriginY = 0;
+	std::vector<uint8_t> m_Coverage;
+	std::vector<stGlyph> m_Glyphs;
+	std::vector<stSpan> m_Spans;
+};
+
+/// Draws the pattern editor's rows into a 32-bit pixel buffer.
+///
+/// The target uses the layout of a top-down 32-bit DIB section, one 0x00RRGGBB
+/// value per pixel. All colors are passed as COLORREF values (0x00BBGGRR) and
+/// all drawing is clipped to the target. Nothing here depends on GDI. Fills,
+/// gradients and rectangles match the GDI calls they replace; text is blended
+/// from grayscale coverage, so it lacks ClearType's per-subpixel coverage.
+class CPatternRasterizer {
+public:
+	/// Sets the target buffer, Pitch is in pixels. Resets the origin.
+	void SetTarget(uint32_t *pBits, int Width, int Height, int Pitch);
+	void SetAtlas(const CGlyphAtlas *pAtlas);
+	/// Offsets all subsequent drawing, same as CDC::SetWindowOrg(-x, -y).
+	void SetOrigin(int x, int y);
+
+	void FillRect(int x, int y, int w, int h, uint32_t Color);
+	/// Same as GradientBar() in Graphics.h.
+	void GradientBar(int x, int y, int w, int h, uint32_t ColFg, uint32_t ColBg);
+	/// Same as CDC::Draw3dRect().
+	void Draw3dRect(int x, int y, int w, int h, uint32_t ColTopLeft, uint32_t ColBottomRight);
+	/// Draws a character centered at x with its baseline at y.
+	void DrawChar(int x, int y, char c, uint32_t Color);
+	/// Copies NumRows pixel rows of width w starting at column x from SrcY to
+	/// DestY. Ignores the origin; the areas may overlap.
+	void MoveArea(int x, int SrcY, int DestY, int w, int NumRows);
+
+private:
+	bool Clip(int &x, int &y, int &w, int &h) const;
+	void FillPixels(int x, int y, int w, int h, uint32_t Pixel);
+
+private:
+	uint32_t *m_pBits = nullptr;
+	int m_iWidth = 0;
+	int m_iHeight = 0;
+	int m_iPitch = 0;
+	int m_iOriginX = 0;
+	int m_iOriginY = 0;
+	const CGlyphAtlas *m_pAtlas = nullptr;
+};
@@ -25,6 +25,7 @@
 #include "Settings.h"
 #include "APU/Types.h"
 #include "SoundGen.h"
+#include "AudioProfiler.h"		// // //
 
 // Timer IDs
 enum {
@@ -54,6 +55,8 @@ BEGIN_MESSAGE_MAP(CPerformanceDlg, CDialog)
 	ON_WM_TIMER()
 	ON_BN_CLICKED(IDOK, OnBnClickedOk)
 	ON_WM_CLOSE()
+	ON_BN_CLICKED(IDC_PROFILE_RESET, OnBnClickedProfileReset)
+	ON_BN_CLICKED(IDC_PROFILE_EXPORT, OnBnClickedProfileExport)
 END_MESSAGE_MAP()
 
 
@@ -70,6 +73,28 @@ BOOL CPerformanceDlg::OnInitDialog()
 	SetTimer(TMR_BAR, PerRefreshRate, NULL);
 	SetTimer(TMR_INFO, 1000, NULL);
 
+	// // // Audio thread profile, collected while the dialog is open
+	CListCtrl *pList = static_cast<CListCtrl*>(GetDlgItem(IDC_PROFILE_LIST));
+	pList->SetExtendedStyle(LVS_EX_FULLROWSELECT);
+
+	CRect Rect;
+	pList->GetClientRect(&Rect);
+	const int Width = Rect.Width() - ::GetSystemMetrics(SM_CXVSCROLL);
+	pList->InsertColumn(0, _T("Stage"), LVCFMT_LEFT, Width * 2 / 5);
+	pList->InsertColumn(1, _T("Mean"), LVCFMT_RIGHT, Width / 5);
+	pList->InsertColumn(2, _T("99%"), LVCFMT_RIGHT, Width / 5);
+	pList->InsertColumn(3, _T("Max"), LVCFMT_RIGHT, Width / 5);
+
+	for (unsigned int i = 0; i < PROFILE_ENTRY_COUNT; ++i)
+		pList->InsertItem(i, CString(CAudioProfiler::GetEntryName(i)));
+
+#ifdef ENABLE_AUDIO_PROFILER
+	CAudioProfiler::Get().Enable(true);
+#else
+	GetDlgItem(IDC_PROFILE_RESET)->EnableWindow(FALSE);
+	GetDlgItem(IDC_PROFILE_EXPORT)->EnableWindow(FALSE);
+#endif
+
 	return TRUE;  // return TRUE unless you set the focus to a control
 	// EXCEPTION: OCX Property Pages should return FALSE
 }
@@ -79,6 +104,7 @@ void CPerformanceDlg::OnTimer(UINT_PTR nIDEvent)
 	switch (nIDEvent) {
 		case TMR_INFO:
 			UpdateInfo();
+			UpdateProfile();		// // //
 			break;
 
 		case TMR_BAR:
@@ -112,6 +138,59 @@ void CPerformanceDlg::UpdateInfo()
 
 	AfxFormatString1(Text, IDS_PERFORMANCE_UNDERRUN_FORMAT, MakeIntString(Underruns));
 	SetDlgItemText(IDC_UNDERRUN, Text);
+
+	stLatencyStats Latency = theApp.GetSoundGenerator()->GetLatencyStats();
+	AfxFormatString2(Text, IDS_PERFORMANCE_LATENCY_FORMAT, MakeIntString(Latency.iLatencyMs), MakeIntString(Latency.iTargetMs));
+	SetDlgItemText(IDC_LATENCY, Text);
+}
+
+void CPerformanceDlg::UpdateProfile()		// // //
+{
+	CListCtrl *pList = static_cast<CListCtrl*>(GetDlgItem(IDC_PROFILE_LIST));
+	const profile_stats_t Stats = CAudioProfiler::Get().GetStats();
+
+	CString Text;
+	for (unsigned int i = 0; i < PROFILE_ENTRY_COUNT; ++i) {
+		const stProfileStats &s = Stats[i];
+		if (!s.iFrames) {
+			for (int j = 1; j <= 3; ++j)
+				pList->SetItemText(i, j, _T("-"));
+			continue;
+		}
+		Text.Format(_T("%.1f us"), s.GetMeanUs());
+		pList->SetItemText(i, 1, Text);
+		Text.Format(_T("< %u us"), s.GetQuantileUs(.99));
+		pList->SetItemText(i, 2, Text);
+		Text.Format(_T("%.1f us"), s.iMaxNs / 1000.);
+		pList->SetItemText(i, 3, Text);
+	}
+}
+
+void CPerformanceDlg::OnBnClickedProfileReset()
+{
+	CAudioProfiler::Get().Reset();
+	UpdateProfile();
+}
+
+void CPerformanceDlg::OnBnClickedProfileExport()
+{
+	CFileDialog SaveFileDialog(FALSE, _T("csv"), _T("profile"), OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT,
+		_T("Comma-separated values (*.csv)|*.csv|JSON (*.json)|*.json|All files|*.*||"));
+
+	if (SaveFileDialog.DoModal() == IDCANCEL)
+		return;
+
+	const profile_stats_t Stats = CAudioProfiler::Get().GetStats();
+	const std::string Data = SaveFileDialog.GetFileExt().CompareNoCase(_T("json")) ?
+		CAudioProfiler::ExportCSV(Stats) : CAudioProfiler::ExportJSON(Stats);
+
+	CFile File;
+	if (!File.Open(SaveFileDialog.GetPathName(), CFile::modeWrite | CFile::modeCreate)) {
+		AfxMessageBox(IDS_FILE_OPEN_ERROR);
+		return;
+	}
+	File.Write(Data.data(), static_cast<UINT>(Data.size()));
+	File.Close();
 }
 
 void CPerformanceDlg::OnBnClickedOk()
@@ -128,5 +207,6 @@ BOOL CPerformanceDlg::DestroyWindow()
 {
 	KillTimer(TMR_BAR);
 	KillTimer(TMR_INFO);
+	CAudioProfiler::Get().Enable(false);		// // //
 	return CDialog::DestroyWindow();
 }
@@ -37,6 +37,7 @@ public:
 private:
 	void UpdateBar();
 	void UpdateInfo();
+	void UpdateProfile();		// // //
 protected:
 	virtual void DoDataExchange(CDataExchange* pDX);    // DDX/DDV support
 
@@ -49,4 +50,6 @@ public:
 	afx_msg void OnBnClickedOk();
 	virtual BOOL DestroyWindow();
 	afx_msg void OnClose();
+	afx_msg void OnBnClickedProfileReset();
+	afx_msg void OnBnClickedProfileExport();
 };
@@ -18,35 +18,14 @@
 ** along with this program. If not, see https://www.gnu.org/licenses/.
 */
 
-#include "../stdafx.h"
-#include "SoundChip.h"
-#include "../RegisterState.h"
 
-CSoundChip::CSoundChip(CMixer *pMixer) :
-	m_pMixer(pMixer),
-	m_pRegisterLogger(new CRegisterLogger { })
-{
-}
+#pragma once
 
-CSoundChip::~CSoundChip()
-{
-	if (m_pRegisterLogger)
-		delete m_pRegisterLogger;
-}
-
-double CSoundChip::GetFreq(int Channel) const		// // //
-{
-	return 0.0;
-}
-
-void CSoundChip::Log(uint16_t Address, uint8_t Value)		// // //
-{
-	// default logger operation
-	if (m_pRegisterLogger->SetPort(Address))
-		m_pRegisterLogger->Write(Value);
-}
-
-CRegisterLogger *CSoundChip::GetRegisterLogger() const		// // //
-{
-	return m_pRegisterLogger;
-}
+/// Application options read by the channel handlers during playback.
+/// Each sound generator owns a copy and hands a pointer to its channels, so that
+/// the player never reaches for the global settings object.
+struct stPlayerSettings {
+	bool bCutVolume = false;		// Zero volume mutes the channel even if the instrument volume is non-zero
+	bool bNoDPCMReset = false;		// Keep the DPCM DAC level when a sample is cut outside of playback
+	bool bFDSOldVolume = false;		// Use the old FDS and VRC6 sawtooth volume tables
+};
@@ -19,10 +19,8 @@
 */
 
 #include "stdafx.h"
-#include "FamiTracker.h" // theApp.getSoundGenerator()
 #include "APU/Types.h"
 #include "FamiTrackerTypes.h"
-#include "SoundGen.h"
 
 #include "Instrument.h"
 #include "SeqInstrument.h"
@@ -89,38 +87,20 @@ void CSeqInstHandler::ReleaseInstrument()
 
 void CSeqInstHandler::UpdateInstrument()
 {
+	m_iSeqUpdated = 0;		// // //
 	if (!m_pInterface->IsActive()) return;
 	for (std::size_t i = 0; i < sizeof(m_pSequence) / sizeof(CSequence*); i++) {
 		if (m_pSequence[i] == nullptr || m_pSequence[i]->GetItemCount() == 0) continue;
-		int Value;
 		switch (m_iSeqState[i]) {
 		case SEQ_STATE_RUNNING:
-			Value = m_pSequence[i]->GetItem(m_iSeqPointer[i]);
-			ProcessSequence(static_cast<int>(i), m_pSequence[i]->GetSetting(), Value);
-			++m_iSeqPointer[i];
-
-			{	
-				int Release = m_pSequence[i]->GetReleasePoint();
-				int Items = m_pSequence[i]->GetItemCount();
-				int Loop = m_pSequence[i]->GetLoopPoint();
-				if (m_iSeqPointer[i] == (Release + 1) || m_iSeqPointer[i] >= Items) {
-					// End point reached
-					if (Loop != -1 && !(m_pInterface->IsReleasing() && Release != -1) && Loop < Release) {		// // //
-						m_iSeqPointer[i] = Loop;
-					}
-					else if (m_iSeqPointer[i] >= Items) {
-						// End of sequence 
-						if (Loop >= Release && Loop != -1)		// // //
-							m_iSeqPointer[i] = Loop;
-						else
-							m_iSeqState[i] = SEQ_STATE_END;
-					}
-					else if (!m_pInterface->IsReleasing()) {
-						// Waiting for release
-						--m_iSeqPointer[i];
-					}
-				}
-				theApp.GetSoundGenerator()->SetSequencePlayPos(m_pSequence[i], m_iSeqPointer[i]);
+			{
+				const stSequenceStep &Step = m_pSequence[i]->GetStep(m_iSeqPointer[i]);
+				ProcessSequence(static_cast<int>(i), m_pSequence[i]->GetSetting(), Step.Value);
+				const int Releasing = m_pInterface->IsReleasing() ? 1 : 0;
+				m_iSeqPointer[i] = Step.Next[Releasing];
+				if (Step.End[Releasing])
+					m_iSeqState[i] = SEQ_STATE_END;
+				m_iSeqUpdated |= 1u << i;
 			}
 			break;
 
@@ -132,7 +112,7 @@ void CSeqInstHandler::UpdateInstrument()
 				break;
 			}
 			m_iSeqState[i] = SEQ_STATE_HALT;
-			theApp.GetSoundGenerator()->SetSequencePlayPos(m_pSequence[i], -1);
+			m_iSeqUpdated |= 1u << i;
 			break;
 
 		case SEQ_STATE_HALT:
@@ -142,6 +122,16 @@ void CSeqInstHandler::UpdateInstrument()
 	}
 }
 
+bool CSeqInstHandler::GetSequencePlayPos(const CSequence *pSequence, int &Pos) const		// // //
+{
+	for (std::size_t i = 0; i < sizeof(m_pSequence) / sizeof(CSequence*); i++)
+		if (m_pSequence[i] == pSequence && (m_iSeqUpdated & (1u << i))) {
+			Pos = m_iSeqState[i] == SEQ_STATE_HALT ? -1 : m_iSeqPointer[i];
+			return true;
+		}
+	return false;
+}
+
 bool CSeqInstHandler::ProcessSequence(int Index, unsigned Setting, int Value)
 {
 	switch (Index) {
@@ -53,6 +53,7 @@ public:
 	void TriggerInstrument() override;
 	void ReleaseInstrument() override;
 	void UpdateInstrument() override;
+	bool GetSequencePlayPos(const CSequence *pSequence, int &Pos) const override;		// // //
 
 	/*!	\brief Obtains the current sequence state of a given sequence type.
 		\param Index The sequence type, which should be a member of sequence_t.
@@ -83,6 +84,8 @@ protected:
 	seq_state_t		m_iSeqState[SEQ_COUNT];
 	/*!	\brief An array holding the tick index of each sequence type used in sequence instruments. */
 	int				m_iSeqPointer[SEQ_COUNT];
+	/*!	\brief A bit mask of the sequence types that were run during the last tick. */
+	unsigned		m_iSeqUpdated = 0;
 	/*!	\brief The current duty cycle of the instrument.
 		\details The exact interpretation of this member may not be identical across sound channels.
 		\warning Currently unused. */
@@ -36,6 +36,8 @@ void CSequence::Clear()
 	memset(m_cValues, 0, sizeof(char) * MAX_SEQUENCE_ITEMS);
 
 	m_iPlaying = -1;
+
+	Compile();
 }
 
 bool CSequence::operator==(const CSequence &other)		// // //
@@ -50,6 +52,7 @@ bool CSequence::operator==(const CSequence &other)		// // //
 void CSequence::SetItem(int Index, signed char Value)
 {
 	m_cValues[Index] = Value;
+	m_Steps[Index].Value = Value;
 }
 
 void CSequence::SetItemCount(unsigned int Count)
@@ -62,6 +65,8 @@ void CSequence::SetItemCount(unsigned int Count)
 		m_iLoopPoint = -1;
 	if (m_iReleasePoint > m_iItemCount)
 		m_iReleasePoint = -1;
+
+	Compile();
 }
 
 void CSequence::SetLoopPoint(unsigned int Point)
@@ -69,6 +74,8 @@ void CSequence::SetLoopPoint(unsigned int Point)
 	m_iLoopPoint = Point;
 	if (m_iLoopPoint > m_iItemCount)		// // //
 		m_iLoopPoint = -1;
+
+	Compile();
 }
 
 void CSequence::SetReleasePoint(unsigned int Point)
@@ -76,6 +83,8 @@ void CSequence::SetReleasePoint(unsigned int Point)
 	m_iReleasePoint = Point;
 	if (m_iReleasePoint > m_iItemCount)		// // //
 		m_iReleasePoint = -1;
+
+	Compile();
 }
 
 void CSequence::SetSetting(seq_setting_t Setting)		// // //
@@ -117,4 +126,41 @@ void CSequence::Copy(const CSequence *pSeq)
 	m_iSetting = pSeq->m_iSetting;
 
 	memcpy(m_cValues, pSeq->m_cValues, MAX_SEQUENCE_ITEMS);
+
+	Compile();
+}
+
+void CSequence::Compile()
+{
+	// Resolve the loop and release points of every item in advance, so that the
+	// sequence instrument handler only needs a table lookup on each tick
+	const int Items = m_iItemCount;
+	const int Loop = m_iLoopPoint;
+	const int Release = m_iReleasePoint;
+
+	for (int i = 0; i <= MAX_SEQUENCE_ITEMS; ++i) {
+		stSequenceStep &Step = m_Steps[i];
+		Step.Value = i < MAX_SEQUENCE_ITEMS ? m_cValues[i] : 0;
+		for (int Releasing = 0; Releasing < 2; ++Releasing) {
+			int Next = i + 1;
+			bool End = false;
+			if (Next == Release + 1 || Next >= Items) {
+				// End point reached
+				if (Loop != -1 && !(Releasing && Release != -1) && Loop < Release)
+					Next = Loop;
+				else if (Next >= Items) {
+					// End of sequence
+					if (Loop >= Release && Loop != -1)
+						Next = Loop;
+					else
+						End = true;
+				}
+				else if (!Releasing)
+					// Waiting for release
+					Next = i;
+			}
+			Step.Next[Releasing] = static_cast<unsigned char>(Next);
+			Step.End[Releasing] = End;
+		}
+	}
 }
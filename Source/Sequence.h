@@ -66,6 +66,13 @@ const int ARPSCHEME_MIN = ARPSCHEME_MAX - 0x3F;		// // //
 
 #include "CustomExporterInterfaces.h"		// // //
 
+// Precompiled transition of a single sequence item, see CSequence::GetStep
+struct stSequenceStep {
+	signed char Value;			// Item value
+	unsigned char Next[2];		// Item index of the next tick, while not releasing / releasing
+	bool End[2];				// True if the sequence ends after this tick, while not releasing / releasing
+};
+
 /*
 ** This class is used to store instrument sequences
 */
@@ -88,6 +95,12 @@ public:
 	void		 SetSetting(seq_setting_t Setting);			// // //
 	void		 Copy(const CSequence *pSeq);
 
+	// Loop and release points already resolved, valid for indices up to MAX_SEQUENCE_ITEMS
+	const stSequenceStep &GetStep(unsigned int Index) const { return m_Steps[Index]; }
+
+private:
+	void		 Compile();
+
 private:
 	// Sequence data
 	unsigned int m_iItemCount;
@@ -95,5 +108,6 @@ private:
 	unsigned int m_iReleasePoint;
 	seq_setting_t m_iSetting;		// // //
 	signed char	 m_cValues[MAX_SEQUENCE_ITEMS];
+	stSequenceStep m_Steps[MAX_SEQUENCE_ITEMS + 1];		// one extra item for a release point at the end
 	int			 m_iPlaying; // unused
 };
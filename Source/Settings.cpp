@@ -154,6 +154,9 @@ void CSettings::SetupSettings()
 	SETTING_INT("Sound", "Treble filter freq", 12000, &Sound.iTrebleFilter);
 	SETTING_INT("Sound", "Treble filter damping", 24, &Sound.iTrebleDamping);
 	SETTING_INT("Sound", "Volume", 100, &Sound.iMixVolume);
+	SETTING_BOOL("Sound", "Adaptive buffer", false, &Sound.bAdaptiveBuffer);
+	SETTING_BOOL("Sound", "Sub-frame note timing", false, &Sound.bSubFrameInput);		// // //
+	SETTING_BOOL("Sound", "Null device", false, &Sound.bNullDevice);
 
 	// Midi
 	SETTING_INT("MIDI", "Device", 0, &Midi.iMidiDevice);
@@ -286,6 +289,14 @@ void CSettings::DefaultSettings()
 	}
 }
 
+void CSettings::DefaultSettings(LPCTSTR pSection)		// // //
+{
+	for (int i = 0; i < m_iAddedSettings; ++i) {
+		if (!_tcscmp(m_pSettings[i]->GetSection(), pSection))
+			m_pSettings[i]->Default();
+	}
+}
+
 void CSettings::DeleteSettings()
 {
 	// Delete all settings from registry
@@ -308,6 +319,15 @@ CString CSettings::GetPath(unsigned int PathType) const
 	return Paths[PathType];
 }
 
+stPlayerSettings CSettings::GetPlayerSettings() const		// // //
+{
+	stPlayerSettings Settings;
+	Settings.bCutVolume = General.bCutVolume;
+	Settings.bNoDPCMReset = General.bNoDPCMReset;
+	Settings.bFDSOldVolume = General.bFDSOldVolume;
+	return Settings;
+}
+
 void CSettings::SetPath(CString PathName, unsigned int PathType)
 {
 	ASSERT(PathType < PATH_COUNT);
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "PlayerSettings.h"		// // //
 
 // CSettings command target
 
@@ -115,12 +116,15 @@ public:
 	void	LoadSettings();
 	void	SaveSettings();
 	void	DefaultSettings();
+	void	DefaultSettings(LPCTSTR pSection);		// // //
 	void	DeleteSettings();
 	void	SetWindowPos(int Left, int Top, int Right, int Bottom, int State);
 
 	CString GetPath(unsigned int PathType) const;
 	void	SetPath(CString PathName, unsigned int PathType);
 
+	stPlayerSettings GetPlayerSettings() const;		// // //
+
 public:
 	static CSettings* GetObject();
 
@@ -173,6 +177,9 @@ public:
 		int		iTrebleFilter;
 		int		iTrebleDamping;
 		int		iMixVolume;
+		bool	bAdaptiveBuffer;
+		bool	bSubFrameInput;		// // //
+		bool	bNullDevice;
 	} Sound;
 
 	struct {
@@ -49,6 +49,8 @@
 #include "MIDI.h"
 #include "ChannelFactory.h"		// // // test
 #include "DetuneTable.h"		// // //
+#include "AudioProfiler.h"		// // //
+#include <algorithm>		// // //
 #include <array>
 #include <cstdio>
 #include <filesystem>
@@ -221,10 +223,14 @@ int dither(long size);
 // According to https://docs.microsoft.com/en-us/windows/win32/api/winuser/nf-winuser-postthreadmessagea,
 // the default window message limit is 10000. Let's use 8192 for our replacement queue.
 static constexpr size_t MESSAGE_QUEUE_SIZE = 8192;
+static constexpr size_t LIVE_INPUT_QUEUE_SIZE = 1024;		// // //
+static constexpr int MAX_LIVE_INPUT_FRAMES = 4;		// // // Live input is never held back for longer
 
 CSoundGen::CSoundGen() :
 	m_pInstRecorder(new CInstrumentRecorder(this)),
 	m_MessageQueue(MESSAGE_QUEUE_SIZE),
+	m_LiveInputQueue(LIVE_INPUT_QUEUE_SIZE),		// // //
+	m_bSubFrameInput(false),		// // //
 	m_pDocument(NULL),
 	m_pTrackerView(NULL),
 	m_pSoundInterface(NULL),
@@ -235,6 +241,7 @@ CSoundGen::CSoundGen() :
 	m_CoInitialized(false),		// // //
 	m_bRunning(false),
 	m_hInterruptEvent(::CreateEvent(NULL, FALSE, FALSE, NULL)),
+	m_AudioWaitTime(),
 	m_bBufferTimeout(false),
 	m_bBufferUnderrun(false),
 	m_bAudioClipping(false),		// // //
@@ -273,6 +280,9 @@ CSoundGen::CSoundGen() :
 
 	TRACE("SoundGen: Object created\n");
 
+	m_LiveInputHeld.reserve(LIVE_INPUT_QUEUE_SIZE);		// // //
+	m_iRefreshCycle.fill(0);
+
 	// Create APU
 	m_pAPU = new CAPU(this);		// // //
 
@@ -417,7 +427,7 @@ void CSoundGen::AssignDocument(CFamiTrackerDoc *pDoc)
 	// Setup all channels
 	for (int i = 0; i < CHANNELS; ++i) {
 		if (m_pChannels[i])
-			m_pChannels[i]->InitChannel(m_pAPU, m_iVibratoTable, this);
+			m_pChannels[i]->InitChannel(m_pAPU, m_iVibratoTable, this, &m_PlayerSettings);
 	}
 	DocumentPropertiesChanged(pDoc);		// // //
 }
@@ -788,6 +798,17 @@ void CSoundGen::LoadSettings()
 	PostGuiMessage(WM_USER_LOAD_SETTINGS, 0, 0);
 }
 
+void CSoundGen::SetPlayerSettings(const stPlayerSettings &Settings)		// // //
+{
+	// Called from main thread, the options are single flags read by the player on each tick
+	m_PlayerSettings = Settings;
+}
+
+const stPlayerSettings &CSoundGen::GetPlayerSettings() const		// // //
+{
+	return m_PlayerSettings;
+}
+
 void CSoundGen::SilentAll()
 {
 	if (!m_audioThread.joinable())
@@ -978,29 +999,41 @@ bool CSoundGen::ResetAudioDevice()
 	unsigned int SampleRate	= pSettings->Sound.iSampleRate;
 	unsigned int BufferLen = pSettings->Sound.iBufferLength;
 	unsigned int Device = pSettings->Sound.iDevice;
+	bool bAdaptive = pSettings->Sound.bAdaptiveBuffer;
+	m_bSubFrameInput = pSettings->Sound.bSubFrameInput;		// // //
 
 	auto l = Lock();
 
 	m_iAudioUnderruns = 0;
+	m_OutputClock = { };		// // //
 	src_reset(m_resampler);
 
 	// Close the old sound channel
 	CloseAudioDevice();
 
-	if (Device >= m_pSoundInterface->GetDeviceCount()) {
-		// Invalid device detected, reset to 0
-		Device = 0;
-		pSettings->Sound.iDevice = 0;
-	}
+	// In adaptive mode, open a large buffer and only keep part of it filled
+	unsigned int DeviceBufferLen = bAdaptive ? std::max(BufferLen, (unsigned int)ADAPTIVE_BUFFER_LENGTH) : BufferLen;
 
-	// Reinitialize sound interface
-	if (!m_pSoundInterface->SetupDevice(Device)) {
-		m_pTrackerView->PostAudioMessage(AM_ERROR, IDS_SOUND_ERROR, MB_ICONERROR);
-		return false;
+	if (pSettings->Sound.bNullDevice) {
+		// Consume audio without a device
+		m_pSoundStream = m_pSoundInterface->OpenNullChannel(1, DeviceBufferLen, SampleRate);
 	}
+	else {
+		if (Device >= m_pSoundInterface->GetDeviceCount()) {
+			// Invalid device detected, reset to 0
+			Device = 0;
+			pSettings->Sound.iDevice = 0;
+		}
 
-	// Create channel
-	m_pSoundStream = m_pSoundInterface->OpenFloatChannel(1, BufferLen);
+		// Reinitialize sound interface
+		if (!m_pSoundInterface->SetupDevice(Device)) {
+			m_pTrackerView->PostAudioMessage(AM_ERROR, IDS_SOUND_ERROR, MB_ICONERROR);
+			return false;
+		}
+
+		// Create channel
+		m_pSoundStream = m_pSoundInterface->OpenFloatChannel(1, DeviceBufferLen);
+	}
 
 	// Channel failed
 	if (m_pSoundStream == NULL) {
@@ -1015,6 +1048,9 @@ bool CSoundGen::ResetAudioDevice()
 	m_iBufSizeBytes	  = m_pSoundStream->TotalBufferSizeBytes();
 	m_iBufSizeSamples = m_pSoundStream->TotalBufferSizeFrames();
 
+	m_LatencyController.Reset(ResampleRate, m_iBufSizeSamples, ResampleRate * BufferLen / 1000, bAdaptive);
+	m_pSoundStream->SetTargetFrames(m_LatencyController.GetTargetFrames());
+
 	// Temp. audio buffer
 	m_pResampleOutBuffer = std::make_unique<float[]>(m_iBufSizeSamples);
 
@@ -1153,11 +1189,22 @@ bool CSoundGen::TryWaitForWritable(uint32_t& framesWritable, bool SkipIfWritable
 	ASSERT(!m_bRendering);
 
 	while (true) {
-		WaitResult result = m_pSoundStream->WaitForReady(AUDIO_TIMEOUT, SkipIfWritable);
+		m_pSoundStream->SetTargetFrames(m_LatencyController.GetTargetFrames());
+
+		const auto WaitStart = std::chrono::steady_clock::now();
+		WaitResult result;
+		{
+			AUDIO_PROFILE_SCOPE(PROFILE_AUDIO_WAIT);		// // //
+			result = m_pSoundStream->WaitForReady(AUDIO_TIMEOUT, SkipIfWritable);
+		}
+		const auto WaitEnd = std::chrono::steady_clock::now();
+		m_AudioWaitTime += WaitEnd - WaitStart;
+
 		// TRACE("WaitResult %d\n", result);
 		switch (result) {
 		case WaitResult::Ready:
-			goto endWhile;
+			m_LatencyController.OnWake(WaitEnd);
+			break;
 
 		case WaitResult::InternalError:
 		case WaitResult::Timeout:
@@ -1172,17 +1219,22 @@ bool CSoundGen::TryWaitForWritable(uint32_t& framesWritable, bool SkipIfWritable
 			return false;
 
 		case WaitResult::OutOfSync:
-			// Buffer underrun detected (unreachable since underruns are not reported)
+			// Buffer underrun detected, write audio immediately
 			m_iAudioUnderruns++;
 			m_bBufferUnderrun = true;
-			continue;
+			m_LatencyController.OnUnderrun();
+			m_pSoundStream->SetTargetFrames(m_LatencyController.GetTargetFrames());
+			break;
 		}
-	}
-endWhile:
 
-	framesWritable = m_pSoundStream->BufferFramesWritable();
-	ASSERT(framesWritable <= m_iBufSizeSamples);
-	return true;
+		framesWritable = m_pSoundStream->BufferFramesWritable();
+		ASSERT(framesWritable <= m_iBufSizeSamples);
+		if (framesWritable)
+			return true;
+
+		// Still filled above the target, wait for the device to consume more
+		SkipIfWritable = false;
+	}
 }
 
 void CSoundGen::FlushBuffer(int16_t const * pBuffer, uint32_t Size)
@@ -1348,6 +1400,12 @@ bool CSoundGen::PlayBuffer(unsigned int bytesToWrite) {
 	// Output audio
 	// Write audio to buffer
 	m_pSoundStream->WriteBuffer(m_pResampleOutBuffer.get(), bytesToWrite);
+	const uint32_t QueuedFrames = m_pSoundStream->BufferFramesQueued();		// // //
+	m_LatencyController.OnWrite(QueuedFrames);
+
+	// // // The next frame starts playing once everything queued so far has been played
+	m_OutputClock = std::chrono::steady_clock::now() +
+		std::chrono::microseconds(uint64_t(QueuedFrames) * 1000000 / m_pSoundStream->GetSampleRate());
 
 	// Reset buffer position
 	m_bBufferTimeout = false;
@@ -1367,6 +1425,11 @@ unsigned int CSoundGen::GetUnderruns() const
 	return m_iAudioUnderruns;
 }
 
+stLatencyStats CSoundGen::GetLatencyStats() const
+{
+	return m_LatencyController.GetStats();
+}
+
 unsigned int CSoundGen::GetFrameRate()
 {
 	int FrameRate = m_iFrameCounter;
@@ -1698,7 +1761,7 @@ void CSoundGen::HaltPlayer()
 
 	// Signal that playback has stopped
 	if (m_pTrackerView != NULL) {
-		m_pTrackerView->PostAudioMessage(AM_PLAYER, m_iPlayFrame, m_iPlayRow);
+		m_pTrackerView->PostGuiUpdate(GUI_UPDATE_POSITION | GUI_UPDATE_METERS);		// // //
 		m_pInstRecorder->StopRecording(m_pTrackerView);		// // //
 	}
 
@@ -1844,6 +1907,12 @@ void CSoundGen::MakeSilent()
 		if (m_pTrackerChannels[i])
 			m_pTrackerChannels[i]->Reset();
 	}
+
+	// // // Discard pending live input along with the pending notes
+	stLiveEvent Event;
+	while (m_LiveInputQueue.Pop(Event))
+		;
+	m_LiveInputHeld.clear();
 }
 
 void CSoundGen::ResetState()
@@ -1966,6 +2035,8 @@ void CSoundGen::RunFrame()
 	if (IsPlaying()) {
 
 		++m_iPlayTicks;
+		if (!m_bRendering)		// // //
+			m_pTrackerView->PostGuiUpdate(GUI_UPDATE_TIME);
 
 		if (m_bRendering) {
 			if (m_iRenderEndWhen == SONG_TIME_LIMIT) {
@@ -2049,7 +2120,7 @@ void CSoundGen::CheckControl()
 	if (m_bDirty) {
 		m_bDirty = false;
 		if (!m_bRendering)
-			m_pTrackerView->PostAudioMessage(AM_PLAYER, m_iPlayFrame, m_iPlayRow);
+			m_pTrackerView->PostGuiUpdate(GUI_UPDATE_POSITION);		// // //
 	}
 }
 
@@ -2127,6 +2198,11 @@ int CSoundGen::GetChannelVolume(int Channel) const
 	return m_pChannels[Channel]->GetChannelVolume();
 }
 
+CChannelScopeTap *CSoundGen::GetChannelScopeTap() const
+{
+	return m_pAPU->GetChannelScopeTap();
+}
+
 void CSoundGen::PlayNote(int Channel, stChanNote *NoteData, int EffColumns)
 {
 	if (!NoteData)
@@ -2251,8 +2327,7 @@ bool CSoundGen::RenderToFile(LPTSTR pFile, render_end_t SongEndType, int SongEnd
 	// Unfortunately, destructor doesn't cleanup object. Only CloseFile() does.
 	if (!m_pWaveFile ||
 		!m_pWaveFile->OpenFile(pFile, theApp.GetSettings()->Sound.iSampleRate, 16, 1)) {
-		AfxMessageBox(IDS_FILE_OPEN_ERROR);
-
+		// // // The caller reports the error, the regression runner must not block on a message box
 		// When writing to a locked file, hmmioOut is nullptr so we don't need to call
 		// m_pWaveFile->CloseFile().
 		m_pWaveFile.reset();
@@ -2474,29 +2549,48 @@ void CSoundGen::OnIdle()
 
 	++m_iFrameCounter;
 
+	AUDIO_PROFILE_SCOPE(PROFILE_FRAME);		// // //
+	const auto FrameStart = std::chrono::steady_clock::now();
+	m_AudioWaitTime = { };
+
 	// Access the document object, skip if access wasn't granted to avoid gaps in audio playback
 	if (m_pDocument->LockDocument(0)) {
 
 		// Read module framerate
 		m_iFrameRate = m_pDocument->GetFrameRate();
 
-		RunFrame();
+		{
+			AUDIO_PROFILE_SCOPE(PROFILE_RUN_FRAME);
+			RunFrame();
+		}
 
 		// Play queued notes
-		PlayChannelNotes();
+		{
+			AUDIO_PROFILE_SCOPE(PROFILE_PLAY_NOTES);
+			PlayChannelNotes();
+		}
 
 		// Update player
-		UpdatePlayer();
+		{
+			AUDIO_PROFILE_SCOPE(PROFILE_UPDATE_PLAYER);
+			UpdatePlayer();
+		}
 
 		// Channel updates (instruments, effects etc)
-		UpdateChannels();
+		{
+			AUDIO_PROFILE_SCOPE(PROFILE_UPDATE_CHANNELS);
+			UpdateChannels();
+		}
 
 		// Unlock document
 		m_pDocument->UnlockDocument();
 	}
 
 	// Update APU registers
-	UpdateAPU();
+	{
+		AUDIO_PROFILE_SCOPE(PROFILE_UPDATE_APU);
+		UpdateAPU();
+	}
 
 	if (IsPlaying()) {		// // //
 		int Channel = m_pInstRecorder->GetRecordChannel();
@@ -2533,10 +2627,19 @@ void CSoundGen::OnIdle()
 		delete m_pPreviewSample;
 		m_pPreviewSample = NULL;
 	}
+
+	if (!m_bRendering)
+		m_LatencyController.OnFrameEmulated(std::chrono::steady_clock::now() - FrameStart - m_AudioWaitTime);
 }
 
 void CSoundGen::PlayChannelNotes()
 {
+	bool bMetersChanged = false;		// // //
+	bool bNoteHeld = false;
+
+	// // // Take notes and pitch from live input
+	ApplyLiveInput();
+
 	// Read notes
 	for (int i = 0; i < CHANNELS; ++i) {		// // //
 		int Index = m_pTrackerChannels[i]->GetID();
@@ -2551,6 +2654,7 @@ void CSoundGen::PlayChannelNotes()
 
 		// Check if new note data has been queued for playing
 		if (m_pTrackerChannels[Index]->NewNoteData()) {
+			m_iRefreshCycle[Index] = m_pTrackerChannels[Index]->GetNoteCycle();		// // //
 			stChanNote Note = m_pTrackerChannels[Index]->GetNote();
 			PlayNote(Index, &Note, m_pDocument->GetEffColumns(m_iPlayTrack, Channel) + 1);
 		}
@@ -2560,9 +2664,19 @@ void CSoundGen::PlayChannelNotes()
 		m_pChannels[Index]->SetPitch(Pitch);
 
 		// Update volume meters
-		m_pTrackerChannels[Index]->SetVolumeMeter(m_pAPU->GetVol(m_pTrackerChannels[Index]->GetID()));
+		const int Level = m_pAPU->GetVol(m_pTrackerChannels[Index]->GetID());		// // //
+		if (Level != m_pTrackerChannels[Index]->GetVolumeMeter())
+			bMetersChanged = true;
+		m_pTrackerChannels[Index]->SetVolumeMeter(Level);
+		if (m_pChannels[Index]->IsActive() && !m_pChannels[Index]->IsReleasing())
+			bNoteHeld = true;
 	}
 
+	// // // Registers and DPCM state change with every played frame and every frame a note is held.
+	// Released notes keep their gate until cut, so they only update while their level changes.
+	if (!m_bRendering && (bMetersChanged || bNoteHeld || IsPlaying()))
+		m_pTrackerView->PostGuiUpdate(GUI_UPDATE_METERS);
+
 	// Instrument sequence visualization
 	// // //
 }
@@ -2594,6 +2708,18 @@ void CSoundGen::UpdateChannels()
 				m_pChannels[i]->ProcessChannel();
 		}
 	}
+
+	// Report the play position of the sequence shown in the sequence editor
+	const CSequence *pSequence = m_pSequencePlayPos;		// // // set by the GUI thread
+	if (pSequence != NULL && !m_bHaltRequest) {
+		int Pos = -1;
+		bool Found = false;
+		for (int i = 0; i < CHANNELS; ++i)
+			if (m_pChannels[i] != NULL && m_pChannels[i]->GetSequencePlayPos(pSequence, Pos))
+				Found = true;
+		if (Found)
+			SetSequencePlayPos(pSequence, Pos);
+	}
 }
 
 void CSoundGen::UpdateAPU()
@@ -2605,20 +2731,43 @@ void CSoundGen::UpdateAPU()
 
 	auto UpdateAPUImpl = [&]() {
 		unsigned int PrevChip = SNDCHIP_NONE;		// // // 050B
+		auto RefreshChannel = [&] (int i) {		// // //
+			m_pChannels[i]->RefreshChannel();
+			m_pChannels[i]->FinishTick();		// // //
+			unsigned int Chip = m_pTrackerChannels[i]->GetChip();
+			if (m_pDocument->ExpansionEnabled(Chip)) {
+				int Delay = (Chip == PrevChip) ? 150 : 250;
+
+				AddCyclesUnlessEndOfFrame(Delay);
+				m_pAPU->Process();
+
+				PrevChip = Chip;
+			}
+		};
+
+		std::array<int, CHANNELS> Scheduled;		// // //
+		int ScheduledCount = 0;
 		for (int i = 0; i < CHANNELS; ++i) {
 			if (m_pChannels[i] != NULL) {
-				m_pChannels[i]->RefreshChannel();
-				m_pChannels[i]->FinishTick();		// // //
-				unsigned int Chip = m_pTrackerChannels[i]->GetChip();
-				if (m_pDocument->ExpansionEnabled(Chip)) {
-					int Delay = (Chip == PrevChip) ? 150 : 250;
-
-					AddCyclesUnlessEndOfFrame(Delay);
-					m_pAPU->Process();
+				if (m_iRefreshCycle[i] > 0)
+					Scheduled[ScheduledCount++] = i;
+				else
+					RefreshChannel(i);
+			}
+		}
 
-					PrevChip = Chip;
-				}
+		// // // Channels with live notes placed inside the frame keep their previous
+		// register values until the cycle the note was scheduled at
+		std::sort(Scheduled.begin(), Scheduled.begin() + ScheduledCount, [&] (int a, int b) {
+			return m_iRefreshCycle[a] < m_iRefreshCycle[b];
+		});
+		for (int j = 0; j < ScheduledCount; ++j) {
+			const int i = Scheduled[j];
+			if (m_iRefreshCycle[i] > m_iConsumedCycles) {
+				AddCyclesUnlessEndOfFrame(m_iRefreshCycle[i] - m_iConsumedCycles);
+				m_pAPU->Process();
 			}
+			RefreshChannel(i);
 		}
 #ifdef WRITE_VGM		// // //
 		if (m_bPlaying)
@@ -2651,6 +2800,7 @@ void CSoundGen::UpdateAPU()
 	}
 
 	m_iConsumedCycles = 0;
+	m_iRefreshCycle.fill(0);		// // //
 
 #ifdef LOGGING
 	if (m_bPlaying)
@@ -2881,21 +3031,115 @@ void CSoundGen::PlayerSkipTo(int Row)
 	m_bDirty = true;
 }
 
-void CSoundGen::QueueNote(int Channel, stChanNote &NoteData, note_prio_t Priority) const
+void CSoundGen::QueueNote(int Channel, const stChanNote &NoteData, note_prio_t Priority, stLiveEvent::clock_type::time_point Time)
 {
 	if (m_pDocument == NULL)
 		return;
 
 	// Queue a note for play
-	m_pDocument->GetChannel(Channel)->SetNote(NoteData, Priority);
+	if (std::this_thread::get_id() == m_audioThreadID)		// // // Pattern playback
+		m_pDocument->GetChannel(Channel)->SetNote(NoteData, Priority);
+	else {
+		stLiveEvent Event;
+		Event.Type = LIVE_EVENT_NOTE;
+		Event.Channel = Channel;
+		Event.Priority = Priority;
+		Event.Note = NoteData;
+		Event.Time = Time;
+		QueueLiveEvent(Event);
+	}
 	theApp.GetMIDI()->WriteNote(Channel, NoteData.Note, NoteData.Octave, NoteData.Vol);
 }
 
+void CSoundGen::QueuePitch(int Channel, int Pitch, stLiveEvent::clock_type::time_point Time)		// // //
+{
+	stLiveEvent Event;
+	Event.Type = LIVE_EVENT_PITCH;
+	Event.Channel = Channel;
+	Event.Value = Pitch;
+	Event.Time = Time;
+	QueueLiveEvent(Event);
+}
+
 void CSoundGen::ForceReloadInstrument(int Channel)		// // //
 {
-	if (m_pDocument == NULL)
-		return;
-	m_pChannels[m_pDocument->GetChannel(Channel)->GetID()]->ForceReloadInstrument();
+	stLiveEvent Event;
+	Event.Type = LIVE_EVENT_RELOAD_INSTRUMENT;
+	Event.Channel = Channel;
+	QueueLiveEvent(Event);
+}
+
+void CSoundGen::QueueLiveEvent(stLiveEvent Event)		// // //
+{
+	if (Event.Time == stLiveEvent::clock_type::time_point { })
+		Event.Time = stLiveEvent::clock_type::now();
+	if (!m_LiveInputQueue.Push(Event))
+		TRACE("SoundGen: Live input queue is full, event dropped\n");
+}
+
+void CSoundGen::ApplyLiveInput()		// // //
+{
+	// Called from player thread
+	ASSERT(std::this_thread::get_id() == m_audioThreadID);
+
+	// Events held back by earlier frames come first, stop at the first one still not due
+	auto Due = m_LiveInputHeld.begin();
+	while (Due != m_LiveInputHeld.end() && ApplyLiveEvent(*Due))
+		++Due;
+	m_LiveInputHeld.erase(m_LiveInputHeld.begin(), Due);
+
+	stLiveEvent Event;
+	while (m_LiveInputQueue.Pop(Event))
+		if (!m_LiveInputHeld.empty() || !ApplyLiveEvent(Event))
+			m_LiveInputHeld.push_back(Event);
+}
+
+bool CSoundGen::ApplyLiveEvent(const stLiveEvent &Event)		// // //
+{
+	// Returns false if the event belongs to a later frame
+	const int Cycle = m_bSubFrameInput ? GetLiveEventCycle(Event.Time) : 0;
+	if (Cycle >= m_iUpdateCycles)
+		return false;
+
+	// The channel layout may have changed since the event was queued
+	if (Event.Channel < 0 || Event.Channel >= m_pDocument->GetChannelCount())
+		return true;
+	CTrackerChannel *pChannel = m_pDocument->GetChannel(Event.Channel);
+
+	switch (Event.Type) {
+	case LIVE_EVENT_NOTE:
+		pChannel->SetNote(Event.Note, Event.Priority, Cycle);
+		break;
+	case LIVE_EVENT_PITCH:
+		pChannel->SetPitch(Event.Value);
+		break;
+	case LIVE_EVENT_RELOAD_INSTRUMENT:
+		if (CChannelHandler *pHandler = m_pChannels[pChannel->GetID()])
+			pHandler->ForceReloadInstrument();
+		break;
+	}
+	return true;
+}
+
+int CSoundGen::GetLiveEventCycle(stLiveEvent::clock_type::time_point Time) const		// // //
+{
+	// Live input is heard a fixed delay after it was received: the output latency target
+	// plus one frame, so that input received during one frame is spread over the next one
+	// instead of being quantized to its start. Returns the APU cycle relative to the start
+	// of the current frame, 0 if the input is already late.
+
+	if (m_bRendering || !m_pSoundStream || m_OutputClock == stLiveEvent::clock_type::time_point { })
+		return 0;
+
+	const double BaseFreq = (m_iMachineType == NTSC) ? CAPU::BASE_FREQ_NTSC : CAPU::BASE_FREQ_PAL;
+	const double Latency = double(m_LatencyController.GetTargetFrames()) / m_pSoundStream->GetSampleRate();
+	const double Offset = std::chrono::duration<double>(Time - m_OutputClock).count() + Latency;
+	const double Cycle = Offset * BaseFreq + m_iUpdateCycles;
+
+	// Also treat input too far ahead of the output as late, the clocks have drifted apart
+	if (Cycle < 0 || Cycle >= MAX_LIVE_INPUT_FRAMES * m_iUpdateCycles)
+		return 0;
+	return static_cast<int>(Cycle);
 }
 
 int	CSoundGen::GetPlayerRow() const
@@ -33,12 +33,17 @@
 #include "Common.h"
 #include "FamiTrackerTypes.h"
 #include "ChannelState.h"		// // //
+#include "AudioLatency.h"
+#include "LiveInputQueue.h"		// // //
+#include "PlayerSettings.h"
 
+#include <array>		// // //
 #include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <thread>
+#include <vector>		// // //
 
 const int VIBRATO_LENGTH = 256;
 const int TREMOLO_LENGTH = 256;
@@ -93,6 +98,7 @@ class CFamiTrackerDoc;
 class CInstrument;		// // //
 class CSequence;		// // //
 class CAPU;
+class CChannelScopeTap;
 class CSoundInterface;
 class CSoundStream;
 class CWaveFile;		// // //
@@ -192,6 +198,8 @@ public:
 	void		 ResetPlayer(int Track);
 	void		 LoadSettings();
 	void		 SilentAll();
+	void		 SetPlayerSettings(const stPlayerSettings &Settings);		// // //
+	const stPlayerSettings &GetPlayerSettings() const;		// // //
 
 	void		 ResetState();
 	void		 ResetTempo();
@@ -203,6 +211,7 @@ public:
 
 	// Stats
 	unsigned int GetUnderruns() const;
+	stLatencyStats GetLatencyStats() const;
 	unsigned int GetFrameRate();
 
 	// Tracker playing
@@ -212,9 +221,11 @@ public:
 
 	stDPCMState	 GetDPCMState() const;
 	int			 GetChannelVolume(int Channel) const;		// // //
+	// Per-channel oscilloscope samples, may be read from any single GUI thread
+	CChannelScopeTap *GetChannelScopeTap() const;
 
 	// Rendering
-	bool		 RenderToFile(LPTSTR pFile, render_end_t SongEndType, int SongEndParam, int Track);
+	bool		 RenderToFile(LPTSTR pFile, render_end_t SongEndType, int SongEndParam, int Track);		// // // False if the file cannot be opened
 	void		 StopRendering();
 	void		 GetRenderStat(int &Frame, int &Time, bool &Done, int &FramesToRender, int &Row, int &RowCount) const;
 	bool		 IsRendering() const;
@@ -253,8 +264,12 @@ public:
 	int			GetPlayerFrame() const;
 	int			GetPlayerTrack() const;
 	int			GetPlayerTicks() const;
-	void		QueueNote(int Channel, stChanNote &NoteData, note_prio_t Priority) const;
+	// // // Live input, may be called from any thread. Time is when the input was received,
+	// the default of time_point() means now.
+	void		QueueNote(int Channel, const stChanNote &NoteData, note_prio_t Priority, stLiveEvent::clock_type::time_point Time = { });
+	void		QueuePitch(int Channel, int Pitch, stLiveEvent::clock_type::time_point Time = { });
 	void		ForceReloadInstrument(int Channel);		// // //
+	void		QueueLiveEvent(stLiveEvent Event);		// // //
 	void		MoveToFrame(int Frame);
 	void		SetQueueFrame(int Frame);
 	int			GetQueueFrame() const;
@@ -302,6 +317,9 @@ private:
 	void		UpdateAPU();
 	void		UpdatePlayer();
 	void		PlayChannelNotes();
+	void		ApplyLiveInput();		// // //
+	bool		ApplyLiveEvent(const stLiveEvent &Event);		// // //
+	int			GetLiveEventCycle(stLiveEvent::clock_type::time_point Time) const;		// // //
 	void	 	PlayNote(int Channel, stChanNote *NoteData, int EffColumns);
 	void		RunFrame();
 	void		CheckControl();
@@ -329,6 +347,7 @@ public:
 	static const double OLD_VIBRATO_DEPTH[];
 
 	static const int AUDIO_TIMEOUT = 2000;		// 2s buffer timeout
+	static const int ADAPTIVE_BUFFER_LENGTH = 200;		// Device buffer size in adaptive mode, in ms
 
 	//
 	// Private variables
@@ -346,6 +365,19 @@ private:
 	std::optional<GuiMessage> m_maybeSelfMessage;
 	rigtorp::SPSCQueue<GuiMessage> m_MessageQueue;
 
+	/// // // Notes and pitch from the GUI and MIDI input, consumed by the audio thread
+	/// at the start of each frame.
+	CLiveInputQueue m_LiveInputQueue;
+	/// Live input taken from the queue which is not due until a later frame.
+	std::vector<stLiveEvent> m_LiveInputHeld;
+	/// Place live notes inside the frame according to when they were received.
+	bool m_bSubFrameInput;
+	/// Time at which the start of the next emulated frame will be heard.
+	stLiveEvent::clock_type::time_point m_OutputClock;
+	/// Cycle within the current frame at which each channel writes its registers,
+	/// 0 for channels updated along with the others at the start of the frame.
+	std::array<int, CHANNELS> m_iRefreshCycle;
+
 	// Objects
 	CChannelHandler		*m_pChannels[CHANNELS];
 	CTrackerChannel		*m_pTrackerChannels[CHANNELS];
@@ -404,6 +436,8 @@ private:
 	std::unique_ptr<float[]> m_pResampleOutBuffer;
 
 	int					m_iAudioUnderruns;					// Keep track of underruns to inform user
+	CAudioLatencyController m_LatencyController;
+	std::chrono::steady_clock::duration m_AudioWaitTime;		// Time spent waiting on the device during the current frame
 	bool				m_bBufferTimeout;
 	bool				m_bBufferUnderrun;
 	bool				m_bAudioClipping;
@@ -450,6 +484,7 @@ private:
 	unsigned int		m_iNoteLookupTableN163[96];			// For N163
 	unsigned int		m_iNoteLookupTableS5B[96];			// // // For 5B, internal use only
 	int					m_iVibratoTable[VIBRATO_LENGTH];
+	stPlayerSettings	m_PlayerSettings;					// // // Options shared by all channel handlers
 
 	machine_t			m_iMachineType;						// // // NTSC/PAL
 
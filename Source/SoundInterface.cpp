@@ -23,6 +23,7 @@
 //
 
 #include "stdafx.h"
+#include <algorithm>
 #include <cstdio>
 #include <utility>  // std::move
 #include "Common.h"
@@ -343,7 +344,7 @@ CSoundStream *CSoundInterface::OpenFloatChannel(const int InputChannels, int Buf
 	//
 	// ~~what if CSoundGen and CSoundStream were coroutines~~
 
-	return new CSoundStream(
+	return new CWasapiSoundStream(
 		std::move(pAudioClient),
 		std::move(pAudioRenderClient),
 		m_hInterrupt,
@@ -355,6 +356,12 @@ CSoundStream *CSoundInterface::OpenFloatChannel(const int InputChannels, int Buf
 		OutputChannels);
 }
 
+CSoundStream *CSoundInterface::OpenNullChannel(int Channels, int BufferLength, unsigned int SampleRate, FILE *pFile)
+{
+	unsigned int bufferFrameCount = std::max(1u, SampleRate * BufferLength / 1000);
+	return new CNullSoundStream(m_hInterrupt, SampleRate, bufferFrameCount, Channels, pFile);
+}
+
 void CSoundInterface::CloseChannel(CSoundStream *pSoundStream)
 {
 	if (pSoundStream == NULL)
@@ -363,9 +370,9 @@ void CSoundInterface::CloseChannel(CSoundStream *pSoundStream)
 	delete pSoundStream;
 }
 
-// CSoundStream
+// CWasapiSoundStream
 
-CSoundStream::CSoundStream(
+CWasapiSoundStream::CWasapiSoundStream(
 	ComPtr<IAudioClient> pAudioClient,
 	ComPtr<IAudioRenderClient> pAudioRenderClient,
 	HANDLE hInterrupt,
@@ -376,22 +383,16 @@ CSoundStream::CSoundStream(
 	unsigned int inputChannels,
 	unsigned int outputChannels)
 :
+	CSoundStream(hInterrupt, iSampleRate, bufferFrameCount, bytesPerSample, inputChannels),
 	m_bufferEvent(std::move(bufferEvent)),
 	m_pAudioClient(std::move(pAudioClient)),
 	m_pAudioRenderClient(std::move(pAudioRenderClient)),
-	m_state(StreamState::Stopped),
-	m_hInterrupt(hInterrupt),
 	m_hTask(nullptr),
-	m_iSampleRate(iSampleRate),
-	m_bufferFrameCount(bufferFrameCount),
-	m_bytesPerSample(bytesPerSample),
-	m_inputChannels(inputChannels),
 	m_outputChannels(outputChannels)
 {
-	ASSERT(m_inputChannels == 1);
 }
 
-CSoundStream::~CSoundStream()
+CWasapiSoundStream::~CWasapiSoundStream()
 {
 	if (m_hTask) {
 		// AvRevertMmThreadCharacteristics must be called on the same thread as
@@ -401,7 +402,7 @@ CSoundStream::~CSoundStream()
 	}
 }
 
-bool CSoundStream::Play()
+bool CWasapiSoundStream::Play()
 {
 	// "To avoid start-up glitches with rendering streams, clients should not call Start
 	// until the audio engine has been initially loaded with data by calling the
@@ -427,7 +428,7 @@ bool CSoundStream::Play()
 	return true;
 }
 
-bool CSoundStream::Stop()
+bool CWasapiSoundStream::Stop()
 {
 	// Only called by CSoundGen::CloseAudioDevice(), before deleting CSoundStream.
 	// Exact behavior is unimportant.
@@ -448,15 +449,14 @@ bool CSoundStream::Stop()
 	return true;
 }
 
-bool CSoundStream::ClearBuffer()
+bool CWasapiSoundStream::ClearBuffer()
 {
 	// This function is only called when starting or stopping WAV export:
 	// CSoundGen::OnStartRender()/StopRendering() -> CSoundGen::ResetBuffer() ->
 	// CSoundStream::ClearBuffer().
 	//
 	// I'm not sure if it's even necessary to stop the output stream during
-	// WAV export, though it avoids underruns (if we actually reported underruns
-	// properly).
+	// WAV export, though it avoids underruns.
 
 	if (m_state == StreamState::Started)
 		if (!Stop())
@@ -468,83 +468,17 @@ bool CSoundStream::ClearBuffer()
 	return true;
 }
 
-// Buffering
-
-uint32_t CSoundStream::PubBytesToFrames(uint32_t Bytes) const
-{
-	return Bytes / m_bytesPerSample / m_inputChannels;
-}
-
-uint32_t CSoundStream::FramesToPubBytes(uint32_t Frames) const
+WaitResult CWasapiSoundStream::WaitForDevice(DWORD dwTimeout)
 {
-	return Frames * m_bytesPerSample * m_inputChannels;
-}
-
-uint32_t CSoundStream::TotalBufferSizeFrames() const {
-	return m_bufferFrameCount;
-}
-
-uint32_t CSoundStream::TotalBufferSizeBytes() const {
-	return FramesToPubBytes(m_bufferFrameCount);
-}
-
-// Steady-state
-
-WaitResult CSoundStream::WaitForReady(DWORD dwTimeout, bool SkipIfWritable)
-{
-	auto onInterrupted = []() {
-		return WaitResult::Interrupted;
-	};
-
-	auto onWritable = []() {
-		// I don't know of any way to detect playback buffer underruns in WASAPI,
-		// to return WaitResult::OutOfSync.
-		// https://stackoverflow.com/q/32112562 has no answer, and
-		// https://github.com/mackron/miniaudio/issues/81 couldn't figure it out either.
-		return WaitResult::Ready;
-	};
-
-	// Check for cancellation upfront.
-	if (WaitForSingleObject(m_hInterrupt, 0) == WAIT_OBJECT_0) {
-		return onInterrupted();
-	}
-
-	// Check for special cases.
-	if (m_state == StreamState::Stopped) {
-		// The first few times CSoundGen waits to write audio, don't start stream playback.
-		// Instead return and let CSoundGen write audio. (At this point,
-		// CSoundStream::BufferFramesWritable() returns the full buffer size.)
-		//
-		// When WriteBuffer() is called, if m_state == StreamState::Stopped and the buffer is
-		// full, it calls Play() which sets m_state = StreamState::Started.
-		return WaitResult::Ready;
-	}
-	// TODO we can get marginally less latency by having CSoundGen call
-	// CSoundStream::WaitForReady before generating audio, rather than before
-	// converting/buffering it.
-
-	// Check if we can write audio without waiting at all (which is the case if the
-	// previous WriteBuffer() didn't fill the whole buffer).
-	//
-	// SkipIfWritable=false (after a full write) causes WaitForReady() to block if WASAPI
-	// hasn't set m_bufferEvent, but BufferFramesWritable() > 0. I've never seen this
-	// happen after a full write, on either Windows or Wine. So not checking
-	// BufferFramesWritable() if SkipIfWritable=false isn't needed to avoid an endless
-	// loop of writing 1 sample at a time, but saves an IAudioClient::GetCurrentPadding()
-	// call.
-	if (SkipIfWritable && BufferFramesWritable()) {
-		return onWritable();
-	}
-
 	// Wait for events
 	HANDLE waitEvents[2] = { m_hInterrupt, m_bufferEvent.get() };
 
 	switch (WaitForMultipleObjects(2, waitEvents, FALSE, dwTimeout)) {
 	case WAIT_OBJECT_0:  // hInterrupt: interrupted by GUI
-		return onInterrupted();
+		return WaitResult::Interrupted;
 
 	case WAIT_OBJECT_0 + 1:  // m_bufferEvent: WASAPI buffer ready to write
-		return onWritable();
+		return WaitResult::Ready;
 
 	case WAIT_TIMEOUT:  // Timeout
 		return WaitResult::Timeout;
@@ -554,21 +488,15 @@ WaitResult CSoundStream::WaitForReady(DWORD dwTimeout, bool SkipIfWritable)
 	}
 }
 
-unsigned int CSoundStream::BufferFramesWritable() const {
+uint32_t CWasapiSoundStream::BufferFramesQueued() const {
 	UINT32 numFramesPadding;
 	auto hr = m_pAudioClient->GetCurrentPadding(&numFramesPadding);
-	if (FAILED(hr)) return 0;
+	if (FAILED(hr)) return m_bufferFrameCount;  // Report a full buffer so nothing is written
 
-	UINT32 numFramesAvailable = m_bufferFrameCount - numFramesPadding;
-	// TRACE("%d frames available of %d\n", numFramesAvailable, m_bufferFrameCount);
-	return numFramesAvailable;
+	return numFramesPadding;
 }
 
-uint32_t CSoundStream::BufferBytesWritable() const {
-	return FramesToPubBytes(BufferFramesWritable());
-}
-
-bool CSoundStream::WriteBuffer(float const* pSrcBuffer, unsigned int Bytes)
+bool CWasapiSoundStream::WriteBuffer(float const* pSrcBuffer, unsigned int Bytes)
 {
 	// Bytes comes from CSoundStream::BufferBytesWritable().
 	const unsigned int nFrames = PubBytesToFrames(Bytes);
@@ -604,12 +532,5 @@ bool CSoundStream::WriteBuffer(float const* pSrcBuffer, unsigned int Bytes)
 	hr = m_pAudioRenderClient->ReleaseBuffer(nFrames, 0);
 	if (FAILED(hr)) return false;
 
-	if (m_state == StreamState::Stopped && BufferFramesWritable() == 0) {
-		if (!Play()) {
-			return false;
-		}
-		// m_state = StreamState::Started (in Play())
-	}
-
-	return true;
+	return StartIfFilled();
 }
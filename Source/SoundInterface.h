@@ -21,46 +21,22 @@
 #ifndef SOUNDINTERFACE_H
 #define SOUNDINTERFACE_H
 
-#include <cstdint>
 #include <memory>
 #include <wrl/client.h>
+#include "SoundStream.h"		// // //
 #include "str_conv/str_conv.hpp"
 #include "utils/handle_ptr.h"
 
 using Microsoft::WRL::ComPtr;
 
-// Return values from CSoundStream::WaitForReady()
-enum class WaitResult {
-	InternalError = 0,
-
-	/// Stop playback, etc.
-	Interrupted = 1,
-
-	/// Audio stream stuck, can't play audio
-	Timeout,
-
-	/// Ready to write data
-	Ready,
-
-	/// TODO how to identify underruns?
-	OutOfSync,
-};
-
 struct IAudioClient;
 struct IAudioRenderClient;
 
-enum class StreamState {
-	Stopped,
-	Started,
-};
-
-// Audio output stream to a device
-class CSoundStream
+// Audio output stream to a WASAPI device
+class CWasapiSoundStream : public CSoundStream
 {
-	friend class CSoundInterface;
-
 public:
-	CSoundStream(
+	CWasapiSoundStream(
 		ComPtr<IAudioClient> pAudioClient,
 		ComPtr<IAudioRenderClient> pAudioRenderClient,
 		HANDLE hInterrupt,
@@ -70,39 +46,18 @@ public:
 		unsigned int bytesPerSample,
 		unsigned int inputChannels,
 		unsigned int outputChannels);
-	~CSoundStream();
-
-	// State changes
-	bool Play();
-	bool Stop();
-	bool ClearBuffer();
-
-	// Buffer calculations
+	~CWasapiSoundStream() override;
 
-	uint32_t PubBytesToFrames(uint32_t Bytes) const;
-	uint32_t FramesToPubBytes(uint32_t Frames) const;
+	bool Play() override;
+	bool Stop() override;
+	bool ClearBuffer() override;
 
-	uint32_t TotalBufferSizeFrames() const;
+	uint32_t BufferFramesQueued() const override;
 
-	/// Get public/input buffer size. If upmixing mono to stereo, this is mono.
-	uint32_t TotalBufferSizeBytes() const;
+	bool WriteBuffer(float const * pBuffer, unsigned int Bytes) override;
 
-	uint32_t GetSampleRate() const {
-		return m_iSampleRate;
-	};
-
-	// Steady-state
-
-	/// Automatically starts the stream when enough audio is buffered.
-	///
-	/// If SkipIfWritable is true (after a partial write), return immediately if there is
-	/// already room to write audio.
-	WaitResult WaitForReady(DWORD dwTimeout, bool SkipIfWritable);
-
-	uint32_t BufferFramesWritable() const;
-	uint32_t BufferBytesWritable() const;
-
-	bool WriteBuffer(float const * pBuffer, unsigned int Bytes);
+protected:
+	WaitResult WaitForDevice(DWORD dwTimeout) override;
 
 private:
 	// m_bufferEvent should outlive IAudioClient probably, so list it first.
@@ -110,23 +65,11 @@ private:
 
 	ComPtr<IAudioClient> m_pAudioClient;
 	ComPtr<IAudioRenderClient> m_pAudioRenderClient;
-	StreamState m_state;
-
-	/// Owned by CSoundGen, borrowed by CSoundStream.
-	HANDLE m_hInterrupt;
 
 	/// Returned from AvSetMmThreadCharacteristicsW(), passed into
 	/// AvRevertMmThreadCharacteristics()
 	HANDLE  m_hTask;
 
-	// Configuration
-	unsigned int m_iSampleRate;
-	unsigned int m_bufferFrameCount;
-	unsigned int m_bytesPerSample;
-
-	// Public, picked by user, 1 for mono sound.
-	unsigned int m_inputChannels;
-
 	// Private, generally 2 or greater since WASAPI shared mode doesn't support mono.
 	unsigned int m_outputChannels;
 };
@@ -161,6 +104,10 @@ public:
 	/// = 1 and not supported by WASAPI (on Windows, possibly Wine), we accept 1ch audio
 	/// and upmix to 2ch before sending to WASAPI.
 	CSoundStream	*OpenFloatChannel(int Channels, int BufferLength);
+
+	/// Opens a CNullSoundStream, which does not need a device. If pFile is not null,
+	/// the stream writes all audio to it and closes it when destroyed.
+	CSoundStream	*OpenNullChannel(int Channels, int BufferLength, unsigned int SampleRate, FILE *pFile = nullptr);
 	void			CloseChannel(CSoundStream *pChannel);
 
 	// Utility
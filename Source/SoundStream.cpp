@@ -0,0 +1,242 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+//
+// Audio output streams, and the device-less stream
+//
+
+#include "SoundStream.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// CSoundStream
+
+CSoundStream::CSoundStream(
+	HANDLE hInterrupt,
+	unsigned int iSampleRate,
+	unsigned int bufferFrameCount,
+	unsigned int bytesPerSample,
+	unsigned int inputChannels)
+:
+	m_state(StreamState::Stopped),
+	m_hInterrupt(hInterrupt),
+	m_iSampleRate(iSampleRate),
+	m_bufferFrameCount(bufferFrameCount),
+	m_targetFrameCount(bufferFrameCount),
+	m_bytesPerSample(bytesPerSample),
+	m_inputChannels(inputChannels)
+{
+	assert(m_inputChannels == 1);
+}
+
+// Buffering
+
+uint32_t CSoundStream::PubBytesToFrames(uint32_t Bytes) const
+{
+	return Bytes / m_bytesPerSample / m_inputChannels;
+}
+
+uint32_t CSoundStream::FramesToPubBytes(uint32_t Frames) const
+{
+	return Frames * m_bytesPerSample * m_inputChannels;
+}
+
+uint32_t CSoundStream::TotalBufferSizeFrames() const {
+	return m_bufferFrameCount;
+}
+
+uint32_t CSoundStream::TotalBufferSizeBytes() const {
+	return FramesToPubBytes(m_bufferFrameCount);
+}
+
+void CSoundStream::SetTargetFrames(uint32_t Frames) {
+	m_targetFrameCount = std::clamp(Frames, 1u, m_bufferFrameCount);
+}
+
+uint32_t CSoundStream::GetTargetFrames() const {
+	return m_targetFrameCount;
+}
+
+// Steady-state
+
+WaitResult CSoundStream::WaitForReady(DWORD dwTimeout, bool SkipIfWritable)
+{
+	// Check for cancellation upfront.
+	if (WaitForSingleObject(m_hInterrupt, 0) == WAIT_OBJECT_0) {
+		return WaitResult::Interrupted;
+	}
+
+	// Check for special cases.
+	if (m_state == StreamState::Stopped) {
+		// The first few times CSoundGen waits to write audio, don't start stream playback.
+		// Instead return and let CSoundGen write audio. (At this point,
+		// CSoundStream::BufferFramesWritable() returns the full target size.)
+		//
+		// When WriteBuffer() is called, if m_state == StreamState::Stopped and the buffer is
+		// filled to the target, it calls Play() which sets m_state = StreamState::Started.
+		if (BufferFramesWritable()) {
+			return WaitResult::Ready;
+		}
+		// The target was lowered below the queued audio before playback started.
+		if (!Play()) {
+			return WaitResult::InternalError;
+		}
+	}
+	// TODO we can get marginally less latency by having CSoundGen call
+	// CSoundStream::WaitForReady before generating audio, rather than before
+	// converting/buffering it.
+
+	// Check if we can write audio without waiting at all (which is the case if the
+	// previous WriteBuffer() didn't fill the whole buffer).
+	//
+	// SkipIfWritable=false (after a full write) causes WaitForReady() to block if the
+	// device hasn't woken us up, but BufferFramesWritable() > 0. I've never seen this
+	// happen after a full write, on either Windows or Wine. So not checking
+	// BufferFramesWritable() if SkipIfWritable=false isn't needed to avoid an endless
+	// loop of writing 1 sample at a time, but saves an IAudioClient::GetCurrentPadding()
+	// call.
+	if (SkipIfWritable && BufferFramesWritable()) {
+		return WaitResult::Ready;
+	}
+
+	auto result = WaitForDevice(dwTimeout);
+
+	// Neither WASAPI nor the null stream report underruns directly, but a started
+	// stream with nothing queued has run dry.
+	// (https://stackoverflow.com/q/32112562, https://github.com/mackron/miniaudio/issues/81)
+	if (result == WaitResult::Ready && m_state == StreamState::Started && BufferFramesQueued() == 0) {
+		return WaitResult::OutOfSync;
+	}
+	return result;
+}
+
+unsigned int CSoundStream::BufferFramesWritable() const {
+	uint32_t numFramesQueued = BufferFramesQueued();
+	if (numFramesQueued >= m_targetFrameCount)
+		return 0;
+
+	// TRACE("%d frames available of %d\n", m_targetFrameCount - numFramesQueued, m_targetFrameCount);
+	return m_targetFrameCount - numFramesQueued;
+}
+
+uint32_t CSoundStream::BufferBytesWritable() const {
+	return FramesToPubBytes(BufferFramesWritable());
+}
+
+bool CSoundStream::StartIfFilled()
+{
+	if (m_state == StreamState::Stopped && BufferFramesWritable() == 0) {
+		return Play();
+		// m_state = StreamState::Started (in Play())
+	}
+	return true;
+}
+
+// CNullSoundStream
+
+CNullSoundStream::CNullSoundStream(
+	HANDLE hInterrupt,
+	unsigned int iSampleRate,
+	unsigned int bufferFrameCount,
+	unsigned int inputChannels,
+	FILE *pFile)
+:
+	CSoundStream(hInterrupt, iSampleRate, bufferFrameCount, sizeof(float), inputChannels),
+	m_pFile(pFile),
+	m_fConsumeRemainder(0.),
+	m_iQueuedFrames(0)
+{
+}
+
+CNullSoundStream::~CNullSoundStream()
+{
+	if (m_pFile)
+		fclose(m_pFile);
+}
+
+bool CNullSoundStream::Play()
+{
+	m_state = StreamState::Started;
+	m_LastConsume = std::chrono::steady_clock::now();
+	m_fConsumeRemainder = 0.;
+	return true;
+}
+
+bool CNullSoundStream::Stop()
+{
+	Consume();
+	m_state = StreamState::Stopped;
+	return true;
+}
+
+bool CNullSoundStream::ClearBuffer()
+{
+	m_state = StreamState::Stopped;
+	m_iQueuedFrames = 0;
+	return true;
+}
+
+void CNullSoundStream::Consume() const
+{
+	if (m_state != StreamState::Started)
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+	double frames = std::chrono::duration<double>(now - m_LastConsume).count() * m_iSampleRate + m_fConsumeRemainder;
+	m_LastConsume = now;
+
+	double whole = std::floor(frames);
+	m_fConsumeRemainder = frames - whole;
+
+	// Like a real device, play silence once the queue runs dry.
+	m_iQueuedFrames -= static_cast<uint32_t>(std::min(whole, static_cast<double>(m_iQueuedFrames)));
+}
+
+uint32_t CNullSoundStream::BufferFramesQueued() const
+{
+	Consume();
+	return m_iQueuedFrames;
+}
+
+WaitResult CNullSoundStream::WaitForDevice(DWORD dwTimeout)
+{
+	switch (WaitForSingleObject(m_hInterrupt, std::min<DWORD>(PERIOD_MS, dwTimeout))) {
+	case WAIT_OBJECT_0:
+		return WaitResult::Interrupted;
+	case WAIT_TIMEOUT:
+		return PERIOD_MS <= dwTimeout ? WaitResult::Ready : WaitResult::Timeout;
+	default:
+		return WaitResult::InternalError;
+	}
+}
+
+bool CNullSoundStream::WriteBuffer(float const* pSrcBuffer, unsigned int Bytes)
+{
+	const unsigned int nFrames = PubBytesToFrames(Bytes);
+
+	if (m_pFile && fwrite(pSrcBuffer, 1, Bytes, m_pFile) != Bytes)
+		return false;
+
+	Consume();
+	m_iQueuedFrames = std::min(m_iQueuedFrames + nFrames, m_bufferFrameCount);
+
+	return StartIfFilled();
+}
@@ -0,0 +1,167 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <windows.h>
+
+// Return values from CSoundStream::WaitForReady()
+enum class WaitResult {
+	InternalError = 0,
+
+	/// Stop playback, etc.
+	Interrupted = 1,
+
+	/// Audio stream stuck, can't play audio
+	Timeout,
+
+	/// Ready to write data
+	Ready,
+
+	/// The stream ran out of audio while waiting (an underrun)
+	OutOfSync,
+};
+
+enum class StreamState {
+	Stopped,
+	Started,
+};
+
+// Audio output stream
+class CSoundStream
+{
+public:
+	CSoundStream(
+		HANDLE hInterrupt,
+		unsigned int iSampleRate,
+		unsigned int bufferFrameCount,
+		unsigned int bytesPerSample,
+		unsigned int inputChannels);
+	virtual ~CSoundStream() = default;
+
+	// State changes
+	virtual bool Play() = 0;
+	virtual bool Stop() = 0;
+	virtual bool ClearBuffer() = 0;
+
+	// Buffer calculations
+
+	uint32_t PubBytesToFrames(uint32_t Bytes) const;
+	uint32_t FramesToPubBytes(uint32_t Frames) const;
+
+	uint32_t TotalBufferSizeFrames() const;
+
+	/// Get public/input buffer size. If upmixing mono to stereo, this is mono.
+	uint32_t TotalBufferSizeBytes() const;
+
+	uint32_t GetSampleRate() const {
+		return m_iSampleRate;
+	};
+
+	/// Limit how much audio is kept queued, between 1 frame and the buffer size.
+	/// BufferFramesWritable() and the automatic start of playback are relative to
+	/// this target. Defaults to the whole buffer.
+	void SetTargetFrames(uint32_t Frames);
+	uint32_t GetTargetFrames() const;
+
+	// Steady-state
+
+	/// Automatically starts the stream when enough audio is buffered.
+	///
+	/// If SkipIfWritable is true (after a partial write), return immediately if there is
+	/// already room to write audio.
+	///
+	/// Returns WaitResult::OutOfSync if the stream ran out of audio while waiting.
+	WaitResult WaitForReady(DWORD dwTimeout, bool SkipIfWritable);
+
+	/// Number of frames written but not yet played.
+	virtual uint32_t BufferFramesQueued() const = 0;
+
+	uint32_t BufferFramesWritable() const;
+	uint32_t BufferBytesWritable() const;
+
+	virtual bool WriteBuffer(float const * pBuffer, unsigned int Bytes) = 0;
+
+protected:
+	/// Blocks until the device requests more audio, or m_hInterrupt is set.
+	virtual WaitResult WaitForDevice(DWORD dwTimeout) = 0;
+
+	/// Starts playback once the stream has been filled up to the target.
+	bool StartIfFilled();
+
+protected:
+	StreamState m_state;
+
+	/// Owned by CSoundGen, borrowed by CSoundStream.
+	HANDLE m_hInterrupt;
+
+	// Configuration
+	unsigned int m_iSampleRate;
+	unsigned int m_bufferFrameCount;
+	unsigned int m_targetFrameCount;
+	unsigned int m_bytesPerSample;
+
+	// Public, picked by user, 1 for mono sound.
+	unsigned int m_inputChannels;
+};
+
+// Audio output stream without a device. Audio is consumed in real time from a clock,
+// and optionally appended to a raw 32-bit float file, so that the audio thread can be
+// run and measured on machines without sound hardware.
+class CNullSoundStream : public CSoundStream
+{
+public:
+	CNullSoundStream(
+		HANDLE hInterrupt,
+		unsigned int iSampleRate,
+		unsigned int bufferFrameCount,
+		unsigned int inputChannels,
+		FILE *pFile);
+	~CNullSoundStream() override;
+
+	bool Play() override;
+	bool Stop() override;
+	bool ClearBuffer() override;
+
+	uint32_t BufferFramesQueued() const override;
+
+	bool WriteBuffer(float const * pBuffer, unsigned int Bytes) override;
+
+public:
+	/// Interval between simulated device wake-ups.
+	static constexpr unsigned int PERIOD_MS = 10;
+
+protected:
+	WaitResult WaitForDevice(DWORD dwTimeout) override;
+
+private:
+	/// Removes the audio played since the last call from the queue.
+	void Consume() const;
+
+private:
+	FILE *m_pFile;
+
+	mutable std::chrono::steady_clock::time_point m_LastConsume;
+	mutable double m_fConsumeRemainder;
+	mutable uint32_t m_iQueuedFrames;
+};
@@ -36,6 +36,13 @@
 #include "InstrumentN163.h"
 #include "InstrumentVRC7.h"
 #include "InstrumentFactory.h"
+#include "utils/parallel_for.h"
+#include <cctype>
+#include <climits>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #define DEBUG_OUT(...) { CString s__; s__.Format(__VA_ARGS__); OutputDebugString(s__); }
 
@@ -175,10 +182,284 @@ static const TCHAR* CT[CT_COUNT] =
 
 // =============================================================================
 
+namespace {
+
+bool EqualsNoCase(std::string_view a, std::string_view b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i)
+		if (::toupper(static_cast<unsigned char>(a[i])) != ::toupper(static_cast<unsigned char>(b[i])))
+			return false;
+	return true;
+}
+
+// value of each hexadecimal digit, -1 for other characters
+struct HexTable
+{
+	int8_t Value[256];
+	constexpr HexTable() : Value()
+	{
+		for (int i = 0; i < 256; ++i)
+			Value[i] = -1;
+		for (int i = 0; i < 10; ++i)
+			Value['0' + i] = i;
+		for (int i = 0; i < 6; ++i)
+			Value['A' + i] = Value['a' + i] = 10 + i;
+	}
+	constexpr int operator[](char c) const
+	{
+		return Value[static_cast<unsigned char>(c)];
+	}
+};
+
+constexpr HexTable HEX_DIGIT { };
+
+// semitone of each note letter, -1 for other characters
+struct NoteTable
+{
+	int8_t Value[256];
+	constexpr NoteTable() : Value()
+	{
+		for (int i = 0; i < 256; ++i)
+			Value[i] = -1;
+		const char LETTERS[] = "CDEFGAB";
+		const int8_t SEMITONES[] = {0, 2, 4, 5, 7, 9, 11};
+		for (int i = 0; i < 7; ++i)
+			Value[static_cast<unsigned char>(LETTERS[i])] = Value[static_cast<unsigned char>(LETTERS[i] - 'A' + 'a')] = SEMITONES[i];
+	}
+	constexpr int operator[](char c) const
+	{
+		return Value[static_cast<unsigned char>(c)];
+	}
+};
+
+constexpr NoteTable NOTE_LETTER { };
+
+// same as sscanf("%d") / sscanf("%x"): optional sign (and 0x prefix), then digits up to the first invalid character
+bool ParseInt(std::string_view sv, int Base, int &Value)
+{
+	size_t pos = 0;
+	bool Negative = false;
+	if (pos < sv.size() && (sv[pos] == '-' || sv[pos] == '+'))
+		Negative = sv[pos++] == '-';
+	if (Base == 16 && sv.size() - pos >= 3 && sv[pos] == '0' && (sv[pos + 1] == 'x' || sv[pos + 1] == 'X') && HEX_DIGIT[sv[pos + 2]] >= 0)
+		pos += 2;
+
+	long long Result = 0;
+	size_t Start = pos;
+	for (; pos < sv.size(); ++pos) {
+		int d = HEX_DIGIT[sv[pos]];
+		if (d < 0 || d >= Base)
+			break;
+		if (Result <= INT_MAX)
+			Result = Result * Base + d;
+	}
+	if (pos == Start)
+		return false;
+
+	if (Result > INT_MAX)
+		Result = INT_MAX;
+	Value = static_cast<int>(Negative ? -Result : Result);
+	return true;
+}
+
+CString ToCString(std::string_view sv)
+{
+	return CString(sv.data(), static_cast<int>(sv.size()));
+}
+
+// Formats exported text into a reusable buffer, which is written to the file in large
+// chunks instead of once per field.
+class TextBuffer
+{
+public:
+	static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+	void Append(std::string_view sv)
+	{
+		buf.append(sv.data(), sv.size());
+	}
+
+	void Append(char c)
+	{
+		buf.push_back(c);
+	}
+
+	// same as %0*X
+	void AppendHex(unsigned int Value, int Digits)
+	{
+		static constexpr char HEX[] = "0123456789ABCDEF";
+		char tmp[8];
+		int n = 0;
+		do {
+			tmp[n++] = HEX[Value & 0x0F];
+			Value >>= 4;
+		} while (Value || n < Digits);
+		while (n)
+			buf.push_back(tmp[--n]);
+	}
+
+	// same as %*d
+	void AppendInt(int Value, int Width = 0)
+	{
+		char tmp[12];
+		int n = 0;
+		unsigned int u = Value < 0 ? 0u - static_cast<unsigned int>(Value) : static_cast<unsigned int>(Value);
+		do {
+			tmp[n++] = static_cast<char>('0' + u % 10);
+			u /= 10;
+		} while (u);
+		if (Value < 0)
+			tmp[n++] = '-';
+		for (int i = n; i < Width; ++i)
+			buf.push_back(' ');
+		while (n)
+			buf.push_back(tmp[--n]);
+	}
+
+	void AppendCell(const stChanNote& stCell, unsigned int nEffects, bool bNoise)
+	{
+		static const char* TEXT_NOTE[ECHO+1] = {		// // //
+			"...",
+			"C-?", "C#?", "D-?", "D#?", "E-?", "F-?",
+			"F#?", "G-?", "G#?", "A-?", "A#?", "B-?",
+			"===", "---", "^-?" };
+
+		if (stCell.Note >= NOTE_C && stCell.Note <= NOTE_B || stCell.Note == ECHO)		// // //
+		{
+			if (bNoise)
+			{
+				AppendHex((stCell.Note - 1 + stCell.Octave * NOTE_RANGE) & 0x0F, 1);
+				Append("-#");
+			}
+			else
+			{
+				Append(std::string_view(TEXT_NOTE[stCell.Note], 2));
+				AppendInt(stCell.Octave);
+			}
+		}
+		else
+			Append((stCell.Note <= ECHO) ? TEXT_NOTE[stCell.Note] : "...");
+
+		if (stCell.Instrument == MAX_INSTRUMENTS)
+			Append(" ..");
+		else if (stCell.Instrument == HOLD_INSTRUMENT)		// // // 050B
+			Append(" &&");
+		else {
+			Append(' ');
+			AppendHex(stCell.Instrument, 2);
+		}
+
+		if (stCell.Vol == MAX_VOLUME)
+			Append(" .");
+		else {
+			Append(' ');
+			AppendHex(stCell.Vol, 1);
+		}
+
+		for (unsigned int e=0; e < nEffects; ++e)
+		{
+			if (stCell.EffNumber[e] == 0)
+				Append(" ...");
+			else
+			{
+				Append(' ');
+				Append(EFF_CHAR[stCell.EffNumber[e]]);
+				AppendHex(stCell.EffParam[e], 2);
+			}
+		}
+	}
+
+	size_t Size() const
+	{
+		return buf.size();
+	}
+
+	std::string &Str()
+	{
+		return buf;
+	}
+
+	// CFile::Write on a text-mode CStdioFile translates newlines the same way as WriteString
+	void Flush(CFile &f)
+	{
+		if (!buf.empty())
+			f.Write(buf.data(), static_cast<UINT>(buf.size()));
+		buf.clear();
+	}
+
+	void FlushIfFull(CFile &f)
+	{
+		if (buf.size() >= FLUSH_SIZE)
+			Flush(f);
+	}
+
+private:
+	std::string buf;
+};
+
+// Formats the PATTERNS block of one track. Only uses document accessors which never
+// allocate patterns, so different tracks may be formatted on separate threads.
+void ExportPatternsBlock(const CFamiTrackerDoc *pDoc, unsigned int t, TextBuffer &out)
+{
+	const int Channels = pDoc->GetChannelCount();
+	const unsigned int Rows = pDoc->GetPatternLength(t);
+
+	unsigned int EffColumns[MAX_CHANNELS];
+	for (int c=0; c < Channels; ++c)
+		EffColumns[c] = pDoc->GetEffColumns(t, c) + 1;
+
+	out.Append("# track PATTERNS block\n");
+
+	for (int p=0; p < MAX_PATTERN; ++p)
+	{
+		// detect and skip empty patterns
+		bool bUsed = false;
+		for (int c=0; c < Channels; ++c)
+		{
+			if (!pDoc->IsPatternEmpty(t, c, p))
+			{
+				bUsed = true;
+				break;
+			}
+		}
+		if (!bUsed) continue;
+
+		out.Append(CT[CT_PATTERN]);
+		out.Append(' ');
+		out.AppendHex(p, 2);
+		out.Append('\n');
+
+		const stChanNote *pRows[MAX_CHANNELS];		// unallocated patterns are empty
+		for (int c=0; c < Channels; ++c)
+			pRows[c] = pDoc->GetPatternRows(t, p, c);
+
+		for (unsigned int r=0; r < Rows; ++r)
+		{
+			out.Append(CT[CT_ROW]);
+			out.Append(' ');
+			out.AppendHex(r, 2);
+			for (int c=0; c < Channels; ++c)
+			{
+				out.Append(" : ");
+				out.AppendCell(pRows[c] ? pRows[c][r] : stChanNote { }, EffColumns[c], c==3);
+			}
+			out.Append('\n');
+		}
+	}
+	out.Append('\n');
+}
+
+} // namespace
+
+// Reads tokens from the whole text file in memory. Tokens are returned as views into the
+// text, except for tokens containing quotes, which are unescaped into a buffer that stays
+// valid until the next token is read.
 class Tokenizer
 {
 public:
-	Tokenizer(const CString* text_)
+	Tokenizer(std::string_view text_)
 		: text(text_), pos(0), line(1), linestart(0)
 	{}
 
@@ -194,12 +475,10 @@ public:
 
 	void ConsumeSpace()
 	{
-		if (!text) return;
-		while (pos < text->GetLength())
+		while (pos < text.size())
 		{
-			TCHAR c = text->GetAt(pos);
-			if (c != TCHAR(' ') &&
-				c != TCHAR('\t'))
+			char c = text[pos];
+			if (c != ' ' && c != '\t')
 			{
 				return;
 			}
@@ -209,52 +488,58 @@ public:
 
 	void FinishLine()
 	{
-		if (!text) return;
-		while (pos < text->GetLength() && text->GetAt(pos) != TCHAR('\n'))
-		{
-			++pos;
-		}
-		if (pos < text->GetLength()) ++pos; // skip newline
+		size_t eol = text.find('\n', pos);
+		pos = (eol == std::string_view::npos) ? text.size() : eol + 1; // skip newline
 		++line;
 		linestart = pos;
 	}
 
 	int GetColumn() const
 	{
-		return 1 + pos - linestart;
+		return static_cast<int>(1 + pos - linestart);
 	}
 
 	bool Finished() const
 	{
-		if (!text) return true;
-		return pos >= text->GetLength();
+		return pos >= text.size();
 	}
 
-	CString ReadToken()
+	std::string_view ReadTokenView()
 	{
-		if (!text) return _T("");
-
 		ConsumeSpace();
-		CString t = _T("");
+
+		size_t start = pos;
+		for (; pos < text.size(); ++pos)
+		{
+			char c = text[pos];
+			if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+				return text.substr(start, pos - start);
+			if (c == '\"')
+				break;
+		}
+		if (pos >= text.size())
+			return text.substr(start, pos - start);
+
+		// quotes suppress space ending the token
+		pos = start;
+		quoted.clear();
 
 		bool inQuote = false;
 		bool lastQuote = false; // for finding double-quotes
-		do
+		for (; pos < text.size(); ++pos)
 		{
-			if (pos >= text->GetLength()) break;
-			TCHAR c = text->GetAt(pos);
-			if ((c == TCHAR(' ') && !inQuote) ||
-				c == TCHAR('\t') ||
-				c == TCHAR('\r') ||
-				c == TCHAR('\n'))
+			char c = text[pos];
+			if ((c == ' ' && !inQuote) ||
+				c == '\t' ||
+				c == '\r' ||
+				c == '\n')
 			{
 				break;
 			}
 
-			// quotes suppress space ending the token
-			if (c == TCHAR('\"'))
+			if (c == '\"')
 			{
-				if (!inQuote && t.GetLength() == 0) // first quote begins a quoted string
+				if (!inQuote && quoted.empty()) // first quote begins a quoted string
 				{
 					inQuote = true;
 				}
@@ -262,7 +547,7 @@ public:
 				{
 					if (lastQuote) // convert "" to "
 					{
-						t += c;
+						quoted += c;
 						lastQuote = false;
 					}
 					else
@@ -274,66 +559,26 @@ public:
 			else
 			{
 				lastQuote = false;
-				t += c;
+				quoted += c;
 			}
-
-			++pos;
 		}
-		while (true);
 
-		//DEBUG_OUT("ReadToken(%d,%d): '%s'\n", line, GetColumn(), t);
-		return t;
+		return quoted;
 	}
 
-	bool ReadInt(int& i, int range_min, int range_max, CString* err)
+	CString ReadToken()
 	{
-		CString t = ReadToken();
-		int c = GetColumn();
-		if (t.GetLength() < 1)
-		{
-			if (err) err->Format(_T("Line %d column %d: expected integer, no token found."), line, c);
-			return false;
-		}
-
-		int result = ::sscanf(t, "%d", &i);
-		if(result == EOF || result == 0)
-		{
-			if (err) err->Format(_T("Line %d column %d: expected integer, '%s' found."), line, c, t);
-			return false;
-		}
-
-		if (i < range_min || i > range_max)
-		{
-			if (err) err->Format(_T("Line %d column %d: expected integer in range [%d,%d], %d found."), line, c, range_min, range_max, i);
-			return false;
-		}
+		return ToCString(ReadTokenView());
+	}
 
-		return true;
+	bool ReadInt(int& i, int range_min, int range_max, CString* err)
+	{
+		return ReadNumber(i, 10, range_min, range_max, err);
 	}
 
 	bool ReadHex(int& i, int range_min, int range_max, CString* err)
 	{
-		CString t = ReadToken();
-		int c = GetColumn();
-		if (t.GetLength() < 1)
-		{
-			if (err) err->Format(_T("Line %d column %d: expected hexadecimal, no token found."), line, c);
-			return false;
-		}
-
-		int result = ::sscanf(t, "%x", &i);
-		if(result == EOF || result == 0)
-		{
-			if (err) err->Format(_T("Line %d column %d: expected hexadecimal, '%s' found."), line, c, t);
-			return false;
-		}
-
-		if (i < range_min || i > range_max)
-		{
-			if (err) err->Format(_T("Line %d column %d: expected hexidecmal in range [%X,%X], %X found."), line, c, range_min, range_max, i);
-			return false;
-		}
-		return true;
+		return ReadNumber(i, 16, range_min, range_max, err);
 	}
 
 	// note: finishes line if found
@@ -341,17 +586,17 @@ public:
 	{
 		int c = GetColumn();
 		ConsumeSpace();
-		CString s = ReadToken();
-		if (s.GetLength() > 0)
+		std::string_view s = ReadTokenView();
+		if (s.size() > 0)
 		{
-			if (err) err->Format(_T("Line %d column %d: expected end of line, '%s' found."), line, c, s);
+			if (err) err->Format(_T("Line %d column %d: expected end of line, '%s' found."), line, c, (LPCTSTR)ToCString(s));
 			return false;
 		}
 
 		if (Finished()) return true;
 
-		TCHAR eol = text->GetAt(pos);
-		if (eol != TCHAR('\r') && eol != TCHAR('\n'))
+		char eol = text[pos];
+		if (eol != '\r' && eol != '\n')
 		{
 			if (err) err->Format(_T("Line %d column %d: expected end of line, '%c' found."), line, c, eol);
 			return false;
@@ -367,8 +612,8 @@ public:
 		ConsumeSpace();
 		if (Finished()) return true;
 
-		TCHAR eol = text->GetAt(pos);
-		if (eol == TCHAR('\r') || eol == TCHAR('\n'))
+		char eol = text[pos];
+		if (eol == '\r' || eol == '\n')
 		{
 			FinishLine();
 			return true;
@@ -377,34 +622,62 @@ public:
 		return false;
 	}
 
-	const CString* text;
-	int pos;
+private:
+	bool ReadNumber(int& i, int base, int range_min, int range_max, CString* err)
+	{
+		std::string_view t = ReadTokenView();
+		int c = GetColumn();
+		LPCTSTR name = (base == 16) ? _T("hexadecimal") : _T("integer");
+		if (t.size() < 1)
+		{
+			if (err) err->Format(_T("Line %d column %d: expected %s, no token found."), line, c, name);
+			return false;
+		}
+
+		if (!ParseInt(t, base, i))
+		{
+			if (err) err->Format(_T("Line %d column %d: expected %s, '%s' found."), line, c, name, (LPCTSTR)ToCString(t));
+			return false;
+		}
+
+		if (i < range_min || i > range_max)
+		{
+			if (err) {
+				if (base == 16)
+					err->Format(_T("Line %d column %d: expected hexidecmal in range [%X,%X], %X found."), line, c, range_min, range_max, i);
+				else
+					err->Format(_T("Line %d column %d: expected integer in range [%d,%d], %d found."), line, c, range_min, range_max, i);
+			}
+			return false;
+		}
+
+		return true;
+	}
+
+public:
+	std::string_view text;
+	size_t pos;
 	int line;
-	int linestart;
+	size_t linestart;
+
+private:
+	std::string quoted;
 };
 
 // =============================================================================
 
-bool CTextExport::ImportHex(CString& sToken, int& i, int line, int column, CString& sResult)
+bool CTextExport::ImportHex(std::string_view sToken, int& i, int line, int column, CString& sResult)
 {
 	i = 0;
-	for (int d=0; d < sToken.GetLength(); ++d)
+	for (char ch : sToken)
 	{
-		const TCHAR* HEX_TEXT[16] = {
-			_T("0"), _T("1"), _T("2"), _T("3"), _T("4"), _T("5"), _T("6"), _T("7"),
-			_T("8"), _T("9"), _T("A"), _T("B"), _T("C"), _T("D"), _T("E"), _T("F") };
-
-		i <<= 4;
-		CString t = sToken.Mid(d,1);
-		int h = 0;
-		for (h=0; h < 16; ++h)
-			if (0 == t.CompareNoCase(HEX_TEXT[h])) break;
-		if (h >= 16)
+		int h = HEX_DIGIT[ch];
+		if (h < 0)
 		{
-			sResult.Format(_T("Line %d column %d: hexadecimal number expected, '%s' found."), line, column, sToken);
+			sResult.Format(_T("Line %d column %d: hexadecimal number expected, '%s' found."), line, column, (LPCTSTR)ToCString(sToken));
 			return false;
 		}
-		i += h;
+		i = (i << 4) + h;
 	}
 	return true;
 }
@@ -437,22 +710,22 @@ bool CTextExport::ImportCellText(		// // //
 {
 	stChanNote Cell { };		// // //
 
-	CString sNote = t.ReadToken();
-	if      (sNote == _T("...")) { Cell.Note = NONE; }
-	else if (sNote == _T("---")) { Cell.Note = HALT; }
-	else if (sNote == _T("===")) { Cell.Note = RELEASE; }
+	std::string_view sNote = t.ReadTokenView();
+	if      (sNote == "...") { Cell.Note = NONE; }
+	else if (sNote == "---") { Cell.Note = HALT; }
+	else if (sNote == "===") { Cell.Note = RELEASE; }
 	else
 	{
-		if (sNote.GetLength() != 3)
+		if (sNote.size() != 3)
 		{
-			sResult.Format(_T("Line %d column %d: note column should be 3 characters wide, '%s' found."), t.line, t.GetColumn(), sNote);
+			sResult.Format(_T("Line %d column %d: note column should be 3 characters wide, '%s' found."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sNote));
 			return false;
 		}
 
 		if (channel == 3) // noise
 		{
 			int h;
-			if (!ImportHex(sNote.Left(1), h, t.line, t.GetColumn(), sResult))
+			if (!ImportHex(sNote.substr(0, 1), h, t.line, t.GetColumn(), sResult))
 				return false;
 			Cell.Note = (h % NOTE_RANGE) + 1;
 			Cell.Octave = h / NOTE_RANGE;
@@ -460,8 +733,8 @@ bool CTextExport::ImportCellText(		// // //
 			// importer is very tolerant about the second and third characters
 			// in a noise note, they can be anything
 		}
-		else if (sNote.GetAt(0) == TCHAR('^') && sNote.GetAt(1) == TCHAR('-')) {		// // //
-			int o = sNote.GetAt(2) - TCHAR('0');
+		else if (sNote[0] == '^' && sNote[1] == '-') {		// // //
+			int o = sNote[2] - '0';
 			if (o < 0 || o > ECHO_BUFFER_LENGTH) {
 				sResult.Format(_T("Line %d column %d: out-of-bound echo buffer accessed."), t.line, t.GetColumn());
 				return false;
@@ -470,51 +743,43 @@ bool CTextExport::ImportCellText(		// // //
 			Cell.Octave = o;
 		}
 		else {
-			int n = 0;
-			switch (sNote.GetAt(0))
+			int n = NOTE_LETTER[sNote[0]];
+			if (n < 0)
 			{
-				case TCHAR('c'): case TCHAR('C'): n = 0; break;
-				case TCHAR('d'): case TCHAR('D'): n = 2; break;
-				case TCHAR('e'): case TCHAR('E'): n = 4; break;
-				case TCHAR('f'): case TCHAR('F'): n = 5; break;
-				case TCHAR('g'): case TCHAR('G'): n = 7; break;
-				case TCHAR('a'): case TCHAR('A'): n = 9; break;
-				case TCHAR('b'): case TCHAR('B'): n = 11; break;
-				default:
-					sResult.Format(_T("Line %d column %d: unrecognized note '%s'."), t.line, t.GetColumn(), sNote);
-					return false;
+				sResult.Format(_T("Line %d column %d: unrecognized note '%s'."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sNote));
+				return false;
 			}
-			switch (sNote.GetAt(1))
+			switch (sNote[1])
 			{
-				case TCHAR('-'): case TCHAR('.'): break;
-				case TCHAR('#'): case TCHAR('+'): n += 1; break;
-				case TCHAR('b'): case TCHAR('f'): n -= 1; break;
+				case '-': case '.': break;
+				case '#': case '+': n += 1; break;
+				case 'b': case 'f': n -= 1; break;
 				default:
-					sResult.Format(_T("Line %d column %d: unrecognized note '%s'."), t.line, t.GetColumn(), sNote);
+					sResult.Format(_T("Line %d column %d: unrecognized note '%s'."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sNote));
 					return false;
 			}
 			while (n < 0) n += NOTE_RANGE;
 			while (n >= NOTE_RANGE) n -= NOTE_RANGE;
 			Cell.Note = n + 1;
 
-			int o = sNote.GetAt(2) - TCHAR('0');
+			int o = sNote[2] - '0';
 			if (o < 0 || o >= OCTAVE_RANGE)
 			{
-				sResult.Format(_T("Line %d column %d: unrecognized octave '%s'."), t.line, t.GetColumn(), sNote);
+				sResult.Format(_T("Line %d column %d: unrecognized octave '%s'."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sNote));
 				return false;
 			}
 			Cell.Octave = o;
 		}
 	}
 
-	CString sInst = t.ReadToken();
-	if (sInst == _T("..")) { Cell.Instrument = MAX_INSTRUMENTS; }
-	else if (sInst == _T("&&")) { Cell.Instrument = HOLD_INSTRUMENT; }		// // // 050B
+	std::string_view sInst = t.ReadTokenView();
+	if (sInst == "..") { Cell.Instrument = MAX_INSTRUMENTS; }
+	else if (sInst == "&&") { Cell.Instrument = HOLD_INSTRUMENT; }		// // // 050B
 	else
 	{
-		if (sInst.GetLength() != 2)
+		if (sInst.size() != 2)
 		{
-			sResult.Format(_T("Line %d column %d: instrument column should be 2 characters wide, '%s' found."), t.line, t.GetColumn(), sInst);
+			sResult.Format(_T("Line %d column %d: instrument column should be 2 characters wide, '%s' found."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sInst));
 			return false;
 		}
 		int h;
@@ -522,52 +787,48 @@ bool CTextExport::ImportCellText(		// // //
 			return false;
 		if (h >= MAX_INSTRUMENTS)
 		{
-			sResult.Format(_T("Line %d column %d: instrument '%s' is out of bounds."), t.line, t.GetColumn(), sInst);
+			sResult.Format(_T("Line %d column %d: instrument '%s' is out of bounds."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sInst));
 			return false;
 		}
 		Cell.Instrument = h;
 	}
 
-	CString sVol  = t.ReadToken();
-	const TCHAR* VOL_TEXT[17] = {
-		_T("0"), _T("1"), _T("2"), _T("3"), _T("4"), _T("5"), _T("6"), _T("7"),
-		_T("8"), _T("9"), _T("A"), _T("B"), _T("C"), _T("D"), _T("E"), _T("F"),
-		_T(".") };
-	int v = 0;
-	for (; v <= 17; ++v)
-		if (0 == sVol.CompareNoCase(VOL_TEXT[v])) break;
-	if (v > 17)
+	std::string_view sVol = t.ReadTokenView();
+	int v = -1;
+	if (sVol.size() == 1)
+		v = (sVol[0] == '.') ? MAX_VOLUME : HEX_DIGIT[sVol[0]];
+	if (v < 0)
 	{
-		sResult.Format(_T("Line %d column %d: unrecognized volume token '%s'."), t.line, t.GetColumn(), sVol);
+		sResult.Format(_T("Line %d column %d: unrecognized volume token '%s'."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sVol));
 		return false;
 	}
 	Cell.Vol = v;
 
 	for (unsigned int e=0; e <= pDoc->GetEffColumns(track, channel); ++e)
 	{
-		CString sEff = t.ReadToken();
-		if (sEff != _T("..."))
+		std::string_view sEff = t.ReadTokenView();
+		if (sEff != "...")
 		{
-			if (sEff.GetLength() != 3)
+			if (sEff.size() != 3)
 			{
-				sResult.Format(_T("Line %d column %d: effect column should be 3 characters wide, '%s' found."), t.line, t.GetColumn(), sEff);
+				sResult.Format(_T("Line %d column %d: effect column should be 3 characters wide, '%s' found."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sEff));
 				return false;
 			}
 
-			TCHAR pC = sEff.GetAt(0);
-			if (pC >= TCHAR('a') && pC <= TCHAR('z')) pC += TCHAR('A') - TCHAR('a');
+			char pC = sEff[0];
+			if (pC >= 'a' && pC <= 'z') pC += 'A' - 'a';
 
 			bool Valid;		// // //
 			effect_t Eff = GetEffectFromChar(pC, pDoc->GetChipType(channel), &Valid);
 			if (!Valid)
 			{
-				sResult.Format(_T("Line %d column %d: unrecognized effect '%s'."), t.line, t.GetColumn(), sEff);
+				sResult.Format(_T("Line %d column %d: unrecognized effect '%s'."), t.line, t.GetColumn(), (LPCTSTR)ToCString(sEff));
 				return false;
 			}
 			Cell.EffNumber[e] = Eff;
 
 			int h;
-			if (!ImportHex(sEff.Right(2), h, t.line, t.GetColumn(), sResult))
+			if (!ImportHex(sEff.substr(1), h, t.line, t.GetColumn(), sResult))
 				return false;
 			Cell.EffParam[e] = h;
 		}
@@ -580,50 +841,9 @@ bool CTextExport::ImportCellText(		// // //
 const CString& CTextExport::ExportCellText(const stChanNote& stCell, unsigned int nEffects, bool bNoise)		// // //
 {
 	static CString s;
-	CString tmp;
-	
-	static const char* TEXT_NOTE[ECHO+1] = {		// // //
-		_T("..."),
-		_T("C-?"), _T("C#?"), _T("D-?"), _T("D#?"), _T("E-?"), _T("F-?"),
-		_T("F#?"), _T("G-?"), _T("G#?"), _T("A-?"), _T("A#?"), _T("B-?"),
-		_T("==="), _T("---"), _T("^-?") };
-		
-	s = (stCell.Note <= ECHO) ? TEXT_NOTE[stCell.Note] : "...";		// // //
-	if (stCell.Note >= NOTE_C && stCell.Note <= NOTE_B || stCell.Note == ECHO)		// // //
-	{
-		if (bNoise)
-		{
-			char nNoiseFreq = (stCell.Note - 1 + stCell.Octave * NOTE_RANGE) & 0x0F;
-			s.Format(_T("%01X-#"), nNoiseFreq);
-		}
-		else
-		{
-			s = s.Left(2);
-			tmp.Format(_T("%01d"), stCell.Octave);
-			s += tmp;
-		}
-	}
-
-	tmp.Format(_T(" %02X"), stCell.Instrument);
-	s += (stCell.Instrument == MAX_INSTRUMENTS) ? _T(" ..") :
-		(stCell.Instrument == HOLD_INSTRUMENT) ? _T(" &&") : tmp;		// // // 050B
-
-	tmp.Format(_T(" %01X"), stCell.Vol);
-	s += (stCell.Vol == 0x10) ? _T(" .") : tmp;
-
-	for (unsigned int e=0; e < nEffects; ++e)
-	{
-		if (stCell.EffNumber[e] == 0)
-		{
-			s += _T(" ...");
-		}
-		else
-		{
-			tmp.Format(_T(" %c%02X"), EFF_CHAR[stCell.EffNumber[e]], stCell.EffParam[e]);
-			s += tmp;
-		}
-	}
-
+	TextBuffer buf;
+	buf.AppendCell(stCell, nEffects, bNoise);
+	s = ToCString(buf.Str());
 	return s;
 }
 
@@ -643,10 +863,10 @@ CTextExport::~CTextExport()
 
 #define CHECK_SYMBOL(x) \
 	{ \
-		CString symbol_ = t.ReadToken(); \
-		if (symbol_ != _T(x)) \
+		std::string_view symbol_ = t.ReadTokenView(); \
+		if (symbol_ != x) \
 		{ \
-			sResult.Format(_T("Line %d column %d: expected '%s', '%s' found."), t.line, t.GetColumn(), _T(x), symbol_); \
+			sResult.Format(_T("Line %d column %d: expected '%s', '%s' found."), t.line, t.GetColumn(), _T(x), (LPCTSTR)ToCString(symbol_)); \
 			return sResult; \
 		} \
 	}
@@ -664,11 +884,11 @@ const CString& CTextExport::ImportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 	static CString sResult;
 	sResult = _T("");
 
-	// read file into "text" CString
-	CString text = _T("");
-	CStdioFile f;
+	// read the whole file at once
+	std::string text;
+	CFile f;
 	CFileException oFileException;
-	if (!f.Open(FileName, CFile::modeRead | CFile::typeText, &oFileException))
+	if (!f.Open(FileName, CFile::modeRead | CFile::shareDenyWrite, &oFileException))
 	{
 		TCHAR szError[256];
 		oFileException.GetErrorMessage(szError, 256);
@@ -676,9 +896,8 @@ const CString& CTextExport::ImportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 		sResult.Format(_T("Unable to open file:\n%s"), szError);
 		return sResult;
 	}
-	CString line;
-	while (f.ReadString(line))
-		text += line + TCHAR('\n');
+	text.resize(static_cast<size_t>(f.GetLength()));
+	text.resize(f.Read(text.data(), static_cast<UINT>(text.size())));
 	f.Close();
 
 	// begin a new document
@@ -689,7 +908,7 @@ const CString& CTextExport::ImportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 	}
 
 	// parse the file
-	Tokenizer t(&text);
+	Tokenizer t(text);
 	int i; // generic integer for reading
 	unsigned int dpcm_index = 0;
 	unsigned int dpcm_pos = 0;
@@ -706,11 +925,11 @@ const CString& CTextExport::ImportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 	{
 		// read first token on line
 		if (t.IsEOL()) continue; // blank line
-		CString command = t.ReadToken();
+		std::string_view command = t.ReadTokenView();
 
 		int c = 0;
 		for (; c < CT_COUNT; ++c)
-			if (0 == command.CompareNoCase(CT[c])) break;
+			if (EqualsNoCase(command, CT[c])) break;
 
 		//DEBUG_OUT("Command read: %s\n", command);
 		switch (c)
@@ -1229,7 +1448,7 @@ const CString& CTextExport::ImportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 			break;
 			case CT_COUNT:
 			default:
-				sResult.Format(_T("Unrecognized command at line %d: '%s'."), t.line, command);
+				sResult.Format(_T("Unrecognized command at line %d: '%s'."), t.line, (LPCTSTR)ToCString(command));
 				return sResult;
 		}
 	}
@@ -1270,9 +1489,9 @@ const CString& CTextExport::ExportRows(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 		return sResult;
 	}
 
-	f.WriteString(_T("ID,TRACK,CHANNEL,PATTERN,ROW,NOTE,OCTAVE,INST,VOLUME,FX1,FX1PARAM,FX2,FX2PARAM,FX3,FX3PARAM,FX4,FX4PARAM\n"));
+	TextBuffer buf;
+	buf.Append("ID,TRACK,CHANNEL,PATTERN,ROW,NOTE,OCTAVE,INST,VOLUME,FX1,FX1PARAM,FX2,FX2PARAM,FX3,FX3PARAM,FX4,FX4PARAM\n");
 
-	CString l, s = _T("%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n");
 	stChanNote stCell;
 	int id = 0;
 	
@@ -1286,13 +1505,22 @@ const CString& CTextExport::ExportRows(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 					for (int fx = 0; fx < MAX_EFFECT_COLUMNS; fx++)
 						if (stCell.EffNumber[fx] != EF_NONE) isEmpty = false;
 					if (isEmpty) continue;
-					l.Format(s, id++, t, c, p, r, stCell.Note, stCell.Octave, stCell.Instrument, stCell.Vol,
+					const int Fields[] = {
+						id++, static_cast<int>(t), c, p, static_cast<int>(r),
+						stCell.Note, stCell.Octave, stCell.Instrument, stCell.Vol,
 						stCell.EffNumber[0], stCell.EffParam[0],
 						stCell.EffNumber[1], stCell.EffParam[1],
 						stCell.EffNumber[2], stCell.EffParam[2],
-						stCell.EffNumber[3], stCell.EffParam[3]);
-					f.WriteString(l);
+						stCell.EffNumber[3], stCell.EffParam[3],
+					};
+					for (int i = 0; i < static_cast<int>(std::size(Fields)); ++i) {
+						if (i) buf.Append(',');
+						buf.AppendInt(Fields[i]);
+					}
+					buf.Append('\n');
+					buf.FlushIfFull(f);
 				}
+	buf.Flush(f);
 	return sResult;
 }
 
@@ -1641,7 +1869,16 @@ const CString& CTextExport::ExportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 	}
 	f.WriteString(_T("\n"));
 
-	for (unsigned int t=0; t < pDoc->GetTrackCount(); ++t)
+	// Format the pattern data of all tracks in parallel, then write it in order
+	const unsigned int TrackCount = pDoc->GetTrackCount();
+	std::vector<TextBuffer> PatternText(TrackCount);
+	parallel_for(TrackCount, [&] (size_t t) {
+		ExportPatternsBlock(pDoc, static_cast<unsigned int>(t), PatternText[t]);
+	});
+
+	TextBuffer buf;
+
+	for (unsigned int t=0; t < TrackCount; ++t)
 	{
 		const char* zpTitle = pDoc->GetTrackTitle(t).GetString();
 		if (zpTitle == NULL) zpTitle = "";
@@ -1665,55 +1902,26 @@ const CString& CTextExport::ExportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc)
 		}
 		f.WriteString(_T("\n\n"));
 
-		f.WriteString(_T("# track FRAMES block\n"));
+		buf.Append("# track FRAMES block\n");
 
 		for (unsigned int o=0; o < pDoc->GetFrameCount(t); ++o)
 		{
-			s.Format(_T("%s %02X :"), CT[CT_ORDER], o);
-			f.WriteString(s);
+			buf.Append(CT[CT_ORDER]);
+			buf.Append(' ');
+			buf.AppendHex(o, 2);
+			buf.Append(" :");
 			for (int c=0; c < pDoc->GetChannelCount(); ++c)
 			{
-				s.Format(_T(" %02X"), pDoc->GetPatternAtFrame(t, o, c));
-				f.WriteString(s);
+				buf.Append(' ');
+				buf.AppendHex(pDoc->GetPatternAtFrame(t, o, c), 2);
 			}
-			f.WriteString(_T("\n"));
+			buf.Append('\n');
 		}
-		f.WriteString(_T("\n"));
-
-		f.WriteString(_T("# track PATTERNS block\n"));
-
-		for (int p=0; p < MAX_PATTERN; ++p)
-		{
-			// detect and skip empty patterns
-			bool bUsed = false;
-			for (int c=0; c < pDoc->GetChannelCount(); ++c)
-			{
-				if (!pDoc->IsPatternEmpty(t, c, p))
-				{
-					bUsed = true;
-					break;
-				}
-			}
-			if (!bUsed) continue;
+		buf.Append('\n');
+		buf.Flush(f);
 
-			s.Format(_T("%s %02X\n"), CT[CT_PATTERN], p);
-			f.WriteString(s);
-
-			for (unsigned int r=0; r < pDoc->GetPatternLength(t); ++r)
-			{
-				s.Format(_T("%s %02X"), CT[CT_ROW], r);
-				f.WriteString(s);
-				for (int c=0; c < pDoc->GetChannelCount(); ++c)
-				{
-					f.WriteString(_T(" : "));
-					stChanNote stCell;
-					pDoc->GetDataAtPattern(t,p,c,r,&stCell);
-					f.WriteString(ExportCellText(stCell, pDoc->GetEffColumns(t, c)+1, c==3));
-				}
-				f.WriteString(_T("\n"));
-			}
-		}
-		f.WriteString(_T("\n"));
+		PatternText[t].Flush(f);
+		PatternText[t] = TextBuffer { };		// release memory early
 
 		f.WriteString(_T("# track BOOKMARKS block\n"));
 
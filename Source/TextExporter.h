@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <string_view>
+
 class CFamiTrackerDoc; // forward declaration
 class Tokenizer;
 
@@ -36,7 +38,7 @@ public:
 	const CString& ExportFile(LPCTSTR FileName, CFamiTrackerDoc *pDoc);
 	const CString& ExportRows(LPCTSTR FileName, CFamiTrackerDoc *pDoc);		// // //
 private:		// // //
-	bool ImportHex(CString& sToken, int& i, int line, int column, CString& sResult);
+	bool ImportHex(std::string_view sToken, int& i, int line, int column, CString& sResult);
 	CString ExportString(const CString& s);
 	bool ImportCellText(CFamiTrackerDoc* pDoc, Tokenizer &t, unsigned int track, unsigned int pattern, unsigned int channel, unsigned int row, CString& sResult);
 	const char* Charify(CString& s);
@@ -29,7 +29,8 @@
 
 /*
  * This class serves as the interface between the UI and the sound player for each channel
- * Thread synchronization should be done here
+ * Notes and pitch are owned by the audio thread, input from other threads goes through
+ * CSoundGen's live input queue
  *
  */
 
@@ -42,6 +43,7 @@ CTrackerChannel::CTrackerChannel(LPCTSTR pName, LPCTSTR pShort, const int iChip,
 	m_bNewNote(false),
 	m_iPitch(0),
 	m_iNotePriority(NOTE_PRIO_0),
+	m_iNoteCycle(0),		// // //
 	m_iVolumeMeter(0)
 {
 }
@@ -80,32 +82,22 @@ void CTrackerChannel::SetColumnCount(int Count)
 	m_iColumnCount = Count;
 }
 
-void CTrackerChannel::SetNote(stChanNote &Note, note_prio_t Priority)
+void CTrackerChannel::SetNote(const stChanNote &Note, note_prio_t Priority, int Cycle)		// // //
 {
-	m_csNoteLock.Lock();
-
 	if (Priority >= m_iNotePriority) {
 		m_Note = Note;
 		m_bNewNote = true;
 		m_iNotePriority = Priority;
+		m_iNoteCycle = Cycle;
 	}
-
-	m_csNoteLock.Unlock();
 }
 
 stChanNote CTrackerChannel::GetNote()
 {
-	stChanNote Note;
-	
-	m_csNoteLock.Lock();
-
-	Note = m_Note;
 	m_bNewNote = false;
 	m_iNotePriority = NOTE_PRIO_0;
 
-	m_csNoteLock.Unlock();
-
-	return Note;
+	return m_Note;
 }
 
 bool CTrackerChannel::NewNoteData() const
@@ -113,15 +105,17 @@ bool CTrackerChannel::NewNoteData() const
 	return m_bNewNote;
 }
 
-void CTrackerChannel::Reset()
+int CTrackerChannel::GetNoteCycle() const		// // //
 {
-	m_csNoteLock.Lock();
+	return m_iNoteCycle;
+}
 
+void CTrackerChannel::Reset()
+{
 	m_bNewNote = false;
 	m_iVolumeMeter = 0;
 	m_iNotePriority = NOTE_PRIO_0;
-
-	m_csNoteLock.Unlock();
+	m_iNoteCycle = 0;		// // //
 }
 
 void CTrackerChannel::SetVolumeMeter(int Value)
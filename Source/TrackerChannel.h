@@ -45,15 +45,18 @@ public:
 	const int GetColumnCount() const;
 	void SetColumnCount(int Count);
 
+	// // // Pending note, audio thread only. Other threads queue notes through CSoundGen.
+	// Cycle is the APU cycle within the next frame at which the note should be heard.
 	stChanNote GetNote();
-	void SetNote(stChanNote &Note, note_prio_t Priority);
+	void SetNote(const stChanNote &Note, note_prio_t Priority, int Cycle = 0);
 	bool NewNoteData() const;
+	int GetNoteCycle() const;		// // //
 	void Reset();
 
 	void SetVolumeMeter(int Value);
 	int GetVolumeMeter() const;
 
-	void SetPitch(int Pitch);
+	void SetPitch(int Pitch);		// // // Audio thread only
 	int GetPitch() const;
 
 	bool IsInstrumentCompatible(int Instrument, inst_type_t Type) const;		// // //
@@ -70,10 +73,8 @@ private:
 	stChanNote m_Note;
 	bool m_bNewNote;
 	note_prio_t	m_iNotePriority;
+	int m_iNoteCycle;		// // //
 
 	int m_iVolumeMeter;
 	int m_iPitch;
-
-private:
-	CCriticalSection m_csNoteLock;
 };
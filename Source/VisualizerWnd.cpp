@@ -103,6 +103,7 @@ CVisualizerWnd::CVisualizerWnd() :
 	m_ScopeWriteProgress(0),
 	m_SpectrumWriter(m_pSpectrumData.get()),
 	m_pSpectrumHistory(std::make_unique<short[]>(FFT_POINTS)),
+	m_SpectrumHistoryPos(0),
 	m_hNewSamples(NULL),
 	m_bNoAudio(false),
 	m_pWorkerThread(NULL),
@@ -287,6 +288,8 @@ void CVisualizerWnd::FlushSamples(gsl::span<const short> Samples)
 
 	// Fill m_pSpectrumHistory. (We can't write incrementally to m_SpectrumWriter.Curr()
 	// because we keep some old data from one publish-swap to the next.)
+	// The history is a ring buffer, so only the new samples are written into it,
+	// and it is unrolled into the published buffer oldest sample first.
 	{
 		auto tail = Samples;
 		if (tail.size() > (size_t)FFT_POINTS) {
@@ -295,18 +298,22 @@ void CVisualizerWnd::FlushSamples(gsl::span<const short> Samples)
 		ASSERT(tail.size() <= (size_t)FFT_POINTS);
 
 		auto history = m_pSpectrumHistory.get();
-		// Push tail to end of history.
+		for (size_t i = 0; i < tail.size(); ) {
+			size_t push = std::min(tail.size() - i, (size_t)FFT_POINTS - m_SpectrumHistoryPos);
+			std::copy(tail.begin() + i, tail.begin() + i + push, history + m_SpectrumHistoryPos);
+			m_SpectrumHistoryPos = (m_SpectrumHistoryPos + push) % FFT_POINTS;
+			i += push;
+		}
+
+		short* pSpectrumBuffer = m_SpectrumWriter.Curr();
 		std::copy(
-			history + tail.size(),
+			history + m_SpectrumHistoryPos,
 			history + FFT_POINTS,
-			history);
+			pSpectrumBuffer);
 		std::copy(
-			tail.begin(),
-			tail.end(),
-			history + FFT_POINTS - tail.size());
-
-		short* pSpectrumBuffer = m_SpectrumWriter.Curr();
-		std::copy(history, history + FFT_POINTS, pSpectrumBuffer);
+			history,
+			history + m_SpectrumHistoryPos,
+			pSpectrumBuffer + FFT_POINTS - m_SpectrumHistoryPos);
 		m_SpectrumWriter.Publish();
 	}
 
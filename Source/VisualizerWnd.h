@@ -130,6 +130,7 @@ private:
 
 	Writer m_SpectrumWriter;
 	std::unique_ptr<short[]> m_pSpectrumHistory;
+	size_t m_SpectrumHistoryPos;		// write position (oldest sample) in ring buffer
 
 	HANDLE m_hNewSamples;
 
@@ -82,8 +82,10 @@ BOOL CWavProgressDlg::OnInitDialog()
 	AfxFormatString1(FileStr, IDS_WAVE_PROGRESS_FILE_FORMAT, m_sFile);
 	SetDlgItemText(IDC_PROGRESS_FILE, FileStr);
 
-	if (!pSoundGen->RenderToFile(m_sFile.GetBuffer(), m_iSongEndType, m_iSongEndParam, m_iTrack))
+	if (!pSoundGen->RenderToFile(m_sFile.GetBuffer(), m_iSongEndType, m_iSongEndParam, m_iTrack)) {
+		AfxMessageBox(IDS_FILE_OPEN_ERROR);		// // //
 		EndDialog(0);
+	}
 
 	m_dwStartTime = GetTickCount();
 	SetTimer(0, m_iTimerPeriod, NULL);
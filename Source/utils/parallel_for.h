@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/// Calls func(i) for every i in [0, count), spread over up to hardware_concurrency() threads,
+/// including the calling thread. Indices are handed out one at a time, so uneven work is balanced.
+/// Returns after every call has finished.
+template<typename F>
+void parallel_for(std::size_t count, F&& func)
+{
+	std::atomic<std::size_t> next {0};
+	const auto worker = [&] {
+		for (std::size_t i; (i = next++) < count; )
+			func(i);
+	};
+
+	const std::size_t threads = std::min<std::size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> pool;
+	for (std::size_t i = 1; i < threads; ++i)
+		pool.emplace_back(worker);
+	worker();
+	for (auto &t : pool)
+		t.join();
+}
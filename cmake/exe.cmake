@@ -70,6 +70,7 @@ add_executable(${exe}
 
         Source/FFT/FftBuffer.h
         Source/FFT/FftComplex.hpp
+        Source/FFT/FftReal.hpp
 
         Source/gsl/gsl
         Source/gsl/gsl_algorithm
@@ -146,6 +147,7 @@ add_executable(${exe}
         Source/utils/ftmath.cpp
         Source/utils/ftmath.h
         Source/utils/handle_ptr.h
+        Source/utils/parallel_for.h
         Source/utils/input.h
         Source/utils/variadic_minmax.h
 
@@ -157,6 +159,8 @@ add_executable(${exe}
         Source/APU/APU.h
         Source/APU/Channel.h
         Source/APU/ChannelLevelState.h
+        Source/APU/ChannelScopeTap.cpp
+        Source/APU/ChannelScopeTap.h
         Source/APU/FDS.cpp
         Source/APU/FDS.h
         Source/APU/Mixer.cpp
@@ -167,8 +171,6 @@ add_executable(${exe}
         Source/APU/N163.h
         Source/APU/S5B.cpp
         Source/APU/S5B.h
-        Source/APU/SoundChip.cpp
-        Source/APU/SoundChip.h
         Source/APU/SoundChip2.cpp
         Source/APU/SoundChip2.h
         Source/APU/Square.cpp
@@ -185,6 +187,10 @@ add_executable(${exe}
         Source/Accelerator.h
         Source/Action.cpp
         Source/Action.h
+        Source/AudioLatency.cpp
+        Source/AudioLatency.h
+        Source/AudioProfiler.cpp
+        Source/AudioProfiler.h
         Source/Bookmark.cpp
         Source/Bookmark.h
         Source/BookmarkCollection.cpp
@@ -229,6 +235,8 @@ add_executable(${exe}
         Source/ColorScheme.h
         Source/CommandLineExport.cpp
         Source/CommandLineExport.h
+        Source/CommandLineRegression.cpp
+        Source/CommandLineRegression.h
         Source/CommentsDlg.cpp
         Source/CommentsDlg.h
         Source/Common.h
@@ -369,6 +377,8 @@ add_executable(${exe}
         Source/IntRange.h
         Source/JsonExporter.cpp
         Source/JsonExporter.h
+        Source/LiveInputQueue.cpp
+        Source/LiveInputQueue.h
         Source/MainFrm.cpp
         Source/MainFrm.h
         Source/MIDI.cpp
@@ -394,6 +404,8 @@ add_executable(${exe}
         Source/PatternCompiler.h
         Source/PatternComponent.cpp
         Source/PatternComponent.h
+        Source/PatternDamage.cpp
+        Source/PatternDamage.h
         Source/PatternData.cpp
         Source/PatternData.h
         Source/PatternEditor.cpp
@@ -402,10 +414,13 @@ add_executable(${exe}
         Source/PatternEditorTypes.h
         Source/PatternNote.cpp
         Source/PatternNote.h
+        Source/PatternRasterizer.cpp
+        Source/PatternRasterizer.h
         Source/PCMImport.cpp
         Source/PCMImport.h
         Source/PerformanceDlg.cpp
         Source/PerformanceDlg.h
+        Source/PlayerSettings.h
         Source/RecordSettingsDlg.cpp
         Source/RecordSettingsDlg.h
         Source/RegisterState.cpp
@@ -451,6 +466,8 @@ add_executable(${exe}
         Source/SoundGen.h
         Source/SoundInterface.cpp
         Source/SoundInterface.h
+        Source/SoundStream.cpp
+        Source/SoundStream.h
         Source/SpeedDlg.cpp
         Source/SpeedDlg.h
         Source/SplitKeyboardDlg.cpp
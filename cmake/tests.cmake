@@ -0,0 +1,30 @@
+# Unit tests and benchmarks of the parts of the player and editor which do not
+# need a window. Tests are run by CTest; benchmarks are built but not run.
+# Configure with -DDN_BUILD_TESTS=ON to build them.
+
+function(dn_add_test_executable name)
+    add_executable(${name} ${ARGN})
+    target_compile_features(${name} PRIVATE cxx_std_17)
+    target_link_libraries(${name}
+        $<IF:$<BOOL:STATIC_MSVCRT>,${static_msvcrt_libs},${dynamic_msvcrt_libs}>)
+endfunction()
+
+dn_add_test_executable(PatternRasterizerTest
+        tests/PatternRasterizerTest.cpp
+        Source/PatternRasterizer.cpp)
+add_test(NAME PatternRasterizerTest COMMAND PatternRasterizerTest)
+
+dn_add_test_executable(SoundStreamTest
+        tests/SoundStreamTest.cpp
+        Source/SoundStream.cpp)
+add_test(NAME SoundStreamTest COMMAND SoundStreamTest)
+
+dn_add_test_executable(PatternRasterizerBench
+        tests/PatternRasterizerBench.cpp
+        Source/PatternRasterizer.cpp)
+
+dn_add_test_executable(ApuClockBench
+        tests/ApuClockBench.cpp
+        Source/APU/nsfplay/xgm/devices/Sound/nes_apu.cpp
+        Source/APU/nsfplay/xgm/devices/Sound/nes_dmc.cpp
+        Source/Blip_Buffer/Blip_Buffer.cpp)
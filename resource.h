@@ -82,6 +82,7 @@
 #define IDS_OPEN_FILE_ERROR             149
 #define IDS_INFO_COPYRIGHT              150
 #define IDS_IMPORT_FAILED               151
+#define IDS_PERFORMANCE_LATENCY_FORMAT  152
 #define IDS_IMPORT_INSTRUMENT_COUNT     153
 #define IDS_IMPORT_SAMPLE_SLOTS         154
 #define IDS_DPCM_IMPORT_TITLE_FORMAT    155
@@ -148,6 +149,7 @@
 #define IDS_ABOUT_TOOLTIP_WEB3          197
 #define IDR_PATTERN_POPUP               198
 #define IDS_ABOUT_TOOLTIP_WEB4          198
+#define IDS_DPCM_IMPORT_BATCH_FAILED_FORMAT 199
 #define IDD_CONFIG_SOUND                201
 #define IDS_FILE_LOAD_ERROR             204
 #define IDS_CONFIG_WINDOW               205
@@ -708,6 +710,13 @@
 #define IDC_OPLL_PATCHBYTE9             1563
 #define IDC_OPLL_PATCHBYTE10            1564
 #define IDC_OPLL_PATCHBYTE11            1565
+#define IDC_ADAPTIVE_BUFFER             1566
+#define IDC_LATENCY                     1567
+#define IDC_PROFILE_LIST                1569
+#define IDC_PROFILE_RESET               1572
+#define IDC_PROFILE_EXPORT              1574
+#define IDC_SUBFRAME_INPUT              1582
+#define IDC_DPCM_LOOKAHEAD              1568
 #define IDC_OPLL_PATCHBYTE12            1570
 #define IDC_OPLL_PATCHBYTE13            1571
 #define IDC_OPLL_PATCHBYTE14            1573
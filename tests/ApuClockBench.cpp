@@ -0,0 +1,307 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+// Times the 2A03 catch-up loop of C2A03::Process() (nsfplay's NES_APU and
+// NES_DMC feeding Blip_Synth) on a few channel setups, and reports emulated
+// clocks per second and loop iterations per frame.
+// The checksum is taken over the output samples, so it only changes if the
+// emulated waveform does.
+// A VGM file of NES APU writes may be given to add a case driven by a real
+// module; tests/data/hell_or_high_water.vgm is rendered from the 2A03-only
+// demo module of the same name.
+// Define APU_BENCH_BASELINE to build against nsfplay sources from before
+// ClocksUntilLevelChange() skipped level-preserving steps.
+// Usage: ApuClockBench [frames] [stream.vgm]
+
+#include "APU/nsfplay/xgm/devices/Sound/nes_apu.h"
+#include "APU/nsfplay/xgm/devices/Sound/nes_dmc.h"
+#include "Blip_Buffer/Blip_Buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const uint32_t CLOCK_RATE = 1789773;		// NTSC
+const uint32_t CLOCKS_PER_FRAME = CLOCK_RATE / 60;
+const uint32_t SAMPLE_RATE = 48000;
+
+// DPCM sample data at $C000-$FFFF, made up unless an image is given
+class CBenchMemory : public xgm::IDevice
+{
+public:
+	explicit CBenchMemory(const std::vector<uint8_t> *pImage = nullptr) : m_pImage(pImage) { }
+	void Reset() override { }
+	bool Write(xgm::UINT32, xgm::UINT32, xgm::UINT32) override { return false; }
+	bool Read(xgm::UINT32 adr, xgm::UINT32 &val, xgm::UINT32) override {
+		val = m_pImage ? (*m_pImage)[adr & 0x3FFF] : (adr * 0x9E37 >> 7) & 0xFF;
+		return true;
+	}
+
+private:
+	const std::vector<uint8_t> *m_pImage;
+};
+
+using reg_write_t = std::pair<uint16_t, uint8_t>;
+
+struct bench_case_t {
+	const char *Name;
+	std::vector<reg_write_t> Init;
+	std::vector<reg_write_t> (*PerFrame)(int Frame);		// Volume changes, like an instrument sequence
+};
+
+const bench_case_t CASES[] = {
+	{"pulse, triangle, noise", {
+		{0x4015, 0x0F},
+		{0x4000, 0xBF}, {0x4002, 0xAB}, {0x4003, 0x01},
+		{0x4004, 0x7F}, {0x4006, 0xFE}, {0x4007, 0x00},
+		{0x4008, 0xFF}, {0x400A, 0xD5}, {0x400B, 0x00},
+		{0x400C, 0x38}, {0x400E, 0x04}, {0x400F, 0x00},
+	}, [] (int Frame) {
+		return std::vector<reg_write_t> {
+			{0x4000, static_cast<uint8_t>(0xB0 | (15 - Frame % 16))},
+			{0x4004, static_cast<uint8_t>(0x70 | (Frame / 4 % 16))},
+		};
+	}},
+	{"high noise", {
+		{0x4015, 0x08},
+		{0x400C, 0x3F}, {0x400E, 0x00}, {0x400F, 0x00},
+	}, [] (int Frame) {
+		return std::vector<reg_write_t> {{0x400C, static_cast<uint8_t>(0x30 | (15 - Frame % 16))}};
+	}},
+	{"pulse, DPCM sample", {
+		{0x4015, 0x03},
+		{0x4000, 0xBF}, {0x4002, 0x53}, {0x4003, 0x00},
+		{0x4004, 0x7F}, {0x4006, 0xA9}, {0x4007, 0x00},
+		{0x4010, 0x4F}, {0x4012, 0x00}, {0x4013, 0x40}, {0x4015, 0x13},
+	}, [] (int Frame) {
+		return std::vector<reg_write_t> {{0x4000, static_cast<uint8_t>(0xB0 | (15 - Frame % 16))}};
+	}},
+	{"pulse, ended DPCM sample", {
+		{0x4015, 0x03},
+		{0x4000, 0xBF}, {0x4002, 0x53}, {0x4003, 0x00},
+		{0x4004, 0x7F}, {0x4006, 0xA9}, {0x4007, 0x00},
+		{0x4010, 0x0F}, {0x4012, 0x00}, {0x4013, 0x01}, {0x4015, 0x13},
+	}, [] (int Frame) {
+		return std::vector<reg_write_t> {{0x4000, static_cast<uint8_t>(0xB0 | (15 - Frame % 16))}};
+	}},
+};
+
+// Register writes and timing read from a VGM file
+struct reg_stream_t {
+	struct frame_t {
+		std::vector<reg_write_t> Writes;		// Made before the frame is run
+		uint32_t Clocks;
+	};
+	std::vector<frame_t> Frames;
+	std::vector<uint8_t> Memory = std::vector<uint8_t>(0x4000);
+};
+
+bool LoadStream(const char *Path, reg_stream_t &Stream)
+{
+	std::ifstream File(Path, std::ios::binary);
+	const std::vector<uint8_t> Data {std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>()};
+	const auto Read32 = [&] (size_t Pos) {
+		return Pos + 4 > Data.size() ? 0u :
+			Data[Pos] | Data[Pos + 1] << 8 | Data[Pos + 2] << 16 | static_cast<uint32_t>(Data[Pos + 3]) << 24;
+	};
+	if (Data.size() < 0x40 || std::string(Data.begin(), Data.begin() + 4) != "Vgm ")
+		return false;
+
+	size_t Pos = Read32(0x08) >= 0x150 && Read32(0x34) ? 0x34 + Read32(0x34) : 0x40;
+	std::vector<reg_write_t> Writes;
+	uint64_t Samples = 0;		// Waits are counted in 44100 Hz samples
+	uint64_t Clock = 0;
+	const auto Wait = [&] (uint32_t Count) {
+		Samples += Count;
+		const uint64_t Target = Samples * CLOCK_RATE / 44100;
+		while (Clock < Target) {
+			const auto Clocks = static_cast<uint32_t>(std::min<uint64_t>(Target - Clock, CLOCKS_PER_FRAME));
+			Stream.Frames.push_back({std::move(Writes), Clocks});
+			Writes.clear();
+			Clock += Clocks;
+		}
+	};
+
+	while (Pos < Data.size()) {
+		const uint8_t Command = Data[Pos];
+		if (Command == 0x66)		// End of sound data
+			break;
+		if (Command == 0xB4 && Pos + 2 < Data.size()) {		// NES APU write
+			if (Data[Pos + 1] < 0x20)
+				Writes.emplace_back(0x4000 + Data[Pos + 1], Data[Pos + 2]);
+			Pos += 3;
+		}
+		else if (Command == 0x61 && Pos + 2 < Data.size()) {
+			Wait(Data[Pos + 1] | Data[Pos + 2] << 8);
+			Pos += 3;
+		}
+		else if (Command == 0x62 || Command == 0x63) {		// One NTSC or PAL frame
+			Wait(Command == 0x62 ? 735 : 882);
+			++Pos;
+		}
+		else if ((Command & 0xF0) == 0x70) {
+			Wait((Command & 0x0F) + 1);
+			++Pos;
+		}
+		else if (Command == 0x67 && Pos + 7 <= Data.size()) {		// Data block
+			const uint32_t Size = Read32(Pos + 3) & 0x7FFFFFFF;
+			if (Pos + 7 + Size > Data.size())
+				return false;
+			if (Data[Pos + 2] == 0xC2 && Size >= 2) {		// NES APU RAM from a 16-bit address
+				const unsigned Address = Data[Pos + 7] | Data[Pos + 8] << 8;
+				for (uint32_t i = 2; i < Size; ++i)
+					if (Address + i - 2 >= 0xC000 && Address + i - 2 <= 0xFFFF)
+						Stream.Memory[Address + i - 2 - 0xC000] = Data[Pos + 7 + i];
+			}
+			Pos += 7 + Size;
+		}
+		else
+			return false;		// Other sound chips are not handled
+	}
+	return !Stream.Frames.empty();
+}
+
+struct bench_result_t {
+	double Seconds;
+	uint64_t Clocks;
+	uint64_t Iterations;
+	uint64_t Checksum;
+};
+
+// Runs Frames frames, where GetFrame(Frame, Write) makes the register writes of
+// a frame and returns its length in clocks (at most CLOCKS_PER_FRAME)
+template <typename F>
+bench_result_t RunFrames(CBenchMemory &Memory, const std::vector<reg_write_t> &Init, int Frames, F GetFrame)
+{
+	xgm::NES_APU Apu1;
+	xgm::NES_DMC Apu2;
+	Apu2.SetOption(xgm::NES_DMC::OPT_RANDOMIZE_TRI, 0);		// See C2A03::C2A03()
+	Apu2.SetOption(xgm::NES_DMC::OPT_RANDOMIZE_NOISE, 0);
+	Apu2.SetAPU(&Apu1);
+	Apu2.SetMemory(&Memory);
+	Apu1.Reset();
+	Apu2.Reset();
+
+	auto Write = [&] (const std::vector<reg_write_t> &Writes) {
+		for (const auto &[Address, Value] : Writes) {
+			Apu1.Write(Address, Value);
+			Apu2.Write(Address, Value);
+		}
+	};
+	Write(Init);
+
+	Blip_Buffer Buffer;		// See CMixer::AllocateBuffer()
+	Buffer.set_sample_rate(SAMPLE_RATE);
+	Buffer.clock_rate(CLOCK_RATE);
+	Blip_Synth<blip_good_quality> SynthSS;
+	Blip_Synth<blip_good_quality> SynthTND;
+	SynthSS.volume(1.0, 8191);
+	SynthTND.volume(1.0, 8191);
+	std::vector<blip_amplitude_t> Samples(SAMPLE_RATE / 30);
+
+	bench_result_t Result { };
+	const auto Start = std::chrono::steady_clock::now();
+	for (int Frame = 0; Frame < Frames; ++Frame) {
+		const uint32_t FrameClocks = GetFrame(Frame, Write);
+		uint32_t now = 0;
+		while (now < FrameClocks) {		// See C2A03::Process()
+#ifdef APU_BENCH_BASELINE
+			const uint32_t dclocks = std::min({Apu1.ClocksUntilLevelChange(),
+				Apu2.ClocksUntilLevelChange(), FrameClocks - now});
+#else
+			const uint32_t dclocks = std::min({Apu1.ClocksUntilLevelChange(!Apu2.FrameSequencePending()),
+				Apu2.ClocksUntilLevelChange(), FrameClocks - now});
+#endif
+			Apu2.TickFrameSequence(dclocks);
+			Apu1.Tick(dclocks);
+			Apu2.Tick(dclocks);
+			xgm::INT32 out[2];
+			Apu1.Render(out);
+			SynthSS.update(now, out[0], &Buffer);
+			Apu2.Render(out);
+			SynthTND.update(now, out[0], &Buffer);
+			++Result.Iterations;
+			now += dclocks;
+		}
+		Buffer.end_frame(FrameClocks);
+		Result.Clocks += FrameClocks;
+		const auto Count = Buffer.read_samples(Samples.data(), static_cast<blip_nsamp_t>(Samples.size()));
+		for (blip_nsamp_t i = 0; i < Count; ++i)
+			Result.Checksum = Result.Checksum * 31 + static_cast<uint16_t>(Samples[i]);
+	}
+	Result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	return Result;
+}
+
+bench_result_t RunCase(const bench_case_t &Case, int Frames)
+{
+	CBenchMemory Memory;
+	return RunFrames(Memory, Case.Init, Frames, [&] (int Frame, const auto &Write) {
+		Write(Case.PerFrame(Frame));
+		return CLOCKS_PER_FRAME;
+	});
+}
+
+// Loops the stream until Frames frames have been run
+bench_result_t RunStream(const reg_stream_t &Stream, int Frames)
+{
+	CBenchMemory Memory(&Stream.Memory);
+	return RunFrames(Memory, { }, Frames, [&] (int Frame, const auto &Write) {
+		const auto &StreamFrame = Stream.Frames[Frame % Stream.Frames.size()];
+		Write(StreamFrame.Writes);
+		return StreamFrame.Clocks;
+	});
+}
+
+void PrintResult(const char *Name, const bench_result_t &Result, int Frames)
+{
+	std::printf("%-26s %8.1f Mclocks/s %8.1f iterations/frame  checksum %016llx\n",
+		Name, Result.Clocks / Result.Seconds / 1e6,
+		static_cast<double>(Result.Iterations) / Frames,
+		static_cast<unsigned long long>(Result.Checksum));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	const int Frames = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 36000;
+
+	reg_stream_t Stream;
+	if (argc > 2 && !LoadStream(argv[2], Stream)) {
+		std::fprintf(stderr, "Cannot read NES APU writes from %s\n", argv[2]);
+		return 1;
+	}
+
+	std::printf("%d frames of %u clocks per case\n", Frames, CLOCKS_PER_FRAME);
+	for (const auto &Case : CASES)
+		PrintResult(Case.Name, RunCase(Case, Frames), Frames);
+	if (argc > 2)
+		PrintResult("register stream", RunStream(Stream, Frames), Frames);
+	return 0;
+}
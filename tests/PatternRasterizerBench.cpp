@@ -0,0 +1,134 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+// Times full pattern area redraws with CPatternRasterizer, using a synthetic
+// glyph atlas of the size of the default pattern font.
+// Usage: PatternRasterizerBench [iterations]
+
+#include "PatternRasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const int WIDTH = 1920;
+const int HEIGHT = 1080;
+const int ROW_HEIGHT = 12;
+const int CHAR_WIDTH = 10;
+const int CHANNELS = 19;
+const int CHARS_PER_CHANNEL = 8;		// Note, instrument, volume and one effect column
+const int CHANNEL_WIDTH = CHARS_PER_CHANNEL * CHAR_WIDTH + 20;
+
+// Glyphs with opaque strokes and antialiased edges, like a rendered font
+void MakeAtlas(CGlyphAtlas &Atlas)
+{
+	Atlas.Create(CHAR_WIDTH, ROW_HEIGHT, CHAR_WIDTH / 2, ROW_HEIGHT - 2);
+	for (int c = CGlyphAtlas::FIRST_CHAR + 1; c <= CGlyphAtlas::LAST_CHAR; ++c) {
+		uint8_t *pMask = Atlas.GetMask(static_cast<char>(c));
+		for (int y = 1; y < ROW_HEIGHT - 2; ++y)
+			for (int x = 1; x < CHAR_WIDTH - 2; ++x) {
+				const int Bits = (c * 0x9E37 >> ((x + y * 3) % 13)) & 3;
+				pMask[y * CHAR_WIDTH + x] = Bits == 3 ? 0xFF : Bits == 2 ? 0x60 : 0;
+			}
+	}
+	Atlas.Finish();
+}
+
+template <typename F>
+double MedianMs(int Iterations, F &&Func)
+{
+	std::vector<double> Times;
+	for (int i = 0; i < Iterations; ++i) {
+		const auto Start = std::chrono::steady_clock::now();
+		Func();
+		Times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count());
+	}
+	std::sort(Times.begin(), Times.end());
+	return Times[Times.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	const int Iterations = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 200;
+
+	std::vector<uint32_t> Bits(WIDTH * HEIGHT);
+	CGlyphAtlas Atlas;
+	MakeAtlas(Atlas);
+	CPatternRasterizer Raster;
+	Raster.SetTarget(Bits.data(), WIDTH, HEIGHT, WIDTH);
+	Raster.SetAtlas(&Atlas);
+
+	const int Rows = HEIGHT / ROW_HEIGHT;
+	int Chars = 0;
+
+	// Same order as CPatternEditor::PerformFullRedraw, background and text of
+	// one row at a time, then the channel separators
+	auto FillRow = [&] (int Row) {
+		const int y = Row * ROW_HEIGHT;
+		Raster.FillRect(0, y, WIDTH, ROW_HEIGHT, Row & 3 ? 0x00101010 : 0x00202020);
+		if (Row == Rows / 2)
+			Raster.GradientBar(0, y, WIDTH, ROW_HEIGHT, 0x00A04020, 0x00101010);
+	};
+	auto TextRow = [&] (int Row) {
+		const int y = Row * ROW_HEIGHT + ROW_HEIGHT - 2;
+		for (int Ch = 0; Ch < CHANNELS; ++Ch)
+			for (int i = 0; i < CHARS_PER_CHANNEL; ++i, ++Chars)
+				Raster.DrawChar(Ch * CHANNEL_WIDTH + i * CHAR_WIDTH + CHAR_WIDTH / 2, y,
+					static_cast<char>('0' + (Row + Ch + i) % 43), 0x00F0F0F0);
+	};
+	auto Separators = [&] {
+		for (int Ch = 0; Ch < CHANNELS; ++Ch)
+			Raster.FillRect((Ch + 1) * CHANNEL_WIDTH - 1, 0, 1, HEIGHT, 0x00404040);
+	};
+
+	const double FillMs = MedianMs(Iterations, [&] {
+		for (int Row = 0; Row < Rows; ++Row)
+			FillRow(Row);
+		Separators();
+	});
+	const double TextMs = MedianMs(Iterations, [&] {
+		Chars = 0;
+		for (int Row = 0; Row < Rows; ++Row)
+			TextRow(Row);
+	});
+	const double FullMs = MedianMs(Iterations, [&] {
+		for (int Row = 0; Row < Rows; ++Row) {
+			FillRow(Row);
+			TextRow(Row);
+		}
+		Separators();
+	});
+	const double ScrollMs = MedianMs(Iterations, [&] {
+		Raster.MoveArea(0, ROW_HEIGHT, 0, WIDTH, HEIGHT - ROW_HEIGHT);
+	});
+
+	std::printf("%dx%d, %d rows, %d channels, %d characters, median of %d runs\n",
+		WIDTH, HEIGHT, Rows, CHANNELS, Chars, Iterations);
+	std::printf("full redraw  %8.3f ms\n", FullMs);
+	std::printf("fills        %8.3f ms\n", FillMs);
+	std::printf("characters   %8.3f ms\n", TextMs);
+	std::printf("scroll 1 row %8.3f ms\n", ScrollMs);
+	return 0;
+}
@@ -0,0 +1,247 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+// Checks CGlyphAtlas and CPatternRasterizer against hand-computed pixels.
+// Returns a nonzero exit code if any check fails.
+
+#include "PatternRasterizer.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+int g_iFailures = 0;
+
+#define CHECK_EQ(Actual, Expected) \
+	CheckEqual(static_cast<uint32_t>(Actual), static_cast<uint32_t>(Expected), #Actual, __LINE__)
+
+void CheckEqual(uint32_t Actual, uint32_t Expected, const char *pExpr, int Line)
+{
+	if (Actual != Expected) {
+		std::printf("line %d: %s is 0x%08X, expected 0x%08X\n", Line, pExpr, Actual, Expected);
+		++g_iFailures;
+	}
+}
+
+const uint32_t BACKGROUND = 0x123456;
+
+struct Target {
+	Target(int Width, int Height, int Pitch) :
+		Width(Width), Height(Height), Pitch(Pitch), Bits(Pitch * Height, BACKGROUND)
+	{
+		Raster.SetTarget(Bits.data(), Width, Height, Pitch);
+	}
+	uint32_t &At(int x, int y) {
+		return Bits[y * Pitch + x];
+	}
+	// Number of pixels of the rectangle which differ from the background
+	int Changed(int x, int y, int w, int h) {
+		int Count = 0;
+		for (int j = y; j < y + h; ++j)
+			for (int i = x; i < x + w; ++i)
+				Count += At(i, j) != BACKGROUND;
+		return Count;
+	}
+	int Width, Height, Pitch;
+	std::vector<uint32_t> Bits;
+	CPatternRasterizer Raster;
+};
+
+// 4x4 cells with the anchor at (1, 3); 'A' has one opaque pixel, one half
+// covered pixel and an opaque run of two pixels, every other glyph is empty
+void MakeAtlas(CGlyphAtlas &Atlas)
+{
+	Atlas.Create(4, 4, 1, 3);
+	uint8_t *pMask = Atlas.GetMask('A');
+	pMask[0 * 4 + 1] = 0xFF;
+	pMask[1 * 4 + 2] = 0x80;
+	pMask[3 * 4 + 0] = 0xFF;
+	pMask[3 * 4 + 1] = 0xFF;
+	Atlas.Finish();
+}
+
+void TestGlyphAtlas()
+{
+	CGlyphAtlas Atlas;
+	CHECK_EQ(Atlas.IsEmpty(), true);
+	CHECK_EQ(Atlas.GetMask('A') == nullptr, true);
+
+	MakeAtlas(Atlas);
+	CHECK_EQ(Atlas.IsEmpty(), false);
+	CHECK_EQ(Atlas.GetWidth(), 4);
+	CHECK_EQ(Atlas.GetHeight(), 4);
+	CHECK_EQ(Atlas.GetOriginX(), 1);
+	CHECK_EQ(Atlas.GetOriginY(), 3);
+	CHECK_EQ(Atlas.GetMask(CGlyphAtlas::FIRST_CHAR - 1) == nullptr, true);
+	CHECK_EQ(Atlas.GetMask(CGlyphAtlas::LAST_CHAR + 1) == nullptr, true);
+	CHECK_EQ(Atlas.GetMask('B') - Atlas.GetMask('A'), 16);
+
+	Atlas.Clear();
+	CHECK_EQ(Atlas.IsEmpty(), true);
+}
+
+void TestFillRect()
+{
+	Target t(8, 6, 10);
+
+	// COLORREF 0x00BBGGRR is stored as 0x00RRGGBB
+	t.Raster.FillRect(1, 1, 2, 3, 0x00332211);
+	CHECK_EQ(t.At(1, 1), 0x112233);
+	CHECK_EQ(t.At(2, 3), 0x112233);
+	CHECK_EQ(t.Changed(0, 0, 8, 6), 6);
+
+	// Negative sizes extend to the left and top, the origin offsets everything
+	t.Raster.SetOrigin(2, 1);
+	t.Raster.FillRect(3, 3, -2, -1, 0x00FFFFFF);
+	CHECK_EQ(t.At(3, 3), 0xFFFFFF);
+	CHECK_EQ(t.At(4, 3), 0xFFFFFF);
+	CHECK_EQ(t.Changed(0, 0, 8, 6), 8);
+
+	// Clipped to the target, the padding past the width is never written
+	t.Raster.SetOrigin(0, 0);
+	t.Raster.FillRect(-3, 4, 20, 10, 0);
+	CHECK_EQ(t.At(0, 5), 0);
+	CHECK_EQ(t.At(7, 4), 0);
+	CHECK_EQ(t.At(8, 4), BACKGROUND);
+	CHECK_EQ(t.At(9, 5), BACKGROUND);
+	CHECK_EQ(t.Changed(0, 0, 10, 6), 8 + 16);
+}
+
+void TestGradientBar()
+{
+	Target t(4, 6, 4);
+	t.Raster.GradientBar(0, 0, 3, 5, 0x000000FF, 0x00000000);
+
+	// First row is BLEND(ColFg, white, 95)
+	CHECK_EQ(t.At(0, 0), 0xFE0C0C);
+	CHECK_EQ(t.At(2, 0), 0xFE0C0C);
+	// Then from ColFg down to BLEND(ColFg, ColBg, 60) = 153 over four rows
+	CHECK_EQ(t.At(0, 1), 0xFF0000);
+	CHECK_EQ(t.At(1, 2), 0xE60000);
+	CHECK_EQ(t.At(1, 3), 0xCC0000);
+	CHECK_EQ(t.At(2, 4), 0xB30000);
+	CHECK_EQ(t.At(3, 2), BACKGROUND);
+	CHECK_EQ(t.Changed(0, 5, 4, 1), 0);
+}
+
+void TestDraw3dRect()
+{
+	Target t(6, 6, 6);
+	t.Raster.Draw3dRect(1, 1, 4, 4, 0x00FFFFFF, 0);
+	CHECK_EQ(t.At(1, 1), 0xFFFFFF);
+	CHECK_EQ(t.At(3, 1), 0xFFFFFF);
+	CHECK_EQ(t.At(1, 3), 0xFFFFFF);
+	CHECK_EQ(t.At(4, 1), 0);
+	CHECK_EQ(t.At(4, 4), 0);
+	CHECK_EQ(t.At(1, 4), 0);
+	CHECK_EQ(t.Changed(2, 2, 2, 2), 0);
+	CHECK_EQ(t.Changed(0, 0, 6, 6), 12);
+}
+
+void TestDrawChar()
+{
+	CGlyphAtlas Atlas;
+	MakeAtlas(Atlas);
+
+	Target t(8, 8, 8);
+	t.Raster.SetAtlas(&Atlas);
+
+	// Anchor at (4, 5): the cell covers (3, 2) to (6, 5)
+	t.Raster.DrawChar(4, 5, 'A', 0x00FFFFFF);
+	CHECK_EQ(t.At(4, 2), 0xFFFFFF);
+	CHECK_EQ(t.At(3, 5), 0xFFFFFF);
+	CHECK_EQ(t.At(4, 5), 0xFFFFFF);
+	// Coverage 0x80 is blended with a weight of 0x81 out of 256
+	const uint32_t Half = ((0xFF * 0x81 + 0x12 * 0x7F) >> 8) << 16 | ((0xFF * 0x81 + 0x34 * 0x7F) >> 8) << 8
+		| ((0xFF * 0x81 + 0x56 * 0x7F) >> 8);
+	CHECK_EQ(t.At(5, 3), Half);
+	CHECK_EQ(t.Changed(0, 0, 8, 8), 4);
+
+	// Empty glyphs, characters outside the atlas and a missing atlas draw nothing
+	t.Raster.DrawChar(1, 7, 'B', 0);
+	t.Raster.DrawChar(1, 7, '\x7F', 0);
+	t.Raster.SetAtlas(nullptr);
+	t.Raster.DrawChar(1, 7, 'A', 0);
+	CHECK_EQ(t.Changed(0, 0, 8, 8), 4);
+
+	// A glyph crossing the left and top edges only draws its visible part,
+	// with the same pixels as the unclipped glyph
+	Target c(8, 8, 8);
+	c.Raster.SetAtlas(&Atlas);
+	c.Raster.SetOrigin(-3, -2);
+	c.Raster.DrawChar(4, 5, 'A', 0x00FFFFFF);
+	CHECK_EQ(c.At(1, 0), 0xFFFFFF);
+	CHECK_EQ(c.At(2, 1), Half);
+	CHECK_EQ(c.At(0, 3), 0xFFFFFF);
+	CHECK_EQ(c.At(1, 3), 0xFFFFFF);
+	CHECK_EQ(c.Changed(0, 0, 8, 8), 4);
+
+	// Cut at the left edge, the first pixel of the bottom run is dropped
+	Target e(8, 8, 8);
+	e.Raster.SetAtlas(&Atlas);
+	e.Raster.DrawChar(0, 3, 'A', 0);
+	CHECK_EQ(e.At(0, 0), 0);
+	CHECK_EQ(e.At(1, 1), ((0x12 * 0x7F) >> 8) << 16 | ((0x34 * 0x7F) >> 8) << 8 | ((0x56 * 0x7F) >> 8));
+	CHECK_EQ(e.At(0, 3), 0);
+	CHECK_EQ(e.Changed(0, 0, 8, 8), 3);
+}
+
+void TestMoveArea()
+{
+	const int W = 5, H = 6;
+	for (int Dest : {0, 2}) {
+		Target t(W, H, W);
+		for (int y = 0; y < H; ++y)
+			for (int x = 0; x < W; ++x)
+				t.At(x, y) = y * 16 + x;
+		std::vector<uint32_t> Expected = t.Bits;
+		const int Src = 3 - Dest;		// Overlapping rows in both directions
+		for (int i = 0; i < 3; ++i)
+			std::memmove(&Expected[(Dest + i) * W + 1], &t.Bits[(Src + i) * W + 1], 3 * sizeof(uint32_t));
+		t.Raster.MoveArea(1, Src, Dest, 3, 3);
+		for (int y = 0; y < H; ++y)
+			for (int x = 0; x < W; ++x)
+				CHECK_EQ(t.At(x, y), Expected[y * W + x]);
+	}
+
+	// Rows past the bottom are clipped
+	Target t(4, 4, 4);
+	t.At(0, 3) = 0;
+	t.Raster.MoveArea(0, 3, 0, 4, 8);
+	CHECK_EQ(t.At(0, 0), 0);
+	CHECK_EQ(t.Changed(0, 1, 4, 3), 1);
+}
+
+} // namespace
+
+int main()
+{
+	TestGlyphAtlas();
+	TestFillRect();
+	TestGradientBar();
+	TestDraw3dRect();
+	TestDrawChar();
+	TestMoveArea();
+
+	if (g_iFailures)
+		std::printf("%d checks failed\n", g_iFailures);
+	return g_iFailures ? 1 : 0;
+}
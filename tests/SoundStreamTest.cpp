@@ -0,0 +1,197 @@
+/*
+** Dn-FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2020-2025 D.P.C.M.
+** FamiTracker Copyright (C) 2005-2020 Jonathan Liss
+** 0CC-FamiTracker Copyright (C) 2014-2018 HertzDevil
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see https://www.gnu.org/licenses/.
+*/
+
+// Checks how CSoundStream fills up to its target and waits for the device,
+// using CNullSoundStream, which plays audio from the system clock.
+// Returns a nonzero exit code if any check fails.
+
+#include "SoundStream.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+int g_iFailures = 0;
+
+#define CHECK_EQ(Actual, Expected) \
+	CheckEqual(static_cast<long>(Actual), static_cast<long>(Expected), #Actual, __LINE__)
+#define CHECK(Cond) \
+	CheckEqual(static_cast<long>(Cond), 1, #Cond, __LINE__)
+
+void CheckEqual(long Actual, long Expected, const char *pExpr, int Line)
+{
+	if (Actual != Expected) {
+		std::printf("line %d: %s is %ld, expected %ld\n", Line, pExpr, Actual, Expected);
+		++g_iFailures;
+	}
+}
+
+const unsigned int RATE = 48000;
+const unsigned int BUFFER_FRAMES = RATE / 10;		// 100 ms
+const DWORD LONG_TIMEOUT = 1000;
+
+// One null stream with its interrupt event
+struct Stream {
+	explicit Stream(FILE *pFile = nullptr) :
+		hInterrupt(CreateEventW(nullptr, TRUE, FALSE, nullptr)),
+		Null(hInterrupt, RATE, BUFFER_FRAMES, 1, pFile)
+	{
+	}
+	~Stream() {
+		CloseHandle(hInterrupt);
+	}
+	// Writes Frames frames of silence
+	bool Write(uint32_t Frames) {
+		std::vector<float> Buffer(Frames);
+		return Null.WriteBuffer(Buffer.data(), Null.FramesToPubBytes(Frames));
+	}
+	HANDLE hInterrupt;
+	CNullSoundStream Null;
+};
+
+void TestTarget()
+{
+	Stream s;
+	CHECK_EQ(s.Null.GetTargetFrames(), BUFFER_FRAMES);
+	CHECK_EQ(s.Null.BufferFramesWritable(), BUFFER_FRAMES);
+	CHECK_EQ(s.Null.BufferBytesWritable(), BUFFER_FRAMES * sizeof(float));
+
+	// The target stays between 1 frame and the buffer size
+	s.Null.SetTargetFrames(0);
+	CHECK_EQ(s.Null.GetTargetFrames(), 1);
+	s.Null.SetTargetFrames(BUFFER_FRAMES * 2);
+	CHECK_EQ(s.Null.GetTargetFrames(), BUFFER_FRAMES);
+
+	s.Null.SetTargetFrames(960);
+	CHECK_EQ(s.Null.BufferFramesWritable(), 960);
+}
+
+void TestFill()
+{
+	// A stopped stream never waits and plays nothing until it reaches the target
+	Stream s;
+	s.Null.SetTargetFrames(960);
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Ready);
+	CHECK(s.Write(480));
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Ready);
+	Sleep(20);
+	CHECK_EQ(s.Null.BufferFramesQueued(), 480);
+	CHECK_EQ(s.Null.BufferFramesWritable(), 480);
+
+	// Reaching the target starts playback, which drains the queue
+	CHECK(s.Write(480));
+	Sleep(5);
+	CHECK(s.Null.BufferFramesQueued() < 960);
+
+	// Audio written past the buffer size is dropped
+	s.Null.SetTargetFrames(BUFFER_FRAMES);
+	CHECK(s.Write(BUFFER_FRAMES * 2));
+	CHECK(s.Null.BufferFramesQueued() <= BUFFER_FRAMES);
+
+	// Clearing stops the stream and empties it
+	CHECK(s.Null.ClearBuffer());
+	CHECK_EQ(s.Null.BufferFramesQueued(), 0);
+	CHECK_EQ(s.Null.BufferFramesWritable(), BUFFER_FRAMES);
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Ready);
+}
+
+void TestWait()
+{
+	Stream s;
+	s.Null.SetTargetFrames(BUFFER_FRAMES);
+	CHECK(s.Write(BUFFER_FRAMES));
+
+	// A full stream waits for the device, which plays some of the queue
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Ready);
+	const uint32_t Writable = s.Null.BufferFramesWritable();
+	CHECK(Writable > 0);
+	CHECK(s.Null.BufferFramesQueued() > 0);
+
+	// After a partial write, audio can be written again without waiting
+	CHECK(s.Write(Writable / 2));
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, true) == WaitResult::Ready);
+
+	// Timeouts shorter than the device period expire
+	CHECK(s.Write(s.Null.BufferFramesWritable()));
+	CHECK(s.Null.WaitForReady(1, false) == WaitResult::Timeout);
+
+	// Setting the interrupt event cancels waits
+	SetEvent(s.hInterrupt);
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Interrupted);
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, true) == WaitResult::Interrupted);
+	ResetEvent(s.hInterrupt);
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Ready);
+}
+
+void TestLoweredTarget()
+{
+	// Lowering the target below the queued audio before playback starts the stream
+	Stream s;
+	CHECK(s.Write(BUFFER_FRAMES / 2));
+	s.Null.SetTargetFrames(BUFFER_FRAMES / 4);
+	CHECK_EQ(s.Null.BufferFramesWritable(), 0);
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Ready);
+	CHECK(s.Null.BufferFramesQueued() < BUFFER_FRAMES / 2);
+}
+
+void TestUnderrun()
+{
+	// One wake-up period drains a 1 ms target, the next wait reports the underrun
+	Stream s;
+	s.Null.SetTargetFrames(RATE / 1000);
+	CHECK(s.Write(RATE / 1000));
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::OutOfSync);
+	CHECK_EQ(s.Null.BufferFramesQueued(), 0);
+
+	// A larger target recovers
+	s.Null.SetTargetFrames(BUFFER_FRAMES);
+	CHECK(s.Write(s.Null.BufferFramesWritable()));
+	CHECK(s.Null.WaitForReady(LONG_TIMEOUT, false) == WaitResult::Ready);
+}
+
+void TestFile()
+{
+	// All written audio goes to the file, even past a full buffer
+	FILE *pFile = std::tmpfile();
+	CHECK(pFile != nullptr);
+	if (!pFile)
+		return;
+	Stream s(pFile);
+	CHECK(s.Write(480));
+	CHECK(s.Write(BUFFER_FRAMES * 2));
+	std::fflush(pFile);
+	CHECK_EQ(std::ftell(pFile), (480 + BUFFER_FRAMES * 2) * sizeof(float));
+}
+
+} // namespace
+
+int main()
+{
+	TestTarget();
+	TestFill();
+	TestWait();
+	TestLoweredTarget();
+	TestUnderrun();
+	TestFile();
+
+	if (g_iFailures)
+		std::printf("%d checks failed\n", g_iFailures);
+	return g_iFailures ? 1 : 0;
+}